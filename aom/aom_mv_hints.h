@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_AOM_MV_HINTS_H_
+#define AOM_AOM_AOM_MV_HINTS_H_
+
+/*!\file
+ * \brief Describes the motion vector hints exchanged with the codecs.
+ *
+ * The decoder exports the motion field of a frame in this form, and the
+ * encoder accepts it to speed up its motion searches when transcoding.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aom/aom_integer.h"
+
+/*!\brief Motion vector hint for one block of a frame
+ *
+ * See AV1E_SET_MV_HINTS and AV1D_GET_MV_HINTS.
+ */
+typedef struct aom_mv_hint {
+  int16_t row; /**< Vertical component, in 1/8 pel units */
+  int16_t col; /**< Horizontal component, in 1/8 pel units */
+  /*!\brief Display order distance from the frame to the frame the vector
+   * points to, e.g. -1 for the previous frame and 2 for the second next one.
+   *
+   * The encoder scales the vector linearly to the distance of each of its
+   * own reference frames. 0 marks a block without a hint.
+   */
+  int8_t ref_distance;
+} aom_mv_hint_t;
+
+/*!\brief Motion vector hints for a frame
+ *
+ * See AV1E_SET_MV_HINTS and AV1D_GET_MV_HINTS.
+ */
+typedef struct aom_mv_hint_map {
+  /*! rows * cols hints, in raster order. */
+  aom_mv_hint_t *hints;
+  unsigned int block_size; /**< Block size in pixels, 8 or 16 */
+  unsigned int rows;       /**< Number of rows, rounded up */
+  unsigned int cols;       /**< Number of cols, rounded up */
+  /*! Encoder refinement range around the hints in full pels, 0 selects the
+   * default. Not used by the decoder. */
+  unsigned int search_range;
+} aom_mv_hint_map_t;
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_AOM_MV_HINTS_H_
@@ -19,6 +19,7 @@
 #include "aom/aom.h"
 #include "aom/aom_encoder.h"
 #include "aom/aom_external_partition.h"
+#include "aom/aom_mv_hints.h"
 
 /*!\file
  * \brief Provides definitions for using AOM or AV1 encoder algorithm within the
@@ -1533,6 +1534,190 @@ enum aome_enc_control_id {
    */
   AV1E_SET_MAX_CONSEC_FRAME_DROP_CBR = 164,
 
+  /*!\brief Codec control to get a per-subsystem breakdown of the memory held
+   * by the encoder, aom_mem_usage_t * parameter.
+   *
+   * Both the live bytes at the time of the call and the peak live bytes
+   * observed since the encoder was created are reported. The peak is sampled
+   * once per aom_codec_encode() call.
+   */
+  AV1E_GET_MEMORY_USAGE = 165,
+
+  /*!\brief Codec control to set a memory budget in MiB for the frame-sized
+   * buffers of the encoder, unsigned int parameter.
+   *
+   * - 0 = no limit (default)
+   *
+   * When the estimated size of the lookahead, TPL, temporal filter and
+   * reference buffers exceeds the budget, global motion is disabled to drop
+   * the image pyramids, and then the lookahead is shortened. The TPL and
+   * temporal filter buffers scale with the lookahead depth.
+   *
+   * The settings lowered to fit the budget are reported by
+   * AV1E_GET_MEMORY_USAGE.
+   *
+   * \attention Must be set before the first frame is encoded. The budget is
+   *            applied until the lookahead is allocated with the first frame,
+   *            and the lookahead depth it picked is kept by the later config
+   *            changes, including resolution changes. With one-pass
+   *            lookahead processing, the lookahead depth is fixed at
+   *            initialization and only the pyramids are affected.
+   */
+  AV1E_SET_MEMORY_BUDGET = 166,
+
+  /*!\brief Codec control to set the analysis file to import, const char *
+   * parameter.
+   *
+   * The file must have been written with AV1E_SET_ANALYSIS_EXPORT_FILE by a
+   * previous encode of the same source with the same dimensions and GOP
+   * settings, e.g. at another bitrate or cq-level. The TPL model reuses the
+   * motion vectors it holds instead of running its own motion search, and
+   * only recomputes the QP dependent costs. Frames missing from the file are
+   * searched as usual.
+   *
+   * First pass statistics are reused separately, through
+   * rc_twopass_stats_in.
+   *
+   * \attention Must be set before the first frame is encoded.
+   */
+  AV1E_SET_ANALYSIS_IMPORT_FILE = 167,
+
+  /*!\brief Codec control to set the analysis file to write, const char *
+   * parameter.
+   *
+   * The file is versioned and holds the TPL motion vectors of every frame
+   * against each of its reference frames. See AV1E_SET_ANALYSIS_IMPORT_FILE.
+   *
+   * \attention Must be set before the first frame is encoded.
+   */
+  AV1E_SET_ANALYSIS_EXPORT_FILE = 168,
+
+  /*!\brief Codec control to set motion vector hints for the next frame,
+   * aom_mv_hint_map_t* parameter.
+   *
+   * The hints apply to the next frame passed to aom_codec_encode(), e.g. the
+   * motion field of the same frame in the stream being transcoded. The
+   * encoder starts its motion searches (temporal filtering, TPL model and
+   * mode decision) from the hinted vectors and only refines them within
+   * aom_mv_hint_map_t::search_range pixels. The map is copied, so it may be
+   * freed once the control returns. A NULL map clears the hints.
+   *
+   * Hints are ignored for frames coded at a different size than the source,
+   * e.g. with resize or superres.
+   */
+  AV1E_SET_MV_HINTS = 169,
+
+  /*!\brief Codec control to time the main stages of the encoder at runtime,
+   * unsigned int parameter.
+   *
+   * - 0 = disable (default)
+   * - 1 = enable
+   *
+   * Enabling the timing resets the cumulative times. The times are read with
+   * AV1E_GET_COMPONENT_TIMING. Builds with CONFIG_COLLECT_COMPONENT_TIMING
+   * always time all the components.
+   */
+  AV1E_SET_COMPONENT_TIMING = 170,
+
+  /*!\brief Codec control to get the encode times of the encoder components,
+   * aom_component_timing_t * parameter.
+   *
+   * The times of the last encoded frame and the cumulative times since the
+   * timing was enabled with AV1E_SET_COMPONENT_TIMING are reported, in
+   * microseconds. The components are nested, e.g. av1_encode_strategy_time
+   * includes all the others.
+   */
+  AV1E_GET_COMPONENT_TIMING = 171,
+
+  /*!\brief Codec control to collect the statistics of each superblock,
+   * unsigned int parameter.
+   *
+   * - 0 = disable (default)
+   * - 1 = enable
+   *
+   * The statistics of the last coded frame are read with AV1E_GET_SB_STATS.
+   */
+  AV1E_SET_SB_STATS = 172,
+
+  /*!\brief Codec control to get the statistics of each superblock of the last
+   * coded frame, aom_sb_stats_map_t* parameter.
+   *
+   * The caller provides rows * cols stats. A NULL stats only returns the size
+   * of the map. AOM_CODEC_INVALID_PARAM is returned, and the map is left
+   * unchanged, if stats is too small. AOM_CODEC_ERROR is returned if no frame
+   * was coded since AV1E_SET_SB_STATS enabled the statistics.
+   */
+  AV1E_GET_SB_STATS = 173,
+
+  /*!\brief Codec control to set a target encode time per frame in
+   * microseconds, unsigned int parameter.
+   *
+   * - 0 = no target (default)
+   *
+   * The encoder measures the time of each frame and, when the average exceeds
+   * the target, raises the speed features of the non-rd mode search step by
+   * step towards the settings of the faster presets. When the average falls
+   * well below the target, the steps are undone. The speed set with
+   * AOME_SET_CPUUSED is the slowest and best quality setting used. Intra
+   * frames and scene changes are always coded at that speed. A new target
+   * keeps the steps taken so far, which then adapt to it. A target of 0 undoes
+   * them at once.
+   *
+   * \note Only applies to the realtime mode, at speed 7 and above.
+   */
+  AV1E_SET_FRAME_TIME_BUDGET = 174,
+
+  /*!\brief Codec control to output the OBUs of each frame in chunks as soon
+   * as they are packed, aom_tile_group_cb_t* parameter.
+   *
+   * Each frame is first handed to the callback as a chunk holding the
+   * sequence header, metadata and frame header OBUs, then as one chunk per
+   * tile group OBU, in bitstream order. The frame is still returned in a
+   * packet by aom_codec_get_cx_data(): the chunks are that packet without
+   * its temporal delimiter. A NULL callback disables the chunks (default).
+   *
+   * In the realtime mode, when the loop filter and CDEF levels are picked
+   * from the quantizer and the loop restoration is off, the frame header is
+   * written before the tiles are encoded, and each tile group is handed out
+   * as soon as its tiles are encoded, before the frame is filtered. With
+   * several threads, the tile groups are handed out once all the tiles are
+   * encoded. Those frames signal context_update_tile_id 0 and 4-byte tile
+   * sizes, and do not use the temporal prediction of the segment ids.
+   * Otherwise, the whole frame is handed to the callback in one chunk once
+   * it is packed.
+   *
+   * \note The callback is not called with the annexb output, the large scale
+   * tiles or the frame parallel encoding. The tile groups are not streamed
+   * with superres, film grain, delta q, intra block copy or an MTU size.
+   */
+  AV1E_SET_TILE_GROUP_CALLBACK = 175,
+
+  /*!\brief Codec control function to disable the cache of the full pixel
+   * motion search distortions, unsigned int parameter.
+   *
+   * - 0 = use the cache (default)
+   * - 1 = disable the cache
+   *
+   * \note This is only used in the unit test checking that the cache does
+   * not change the output.
+   */
+  AV1E_DISABLE_FULLPEL_SEARCH_CACHE_UNIT_TEST = 176,
+
+  /*!\brief Codec control to drop the frames that repeat the previous source
+   * in 1 pass CBR mode, unsigned int parameter.
+   *
+   * - 0 = disable (default)
+   * - 1 = enable
+   *
+   * Once the source has been static for 30 frames, so that its quality could
+   * ramp up, every frame identical to the previous source is dropped.
+   *
+   * \note Only applies to screen content (AV1E_SET_TUNE_CONTENT) in the
+   * realtime mode without spatial or temporal layers, and only when frame
+   * dropping is enabled with a nonzero rc_dropframe_thresh.
+   */
+  AV1E_SET_DROP_STATIC_FRAMES = 177,
+
   // Any new encoder control IDs should be added above.
   // Maximum allowed encoder control ID is 229.
   // No encoder control ID should be added below.
@@ -1699,6 +1884,95 @@ typedef struct aom_svc_ref_frame_comp_pred {
   int use_comp_pred[3]; /**<Compound reference flag. */
 } aom_svc_ref_frame_comp_pred_t;
 
+/*!\brief Encoder subsystems tracked by AV1E_GET_MEMORY_USAGE */
+typedef enum {
+  AOM_MEM_LOOKAHEAD,          /**< Lookahead (and LAP) source buffers */
+  AOM_MEM_TPL,                /**< TPL stats and reconstruction buffers */
+  AOM_MEM_TEMPORAL_FILTER,    /**< Temporal filter output buffers */
+  AOM_MEM_PYRAMID,            /**< Image pyramids for global motion */
+  AOM_MEM_THREAD_DATA,        /**< Per-worker ThreadData */
+  AOM_MEM_TXB,                /**< Transform coefficient buffers */
+  AOM_MEM_FRAME_BUFFER_POOL,  /**< Reference/reconstruction frame buffers */
+  AOM_MEM_CATEGORIES          /**< Number of categories */
+} aom_mem_category_t;
+
+/*!\brief Memory usage of the encoder, in bytes, indexed by aom_mem_category_t
+ */
+typedef struct aom_mem_usage {
+  uint64_t live_bytes[AOM_MEM_CATEGORIES]; /**< Currently allocated */
+  uint64_t peak_bytes[AOM_MEM_CATEGORIES]; /**< Peak allocated */
+  uint64_t total_live_bytes;               /**< Sum of live_bytes */
+  uint64_t total_peak_bytes;               /**< Peak of total_live_bytes */
+  /*!\brief Lookahead depth in frames */
+  unsigned int lag_in_frames;
+  /*!\brief Set when the lookahead was shortened to fit in
+   * AV1E_SET_MEMORY_BUDGET. */
+  int lag_in_frames_lowered;
+  /*!\brief Set when global motion was disabled to fit in
+   * AV1E_SET_MEMORY_BUDGET. */
+  int global_motion_disabled;
+} aom_mem_usage_t;
+
+/*!\brief Maximum number of components reported by AV1E_GET_COMPONENT_TIMING
+ */
+#define AOM_MAX_TIMING_COMPONENTS 64
+
+/*!\brief Encode times of the encoder components, in microseconds */
+typedef struct aom_component_timing {
+  int num_components; /**< Number of components reported */
+  /*! Name of each component, e.g. "av1_tpl_setup_stats_time" */
+  const char *names[AOM_MAX_TIMING_COMPONENTS];
+  /*! Time of each component for the last encoded frame */
+  uint64_t frame_us[AOM_MAX_TIMING_COMPONENTS];
+  /*! Time of each component since the timing was enabled */
+  uint64_t total_us[AOM_MAX_TIMING_COMPONENTS];
+} aom_component_timing_t;
+
+/*!\brief Statistics of a superblock
+ *
+ * See AV1E_GET_SB_STATS.
+ */
+typedef struct aom_sb_stats {
+  /*! Sum of squared errors of the luma reconstruction, before the loop
+   * filters */
+  uint64_t sse;
+  /*! Time of the partition search, mode search and encoding of the
+   * superblock, in microseconds, summed over the recode iterations */
+  uint32_t encode_us;
+  uint32_t bits; /**< Size of the superblock in the bitstream, in bits */
+  /*! Number of square splits above the smallest block of the superblock, 0
+   * if the superblock is coded as one block */
+  uint8_t partition_depth;
+} aom_sb_stats_t;
+
+/*!\brief Statistics of the superblocks of a frame
+ *
+ * See AV1E_GET_SB_STATS.
+ */
+typedef struct aom_sb_stats_map {
+  /*! rows * cols stats, in raster order. */
+  aom_sb_stats_t *stats;
+  unsigned int sb_size; /**< Superblock size in pixels, 64 or 128 */
+  unsigned int rows;    /**< Number of rows, rounded up */
+  unsigned int cols;    /**< Number of cols, rounded up */
+} aom_sb_stats_map_t;
+
+/*!\brief Callback receiving a chunk of the OBUs of a frame
+ *
+ * data is only valid during the call. See AV1E_SET_TILE_GROUP_CALLBACK.
+ */
+typedef void (*aom_tile_group_cb_fn_t)(void *user_priv, const uint8_t *data,
+                                       size_t size);
+
+/*!\brief Tile group output callback
+ *
+ * See AV1E_SET_TILE_GROUP_CALLBACK.
+ */
+typedef struct aom_tile_group_cb {
+  aom_tile_group_cb_fn_t callback; /**< Called with each chunk, or NULL */
+  void *user_priv;                 /**< Passed to the callback */
+} aom_tile_group_cb_t;
+
 /*!\cond */
 /*!\brief Encoder control function parameter type
  *
@@ -2181,6 +2455,45 @@ AOM_CTRL_USE_TYPE(AV1E_SET_BITRATE_ONE_PASS_CBR, unsigned int)
 AOM_CTRL_USE_TYPE(AV1E_SET_MAX_CONSEC_FRAME_DROP_CBR, int)
 #define AOM_CTRL_AV1E_SET_MAX_CONSEC_FRAME_DROP_CBR
 
+AOM_CTRL_USE_TYPE(AV1E_GET_MEMORY_USAGE, aom_mem_usage_t *)
+#define AOM_CTRL_AV1E_GET_MEMORY_USAGE
+
+AOM_CTRL_USE_TYPE(AV1E_SET_MEMORY_BUDGET, unsigned int)
+#define AOM_CTRL_AV1E_SET_MEMORY_BUDGET
+
+AOM_CTRL_USE_TYPE(AV1E_SET_ANALYSIS_IMPORT_FILE, const char *)
+#define AOM_CTRL_AV1E_SET_ANALYSIS_IMPORT_FILE
+
+AOM_CTRL_USE_TYPE(AV1E_SET_ANALYSIS_EXPORT_FILE, const char *)
+#define AOM_CTRL_AV1E_SET_ANALYSIS_EXPORT_FILE
+
+AOM_CTRL_USE_TYPE(AV1E_SET_MV_HINTS, aom_mv_hint_map_t *)
+#define AOM_CTRL_AV1E_SET_MV_HINTS
+
+AOM_CTRL_USE_TYPE(AV1E_SET_COMPONENT_TIMING, unsigned int)
+#define AOM_CTRL_AV1E_SET_COMPONENT_TIMING
+
+AOM_CTRL_USE_TYPE(AV1E_GET_COMPONENT_TIMING, aom_component_timing_t *)
+#define AOM_CTRL_AV1E_GET_COMPONENT_TIMING
+
+AOM_CTRL_USE_TYPE(AV1E_SET_SB_STATS, unsigned int)
+#define AOM_CTRL_AV1E_SET_SB_STATS
+
+AOM_CTRL_USE_TYPE(AV1E_GET_SB_STATS, aom_sb_stats_map_t *)
+#define AOM_CTRL_AV1E_GET_SB_STATS
+
+AOM_CTRL_USE_TYPE(AV1E_SET_FRAME_TIME_BUDGET, unsigned int)
+#define AOM_CTRL_AV1E_SET_FRAME_TIME_BUDGET
+
+AOM_CTRL_USE_TYPE(AV1E_SET_TILE_GROUP_CALLBACK, aom_tile_group_cb_t *)
+#define AOM_CTRL_AV1E_SET_TILE_GROUP_CALLBACK
+
+AOM_CTRL_USE_TYPE(AV1E_DISABLE_FULLPEL_SEARCH_CACHE_UNIT_TEST, unsigned int)
+#define AOM_CTRL_AV1E_DISABLE_FULLPEL_SEARCH_CACHE_UNIT_TEST
+
+AOM_CTRL_USE_TYPE(AV1E_SET_DROP_STATIC_FRAMES, unsigned int)
+#define AOM_CTRL_AV1E_SET_DROP_STATIC_FRAMES
+
 /*!\endcond */
 /*! @} - end defgroup aom_encoder */
 #ifdef __cplusplus
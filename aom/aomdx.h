@@ -27,6 +27,7 @@ extern "C" {
 
 /* Include controls common to both the encoder and decoder */
 #include "aom/aom.h"
+#include "aom/aom_mv_hints.h"
 
 /*!\name Algorithm interface for AV1
  *
@@ -172,6 +173,70 @@ typedef struct aom_screen_content_tools_info {
   int force_integer_mv;
 } aom_screen_content_tools_info;
 
+/*!\brief Maximum number of frames described by aom_tu_parse_info. */
+#define AOM_MAX_TU_PARSE_FRAMES 16
+
+/*!\brief Structure to hold the header information of one frame.
+ *
+ * For a frame shown with show_existing_frame, the fields other than
+ * show_existing_frame and size describe the frame being shown, and
+ * base_q_idx is -1.
+ */
+typedef struct aom_frame_parse_info {
+  /*! Frame type: 0 = key, 1 = inter, 2 = intra-only, 3 = switch frame */
+  int frame_type;
+  /*! Is the frame shown */
+  int show_frame;
+  /*! Can the frame be shown later with show_existing_frame */
+  int showable_frame;
+  /*! Is the frame a show_existing_frame of an earlier frame */
+  int show_existing_frame;
+  /*! Bit mask of the reference slots refreshed by the frame */
+  int refresh_frame_flags;
+  /*! Base q index of the frame */
+  int base_q_idx;
+  /*! Order hint of the frame */
+  unsigned int order_hint;
+  /*! Temporal layer id of the frame */
+  int temporal_id;
+  /*! Spatial layer id of the frame */
+  int spatial_id;
+  /*! Frame width in pixels, after superres upscaling */
+  int width;
+  /*! Frame height in pixels */
+  int height;
+  /*! Bytes of the temporal unit consumed by the frame, including the
+   * temporal delimiter and sequence header OBUs that precede it */
+  size_t size;
+} aom_frame_parse_info;
+
+/*!\brief Structure to hold the header information of the frames in a
+ * temporal unit.
+ */
+typedef struct aom_tu_parse_info {
+  /*! Number of valid entries in frames */
+  int num_frames;
+  /*! Per frame header information, in decoding order */
+  aom_frame_parse_info frames[AOM_MAX_TU_PARSE_FRAMES];
+} aom_tu_parse_info;
+
+/*!\brief Structure to hold the decoding progress of a frame.
+ *
+ * See AV1D_GET_DECODE_PROGRESS.
+ */
+typedef struct aom_decode_progress {
+  /*! Number of superblock rows of the frame */
+  unsigned int sb_rows;
+  /*! Number of superblock rows, from the top, whose tiles are all decoded */
+  unsigned int decoded_sb_rows;
+  /*! Superblock size in pixels, 64 or 128 */
+  unsigned int sb_size;
+  /*! The frame being decoded, before the in-loop filters, or all zeros when
+   * no frame is partially decoded. Only valid until the next call to
+   * aom_codec_decode() */
+  aom_image_t img;
+} aom_decode_progress_t;
+
 /*!\brief Structure to hold the external reference frame pointer.
  *
  * Define a structure to hold the external reference frame pointer.
@@ -463,6 +528,70 @@ enum aom_dec_control_id {
    * be used.
    */
   AV1D_GET_MI_INFO,
+
+  /*!\brief Codec control function to only parse the headers of the
+   * bitstream, int parameter
+   *
+   * When set to nonzero, the decoder parses the sequence, frame and tile group
+   * headers but skips tile decoding, reconstruction and all in-loop filtering.
+   * No frames are output; use AV1D_GET_TU_PARSE_INFO to read the header
+   * information of each temporal unit. Reference frame state is tracked so
+   * that the headers of later frames are parsed correctly, but if this is
+   * turned off mid-stream, frames are only correct again from the next key
+   * frame. The default value is 0.
+   */
+  AV1D_SET_HEADER_ONLY,
+
+  /*!\brief Codec control function to get the header information of the
+   * frames in the last temporal unit decoded, aom_tu_parse_info* parameter
+   *
+   * This is available both with and without AV1D_SET_HEADER_ONLY. At most
+   * AOM_MAX_TU_PARSE_FRAMES frames are reported.
+   */
+  AV1D_GET_TU_PARSE_INFO,
+
+  /*!\brief Codec control function to get the motion field of the last frame
+   * returned by aom_codec_get_frame(), aom_mv_hint_map_t* parameter
+   *
+   * The caller sets block_size to 8 or 16, and provides rows * cols hints
+   * covering the coded frame size. Each hint holds the motion vector of the
+   * block to one of its past reference frames, or has a ref_distance of 0 if
+   * the block is intra coded or only predicted from future frames. The map
+   * can be passed to the encoder with AV1E_SET_MV_HINTS to transcode the
+   * frame. Requires a stream coded with reference frame motion vectors
+   * (enable_ref_frame_mvs in the sequence header).
+   *
+   * \note Only the motion is exported. The partitioning, prediction modes
+   * and reference frames of the blocks are not, and the encoder does not
+   * take them as input.
+   */
+  AV1D_GET_MV_HINTS,
+
+  /*!\brief Codec control function to decode the frames as their OBUs arrive,
+   * int parameter
+   *
+   * When set to nonzero, the data passed to aom_codec_decode() may end in the
+   * middle of a frame, between two OBUs: e.g. the sequence and frame headers
+   * in one call, then each tile group in its own call. The tile groups are
+   * decoded as they are received, and the frame is filtered and output by
+   * the call which holds its last tile group. AV1D_GET_DECODE_PROGRESS
+   * reports the superblock rows decoded so far. Not supported with annexb or
+   * large scale tile streams. The default value is 0.
+   */
+  AV1D_SET_INCREMENTAL_DECODE,
+
+  /*!\brief Codec control function to get the decoding progress of the frame
+   * being decoded, or of the last decoded frame, aom_decode_progress_t*
+   * parameter
+   *
+   * With AV1D_SET_INCREMENTAL_DECODE, the first decoded_sb_rows superblock
+   * rows of img are reconstructed before the later tile groups arrive. The
+   * loop filter, CDEF and loop restoration only run once the whole frame is
+   * decoded, so these rows only hold their final pixels when the stream
+   * disables these filters. Returns AOM_CODEC_ERROR before the first frame
+   * header.
+   */
+  AV1D_GET_DECODE_PROGRESS,
 };
 
 /*!\cond */
@@ -592,6 +721,21 @@ AOM_CTRL_USE_TYPE(AOMD_GET_BASE_Q_IDX, int *)
 AOM_CTRL_USE_TYPE(AOMD_GET_ORDER_HINT, unsigned int *)
 #define AOM_CTRL_AOMD_GET_ORDER_HINT
 
+AOM_CTRL_USE_TYPE(AV1D_SET_HEADER_ONLY, int)
+#define AOM_CTRL_AV1D_SET_HEADER_ONLY
+
+AOM_CTRL_USE_TYPE(AV1D_GET_TU_PARSE_INFO, aom_tu_parse_info *)
+#define AOM_CTRL_AV1D_GET_TU_PARSE_INFO
+
+AOM_CTRL_USE_TYPE(AV1D_GET_MV_HINTS, aom_mv_hint_map_t *)
+#define AOM_CTRL_AV1D_GET_MV_HINTS
+
+AOM_CTRL_USE_TYPE(AV1D_SET_INCREMENTAL_DECODE, int)
+#define AOM_CTRL_AV1D_SET_INCREMENTAL_DECODE
+
+AOM_CTRL_USE_TYPE(AV1D_GET_DECODE_PROGRESS, aom_decode_progress_t *)
+#define AOM_CTRL_AV1D_GET_DECODE_PROGRESS
+
 // The AOM_CTRL_USE_TYPE macro can't be used with AV1D_GET_MI_INFO because
 // AV1D_GET_MI_INFO takes more than one parameter.
 #define AOM_CTRL_AV1D_GET_MI_INFO
@@ -200,6 +200,7 @@ ImagePyramid *aom_alloc_pyramid(int width, int height, int n_levels,
     aom_free(layer_offsets);
     return NULL;
   }
+  pyr->buffer_alloc_sz = buffer_size * sizeof(*pyr->buffer_alloc);
 
   // Fill in pointers for each level
   // If image is 8-bit, then the lowest level is left unconfigured for now,
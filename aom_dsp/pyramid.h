@@ -76,6 +76,8 @@ typedef struct image_pyramid {
   int n_levels;
   // Pointer to allocated buffer
   uint8_t *buffer_alloc;
+  // Size of the allocation pointed to by `buffer_alloc`, in bytes
+  size_t buffer_alloc_sz;
   // Data for each level
   // The `buffer` pointers inside this array point into the region which
   // is stored in the `buffer_alloc` field here
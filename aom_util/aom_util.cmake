@@ -22,6 +22,11 @@ if(CONFIG_BITSTREAM_DEBUG)
               "${AOM_ROOT}/aom_util/debug_util.h")
 endif()
 
+if(CONFIG_THREAD_TRACE)
+  list(APPEND AOM_UTIL_SOURCES "${AOM_ROOT}/aom_util/thread_trace.c"
+              "${AOM_ROOT}/aom_util/thread_trace.h")
+endif()
+
 # Creates the aom_util build target and makes libaom depend on it. The libaom
 # target must exist before this function is called.
 function(setup_aom_util_targets)
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "aom_ports/aom_once.h"
+#include "aom_ports/aom_timer.h"
+#include "aom_util/aom_thread.h"
+#include "aom_util/thread_trace.h"
+
+typedef struct {
+  const char *name;
+  uint64_t thread;
+  int64_t start_us;
+  int64_t end_us;
+} TraceEvent;
+
+static TraceEvent *events;
+static size_t num_events;
+static size_t max_events;
+static struct aom_usec_timer origin;
+#if CONFIG_MULTITHREAD
+static pthread_mutex_t mutex;
+#endif
+
+static void init_trace(void) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&mutex, NULL);
+#endif
+  aom_usec_timer_start(&origin);
+}
+
+static uint64_t get_thread(void) {
+#if CONFIG_MULTITHREAD && defined(_WIN32) && !HAVE_PTHREAD_H
+  return GetCurrentThreadId();
+#elif CONFIG_MULTITHREAD
+  return (uint64_t)(uintptr_t)pthread_self();
+#else
+  return 0;
+#endif
+}
+
+int64_t aom_thread_trace_now(void) {
+  aom_once(init_trace);
+  struct aom_usec_timer timer = origin;
+  aom_usec_timer_mark(&timer);
+  return aom_usec_timer_elapsed(&timer);
+}
+
+void aom_thread_trace_add(const char *name, int64_t start_us) {
+  const int64_t end_us = aom_thread_trace_now();
+  // Skip the waits which did not block.
+  if (end_us == start_us) return;
+  const uint64_t thread = get_thread();
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&mutex);
+#endif
+  if (num_events == max_events) {
+    const size_t new_max = max_events ? 2 * max_events : 4096;
+    TraceEvent *const new_events =
+        (TraceEvent *)realloc(events, new_max * sizeof(*events));
+    if (new_events != NULL) {
+      events = new_events;
+      max_events = new_max;
+    }
+  }
+  // Events are dropped if the buffer cannot grow.
+  if (num_events < max_events) {
+    TraceEvent *const event = &events[num_events++];
+    event->name = name;
+    event->thread = thread;
+    event->start_us = start_us;
+    event->end_us = end_us;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&mutex);
+#endif
+}
+
+// The end of the trace file, which is overwritten by the next write.
+static const char kTrailer[] = "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+void aom_thread_trace_write(const char *filename) {
+  aom_once(init_trace);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&mutex);
+#endif
+  // Threads are numbered in the order of their first event.
+  static uint64_t threads[MAX_NUM_THREADS * 4];
+  static int num_threads;
+  static size_t num_written;
+  FILE *f;
+  if (num_written == 0) {
+    f = fopen(filename, "wb");
+    if (f != NULL) fprintf(f, "{\"traceEvents\":[");
+  } else {
+    // Append the events after the ones written before.
+    f = fopen(filename, "r+b");
+    if (f != NULL && fseek(f, -(long)(sizeof(kTrailer) - 1), SEEK_END) != 0) {
+      fclose(f);
+      f = NULL;
+    }
+  }
+  if (f != NULL) {
+    for (size_t i = 0; i < num_events; ++i) {
+      const TraceEvent *const event = &events[i];
+      int tid = 0;
+      while (tid < num_threads && threads[tid] != event->thread) ++tid;
+      if (tid == num_threads &&
+          num_threads < (int)(sizeof(threads) / sizeof(threads[0])))
+        threads[num_threads++] = event->thread;
+      fprintf(f,
+              "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+              "\"ts\":%" PRId64 ",\"dur\":%" PRId64 "}",
+              num_written++ ? "," : "", event->name, tid, event->start_us,
+              event->end_us - event->start_us);
+    }
+    fputs(kTrailer, f);
+    fclose(f);
+  }
+  // The events are only kept until they are written.
+  free(events);
+  events = NULL;
+  num_events = 0;
+  max_events = 0;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&mutex);
+#endif
+}
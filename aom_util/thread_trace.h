@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_UTIL_THREAD_TRACE_H_
+#define AOM_AOM_UTIL_THREAD_TRACE_H_
+
+#include <stdint.h>
+
+#include "config/aom_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_THREAD_TRACE
+/* This is a debug tool recording when each thread runs the worker hooks of
+ * the encoder and the decoder, and when it waits for other threads. Whenever a
+ * codec instance is destroyed, the events recorded so far are appended to
+ * thread_trace.json in the Chrome trace event format and freed, so the file
+ * holds the events of all the instances of the process. The file can be loaded
+ * in chrome://tracing or https://ui.perfetto.dev. */
+
+// Returns the time in microseconds since the first event.
+int64_t aom_thread_trace_now(void);
+
+// Records an event of the calling thread from start_us to now. name must be a
+// string literal. Events shorter than a microsecond are not recorded.
+void aom_thread_trace_add(const char *name, int64_t start_us);
+
+// Appends the events recorded since the last call to filename and frees them.
+// The first call of the process truncates filename.
+void aom_thread_trace_write(const char *filename);
+
+#define THREAD_TRACE_BEGIN(event) \
+  const int64_t event##_trace_start = aom_thread_trace_now()
+#define THREAD_TRACE_END(event) \
+  aom_thread_trace_add(#event, event##_trace_start)
+#define THREAD_TRACE_WRITE() aom_thread_trace_write("thread_trace.json")
+#else
+#define THREAD_TRACE_BEGIN(event) (void)0
+#define THREAD_TRACE_END(event) (void)0
+#define THREAD_TRACE_WRITE() (void)0
+#endif  // CONFIG_THREAD_TRACE
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_UTIL_THREAD_TRACE_H_
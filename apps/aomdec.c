@@ -32,6 +32,7 @@
 #include "common/args.h"
 #include "common/ivfdec.h"
 #include "common/md5_utils.h"
+#include "common/mmapdec.h"
 #include "common/obudec.h"
 #include "common/tools_common.h"
 
@@ -52,6 +53,8 @@ struct AvxDecInputContext {
   struct AvxInputContext *aom_input_ctx;
   struct ObuDecInputContext *obu_ctx;
   struct WebmInputContext *webm_ctx;
+  // Non-NULL when the IVF or OBU input is read from a memory mapping.
+  struct MmapDecInputContext *mmap_ctx;
 };
 
 static const arg_def_t help =
@@ -75,6 +78,10 @@ static const arg_def_t limitarg =
     ARG_DEF(NULL, "limit", 1, "Stop decoding after n frames");
 static const arg_def_t skiparg =
     ARG_DEF(NULL, "skip", 1, "Skip the first n input frames");
+static const arg_def_t seekarg =
+    ARG_DEF(NULL, "seek", 1,
+            "Start output at input frame n, decoding from the preceding key "
+            "frame");
 static const arg_def_t summaryarg =
     ARG_DEF(NULL, "summary", 0, "Show timing summary");
 static const arg_def_t outputfile =
@@ -107,13 +114,13 @@ static const arg_def_t skipfilmgrain =
     ARG_DEF(NULL, "skip-film-grain", 0, "Skip film grain application");
 
 static const arg_def_t *all_args[] = {
-  &help,           &codecarg, &use_yv12,      &use_i420,
-  &flipuvarg,      &rawvideo, &noblitarg,     &progressarg,
-  &limitarg,       &skiparg,  &summaryarg,    &outputfile,
-  &threadsarg,     &rowmtarg, &verbosearg,    &scalearg,
-  &fb_arg,         &md5arg,   &framestatsarg, &continuearg,
-  &outbitdeptharg, &isannexb, &oppointarg,    &outallarg,
-  &skipfilmgrain,  NULL
+  &help,        &codecarg,       &use_yv12,  &use_i420,
+  &flipuvarg,   &rawvideo,       &noblitarg, &progressarg,
+  &limitarg,    &skiparg,        &seekarg,   &summaryarg,
+  &outputfile,  &threadsarg,     &rowmtarg,  &verbosearg,
+  &scalearg,    &fb_arg,         &md5arg,    &framestatsarg,
+  &continuearg, &outbitdeptharg, &isannexb,  &oppointarg,
+  &outallarg,   &skipfilmgrain,  NULL
 };
 
 #if CONFIG_LIBYUV
@@ -242,6 +249,15 @@ static int raw_read_frame(struct AvxInputContext *input_ctx, uint8_t **buffer,
 
 static int read_frame(struct AvxDecInputContext *input, uint8_t **buf,
                       size_t *bytes_in_buffer, size_t *buffer_size) {
+  if (input->mmap_ctx) {
+    const uint8_t *frame = NULL;
+    const int status =
+        mmapdec_read_frame(input->mmap_ctx, &frame, bytes_in_buffer, NULL);
+    // The decoder only reads the data, so hand it the mapped bytes directly.
+    *buf = (uint8_t *)frame;
+    *buffer_size = *bytes_in_buffer;
+    return status;
+  }
   switch (input->aom_input_ctx->file_type) {
 #if CONFIG_WEBM_IO
     case FILE_TYPE_WEBM:
@@ -452,6 +468,8 @@ static int main_loop(int argc, const char **argv_) {
   int do_md5 = 0, progress = 0;
   int stop_after = 0, summary = 0, quiet = 1;
   int arg_skip = 0;
+  int seek_frame = 0;
+  int preroll_frames = 0;
   int keep_going = 0;
   uint64_t dx_time = 0;
   struct arg arg;
@@ -487,7 +505,7 @@ static int main_loop(int argc, const char **argv_) {
   MD5Context md5_ctx;
   unsigned char md5_digest[16];
 
-  struct AvxDecInputContext input = { NULL, NULL, NULL };
+  struct AvxDecInputContext input = { NULL, NULL, NULL, NULL };
   struct AvxInputContext aom_input_ctx;
   memset(&aom_input_ctx, 0, sizeof(aom_input_ctx));
 #if CONFIG_WEBM_IO
@@ -496,6 +514,8 @@ static int main_loop(int argc, const char **argv_) {
   input.webm_ctx = &webm_ctx;
 #endif
   struct ObuDecInputContext obu_ctx = { NULL, NULL, 0, 0, 0 };
+  struct MmapDecInputContext mmap_ctx;
+  memset(&mmap_ctx, 0, sizeof(mmap_ctx));
   int is_ivf = 0;
 
   obu_ctx.avx_ctx = &aom_input_ctx;
@@ -553,6 +573,8 @@ static int main_loop(int argc, const char **argv_) {
       stop_after = arg_parse_uint(&arg);
     } else if (arg_match(&arg, &skiparg, argi)) {
       arg_skip = arg_parse_uint(&arg);
+    } else if (arg_match(&arg, &seekarg, argi)) {
+      seek_frame = arg_parse_uint(&arg);
     } else if (arg_match(&arg, &md5arg, argi)) {
       do_md5 = 1;
     } else if (arg_match(&arg, &framestatsarg, argi)) {
@@ -603,6 +625,9 @@ static int main_loop(int argc, const char **argv_) {
     if (argi[0][0] == '-' && strlen(argi[0]) > 1)
       die("Error: Unrecognized option %s\n", *argi);
 
+  if (arg_skip && seek_frame)
+    die("Error: --skip and --seek cannot be used together.\n");
+
   /* Handle non-option arguments */
   fn = argv[0];
 
@@ -661,6 +686,14 @@ static int main_loop(int argc, const char **argv_) {
     return EXIT_FAILURE;
   }
 
+  // Regular IVF and OBU files are memory mapped so that frames can be passed to
+  // the decoder without being copied. Pipes and other inputs that cannot be
+  // mapped keep using the stdio readers.
+  if (using_file && mmapdec_open(&mmap_ctx, infile,
+                                 input.aom_input_ctx->file_type, is_annexb)) {
+    input.mmap_ctx = &mmap_ctx;
+  }
+
   outfile_pattern = outfile_pattern ? outfile_pattern : "-";
   single_file = is_single_file(outfile_pattern);
 
@@ -749,11 +782,32 @@ static int main_loop(int argc, const char **argv_) {
   }
 
   if (arg_skip) fprintf(stderr, "Skipping first %d frames.\n", arg_skip);
+  if (input.mmap_ctx) {
+    const size_t num_frames = input.mmap_ctx->num_frames;
+    mmapdec_seek(input.mmap_ctx, (size_t)arg_skip < num_frames
+                                     ? (size_t)arg_skip
+                                     : num_frames);
+    arg_skip = 0;
+  }
   while (arg_skip) {
     if (read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) break;
     arg_skip--;
   }
 
+  if (seek_frame) {
+    size_t start_frame = 0;
+    // With a frame index decoding starts at the closest random access point,
+    // otherwise every frame before the requested one is decoded.
+    if (input.mmap_ctx &&
+        mmapdec_index_keyframes(input.mmap_ctx, interface) == 0) {
+      start_frame = mmapdec_find_keyframe(input.mmap_ctx, seek_frame);
+      mmapdec_seek(input.mmap_ctx, start_frame);
+    }
+    preroll_frames = seek_frame - (int)start_frame;
+    fprintf(stderr, "Seeking to frame %d, decoding from frame %d.\n",
+            seek_frame, (int)start_frame);
+  }
+
   if (num_external_frame_buffers > 0) {
     ext_fb_list.num_external_frame_buffers = num_external_frame_buffers;
     ext_fb_list.ext_fb = (struct ExternalFrameBuffer *)calloc(
@@ -784,7 +838,7 @@ static int main_loop(int argc, const char **argv_) {
     int corrupted = 0;
 
     frame_avail = 0;
-    if (!stop_after || frame_in < stop_after) {
+    if (!stop_after || frame_in - preroll_frames < stop_after) {
       if (!read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) {
         frame_avail = 1;
         frame_in++;
@@ -835,6 +889,8 @@ static int main_loop(int argc, const char **argv_) {
 
     got_data = 0;
     while ((img = aom_codec_get_frame(&decoder, &iter))) {
+      // Frames decoded only to reach the --seek target are not output.
+      if (frame_in <= preroll_frames) continue;
       ++frame_out;
       got_data = 1;
 
@@ -1042,7 +1098,10 @@ fail2:
   if (input.aom_input_ctx->file_type == FILE_TYPE_OBU)
     obudec_free(input.obu_ctx);
 
-  if (input.aom_input_ctx->file_type != FILE_TYPE_WEBM) free(buf);
+  if (input.mmap_ctx)
+    mmapdec_close(input.mmap_ctx);
+  else if (input.aom_input_ctx->file_type != FILE_TYPE_WEBM)
+    free(buf);
 
   if (scaled_img) aom_img_free(scaled_img);
   if (img_shifted) aom_img_free(img_shifted);
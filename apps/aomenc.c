@@ -267,6 +267,7 @@ const arg_def_t *main_args[] = { &g_av1_codec_arg_defs.help,
                                  &g_av1_codec_arg_defs.rate_hist_n,
                                  &g_av1_codec_arg_defs.disable_warnings,
                                  &g_av1_codec_arg_defs.disable_warning_prompt,
+                                 &g_av1_codec_arg_defs.share_first_pass,
                                  &g_av1_codec_arg_defs.recontest,
                                  NULL };
 
@@ -460,6 +461,10 @@ const arg_def_t *av1_key_val_args[] = {
   &g_av1_codec_arg_defs.sb_qp_sweep,
   &g_av1_codec_arg_defs.dist_metric,
   &g_av1_codec_arg_defs.kf_max_pyr_height,
+  &g_av1_codec_arg_defs.memory_budget,
+  &g_av1_codec_arg_defs.analysis_import,
+  &g_av1_codec_arg_defs.analysis_export,
+  &g_av1_codec_arg_defs.frame_time_budget,
   NULL,
 };
 
@@ -699,6 +704,8 @@ static void parse_global_config(struct AvxEncoderConfig *global, char ***argv) {
     } else if (arg_match(&arg, &g_av1_codec_arg_defs.disable_warning_prompt,
                          argi)) {
       global->disable_warning_prompt = 1;
+    } else if (arg_match(&arg, &g_av1_codec_arg_defs.share_first_pass, argi)) {
+      global->share_first_pass = 1;
     } else {
       argj++;
     }
@@ -739,6 +746,9 @@ static void parse_global_config(struct AvxEncoderConfig *global, char ***argv) {
     aom_tools_warn("Enforcing one-pass encoding in all intra mode\n");
     global->passes = 1;
   }
+
+  if (global->share_first_pass && (global->passes != 2 || global->pass))
+    die("Error: --share-first-pass requires --passes=2 without --pass\n");
 }
 
 static void open_input_file(struct AvxInputContext *input,
@@ -1468,9 +1478,14 @@ static void close_output_file(struct stream_state *stream,
   fclose(stream->file);
 }
 
+// When 'shared_stats' is not NULL the stream reads its first pass statistics
+// from there instead of from its own stats store.
 static void setup_pass(struct stream_state *stream,
-                       struct AvxEncoderConfig *global, int pass) {
-  if (stream->config.stats_fn) {
+                       struct AvxEncoderConfig *global, int pass,
+                       stats_io_t *shared_stats) {
+  if (shared_stats) {
+    assert(pass > 0);
+  } else if (stream->config.stats_fn) {
     if (!stats_open_file(&stream->stats, stream->config.stats_fn, pass))
       fatal("Failed to open statistics store");
   } else {
@@ -1490,7 +1505,8 @@ static void setup_pass(struct stream_state *stream,
   }
 
   if (pass) {
-    stream->config.cfg.rc_twopass_stats_in = stats_get(&stream->stats);
+    stream->config.cfg.rc_twopass_stats_in =
+        stats_get(shared_stats ? shared_stats : &stream->stats);
   }
 
   stream->cx_time = 0;
@@ -1529,6 +1545,25 @@ static void initialize_encoder(struct stream_state *stream,
     ctx_exit_on_error(&stream->encoder, "Failed to set codec option");
   }
 
+  {
+    // Tell which settings were lowered to fit in the memory budget.
+    aom_mem_usage_t mem_usage;
+    if (aom_codec_control(&stream->encoder, AV1E_GET_MEMORY_USAGE,
+                          &mem_usage) == AOM_CODEC_OK) {
+      if (mem_usage.lag_in_frames_lowered) {
+        aom_tools_warn("Stream %d: lag-in-frames lowered from %u to %u to fit "
+                       "in the memory budget\n",
+                       stream->index, stream->config.cfg.g_lag_in_frames,
+                       mem_usage.lag_in_frames);
+      }
+      if (mem_usage.global_motion_disabled) {
+        aom_tools_warn("Stream %d: global motion disabled to fit in the "
+                       "memory budget\n",
+                       stream->index);
+      }
+    }
+  }
+
 #if CONFIG_TUNE_VMAF
   if (stream->config.vmaf_model_path) {
     AOM_CODEC_CONTROL_TYPECHECKED(&stream->encoder, AV1E_SET_VMAF_MODEL_PATH,
@@ -1980,6 +2015,7 @@ int main(int argc, const char **argv_) {
   struct AvxInputContext input;
   struct AvxEncoderConfig global;
   struct stream_state *streams = NULL;
+  struct stream_state *shared_pass_streams = NULL;
   char **argv, **argi;
   uint64_t cx_time = 0;
   int stream_cnt = 0;
@@ -2372,7 +2408,25 @@ int main(int argc, const char **argv_) {
       }
     }
 
-    FOREACH_STREAM(stream, streams) { setup_pass(stream, &global, pass); }
+    // With --share-first-pass only the first stream runs the first pass. Its
+    // statistics then drive the rate control, key frame placement and GF
+    // structure of every stream, so the renditions of a ladder share scene
+    // cuts and the analysis cost is paid once, at the first stream's
+    // resolution.
+    if (global.share_first_pass) {
+      if (pass == 0) {
+        shared_pass_streams = streams->next;
+        streams->next = NULL;
+      }
+      FOREACH_STREAM(stream, streams) {
+        setup_pass(stream, &global, pass,
+                   stream == streams ? NULL : &streams->stats);
+      }
+    } else {
+      FOREACH_STREAM(stream, streams) {
+        setup_pass(stream, &global, pass, NULL);
+      }
+    }
     FOREACH_STREAM(stream, streams) { initialize_encoder(stream, &global); }
     FOREACH_STREAM(stream, streams) {
       char *encoder_settings = NULL;
@@ -2631,6 +2685,11 @@ int main(int argc, const char **argv_) {
       stats_close(&stream->stats, global.passes - 1);
     }
 
+    if (shared_pass_streams) {
+      streams->next = shared_pass_streams;
+      shared_pass_streams = NULL;
+    }
+
     if (global.pass) break;
   }
 
@@ -47,6 +47,7 @@ struct AvxEncoderConfig {
   int show_rate_hist_buckets;
   int disable_warnings;
   int disable_warning_prompt;
+  int share_first_pass;
   int experimental_bitstream;
   aom_chroma_sample_position_t csp;
   cfg_options_t encoder_config;
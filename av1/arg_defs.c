@@ -187,6 +187,10 @@ const av1_codec_arg_definitions_t g_av1_codec_arg_defs = {
   .disable_warning_prompt =
       ARG_DEF("y", "disable-warning-prompt", 0,
               "Display warnings, but do not prompt user to continue"),
+  .share_first_pass =
+      ARG_DEF(NULL, "share-first-pass", 0,
+              "Run the first pass on the first stream only and use its "
+              "statistics for every stream (multi-stream two-pass encodes)"),
   .bitdeptharg =
       ARG_DEF_ENUM("b", "bit-depth", 1, "Bit depth for codec", bitdepth_enum),
   .inbitdeptharg = ARG_DEF(NULL, "input-bit-depth", 1, "Bit depth of input"),
@@ -698,5 +702,20 @@ const av1_codec_arg_definitions_t g_av1_codec_arg_defs = {
       ARG_DEF(NULL, "sb-qp-sweep", 1,
               "When set to 1, enable the superblock level qp sweep for a "
               "given lambda to minimize the rdcost."),
+  .memory_budget = ARG_DEF(NULL, "memory-budget", 1,
+                           "Memory budget in MiB for the frame buffers of the "
+                           "encoder (0: no limit, default). Disables global "
+                           "motion and then shortens the lookahead to fit."),
+  .analysis_import =
+      ARG_DEF(NULL, "analysis-import", 1,
+              "Analysis file from a previous encode of the same source, whose "
+              "TPL motion vectors are reused"),
+  .analysis_export = ARG_DEF(NULL, "analysis-export", 1,
+                             "Analysis file to write for later encodes"),
+  .frame_time_budget =
+      ARG_DEF(NULL, "frame-time-budget", 1,
+              "Target encode time per frame in microseconds in realtime mode "
+              "at speed 7 and above (0: no target, default). The speed "
+              "features are raised above the cpu-used preset to meet it."),
 #endif  // CONFIG_AV1_ENCODER
 };
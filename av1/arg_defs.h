@@ -59,6 +59,7 @@ typedef struct av1_codec_arg_definitions {
   arg_def_t rate_hist_n;
   arg_def_t disable_warnings;
   arg_def_t disable_warning_prompt;
+  arg_def_t share_first_pass;
   arg_def_t bitdeptharg;
   arg_def_t inbitdeptharg;
   arg_def_t input_chroma_subsampling_x;
@@ -235,6 +236,10 @@ typedef struct av1_codec_arg_definitions {
   arg_def_t strict_level_conformance;
   arg_def_t kf_max_pyr_height;
   arg_def_t sb_qp_sweep;
+  arg_def_t memory_budget;
+  arg_def_t analysis_import;
+  arg_def_t analysis_export;
+  arg_def_t frame_time_budget;
 #endif  // CONFIG_AV1_ENCODER
 } av1_codec_arg_definitions_t;
 
@@ -31,6 +31,7 @@
 #include "av1/encoder/ethread.h"
 #include "av1/encoder/external_partition.h"
 #include "av1/encoder/firstpass.h"
+#include "av1/encoder/mem_usage.h"
 #include "av1/encoder/rc_utils.h"
 #include "av1/arg_defs.h"
 
@@ -173,6 +174,7 @@ struct av1_extracfg {
   COST_UPDATE_TYPE dv_cost_upd_freq;
   unsigned int ext_tile_debug;
   unsigned int sb_multipass_unit_test;
+  unsigned int fullpel_search_cache_unit_test;
   // Total number of passes. If this number is -1, then we assume passes = 1 or
   // 2 (passes = 1 if pass == AOM_RC_ONE_PASS and passes = 2 otherwise).
   int passes;
@@ -200,6 +202,11 @@ struct av1_extracfg {
   int strict_level_conformance;
   int kf_max_pyr_height;
   int sb_qp_sweep;
+  unsigned int mem_budget_mb;
+  const char *analysis_import_path;
+  const char *analysis_export_path;
+  unsigned int frame_time_budget_us;
+  unsigned int drop_static_frames;
 };
 
 #if CONFIG_REALTIME_ONLY
@@ -355,6 +362,7 @@ static const struct av1_extracfg default_extra_cfg = {
   COST_UPD_OFF,    // dv_cost_upd_freq
   0,               // ext_tile_debug
   0,               // sb_multipass_unit_test
+  0,               // fullpel_search_cache_unit_test
   -1,              // passes
   -1,              // fwd_kf_dist
   LOOPFILTER_ALL,  // loopfilter_control
@@ -365,6 +373,11 @@ static const struct av1_extracfg default_extra_cfg = {
   0,               // strict_level_conformance
   -1,              // kf_max_pyr_height
   0,               // sb_qp_sweep
+  0,               // mem_budget_mb
+  NULL,            // analysis_import_path
+  NULL,            // analysis_export_path
+  0,               // frame_time_budget_us
+  0,               // drop_static_frames
 };
 #else
 static const struct av1_extracfg default_extra_cfg = {
@@ -506,6 +519,7 @@ static const struct av1_extracfg default_extra_cfg = {
   COST_UPD_SB,     // dv_cost_upd_freq
   0,               // ext_tile_debug
   0,               // sb_multipass_unit_test
+  0,               // fullpel_search_cache_unit_test
   -1,              // passes
   -1,              // fwd_kf_dist
   LOOPFILTER_ALL,  // loopfilter_control
@@ -516,6 +530,11 @@ static const struct av1_extracfg default_extra_cfg = {
   0,               // strict_level_conformance
   -1,              // kf_max_pyr_height
   0,               // sb_qp_sweep
+  0,               // mem_budget_mb
+  NULL,            // analysis_import_path
+  NULL,            // analysis_export_path
+  0,               // frame_time_budget_us
+  0,               // drop_static_frames
 };
 #endif
 
@@ -533,6 +552,8 @@ struct aom_codec_alg_priv {
   size_t pending_cx_data_sz;
   aom_image_t preview_img;
   aom_enc_frame_flags_t next_frame_flags;
+  // Motion vector hints of the next frame passed to encoder_encode().
+  MvHintMap next_mv_hints;
   aom_codec_pkt_list_decl(256) pkt_list;
   unsigned int fixed_kf_cntr;
   // BufferPool that holds all reference frames.
@@ -545,6 +566,15 @@ struct aom_codec_alg_priv {
   int num_lap_buffers;
   STATS_BUFFER_CTX stats_buf_context;
   bool monochrome_on_init;
+  // Lookahead depth and global motion setting fitted to the memory budget,
+  // and whether they were lowered to fit.
+  int mem_budget_lag_in_frames;
+  int mem_budget_global_motion;
+  bool mem_budget_lowered_lag;
+  bool mem_budget_disabled_global_motion;
+  // Encoder context that coded the last frame. With frame parallel encoding
+  // this need not be ppi->cpi.
+  const AV1_COMP *last_coded_cpi;
 };
 
 static INLINE int gcd(int64_t a, int b) {
@@ -720,6 +750,8 @@ static aom_codec_err_t validate_config(aom_codec_alg_priv_t *ctx,
   RANGE_CHECK_HI(extra_cfg, fpmt_unit_test, 1);
 #endif
   RANGE_CHECK_HI(extra_cfg, sb_multipass_unit_test, 1);
+  RANGE_CHECK_HI(extra_cfg, fullpel_search_cache_unit_test, 1);
+  RANGE_CHECK_HI(extra_cfg, drop_static_frames, 1);
   RANGE_CHECK_HI(extra_cfg, ext_tile_debug, 1);
   RANGE_CHECK_HI(extra_cfg, enable_auto_alt_ref, 1);
   RANGE_CHECK_HI(extra_cfg, enable_auto_bwd_ref, 2);
@@ -1146,6 +1178,7 @@ static void set_encoder_config(AV1EncoderConfig *oxcf,
   // Convert target bandwidth from Kbit/s to Bit/s
   rc_cfg->target_bandwidth = 1000 * cfg->rc_target_bitrate;
   rc_cfg->drop_frames_water_mark = cfg->rc_dropframe_thresh;
+  rc_cfg->drop_static_frames = extra_cfg->drop_static_frames;
   rc_cfg->vbr_corpus_complexity_lap = extra_cfg->vbr_corpus_complexity_lap;
   rc_cfg->vbrbias = cfg->rc_2pass_vbr_bias_pct;
   rc_cfg->vbrmin_section = cfg->rc_2pass_vbr_minsection_pct;
@@ -1470,6 +1503,8 @@ static void set_encoder_config(AV1EncoderConfig *oxcf,
       extra_cfg->motion_vector_unit_test;
   oxcf->unit_test_cfg.sb_multipass_unit_test =
       extra_cfg->sb_multipass_unit_test;
+  oxcf->unit_test_cfg.fullpel_search_cache_unit_test =
+      extra_cfg->fullpel_search_cache_unit_test;
 
   oxcf->border_in_pixels =
       av1_get_enc_border_size(av1_is_resize_needed(oxcf),
@@ -1488,15 +1523,49 @@ static void set_encoder_config(AV1EncoderConfig *oxcf,
   oxcf->kf_max_pyr_height = extra_cfg->kf_max_pyr_height;
 
   oxcf->sb_qp_sweep = extra_cfg->sb_qp_sweep;
+
+  oxcf->mem_budget_mb = extra_cfg->mem_budget_mb;
+
+  oxcf->analysis_import_path = extra_cfg->analysis_import_path;
+  oxcf->analysis_export_path = extra_cfg->analysis_export_path;
+
+  oxcf->frame_time_budget_us = extra_cfg->frame_time_budget_us;
 }
 
 AV1EncoderConfig av1_get_encoder_config(const aom_codec_enc_cfg_t *cfg) {
   AV1EncoderConfig oxcf;
   struct av1_extracfg extra_cfg = default_extra_cfg;
   set_encoder_config(&oxcf, cfg, &extra_cfg);
+  av1_fit_config_to_mem_budget(&oxcf);
   return oxcf;
 }
 
+// Fits the frame-sized buffers to the memory budget. The budget is applied
+// until the lookahead is allocated with the first frame. Afterwards the
+// settings it picked are kept, so that the lookahead depth stays consistent
+// with the allocated lookahead, e.g. across resolution changes.
+static void apply_mem_budget(aom_codec_alg_priv_t *ctx) {
+  AV1EncoderConfig *const oxcf = &ctx->oxcf;
+  ToolCfg *const tool_cfg = &oxcf->tool_cfg;
+  ctx->mem_budget_lowered_lag = false;
+  ctx->mem_budget_disabled_global_motion = false;
+  if (oxcf->mem_budget_mb == 0) return;
+  const int lag_in_frames = oxcf->gf_cfg.lag_in_frames;
+  const int enable_global_motion = tool_cfg->enable_global_motion;
+  if (ctx->ppi->lookahead == NULL) {
+    av1_fit_config_to_mem_budget(oxcf);
+    ctx->mem_budget_lag_in_frames = oxcf->gf_cfg.lag_in_frames;
+    ctx->mem_budget_global_motion = tool_cfg->enable_global_motion;
+  } else {
+    oxcf->gf_cfg.lag_in_frames =
+        AOMMIN(oxcf->gf_cfg.lag_in_frames, ctx->mem_budget_lag_in_frames);
+    tool_cfg->enable_global_motion &= ctx->mem_budget_global_motion;
+  }
+  ctx->mem_budget_lowered_lag = oxcf->gf_cfg.lag_in_frames < lag_in_frames;
+  ctx->mem_budget_disabled_global_motion =
+      enable_global_motion && !tool_cfg->enable_global_motion;
+}
+
 static aom_codec_err_t encoder_set_config(aom_codec_alg_priv_t *ctx,
                                           const aom_codec_enc_cfg_t *cfg) {
   aom_codec_err_t res;
@@ -1544,6 +1613,7 @@ static aom_codec_err_t encoder_set_config(aom_codec_alg_priv_t *ctx,
   if (res == AOM_CODEC_OK) {
     ctx->cfg = *cfg;
     set_encoder_config(&ctx->oxcf, &ctx->cfg, &ctx->extra_cfg);
+    apply_mem_budget(ctx);
     // On profile change, request a key frame
     force_key |= ctx->ppi->seq_params.profile != ctx->oxcf.profile;
     bool is_sb_size_changed = false;
@@ -1604,6 +1674,7 @@ static aom_codec_err_t update_extra_cfg(aom_codec_alg_priv_t *ctx,
   if (res == AOM_CODEC_OK) {
     ctx->extra_cfg = *extra_cfg;
     set_encoder_config(&ctx->oxcf, &ctx->cfg, &ctx->extra_cfg);
+    apply_mem_budget(ctx);
     av1_check_fpmt_config(ctx->ppi, &ctx->oxcf);
     bool is_sb_size_changed = false;
     av1_change_config_seq(ctx->ppi, &ctx->oxcf, &is_sb_size_changed);
@@ -2515,6 +2586,14 @@ static aom_codec_err_t ctrl_enable_sb_multipass_unit_test(
   return update_extra_cfg(ctx, &extra_cfg);
 }
 
+static aom_codec_err_t ctrl_disable_fullpel_search_cache_unit_test(
+    aom_codec_alg_priv_t *ctx, va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.fullpel_search_cache_unit_test =
+      CAST(AV1E_DISABLE_FULLPEL_SEARCH_CACHE_UNIT_TEST, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
 static aom_codec_err_t ctrl_enable_sb_qp_sweep(aom_codec_alg_priv_t *ctx,
                                                va_list args) {
   struct av1_extracfg extra_cfg = ctx->extra_cfg;
@@ -2592,6 +2671,108 @@ static aom_codec_err_t ctrl_set_bitrate_one_pass_cbr(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_mem_budget(aom_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  // The lookahead depth cannot change once the lookahead has been allocated.
+  if (ctx->ppi->lookahead != NULL) return AOM_CODEC_INCAPABLE;
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.mem_budget_mb = CAST(AV1E_SET_MEMORY_BUDGET, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_analysis_import_file(aom_codec_alg_priv_t *ctx,
+                                                     va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  const char *str = CAST(AV1E_SET_ANALYSIS_IMPORT_FILE, args);
+  const aom_codec_err_t ret = allocate_and_set_string(
+      str, default_extra_cfg.analysis_import_path,
+      &extra_cfg.analysis_import_path, ctx->ppi->error.detail);
+  if (ret != AOM_CODEC_OK) return ret;
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_analysis_export_file(aom_codec_alg_priv_t *ctx,
+                                                     va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  const char *str = CAST(AV1E_SET_ANALYSIS_EXPORT_FILE, args);
+  const aom_codec_err_t ret = allocate_and_set_string(
+      str, default_extra_cfg.analysis_export_path,
+      &extra_cfg.analysis_export_path, ctx->ppi->error.detail);
+  if (ret != AOM_CODEC_OK) return ret;
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_mv_hints(aom_codec_alg_priv_t *ctx,
+                                         va_list args) {
+  const aom_mv_hint_map_t *const map = va_arg(args, aom_mv_hint_map_t *);
+  const aom_codec_err_t ret = av1_set_mv_hints(
+      &ctx->next_mv_hints, map, (int)ctx->cfg.g_w, (int)ctx->cfg.g_h);
+  if (ret == AOM_CODEC_INVALID_PARAM)
+    ERROR("The motion vector hint map does not match the frame size");
+  return ret;
+}
+
+static aom_codec_err_t ctrl_set_component_timing(aom_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  AV1_PRIMARY *const ppi = ctx->ppi;
+  ppi->collect_component_timing = CAST(AV1E_SET_COMPONENT_TIMING, args) != 0;
+  if (ppi->collect_component_timing) {
+    for (int i = 0; i < ppi->num_fp_contexts; ++i) {
+      AV1_COMP *const cpi = ppi->parallel_cpi[i];
+      av1_zero(cpi->component_time);
+      av1_zero(cpi->frame_component_time);
+      av1_zero(cpi->last_frame_component_time);
+    }
+  }
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_sb_stats(aom_codec_alg_priv_t *ctx,
+                                        va_list args) {
+  AV1_PRIMARY *const ppi = ctx->ppi;
+  ppi->collect_sb_stats = CAST(AV1E_SET_SB_STATS, args) != 0;
+  if (!ppi->collect_sb_stats) {
+    for (int i = 0; i < ppi->num_fp_contexts; ++i) {
+      AV1_COMP *const cpi = ppi->parallel_cpi[i];
+      aom_free(cpi->sb_stats);
+      cpi->sb_stats = NULL;
+    }
+  }
+  return AOM_CODEC_OK;
+}
+
+// Restarts the frame time measurements for a new budget. The speed steps taken
+// so far are kept and adapt to the new budget, unless there is no budget.
+static void reset_frame_time_budget(AV1_COMP *cpi, unsigned int budget_us) {
+  const int level = budget_us > 0 ? cpi->time_budget.level : 0;
+  av1_zero(cpi->time_budget);
+  cpi->time_budget.level = level;
+}
+
+static aom_codec_err_t ctrl_set_frame_time_budget(aom_codec_alg_priv_t *ctx,
+                                                 va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.frame_time_budget_us = CAST(AV1E_SET_FRAME_TIME_BUDGET, args);
+  reset_frame_time_budget(ctx->ppi->cpi, extra_cfg.frame_time_budget_us);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_drop_static_frames(aom_codec_alg_priv_t *ctx,
+                                                  va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.drop_static_frames = CAST(AV1E_SET_DROP_STATIC_FRAMES, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_tile_group_callback(aom_codec_alg_priv_t *ctx,
+                                                   va_list args) {
+  const aom_tile_group_cb_t *const cb =
+      CAST(AV1E_SET_TILE_GROUP_CALLBACK, args);
+  if (cb == NULL) return AOM_CODEC_INVALID_PARAM;
+  ctx->ppi->tile_group_cb = *cb;
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t ctrl_set_max_consec_frame_drop_cbr(
     aom_codec_alg_priv_t *ctx, va_list args) {
   AV1_PRIMARY *const ppi = ctx->ppi;
@@ -2745,10 +2926,10 @@ static aom_codec_err_t encoder_init(aom_codec_ctx_t *ctx) {
           priv->oxcf.pass == AOM_RC_ONE_PASS && priv->oxcf.mode == GOOD) {
         // Enable look ahead - enabled for AOM_Q, AOM_CQ, AOM_VBR
         *num_lap_buffers =
-            AOMMIN((int)priv->cfg.g_lag_in_frames,
+            AOMMIN(priv->oxcf.gf_cfg.lag_in_frames,
                    AOMMIN(MAX_LAP_BUFFERS, priv->oxcf.kf_cfg.key_freq_max +
                                                SCENE_CUT_KEY_TEST_INTERVAL));
-        if ((int)priv->cfg.g_lag_in_frames - (*num_lap_buffers) >=
+        if (priv->oxcf.gf_cfg.lag_in_frames - (*num_lap_buffers) >=
             LAP_LAG_IN_FRAMES) {
           lap_lag_in_frames = LAP_LAG_IN_FRAMES;
         }
@@ -2844,11 +3025,16 @@ static void destroy_extra_config(struct av1_extracfg *extra_cfg) {
                         &extra_cfg->rate_distribution_info);
   check_and_free_string(default_extra_cfg.film_grain_table_filename,
                         &extra_cfg->film_grain_table_filename);
+  check_and_free_string(default_extra_cfg.analysis_import_path,
+                        &extra_cfg->analysis_import_path);
+  check_and_free_string(default_extra_cfg.analysis_export_path,
+                        &extra_cfg->analysis_export_path);
 }
 
 static aom_codec_err_t encoder_destroy(aom_codec_alg_priv_t *ctx) {
   free(ctx->cx_data);
   destroy_extra_config(&ctx->extra_cfg);
+  av1_free_mv_hints(&ctx->next_mv_hints);
 
   if (ctx->ppi) {
     AV1_PRIMARY *ppi = ctx->ppi;
@@ -3075,12 +3261,15 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
         }
 
         const int src_border_in_pixels = get_src_border_in_pixels(cpi, sb_size);
+        // The pyramid worker takes one of the max_threads from the encoder's
+        // worker pool, so it is only used when at least two remain.
         ppi->lookahead = av1_lookahead_init(
             cpi->oxcf.frm_dim_cfg.width, cpi->oxcf.frm_dim_cfg.height,
             subsampling_x, subsampling_y, use_highbitdepth, lag_in_frames,
             src_border_in_pixels, cpi->common.features.byte_alignment,
             ctx->num_lap_buffers, (cpi->oxcf.kf_cfg.key_freq_max == 0),
-            cpi->image_pyramid_levels);
+            cpi->image_pyramid_levels, cpi->common.seq_params->bit_depth,
+            cpi->oxcf.max_threads > 2);
       }
       if (!ppi->lookahead)
         aom_internal_error(&ppi->error, AOM_CODEC_MEM_ERROR,
@@ -3097,10 +3286,12 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
       // Store the original flags in to the frame buffer. Will extract the
       // key frame flag when we actually encode this frame.
       if (av1_receive_raw_frame(cpi, flags | ctx->next_frame_flags, &sd,
-                                src_time_stamp, src_end_time_stamp)) {
+                                src_time_stamp, src_end_time_stamp,
+                                &ctx->next_mv_hints)) {
         res = update_error_state(ctx, cpi->common.error);
       }
       ctx->next_frame_flags = 0;
+      ctx->next_mv_hints.rows = 0;
     }
 
     cpi_data.cx_data = ctx->cx_data;
@@ -3274,6 +3465,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
 
       if (!cpi_data.frame_size) continue;
       assert(cpi_data.cx_data != NULL && cpi_data.cx_data_sz != 0);
+      if (!cpi->common.show_existing_frame) ctx->last_coded_cpi = cpi;
       const int write_temporal_delimiter =
           !cpi->common.spatial_layer_id && !ctx->pending_cx_data_sz;
 
@@ -3374,6 +3566,8 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
     }
   }
 
+  av1_update_mem_usage(ppi);
+
   ppi->error.setjmp = 0;
   return res;
 }
@@ -4186,6 +4380,25 @@ static aom_codec_err_t encoder_set_option(aom_codec_alg_priv_t *ctx,
   } else if (arg_match_helper(&arg, &g_av1_codec_arg_defs.kf_max_pyr_height,
                               argv, err_string)) {
     extra_cfg.kf_max_pyr_height = arg_parse_int_helper(&arg, err_string);
+  } else if (arg_match_helper(&arg, &g_av1_codec_arg_defs.memory_budget, argv,
+                              err_string)) {
+    if (ctx->ppi->lookahead != NULL) {
+      err = AOM_CODEC_INCAPABLE;
+    } else {
+      extra_cfg.mem_budget_mb = arg_parse_uint_helper(&arg, err_string);
+    }
+  } else if (arg_match_helper(&arg, &g_av1_codec_arg_defs.frame_time_budget,
+                              argv, err_string)) {
+    extra_cfg.frame_time_budget_us = arg_parse_uint_helper(&arg, err_string);
+    reset_frame_time_budget(ctx->ppi->cpi, extra_cfg.frame_time_budget_us);
+  } else if (arg_match_helper(&arg, &g_av1_codec_arg_defs.analysis_import,
+                              argv, err_string)) {
+    err = allocate_and_set_string(value, default_extra_cfg.analysis_import_path,
+                                  &extra_cfg.analysis_import_path, err_string);
+  } else if (arg_match_helper(&arg, &g_av1_codec_arg_defs.analysis_export,
+                              argv, err_string)) {
+    err = allocate_and_set_string(value, default_extra_cfg.analysis_export_path,
+                                  &extra_cfg.analysis_export_path, err_string);
   } else if (arg_match_helper(&arg, &g_av1_codec_arg_defs.tile_width, argv,
                               err_string)) {
     ctx->cfg.tile_width_count = arg_parse_list_helper(
@@ -4253,6 +4466,61 @@ static aom_codec_err_t ctrl_get_luma_cdef_strength(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_get_memory_usage(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  aom_mem_usage_t *const arg = va_arg(args, aom_mem_usage_t *);
+  if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  av1_update_mem_usage(ctx->ppi);
+  *arg = ctx->ppi->mem_usage;
+  arg->lag_in_frames = ctx->oxcf.gf_cfg.lag_in_frames;
+  arg->lag_in_frames_lowered = ctx->mem_budget_lowered_lag;
+  arg->global_motion_disabled = ctx->mem_budget_disabled_global_motion;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_component_timing(aom_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  aom_component_timing_t *const arg = va_arg(args, aom_component_timing_t *);
+  if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  const AV1_PRIMARY *const ppi = ctx->ppi;
+  const AV1_COMP *const cpi =
+      ctx->last_coded_cpi != NULL ? ctx->last_coded_cpi : ppi->cpi;
+  // Only the main thread components are timed at runtime.
+  const int num_components = CONFIG_COLLECT_COMPONENT_TIMING
+                                 ? kTimingComponents
+                                 : av1_setup_motion_field_time + 1;
+  assert(num_components <= AOM_MAX_TIMING_COMPONENTS);
+  memset(arg, 0, sizeof(*arg));
+  arg->num_components = num_components;
+  for (int i = 0; i < num_components; ++i) {
+    arg->names[i] = get_component_name(i);
+    arg->frame_us[i] = cpi->last_frame_component_time[i];
+    for (int j = 0; j < ppi->num_fp_contexts; ++j)
+      arg->total_us[i] += ppi->parallel_cpi[j]->component_time[i];
+  }
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_sb_stats(aom_codec_alg_priv_t *ctx,
+                                        va_list args) {
+  aom_sb_stats_map_t *const arg = va_arg(args, aom_sb_stats_map_t *);
+  if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  const AV1_COMP *const cpi =
+      ctx->last_coded_cpi != NULL ? ctx->last_coded_cpi : ctx->ppi->cpi;
+  if (cpi->sb_stats == NULL) return AOM_CODEC_ERROR;
+  const unsigned int rows = cpi->sb_stats_rows;
+  const unsigned int cols = cpi->sb_stats_cols;
+  if (arg->stats != NULL) {
+    if ((uint64_t)arg->rows * arg->cols < (uint64_t)rows * cols)
+      return AOM_CODEC_INVALID_PARAM;
+    memcpy(arg->stats, cpi->sb_stats, rows * cols * sizeof(*arg->stats));
+  }
+  arg->sb_size = block_size_wide[cpi->common.seq_params->sb_size];
+  arg->rows = rows;
+  arg->cols = cols;
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1_COPY_REFERENCE, ctrl_copy_reference },
   { AOME_USE_REFERENCE, ctrl_use_reference },
@@ -4398,6 +4666,17 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1E_SET_QUANTIZER_ONE_PASS, ctrl_set_quantizer_one_pass },
   { AV1E_SET_BITRATE_ONE_PASS_CBR, ctrl_set_bitrate_one_pass_cbr },
   { AV1E_SET_MAX_CONSEC_FRAME_DROP_CBR, ctrl_set_max_consec_frame_drop_cbr },
+  { AV1E_SET_MEMORY_BUDGET, ctrl_set_mem_budget },
+  { AV1E_SET_ANALYSIS_IMPORT_FILE, ctrl_set_analysis_import_file },
+  { AV1E_SET_ANALYSIS_EXPORT_FILE, ctrl_set_analysis_export_file },
+  { AV1E_SET_MV_HINTS, ctrl_set_mv_hints },
+  { AV1E_SET_COMPONENT_TIMING, ctrl_set_component_timing },
+  { AV1E_SET_SB_STATS, ctrl_set_sb_stats },
+  { AV1E_SET_FRAME_TIME_BUDGET, ctrl_set_frame_time_budget },
+  { AV1E_SET_TILE_GROUP_CALLBACK, ctrl_set_tile_group_callback },
+  { AV1E_DISABLE_FULLPEL_SEARCH_CACHE_UNIT_TEST,
+    ctrl_disable_fullpel_search_cache_unit_test },
+  { AV1E_SET_DROP_STATIC_FRAMES, ctrl_set_drop_static_frames },
 
   // Getters
   { AOME_GET_LAST_QUANTIZER, ctrl_get_quantizer },
@@ -4414,6 +4693,9 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1E_GET_TARGET_SEQ_LEVEL_IDX, ctrl_get_target_seq_level_idx },
   { AV1E_GET_NUM_OPERATING_POINTS, ctrl_get_num_operating_points },
   { AV1E_GET_LUMA_CDEF_STRENGTH, ctrl_get_luma_cdef_strength },
+  { AV1E_GET_MEMORY_USAGE, ctrl_get_memory_usage },
+  { AV1E_GET_COMPONENT_TIMING, ctrl_get_component_timing },
+  { AV1E_GET_SB_STATS, ctrl_get_sb_stats },
 
   CTRL_MAP_END,
 };
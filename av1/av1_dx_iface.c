@@ -26,6 +26,7 @@
 
 #include "av1/common/alloccommon.h"
 #include "av1/common/frame_buffers.h"
+#include "av1/common/mvref_common.h"
 #include "av1/common/enums.h"
 #include "av1/common/obu_util.h"
 
@@ -48,6 +49,8 @@ struct aom_codec_alg_priv {
   int byte_alignment;
   int skip_loop_filter;
   int skip_film_grain;
+  int header_only;
+  int incremental_decode;
   int decode_tile_row;
   int decode_tile_col;
   unsigned int tile_mode;
@@ -387,6 +390,8 @@ static void init_buffer_callbacks(aom_codec_alg_priv_t *ctx) {
   cm->features.byte_alignment = ctx->byte_alignment;
   pbi->skip_loop_filter = ctx->skip_loop_filter;
   pbi->skip_film_grain = ctx->skip_film_grain;
+  pbi->header_only = ctx->header_only;
+  pbi->incremental_decode = ctx->incremental_decode;
 
   if (ctx->get_ext_fb_cb != NULL && ctx->release_ext_fb_cb != NULL) {
     pool->get_fb_cb = ctx->get_ext_fb_cb;
@@ -702,6 +707,10 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
   const uint8_t *data_start = data;
   const uint8_t *data_end = data + data_sz;
 
+  FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)ctx->frame_worker->data1;
+  frame_worker_data->pbi->tu_parse_info.num_frames = 0;
+
   if (ctx->is_annexb) {
     // read the size of this temporal unit
     size_t length_of_size;
@@ -810,6 +819,9 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
     return NULL;
   }
 
+  // No frames are reconstructed when only the headers are parsed.
+  if (ctx->header_only) return NULL;
+
   // To avoid having to allocate any extra storage, treat 'iter' as
   // simply a pointer to an integer index
   uintptr_t *index = (uintptr_t *)iter;
@@ -1550,6 +1562,117 @@ static aom_codec_err_t ctrl_set_skip_loop_filter(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_header_only(aom_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  ctx->header_only = va_arg(args, int);
+
+  if (ctx->frame_worker) {
+    AVxWorker *const worker = ctx->frame_worker;
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi->header_only = ctx->header_only;
+  }
+
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_incremental_decode(aom_codec_alg_priv_t *ctx,
+                                                  va_list args) {
+  ctx->incremental_decode = va_arg(args, int);
+
+  if (ctx->frame_worker) {
+    AVxWorker *const worker = ctx->frame_worker;
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi->incremental_decode = ctx->incremental_decode;
+  }
+
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_decode_progress(aom_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  aom_decode_progress_t *const progress =
+      va_arg(args, aom_decode_progress_t *);
+  if (!progress) return AOM_CODEC_INVALID_PARAM;
+
+  if (ctx->frame_worker == NULL) return AOM_CODEC_ERROR;
+  const FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)ctx->frame_worker->data1;
+  const AV1Decoder *const pbi = frame_worker_data->pbi;
+  const AV1_COMMON *const cm = &pbi->common;
+  if (!pbi->sequence_header_ready || cm->mi_params.mi_rows == 0)
+    return AOM_CODEC_ERROR;
+
+  const int mib_size_log2 = cm->seq_params->mib_size_log2;
+  progress->sb_rows = CEIL_POWER_OF_TWO(cm->mi_params.mi_rows, mib_size_log2);
+  progress->decoded_sb_rows = pbi->decoded_sb_rows;
+  progress->sb_size = MI_SIZE << mib_size_log2;
+  memset(&progress->img, 0, sizeof(progress->img));
+  if (pbi->frame_incomplete)
+    yuvconfig2image(&progress->img, &cm->cur_frame->buf, NULL);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_tu_parse_info(aom_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  aom_tu_parse_info *const tu_info = va_arg(args, aom_tu_parse_info *);
+  if (!tu_info) return AOM_CODEC_INVALID_PARAM;
+
+  if (ctx->frame_worker == NULL) return AOM_CODEC_ERROR;
+  const FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)ctx->frame_worker->data1;
+  *tu_info = frame_worker_data->pbi->tu_parse_info;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_mv_hints(aom_codec_alg_priv_t *ctx,
+                                         va_list args) {
+  aom_mv_hint_map_t *const map = va_arg(args, aom_mv_hint_map_t *);
+  if (!map || !map->hints || (map->block_size != 8 && map->block_size != 16))
+    return AOM_CODEC_INVALID_PARAM;
+
+  if (ctx->frame_worker == NULL || ctx->last_show_frame == NULL)
+    return AOM_CODEC_ERROR;
+  const FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)ctx->frame_worker->data1;
+  const AV1_COMMON *const cm = &frame_worker_data->pbi->common;
+  const OrderHintInfo *const order_hint_info = &cm->seq_params->order_hint_info;
+  const RefCntBuffer *const buf = ctx->last_show_frame;
+  // The motion field is only stored when it can be used for temporal motion
+  // vector prediction.
+  if (!order_hint_info->enable_ref_frame_mvs || buf->mvs == NULL)
+    return AOM_CODEC_INCAPABLE;
+
+  const int bs = (int)map->block_size;
+  if ((int)map->rows != (buf->height + bs - 1) / bs ||
+      (int)map->cols != (buf->width + bs - 1) / bs)
+    return AOM_CODEC_INVALID_PARAM;
+
+  // The motion field has one entry per 8x8 block, which holds the vector to
+  // a past reference frame used by the block, if any.
+  const int mvs_rows = ROUND_POWER_OF_TWO(buf->mi_rows, 1);
+  const int mvs_cols = ROUND_POWER_OF_TWO(buf->mi_cols, 1);
+  const int step = bs >> 3;
+  for (int r = 0; r < (int)map->rows; ++r) {
+    for (int c = 0; c < (int)map->cols; ++c) {
+      const MV_REF *const mv =
+          &buf->mvs[AOMMIN(r * step, mvs_rows - 1) * mvs_cols +
+                    AOMMIN(c * step, mvs_cols - 1)];
+      aom_mv_hint_t *const hint = &map->hints[r * map->cols + c];
+      hint->row = hint->col = 0;
+      hint->ref_distance = 0;
+      if (mv->ref_frame <= INTRA_FRAME) continue;
+      const int dist = get_relative_dist(
+          order_hint_info, buf->ref_order_hints[mv->ref_frame - LAST_FRAME],
+          buf->order_hint);
+      if (dist == 0 || dist < INT8_MIN || dist > INT8_MAX) continue;
+      hint->row = mv->mv.as_mv.row;
+      hint->col = mv->mv.as_mv.col;
+      hint->ref_distance = (int8_t)dist;
+    }
+  }
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t ctrl_set_skip_film_grain(aom_codec_alg_priv_t *ctx,
                                                 va_list args) {
   ctx->skip_film_grain = va_arg(args, int);
@@ -1670,6 +1793,8 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1D_SET_ROW_MT, ctrl_set_row_mt },
   { AV1D_SET_EXT_REF_PTR, ctrl_set_ext_ref_ptr },
   { AV1D_SET_SKIP_FILM_GRAIN, ctrl_set_skip_film_grain },
+  { AV1D_SET_HEADER_ONLY, ctrl_set_header_only },
+  { AV1D_SET_INCREMENTAL_DECODE, ctrl_set_incremental_decode },
 
   // Getters
   { AOMD_GET_FRAME_CORRUPTED, ctrl_get_frame_corrupted },
@@ -1700,6 +1825,9 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AOMD_GET_BASE_Q_IDX, ctrl_get_base_q_idx },
   { AOMD_GET_ORDER_HINT, ctrl_get_order_hint },
   { AV1D_GET_MI_INFO, ctrl_get_mi_info },
+  { AV1D_GET_TU_PARSE_INFO, ctrl_get_tu_parse_info },
+  { AV1D_GET_MV_HINTS, ctrl_get_mv_hints },
+  { AV1D_GET_DECODE_PROGRESS, ctrl_get_decode_progress },
   CTRL_MAP_END,
 };
 
@@ -15,6 +15,7 @@
 
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_mem/aom_mem.h"
+#include "aom_util/thread_trace.h"
 #include "av1/common/av1_loopfilter.h"
 #include "av1/common/entropymode.h"
 #include "av1/common/thread_common.h"
@@ -169,12 +170,14 @@ static INLINE void cdef_row_mt_sync_read(AV1CdefSync *const cdef_sync,
   if (!row) return;
 #if CONFIG_MULTITHREAD
   AV1CdefRowSync *const cdef_row_mt = cdef_sync->cdef_row_mt;
+  THREAD_TRACE_BEGIN(cdef_row_sync_wait);
   pthread_mutex_lock(cdef_row_mt[row - 1].row_mutex_);
   while (cdef_row_mt[row - 1].is_row_done != 1)
     pthread_cond_wait(cdef_row_mt[row - 1].row_cond_,
                       cdef_row_mt[row - 1].row_mutex_);
   cdef_row_mt[row - 1].is_row_done = 0;
   pthread_mutex_unlock(cdef_row_mt[row - 1].row_mutex_);
+  THREAD_TRACE_END(cdef_row_sync_wait);
 #else
   (void)cdef_sync;
 #endif  // CONFIG_MULTITHREAD
@@ -201,12 +204,14 @@ static INLINE void sync_read(AV1LfSync *const lf_sync, int r, int c,
 
   if (r && !(c & (nsync - 1))) {
     pthread_mutex_t *const mutex = &lf_sync->mutex_[plane][r - 1];
+    THREAD_TRACE_BEGIN(lf_row_sync_wait);
     pthread_mutex_lock(mutex);
 
     while (c > lf_sync->cur_sb_col[plane][r - 1] - nsync) {
       pthread_cond_wait(&lf_sync->cond_[plane][r - 1], mutex);
     }
     pthread_mutex_unlock(mutex);
+    THREAD_TRACE_END(lf_row_sync_wait);
   }
 #else
   (void)lf_sync;
@@ -366,6 +371,7 @@ static AOM_INLINE void sync_lf_workers(AVxWorker *const workers,
   }
 
   // Wait till all rows are finished.
+  THREAD_TRACE_BEGIN(lf_sync_workers);
   for (int i = num_workers - 1; i > 0; --i) {
     AVxWorker *const worker = &workers[i];
     if (!winterface->sync(worker)) {
@@ -373,6 +379,7 @@ static AOM_INLINE void sync_lf_workers(AVxWorker *const workers,
       error_info = ((LFWorkerData *)worker->data2)->error_info;
     }
   }
+  THREAD_TRACE_END(lf_sync_workers);
   if (had_error)
     aom_internal_error(cm->error, error_info.error_code, "%s",
                        error_info.detail);
@@ -407,11 +414,13 @@ static int loop_filter_row_worker(void *arg1, void *arg2) {
 
   while ((cur_job_info = get_lf_job_info(lf_sync)) != NULL) {
     const int lpf_opt_level = cur_job_info->lpf_opt_level;
+    THREAD_TRACE_BEGIN(lf_row);
     av1_thread_loop_filter_rows(
         lf_data->frame_buffer, lf_data->cm, lf_data->planes, lf_data->xd,
         cur_job_info->mi_row, cur_job_info->plane, cur_job_info->dir,
         lpf_opt_level, lf_sync, error_info, lf_data->params_buf,
         lf_data->tx_buf, MAX_MIB_SIZE_LOG2);
+    THREAD_TRACE_END(lf_row);
   }
   error_info->setjmp = 0;
   return 1;
@@ -517,12 +526,14 @@ static INLINE void lr_sync_read(void *const lr_sync, int r, int c, int plane) {
 
   if (r && !(c & (nsync - 1))) {
     pthread_mutex_t *const mutex = &loop_res_sync->mutex_[plane][r - 1];
+    THREAD_TRACE_BEGIN(lr_row_sync_wait);
     pthread_mutex_lock(mutex);
 
     while (c > loop_res_sync->cur_sb_col[plane][r - 1] - nsync) {
       pthread_cond_wait(&loop_res_sync->cond_[plane][r - 1], mutex);
     }
     pthread_mutex_unlock(mutex);
+    THREAD_TRACE_END(lr_row_sync_wait);
   }
 #else
   (void)lr_sync;
@@ -855,6 +866,7 @@ static int loop_restoration_row_worker(void *arg1, void *arg2) {
       on_sync_write = cur_job_info->sync_mode == 0 ? lr_sync_write
                                                    : av1_lr_sync_write_dummy;
 
+      THREAD_TRACE_BEGIN(lr_row);
       av1_foreach_rest_unit_in_row(
           &limits, plane_w, lr_ctxt->on_rest_unit, lr_unit_row,
           ctxt[plane].rsi->restoration_unit_size, ctxt[plane].rsi->horz_units,
@@ -870,6 +882,7 @@ static int loop_restoration_row_worker(void *arg1, void *arg2) {
                                            cur_job_info->v_copy_start,
                                            cur_job_info->v_copy_end);
       }
+      THREAD_TRACE_END(lr_row);
     } else {
       break;
     }
@@ -891,6 +904,7 @@ static AOM_INLINE void sync_lr_workers(AVxWorker *const workers,
   }
 
   // Wait till all rows are finished.
+  THREAD_TRACE_BEGIN(lr_sync_workers);
   for (int i = num_workers - 1; i > 0; --i) {
     AVxWorker *const worker = &workers[i];
     if (!winterface->sync(worker)) {
@@ -898,6 +912,7 @@ static AOM_INLINE void sync_lr_workers(AVxWorker *const workers,
       error_info = ((LRWorkerData *)worker->data2)->error_info;
     }
   }
+  THREAD_TRACE_END(lr_sync_workers);
   if (had_error)
     aom_internal_error(cm->error, error_info.error_code, "%s",
                        error_info.detail);
@@ -1014,6 +1029,7 @@ static AOM_INLINE void sync_cdef_workers(AVxWorker *const workers,
   }
 
   // Wait till all rows are finished.
+  THREAD_TRACE_BEGIN(cdef_sync_workers);
   for (int i = num_workers - 1; i > 0; --i) {
     AVxWorker *const worker = &workers[i];
     if (!winterface->sync(worker)) {
@@ -1021,6 +1037,7 @@ static AOM_INLINE void sync_cdef_workers(AVxWorker *const workers,
       error_info = ((AV1CdefWorkerData *)worker->data2)->error_info;
     }
   }
+  THREAD_TRACE_END(cdef_sync_workers);
   if (had_error)
     aom_internal_error(cm->error, error_info.error_code, "%s",
                        error_info.detail);
@@ -1098,6 +1115,7 @@ static int cdef_sb_row_worker_hook(void *arg1, void *arg2) {
   const int num_planes = av1_num_planes(cm);
   while (get_cdef_row_next_job(cdef_sync, &cur_fbr, nvfb)) {
     MACROBLOCKD *xd = cdef_worker->xd;
+    THREAD_TRACE_BEGIN(cdef_row);
     av1_cdef_fb_row(cm, xd, cdef_worker->linebuf, cdef_worker->colbuf,
                     cdef_worker->srcbuf, cur_fbr,
                     cdef_worker->cdef_init_fb_row_fn, cdef_sync, error_info);
@@ -1113,6 +1131,7 @@ static int cdef_sb_row_worker_hook(void *arg1, void *arg2) {
         aom_extend_frame_borders_plane_row(ybf, plane, v_start, v_end);
       }
     }
+    THREAD_TRACE_END(cdef_row);
   }
   error_info->setjmp = 0;
   return 1;
@@ -29,6 +29,7 @@
 #include "aom_ports/mem_ops.h"
 #include "aom_scale/aom_scale.h"
 #include "aom_util/aom_thread.h"
+#include "aom_util/thread_trace.h"
 
 #if CONFIG_BITSTREAM_DEBUG || CONFIG_MISMATCH_DEBUG
 #include "aom_util/debug_util.h"
@@ -2534,6 +2535,7 @@ static INLINE void sync_read(AV1DecRowMTSync *const dec_row_mt_sync, int r,
 
   if (r && !(c & (nsync - 1))) {
     pthread_mutex_t *const mutex = &dec_row_mt_sync->mutex_[r - 1];
+    THREAD_TRACE_BEGIN(dec_row_sync_wait);
     pthread_mutex_lock(mutex);
 
     while (c > dec_row_mt_sync->cur_sb_col[r - 1] - nsync -
@@ -2541,6 +2543,7 @@ static INLINE void sync_read(AV1DecRowMTSync *const dec_row_mt_sync, int r,
       pthread_cond_wait(&dec_row_mt_sync->cond_[r - 1], mutex);
     }
     pthread_mutex_unlock(mutex);
+    THREAD_TRACE_END(dec_row_sync_wait);
   }
 #else
   (void)dec_row_mt_sync;
@@ -2962,7 +2965,9 @@ static int tile_worker_hook(void *arg1, void *arg2) {
       // decode tile
       int tile_row = tile_data->tile_info.tile_row;
       int tile_col = tile_data->tile_info.tile_col;
+      THREAD_TRACE_BEGIN(dec_tile);
       decode_tile(pbi, td, tile_row, tile_col);
+      THREAD_TRACE_END(dec_tile);
     } else {
       break;
     }
@@ -3219,7 +3224,9 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
       pthread_mutex_unlock(pbi->row_mt_mutex_);
 #endif
       // decode tile
+      THREAD_TRACE_BEGIN(dec_parse_tile);
       parse_tile_row_mt(pbi, td, tile_data);
+      THREAD_TRACE_END(dec_parse_tile);
 #if CONFIG_MULTITHREAD
       pthread_mutex_lock(pbi->row_mt_mutex_);
 #endif
@@ -3251,6 +3258,7 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
     AV1DecRowMTJobInfo next_job_info;
     int end_of_frame = 0;
 
+    THREAD_TRACE_BEGIN(dec_job_wait);
 #if CONFIG_MULTITHREAD
     pthread_mutex_lock(pbi->row_mt_mutex_);
 #endif
@@ -3262,6 +3270,7 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
 #if CONFIG_MULTITHREAD
     pthread_mutex_unlock(pbi->row_mt_mutex_);
 #endif
+    THREAD_TRACE_END(dec_job_wait);
 
     if (end_of_frame) break;
 
@@ -3277,7 +3286,9 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
     av1_init_macroblockd(cm, &td->dcb.xd);
     td->dcb.xd.error_info = &thread_data->error_info;
 
+    THREAD_TRACE_BEGIN(dec_sb_row);
     decode_tile_sb_row(pbi, td, &tile_data->tile_info, mi_row);
+    THREAD_TRACE_END(dec_sb_row);
 
 #if CONFIG_MULTITHREAD
     pthread_mutex_lock(pbi->row_mt_mutex_);
@@ -3457,10 +3468,12 @@ static AOM_INLINE void sync_dec_workers(AV1Decoder *pbi, int num_workers) {
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
   int corrupted = 0;
 
+  THREAD_TRACE_BEGIN(dec_sync_workers);
   for (int worker_idx = num_workers; worker_idx > 0; --worker_idx) {
     AVxWorker *const worker = &pbi->tile_workers[worker_idx - 1];
     aom_merge_corrupted_flag(&corrupted, !winterface->sync(worker));
   }
+  THREAD_TRACE_END(dec_sync_workers);
 
   pbi->dcb.corrupted = corrupted;
 }
@@ -5196,7 +5209,9 @@ uint32_t av1_decode_frame_headers_and_setup(AV1Decoder *pbi,
   cm->mi_params.setup_mi(&cm->mi_params);
 
   av1_calculate_ref_frame_side(cm);
-  if (cm->features.allow_ref_frame_mvs) av1_setup_motion_field(cm);
+  // The projected motion field is only used by tile decoding.
+  if (cm->features.allow_ref_frame_mvs && !pbi->header_only)
+    av1_setup_motion_field(cm);
 
   av1_setup_block_planes(xd, cm->seq_params->subsampling_x,
                          cm->seq_params->subsampling_y, num_planes);
@@ -5245,6 +5260,19 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
   const int tile_count_tg = end_tile - start_tile + 1;
 
   xd->error_info = cm->error;
+
+  if (pbi->header_only) {
+    // Skip the tile data, but keep the state that the headers of later frames
+    // depend on.
+    *p_data_end = data_end;
+    if (end_tile == tiles->rows * tiles->cols - 1) {
+      cm->cur_frame->frame_context = *cm->fc;
+      if (cm->show_frame && !cm->seq_params->order_hint_info.enable_order_hint)
+        ++cm->current_frame.frame_number;
+    }
+    return;
+  }
+
   if (initialize_flag) setup_frame_info(pbi);
   const int num_planes = av1_num_planes(cm);
 
@@ -5263,6 +5291,10 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     set_planes_to_neutral_grey(cm->seq_params, xd->cur_buf, 1);
   }
 
+  // The tiles are decoded in raster order, so the tile rows above the one of
+  // the next tile are complete.
+  pbi->decoded_sb_rows = tiles->row_start_sb[(end_tile + 1) / tiles->cols];
+
   if (end_tile != tiles->rows * tiles->cols - 1) {
     return;
   }
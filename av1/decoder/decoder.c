@@ -22,6 +22,7 @@
 #include "aom_ports/aom_timer.h"
 #include "aom_scale/aom_scale.h"
 #include "aom_util/aom_thread.h"
+#include "aom_util/thread_trace.h"
 
 #include "av1/common/alloccommon.h"
 #include "av1/common/av1_common_int.h"
@@ -176,6 +177,8 @@ void av1_decoder_remove(AV1Decoder *pbi) {
 
   if (!pbi) return;
 
+  THREAD_TRACE_WRITE();
+
   // Free the tile list output buffer.
   aom_free_frame_buffer(&pbi->tile_list_outbuf);
 
@@ -226,6 +229,7 @@ void av1_decoder_remove(AV1Decoder *pbi) {
   aom_accounting_clear(&pbi->accounting);
 #endif
   av1_free_mc_tmp_buf(&pbi->td);
+  aom_free(pbi->saved_frame_header);
   aom_img_metadata_array_free(pbi->metadata);
   av1_remove_common(&pbi->common);
   aom_free(pbi);
@@ -347,6 +351,7 @@ static void release_current_frame(AV1Decoder *pbi) {
   decrease_ref_count(cm->cur_frame, pool);
   unlock_buffer_pool(pool);
   cm->cur_frame = NULL;
+  pbi->frame_incomplete = 0;
 }
 
 // If any buffer updating is signaled it should be done here.
@@ -421,6 +426,30 @@ static void update_frame_buffers(AV1Decoder *pbi, int frame_decoded) {
   }
 }
 
+// Appends the header information of the frame just decoded to
+// pbi->tu_parse_info. 'size' is the number of bytes consumed by the frame.
+static void record_frame_parse_info(AV1Decoder *pbi, size_t size) {
+  AV1_COMMON *const cm = &pbi->common;
+  aom_tu_parse_info *const tu_info = &pbi->tu_parse_info;
+  if (tu_info->num_frames >= AOM_MAX_TU_PARSE_FRAMES) return;
+
+  const RefCntBuffer *const frame = cm->cur_frame;
+  aom_frame_parse_info *const info = &tu_info->frames[tu_info->num_frames++];
+  info->frame_type = frame->frame_type;
+  info->show_frame = cm->show_frame;
+  info->showable_frame = frame->showable_frame;
+  info->show_existing_frame = cm->show_existing_frame;
+  info->refresh_frame_flags = cm->current_frame.refresh_frame_flags;
+  info->base_q_idx =
+      cm->show_existing_frame ? -1 : cm->quant_params.base_qindex;
+  info->order_hint = frame->order_hint;
+  info->temporal_id = frame->temporal_id;
+  info->spatial_id = frame->spatial_id;
+  info->width = frame->buf.y_crop_width;
+  info->height = frame->buf.y_crop_height;
+  info->size = size;
+}
+
 int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
                                 const uint8_t **psource) {
   AV1_COMMON *volatile const cm = &pbi->common;
@@ -441,7 +470,8 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     if (ref_buf != NULL) ref_buf->buf.corrupted = 1;
   }
 
-  if (assign_cur_frame_new_fb(cm) == NULL) {
+  // An incomplete frame keeps its frame buffer.
+  if (!pbi->frame_incomplete && assign_cur_frame_new_fb(cm) == NULL) {
     pbi->error.error_code = AOM_CODEC_MEM_ERROR;
     return 1;
   }
@@ -478,6 +508,12 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     return 1;
   }
 
+  if (pbi->frame_incomplete) {
+    // The rest of the frame comes with the next data.
+    pbi->error.setjmp = 0;
+    return 0;
+  }
+
 #if TXCOEFF_TIMER
   cm->cum_txcoeff_timer += cm->txcoeff_timer;
   fprintf(stderr,
@@ -487,6 +523,8 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
   cm->txb_count = 0;
 #endif
 
+  if (frame_decoded) record_frame_parse_info(pbi, (size_t)(*psource - source));
+
   // Note: At this point, this function holds a reference to cm->cur_frame
   // in the buffer pool. This reference is consumed by update_frame_buffers().
   update_frame_buffers(pbi, frame_decoded);
@@ -337,6 +337,22 @@ typedef struct AV1Decoder {
   int context_update_tile_id;
   int skip_loop_filter;
   int skip_film_grain;
+  // Only parse the headers; tile data is skipped (see AV1D_SET_HEADER_ONLY).
+  int header_only;
+  // Header information of the frames in the current temporal unit.
+  aom_tu_parse_info tu_parse_info;
+  // Decode the frames as their OBUs arrive (see AV1D_SET_INCREMENTAL_DECODE).
+  int incremental_decode;
+  // Set when the last data ended in the middle of the current frame. Its
+  // decoding resumes with the next data.
+  int frame_incomplete;
+  // Copy of the frame header of an incomplete frame, to check the redundant
+  // frame headers of its later tile groups against.
+  uint8_t *saved_frame_header;
+  size_t saved_frame_header_alloc;
+  // Number of superblock rows of the current frame whose tiles are all
+  // decoded.
+  int decoded_sb_rows;
   int is_annexb;
   int valid_for_referencing[REF_FRAMES];
   int is_fwd_kf_present;
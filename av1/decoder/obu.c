@@ -16,6 +16,7 @@
 
 #include "aom/aom_codec.h"
 #include "aom_dsp/bitreader_buffer.h"
+#include "aom_mem/aom_mem.h"
 #include "aom_ports/mem_ops.h"
 
 #include "av1/common/common.h"
@@ -841,6 +842,25 @@ static size_t read_padding(AV1_COMMON *const cm, const uint8_t *data,
   return sz;
 }
 
+// Copies the frame header of an incomplete frame, as the data holding it may
+// not outlive the call. Returns 0 and sets pbi->error.error_code on failure.
+static int save_frame_header(AV1Decoder *pbi, const uint8_t *frame_header,
+                             uint32_t frame_header_size) {
+  if (frame_header == pbi->saved_frame_header) return 1;
+  if (frame_header_size > pbi->saved_frame_header_alloc) {
+    aom_free(pbi->saved_frame_header);
+    pbi->saved_frame_header_alloc = 0;
+    pbi->saved_frame_header = (uint8_t *)aom_malloc(frame_header_size);
+    if (pbi->saved_frame_header == NULL) {
+      pbi->error.error_code = AOM_CODEC_MEM_ERROR;
+      return 0;
+    }
+    pbi->saved_frame_header_alloc = frame_header_size;
+  }
+  memcpy(pbi->saved_frame_header, frame_header, frame_header_size);
+  return 1;
+}
+
 // On success, returns a boolean that indicates whether the decoding of the
 // current frame is finished. On failure, sets pbi->error.error_code and
 // returns -1.
@@ -849,7 +869,8 @@ int aom_decode_frame_from_obus(struct AV1Decoder *pbi, const uint8_t *data,
                                const uint8_t **p_data_end) {
   AV1_COMMON *const cm = &pbi->common;
   int frame_decoding_finished = 0;
-  int is_first_tg_obu_received = 1;
+  // An incomplete frame resumes after its frame header and first tile groups.
+  const int resume_frame = pbi->frame_incomplete;
   // Whenever pbi->seen_frame_header is set to 1, frame_header is set to the
   // beginning of the frame_header_obu and frame_header_size is set to its
   // size. This allows us to check if a redundant frame_header_obu is a copy
@@ -863,9 +884,16 @@ int aom_decode_frame_from_obus(struct AV1Decoder *pbi, const uint8_t *data,
   uint32_t frame_header_size = 0;
   ObuHeader obu_header;
   memset(&obu_header, 0, sizeof(obu_header));
-  pbi->seen_frame_header = 0;
-  pbi->next_start_tile = 0;
-  pbi->num_tile_groups = 0;
+  if (resume_frame) {
+    frame_header = pbi->saved_frame_header;
+    frame_header_size = (uint32_t)pbi->frame_header_size;
+  } else {
+    pbi->seen_frame_header = 0;
+    pbi->next_start_tile = 0;
+    pbi->num_tile_groups = 0;
+  }
+  pbi->frame_incomplete = 0;
+  int is_first_tg_obu_received = pbi->num_tile_groups == 0;
 
   if (data_end < data) {
     pbi->error.error_code = AOM_CODEC_CORRUPT_FRAME;
@@ -889,6 +917,14 @@ int aom_decode_frame_from_obus(struct AV1Decoder *pbi, const uint8_t *data,
       pbi->error.error_code = AOM_CODEC_OK;
       break;
     }
+    if (bytes_available == 0 && pbi->incremental_decode &&
+        !pbi->is_annexb && !cm->tiles.large_scale) {
+      // Wait for the remaining tile groups of the frame.
+      if (!save_frame_header(pbi, frame_header, frame_header_size)) return -1;
+      pbi->frame_incomplete = 1;
+      *p_data_end = data;
+      break;
+    }
 
     aom_codec_err_t status =
         aom_read_obu_header_and_size(data, bytes_available, pbi->is_annexb,
@@ -967,6 +1003,7 @@ int aom_decode_frame_from_obus(struct AV1Decoder *pbi, const uint8_t *data,
               pbi, &rb, data, p_data_end, obu_header.type != OBU_FRAME);
           frame_header = data;
           pbi->seen_frame_header = 1;
+          pbi->decoded_sb_rows = 0;
           if (!pbi->ext_tile_debug && cm->tiles.large_scale)
             pbi->camera_frame_header_ready = 1;
         } else {
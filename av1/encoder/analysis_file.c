@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+
+#include "config/aom_config.h"
+
+#include "aom/internal/aom_codec_internal.h"
+#include "aom_mem/aom_mem.h"
+#include "av1/encoder/analysis_file.h"
+
+// Analysis files of long sequences can exceed 2 GiB, so 64-bit file offsets
+// are used as in common/tools_common.h.
+#if defined(_MSC_VER)
+#define fseeko _fseeki64
+#define ftello _ftelli64
+#elif defined(_WIN32)
+#define fseeko fseeko64
+#define ftello ftello64
+#elif !CONFIG_OS_SUPPORT
+#define fseeko fseek
+#define ftello ftell
+#endif
+
+static uint64_t get_key(uint32_t frame_display_index,
+                        uint32_t ref_display_index) {
+  return ((uint64_t)frame_display_index << 32) | ref_display_index;
+}
+
+static uint32_t hash_key(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return (uint32_t)key;
+}
+
+static AnalysisIndexEntry *index_lookup(const AnalysisIndex *index,
+                                        uint64_t key) {
+  if (index->capacity == 0) return NULL;
+  const int mask = index->capacity - 1;
+  for (int i = hash_key(key) & mask;; i = (i + 1) & mask) {
+    AnalysisIndexEntry *const entry = &index->entries[i];
+    if (!entry->used) return NULL;
+    if (entry->key == key) return entry;
+  }
+}
+
+// Adds 'key' to the table unless it is already present. Returns the new entry,
+// or NULL if the key was present.
+static AnalysisIndexEntry *index_insert(AnalysisIndex *index, uint64_t key,
+                                        struct aom_internal_error_info *error) {
+  if (2 * (index->count + 1) > index->capacity) {
+    AnalysisIndex grown;
+    grown.capacity = index->capacity ? 2 * index->capacity : 256;
+    grown.count = 0;
+    grown.entries = aom_calloc(grown.capacity, sizeof(*grown.entries));
+    if (!grown.entries) {
+      aom_internal_error(error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate analysis file index");
+    }
+    for (int i = 0; i < index->capacity; ++i) {
+      if (!index->entries[i].used) continue;
+      *index_insert(&grown, index->entries[i].key, error) = index->entries[i];
+    }
+    aom_free(index->entries);
+    *index = grown;
+  }
+  const int mask = index->capacity - 1;
+  for (int i = hash_key(key) & mask;; i = (i + 1) & mask) {
+    AnalysisIndexEntry *const entry = &index->entries[i];
+    if (!entry->used) {
+      entry->used = 1;
+      entry->key = key;
+      ++index->count;
+      return entry;
+    }
+    if (entry->key == key) return NULL;
+  }
+}
+
+static int read_u32s(FILE *stream, uint32_t *vals, size_t count) {
+  return fread(vals, sizeof(*vals), count, stream) == count;
+}
+
+static void write_u32s(FILE *stream, const uint32_t *vals, size_t count,
+                       struct aom_internal_error_info *error) {
+  if (fwrite(vals, sizeof(*vals), count, stream) != count) {
+    aom_internal_error(error, AOM_CODEC_ERROR,
+                       "Could not write to analysis file");
+  }
+}
+
+static void build_import_index(AV1AnalysisFile *af,
+                               struct aom_internal_error_info *error) {
+  uint32_t header[4];
+  if (!read_u32s(af->import_stream, header, 4) ||
+      header[0] != AV1_ANALYSIS_FILE_MAGIC) {
+    aom_internal_error(error, AOM_CODEC_INVALID_PARAM,
+                       "Invalid analysis file");
+  }
+  if (header[1] != AV1_ANALYSIS_FILE_VERSION) {
+    aom_internal_error(error, AOM_CODEC_INCAPABLE,
+                       "Unsupported analysis file version %u", header[1]);
+  }
+  // Motion fields computed at another TPL block size cannot be used.
+  if ((int)header[2] != af->tpl_bsize_1d) return;
+
+  uint32_t record[4];
+  while (read_u32s(af->import_stream, record, 4)) {
+    const int64_t offset = ftello(af->import_stream);
+    const int64_t size = (int64_t)record[2] * record[3] * sizeof(int_mv);
+    if (offset < 0 || fseeko(af->import_stream, size, SEEK_CUR)) break;
+    AnalysisIndexEntry *const entry =
+        index_insert(&af->import_index, get_key(record[0], record[1]), error);
+    if (entry) {
+      entry->offset = offset;
+      entry->width = (int)record[2];
+      entry->height = (int)record[3];
+    }
+  }
+}
+
+void av1_analysis_file_open(AV1AnalysisFile **af_ptr, const char *import_path,
+                            const char *export_path, int tpl_bsize_1d,
+                            struct aom_internal_error_info *error) {
+  if (import_path && export_path && !strcmp(import_path, export_path)) {
+    aom_internal_error(error, AOM_CODEC_INVALID_PARAM,
+                       "The analysis import and export files must differ");
+  }
+  AV1AnalysisFile *const af = aom_calloc(1, sizeof(*af));
+  if (!af) {
+    aom_internal_error(error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate analysis file context");
+  }
+  af->tpl_bsize_1d = tpl_bsize_1d;
+  // Stored before anything else can fail, so that the caller frees it.
+  *af_ptr = af;
+
+  if (import_path) {
+    af->import_stream = fopen(import_path, "rb");
+    if (!af->import_stream) {
+      aom_internal_error(error, AOM_CODEC_ERROR,
+                         "Could not open analysis import file %s",
+                         import_path);
+    }
+    build_import_index(af, error);
+  }
+
+  if (export_path) {
+    af->export_stream = fopen(export_path, "wb");
+    if (!af->export_stream) {
+      aom_internal_error(error, AOM_CODEC_ERROR,
+                         "Could not open analysis export file %s",
+                         export_path);
+    }
+    const uint32_t header[4] = { AV1_ANALYSIS_FILE_MAGIC,
+                                 AV1_ANALYSIS_FILE_VERSION,
+                                 (uint32_t)tpl_bsize_1d, 0 };
+    write_u32s(af->export_stream, header, 4, error);
+  }
+}
+
+void av1_analysis_file_close(AV1AnalysisFile *af) {
+  if (!af) return;
+  if (af->import_stream) fclose(af->import_stream);
+  if (af->export_stream) fclose(af->export_stream);
+  aom_free(af->import_index.entries);
+  aom_free(af->export_index.entries);
+  aom_free(af->record_buf);
+  for (int i = 0; i < INTER_REFS_PER_FRAME; ++i) aom_free(af->mv_buf[i]);
+  aom_free(af);
+}
+
+const int_mv *av1_analysis_file_read_tpl_mvs(
+    AV1AnalysisFile *af, uint32_t frame_display_index,
+    uint32_t ref_display_index, int ref_idx, int width, int height,
+    struct aom_internal_error_info *error) {
+  if (!af->import_stream) return NULL;
+  const AnalysisIndexEntry *const entry = index_lookup(
+      &af->import_index, get_key(frame_display_index, ref_display_index));
+  if (!entry || entry->width != width || entry->height != height) return NULL;
+
+  const int size = width * height;
+  if (af->mv_buf_size[ref_idx] < size) {
+    aom_free(af->mv_buf[ref_idx]);
+    af->mv_buf_size[ref_idx] = 0;
+    af->mv_buf[ref_idx] = aom_malloc(size * sizeof(*af->mv_buf[ref_idx]));
+    if (!af->mv_buf[ref_idx]) {
+      aom_internal_error(error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate analysis motion field");
+    }
+    af->mv_buf_size[ref_idx] = size;
+  }
+  if (fseeko(af->import_stream, entry->offset, SEEK_SET) ||
+      fread(af->mv_buf[ref_idx], sizeof(int_mv), size, af->import_stream) !=
+          (size_t)size) {
+    aom_internal_error(error, AOM_CODEC_ERROR,
+                       "Could not read from analysis file");
+  }
+  return af->mv_buf[ref_idx];
+}
+
+void av1_analysis_file_write_tpl_mvs(AV1AnalysisFile *af,
+                                     uint32_t frame_display_index,
+                                     uint32_t ref_display_index, int ref_idx,
+                                     const TplDepStats *tpl_stats, int width,
+                                     int height,
+                                     struct aom_internal_error_info *error) {
+  if (!af->export_stream) return;
+  if (!index_insert(&af->export_index,
+                    get_key(frame_display_index, ref_display_index), error))
+    return;
+
+  // The record is assembled in memory and written with a single call.
+  const int size = 4 + width * height;
+  if (af->record_buf_size < size) {
+    aom_free(af->record_buf);
+    af->record_buf_size = 0;
+    af->record_buf = aom_malloc(size * sizeof(*af->record_buf));
+    if (!af->record_buf) {
+      aom_internal_error(error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate analysis file record");
+    }
+    af->record_buf_size = size;
+  }
+  uint32_t *const record = af->record_buf;
+  record[0] = frame_display_index;
+  record[1] = ref_display_index;
+  record[2] = (uint32_t)width;
+  record[3] = (uint32_t)height;
+  for (int i = 0; i < width * height; ++i) {
+    record[4 + i] = tpl_stats[i].mv[ref_idx].as_int;
+  }
+  write_u32s(af->export_stream, record, size, error);
+}
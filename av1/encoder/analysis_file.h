@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AV1_ENCODER_ANALYSIS_FILE_H_
+#define AOM_AV1_ENCODER_ANALYSIS_FILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "av1/common/mv.h"
+#include "av1/encoder/tpl_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct aom_internal_error_info;
+
+/*!\cond */
+
+// The analysis file stores the results of QP independent analysis so that
+// later encodes of the same source can skip it. It starts with a header of
+// four uint32_t values: AV1_ANALYSIS_FILE_MAGIC, AV1_ANALYSIS_FILE_VERSION,
+// the TPL block size in pixels and 0 (reserved). It is followed by records,
+// each made of four uint32_t values (frame display index, reference display
+// index, width and height in TPL blocks) and width * height int_mv values
+// holding the TPL motion field of the frame against that reference. Display
+// indices count shown frames from the start of the sequence. All values are
+// in native byte order.
+#define AV1_ANALYSIS_FILE_MAGIC 0x41315641  // "AV1A" read little endian
+#define AV1_ANALYSIS_FILE_VERSION 1
+
+typedef struct {
+  uint64_t key;
+  int64_t offset;
+  int width;
+  int height;
+  int used;
+} AnalysisIndexEntry;
+
+// Open addressing hash table of motion field records.
+typedef struct {
+  AnalysisIndexEntry *entries;
+  int capacity;
+  int count;
+} AnalysisIndex;
+
+typedef struct AV1AnalysisFile {
+  FILE *import_stream;
+  FILE *export_stream;
+  int tpl_bsize_1d;
+  // Records found in the import file, with the offset of their motion field.
+  AnalysisIndex import_index;
+  // Records already written to the export file.
+  AnalysisIndex export_index;
+  // Motion fields read for the reference frames of the current TPL frame.
+  int_mv *mv_buf[INTER_REFS_PER_FRAME];
+  int mv_buf_size[INTER_REFS_PER_FRAME];
+  // A record being written: its four uint32_t header values and motion field.
+  uint32_t *record_buf;
+  int record_buf_size;
+} AV1AnalysisFile;
+
+/*!\endcond */
+
+/*!\brief Opens the analysis files used by the encoder
+ *
+ * Either path may be NULL. The import file is indexed when opened, and the
+ * header of the export file is written. The context is stored in *af_ptr as
+ * soon as it is allocated, so it must be freed with av1_analysis_file_close()
+ * even if opening fails.
+ *
+ * \param[out]   af_ptr        Pointer to the new analysis file context
+ * \param[in]    import_path   Analysis file written by a previous encode
+ * \param[in]    export_path   Analysis file to write
+ * \param[in]    tpl_bsize_1d  TPL block size in pixels
+ * \param[in]    error         Error info, set on failure
+ */
+void av1_analysis_file_open(AV1AnalysisFile **af_ptr, const char *import_path,
+                            const char *export_path, int tpl_bsize_1d,
+                            struct aom_internal_error_info *error);
+
+/*!\brief Closes the analysis files and frees the context */
+void av1_analysis_file_close(AV1AnalysisFile *af);
+
+/*!\brief Reads the TPL motion field of a frame against one reference
+ *
+ * \param[in]    af                   Analysis file context
+ * \param[in]    frame_display_index  Display index of the frame
+ * \param[in]    ref_display_index    Display index of the reference frame
+ * \param[in]    ref_idx              Reference frame type, minus LAST_FRAME
+ * \param[in]    width                Width of the field in TPL blocks
+ * \param[in]    height               Height of the field in TPL blocks
+ * \param[in]    error                Error info, set on failure
+ *
+ * \return The motion field, valid until the next call with the same ref_idx,
+ *         or NULL if the import file has no field of that size for the pair
+ */
+const int_mv *av1_analysis_file_read_tpl_mvs(
+    AV1AnalysisFile *af, uint32_t frame_display_index,
+    uint32_t ref_display_index, int ref_idx, int width, int height,
+    struct aom_internal_error_info *error);
+
+/*!\brief Writes the TPL motion field of a frame against one reference
+ *
+ * Only the first field written for a given frame and reference pair is kept.
+ *
+ * \param[in]    af                   Analysis file context
+ * \param[in]    frame_display_index  Display index of the frame
+ * \param[in]    ref_display_index    Display index of the reference frame
+ * \param[in]    ref_idx              Reference frame type, minus LAST_FRAME
+ * \param[in]    tpl_stats            TPL stats of the frame
+ * \param[in]    width                Width of the TPL stats in blocks
+ * \param[in]    height               Height of the TPL stats in blocks
+ * \param[in]    error                Error info, set on failure
+ */
+void av1_analysis_file_write_tpl_mvs(AV1AnalysisFile *af,
+                                     uint32_t frame_display_index,
+                                     uint32_t ref_display_index, int ref_idx,
+                                     const TplDepStats *tpl_stats, int width,
+                                     int height,
+                                     struct aom_internal_error_info *error);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AV1_ENCODER_ANALYSIS_FILE_H_
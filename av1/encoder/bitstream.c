@@ -1761,8 +1761,16 @@ static AOM_INLINE void write_modes(AV1_COMP *const cpi, ThreadData *const td,
     for (int mi_col = mi_col_start; mi_col < mi_col_end;
          mi_col += cm->seq_params->mib_size) {
       td->mb.cb_coef_buff = av1_get_cb_coeff_buffer(cpi, mi_row, mi_col);
+      const int start = cpi->sb_stats != NULL ? aom_tell_size(w) : 0;
       write_modes_sb(cpi, td, tile, w, &tok, tok_end, mi_row, mi_col,
                      cm->seq_params->sb_size);
+      if (cpi->sb_stats != NULL) {
+        const int mib_size_log2 = cm->seq_params->mib_size_log2;
+        aom_sb_stats_t *const stats =
+            &cpi->sb_stats[(mi_row >> mib_size_log2) * cpi->sb_stats_cols +
+                           (mi_col >> mib_size_log2)];
+        stats->bits = aom_tell_size(w) - start;
+      }
     }
     assert(tok == tok_end);
   }
@@ -3863,13 +3871,16 @@ void av1_accumulate_pack_bs_thread_data(AV1_COMP *const cpi,
         td->interp_filter_selected[filter];
 }
 
-// Store information related to each default tile in the OBU header.
+// Store information related to each default tile in the OBU header. The tiles
+// from start_tile up to end_tile are packed. They must start and end tile
+// groups.
 static void write_tile_obu(
     AV1_COMP *const cpi, uint8_t *const dst, uint32_t *total_size,
     struct aom_write_bit_buffer *saved_wb, uint8_t obu_extn_header,
     const FrameHeaderInfo *fh_info, int *const largest_tile_id,
     unsigned int *max_tile_size, uint32_t *const obu_header_size,
-    uint8_t **tile_data_start) {
+    uint8_t **tile_data_start, int start_tile, int end_tile,
+    int *const is_first_tg) {
   AV1_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
   const CommonTileParams *const tiles = &cm->tiles;
@@ -3882,71 +3893,69 @@ static void write_tile_obu(
   size_t curr_tg_data_size = 0;
   uint8_t *tile_data_curr = dst;
   int new_tg = 1;
-  int is_first_tg = 1;
-
-  av1_reset_pack_bs_thread_data(&cpi->td);
-  for (int tile_row = 0; tile_row < tile_rows; tile_row++) {
-    for (int tile_col = 0; tile_col < tile_cols; tile_col++) {
-      const int tile_idx = tile_row * tile_cols + tile_col;
-      TileDataEnc *this_tile = &cpi->tile_data[tile_idx];
 
-      int is_last_tile_in_tg = 0;
-      if (new_tg) {
-        tile_data_curr = dst + *total_size;
-        tile_count = 0;
-      }
-      tile_count++;
-
-      if (tile_count == tg_size || tile_idx == (tile_cols * tile_rows - 1))
-        is_last_tile_in_tg = 1;
-
-      xd->tile_ctx = &this_tile->tctx;
-
-      // PackBSParams stores all parameters required to pack tile and header
-      // info.
-      PackBSParams pack_bs_params;
-      pack_bs_params.dst = dst;
-      pack_bs_params.curr_tg_hdr_size = 0;
-      pack_bs_params.is_last_tile_in_tg = is_last_tile_in_tg;
-      pack_bs_params.new_tg = new_tg;
-      pack_bs_params.obu_extn_header = obu_extn_header;
-      pack_bs_params.obu_header_size = 0;
-      pack_bs_params.saved_wb = saved_wb;
-      pack_bs_params.tile_col = tile_col;
-      pack_bs_params.tile_row = tile_row;
-      pack_bs_params.tile_data_curr = tile_data_curr;
-      pack_bs_params.total_size = total_size;
-
-      if (new_tg)
-        av1_write_obu_tg_tile_headers(cpi, xd, &pack_bs_params, tile_idx);
-
-      av1_pack_tile_info(cpi, &cpi->td, &pack_bs_params);
-
-      if (new_tg) {
-        curr_tg_data_size = pack_bs_params.curr_tg_hdr_size;
-        *tile_data_start += pack_bs_params.curr_tg_hdr_size;
-        *obu_header_size = pack_bs_params.obu_header_size;
-        new_tg = 0;
-      }
-      if (is_last_tile_in_tg) new_tg = 1;
+  assert(start_tile % tg_size == 0);
+  for (int tile_idx = start_tile; tile_idx < end_tile; tile_idx++) {
+    const int tile_row = tile_idx / tile_cols;
+    const int tile_col = tile_idx % tile_cols;
+    TileDataEnc *this_tile = &cpi->tile_data[tile_idx];
 
-      curr_tg_data_size +=
-          (pack_bs_params.buf.size + (is_last_tile_in_tg ? 0 : 4));
+    int is_last_tile_in_tg = 0;
+    if (new_tg) {
+      tile_data_curr = dst + *total_size;
+      tile_count = 0;
+    }
+    tile_count++;
+
+    if (tile_count == tg_size || tile_idx == (tile_cols * tile_rows - 1))
+      is_last_tile_in_tg = 1;
+
+    xd->tile_ctx = &this_tile->tctx;
+
+    // PackBSParams stores all parameters required to pack tile and header
+    // info.
+    PackBSParams pack_bs_params;
+    pack_bs_params.dst = dst;
+    pack_bs_params.curr_tg_hdr_size = 0;
+    pack_bs_params.is_last_tile_in_tg = is_last_tile_in_tg;
+    pack_bs_params.new_tg = new_tg;
+    pack_bs_params.obu_extn_header = obu_extn_header;
+    pack_bs_params.obu_header_size = 0;
+    pack_bs_params.saved_wb = saved_wb;
+    pack_bs_params.tile_col = tile_col;
+    pack_bs_params.tile_row = tile_row;
+    pack_bs_params.tile_data_curr = tile_data_curr;
+    pack_bs_params.total_size = total_size;
+
+    if (new_tg)
+      av1_write_obu_tg_tile_headers(cpi, xd, &pack_bs_params, tile_idx);
+
+    av1_pack_tile_info(cpi, &cpi->td, &pack_bs_params);
+
+    if (new_tg) {
+      curr_tg_data_size = pack_bs_params.curr_tg_hdr_size;
+      *tile_data_start += pack_bs_params.curr_tg_hdr_size;
+      *obu_header_size = pack_bs_params.obu_header_size;
+      new_tg = 0;
+    }
+    if (is_last_tile_in_tg) new_tg = 1;
 
-      if (pack_bs_params.buf.size > *max_tile_size) {
-        *largest_tile_id = tile_idx;
-        *max_tile_size = (unsigned int)pack_bs_params.buf.size;
-      }
+    curr_tg_data_size +=
+        (pack_bs_params.buf.size + (is_last_tile_in_tg ? 0 : 4));
 
-      if (is_last_tile_in_tg)
-        av1_write_last_tile_info(cpi, fh_info, saved_wb, &curr_tg_data_size,
-                                 tile_data_curr, total_size, tile_data_start,
-                                 largest_tile_id, &is_first_tg,
-                                 *obu_header_size, obu_extn_header);
-      *total_size += (uint32_t)pack_bs_params.buf.size;
+    if (pack_bs_params.buf.size > *max_tile_size) {
+      *largest_tile_id = tile_idx;
+      *max_tile_size = (unsigned int)pack_bs_params.buf.size;
     }
+
+    if (is_last_tile_in_tg)
+      av1_write_last_tile_info(cpi, fh_info, saved_wb, &curr_tg_data_size,
+                               tile_data_curr, total_size, tile_data_start,
+                               largest_tile_id, is_first_tg,
+                               *obu_header_size, obu_extn_header);
+    *total_size += (uint32_t)pack_bs_params.buf.size;
   }
-  av1_accumulate_pack_bs_thread_data(cpi, &cpi->td);
+  assert(new_tg);
 }
 
 // Write total buffer size and related information into the OBU header for
@@ -4060,9 +4069,12 @@ static INLINE uint32_t pack_tiles_in_tg_obus(
                           fh_info, largest_tile_id, &max_tile_size,
                           &obu_header_size, &tile_data_start, num_workers);
   } else {
+    int is_first_tg = 1;
+    av1_reset_pack_bs_thread_data(&cpi->td);
     write_tile_obu(cpi, dst, &total_size, saved_wb, obu_extension_header,
                    fh_info, largest_tile_id, &max_tile_size, &obu_header_size,
-                   &tile_data_start);
+                   &tile_data_start, 0, num_tiles, &is_first_tg);
+    av1_accumulate_pack_bs_thread_data(cpi, &cpi->td);
   }
 
   if (num_tiles > 1)
@@ -4153,30 +4165,19 @@ static size_t av1_write_metadata_array(AV1_COMP *const cpi, uint8_t *dst) {
   return total_bytes_written;
 }
 
-int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t *size,
-                       int *const largest_tile_id) {
+// Writes the OBUs of a frame preceding its tile groups: the sequence header on
+// intra frames, the metadata and the frame header. Stores the number of bytes
+// written to dst in *size.
+static int write_frame_header_obus(AV1_COMP *const cpi, uint8_t *const dst,
+                                   struct aom_write_bit_buffer *saved_wb,
+                                   FrameHeaderInfo *fh_info,
+                                   uint8_t obu_extension_header,
+                                   uint32_t *const size) {
   uint8_t *data = dst;
-  uint32_t data_size;
   AV1_COMMON *const cm = &cpi->common;
   AV1LevelParams *const level_params = &cpi->ppi->level_params;
   uint32_t obu_header_size = 0;
   uint32_t obu_payload_size = 0;
-  FrameHeaderInfo fh_info = { NULL, 0, 0 };
-  const uint8_t obu_extension_header =
-      cm->temporal_layer_id << 5 | cm->spatial_layer_id << 3 | 0;
-
-  // If no non-zero delta_q has been used, reset delta_q_present_flag
-  if (cm->delta_q_info.delta_q_present_flag && cpi->deltaq_used == 0) {
-    cm->delta_q_info.delta_q_present_flag = 0;
-  }
-
-#if CONFIG_BITSTREAM_DEBUG
-  bitstream_queue_reset_write();
-#endif
-
-  cpi->frame_header_count = 0;
-
-  // The TD is now written outside the frame encode loop
 
   // write sequence header obu at each key frame or intra_only frame,
   // preceded by 4-byte size
@@ -4201,15 +4202,14 @@ int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t *size,
 
   const int write_frame_header =
       (cpi->num_tg > 1 || encode_show_existing_frame(cm));
-  struct aom_write_bit_buffer saved_wb = { NULL, 0 };
   size_t length_field = 0;
   if (write_frame_header) {
     // Write Frame Header OBU.
-    fh_info.frame_header = data;
+    fh_info->frame_header = data;
     obu_header_size =
         av1_write_obu_header(level_params, &cpi->frame_header_count,
                              OBU_FRAME_HEADER, obu_extension_header, data);
-    obu_payload_size = write_frame_header_obu(cpi, &cpi->td.mb.e_mbd, &saved_wb,
+    obu_payload_size = write_frame_header_obu(cpi, &cpi->td.mb.e_mbd, saved_wb,
                                               data + obu_header_size, 1);
 
     length_field = av1_obu_memmove(obu_header_size, obu_payload_size, data);
@@ -4218,20 +4218,62 @@ int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t *size,
       return AOM_CODEC_ERROR;
     }
 
-    fh_info.obu_header_byte_offset = 0;
-    fh_info.total_length = obu_header_size + obu_payload_size + length_field;
-    data += fh_info.total_length;
+    fh_info->obu_header_byte_offset = 0;
+    fh_info->total_length = obu_header_size + obu_payload_size + length_field;
+    data += fh_info->total_length;
+  }
+
+  // Since length_field is determined adaptively after frame header
+  // encoding, saved_wb must be adjusted accordingly.
+  if (saved_wb->bit_buffer != NULL) {
+    saved_wb->bit_buffer += length_field;
+  }
+  *size = (uint32_t)(data - dst);
+  return AOM_CODEC_OK;
+}
+
+int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t *size,
+                       int *const largest_tile_id) {
+  uint8_t *data = dst;
+  uint32_t data_size;
+  AV1_COMMON *const cm = &cpi->common;
+  FrameHeaderInfo fh_info = { NULL, 0, 0 };
+  const uint8_t obu_extension_header =
+      cm->temporal_layer_id << 5 | cm->spatial_layer_id << 3 | 0;
+
+  if (cpi->stream_tile_groups) {
+    // The frame was packed as its tiles were encoded.
+    assert(dst == cpi->tg_stream.dst);
+    assert(cpi->tg_stream.next_tile == cm->tiles.rows * cm->tiles.cols);
+    av1_accumulate_pack_bs_thread_data(cpi, &cpi->td);
+    *largest_tile_id = 0;
+    *size = cpi->tg_stream.size;
+    return AOM_CODEC_OK;
+  }
+
+  // If no non-zero delta_q has been used, reset delta_q_present_flag
+  if (cm->delta_q_info.delta_q_present_flag && cpi->deltaq_used == 0) {
+    cm->delta_q_info.delta_q_present_flag = 0;
   }
 
+#if CONFIG_BITSTREAM_DEBUG
+  bitstream_queue_reset_write();
+#endif
+
+  cpi->frame_header_count = 0;
+
+  // The TD is now written outside the frame encode loop
+
+  struct aom_write_bit_buffer saved_wb = { NULL, 0 };
+  if (write_frame_header_obus(cpi, data, &saved_wb, &fh_info,
+                              obu_extension_header,
+                              &data_size) != AOM_CODEC_OK)
+    return AOM_CODEC_ERROR;
+  data += data_size;
+
   if (encode_show_existing_frame(cm)) {
     data_size = 0;
   } else {
-    // Since length_field is determined adaptively after frame header
-    // encoding, saved_wb must be adjusted accordingly.
-    if (saved_wb.bit_buffer != NULL) {
-      saved_wb.bit_buffer += length_field;
-    }
-
     //  Each tile group obu will be preceded by 4-byte size of the tile group
     //  obu
     data_size = write_tiles_in_tg_obus(
@@ -4241,3 +4283,76 @@ int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t *size,
   *size = data - dst;
   return AOM_CODEC_OK;
 }
+
+int av1_start_tile_group_stream(AV1_COMP *const cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  TileGroupStream *const tg_stream = &cpi->tg_stream;
+  struct aom_write_bit_buffer saved_wb = { NULL, 0 };
+  const uint8_t obu_extension_header =
+      cm->temporal_layer_id << 5 | cm->spatial_layer_id << 3 | 0;
+
+  assert(!cm->delta_q_info.delta_q_present_flag);
+  assert(!encode_show_existing_frame(cm));
+#if CONFIG_BITSTREAM_DEBUG
+  bitstream_queue_reset_write();
+#endif
+  cpi->frame_header_count = 0;
+  av1_reset_pack_bs_thread_data(&cpi->td);
+  tg_stream->fh_info = (FrameHeaderInfo){ NULL, 0, 0 };
+  if (write_frame_header_obus(cpi, tg_stream->dst, &saved_wb,
+                              &tg_stream->fh_info, obu_extension_header,
+                              &tg_stream->size) != AOM_CODEC_OK)
+    return AOM_CODEC_ERROR;
+  tg_stream->size_output = 0;
+  tg_stream->next_tile = 0;
+  tg_stream->is_first_tg = 1;
+
+  // With a single tile group, the frame header is in the OBU_FRAME.
+  if (cpi->num_tg > 1) {
+    av1_output_tile_group(cpi, tg_stream->dst, tg_stream->size);
+    tg_stream->size_output = tg_stream->size;
+  }
+  return AOM_CODEC_OK;
+}
+
+void av1_stream_tile_groups(AV1_COMP *const cpi, int num_tiles_encoded) {
+  AV1_COMMON *const cm = &cpi->common;
+  TileGroupStream *const tg_stream = &cpi->tg_stream;
+  const int num_tiles = cm->tiles.rows * cm->tiles.cols;
+  const int tg_size = (num_tiles + cpi->num_tg - 1) / cpi->num_tg;
+  const uint8_t obu_extension_header =
+      cm->temporal_layer_id << 5 | cm->spatial_layer_id << 3 | 0;
+
+  while (tg_stream->next_tile < num_tiles) {
+    const int end_tile = AOMMIN(tg_stream->next_tile + tg_size, num_tiles);
+    if (end_tile > num_tiles_encoded) break;
+
+    // The tiles are packed from the frame context, as in
+    // av1_finalize_encoded_frame().
+    for (int tile_idx = tg_stream->next_tile; tile_idx < end_tile; tile_idx++)
+      cpi->tile_data[tile_idx].tctx = *cm->fc;
+
+    struct aom_write_bit_buffer saved_wb = { NULL, 0 };
+    uint8_t *tile_data_start = tg_stream->dst + tg_stream->size;
+    int largest_tile_id = 0;
+    unsigned int max_tile_size = 0;
+    uint32_t obu_header_size = 0;
+    // The tile sizes are written with 4 bytes and context_update_tile_id is
+    // left at 0, since the frame header is already out.
+    write_tile_obu(cpi, tg_stream->dst, &tg_stream->size, &saved_wb,
+                   obu_extension_header, &tg_stream->fh_info, &largest_tile_id,
+                   &max_tile_size, &obu_header_size, &tile_data_start,
+                   tg_stream->next_tile, end_tile, &tg_stream->is_first_tg);
+    tg_stream->next_tile = end_tile;
+
+    av1_output_tile_group(cpi, tg_stream->dst + tg_stream->size_output,
+                          tg_stream->size - tg_stream->size_output);
+    tg_stream->size_output = tg_stream->size;
+  }
+}
+
+void av1_output_tile_group(const AV1_COMP *const cpi, const uint8_t *data,
+                           size_t size) {
+  const aom_tile_group_cb_t *const cb = &cpi->ppi->tile_group_cb;
+  if (cb->callback != NULL) cb->callback(cb->user_priv, data, size);
+}
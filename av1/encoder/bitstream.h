@@ -79,6 +79,17 @@ typedef struct {
   bool pack_bs_mt_exit;
 } AV1EncPackBSSync;
 
+// State of a frame whose tile groups are packed as soon as their tiles are
+// encoded.
+typedef struct {
+  uint8_t *dst;             // Start of the bitstream of the frame
+  uint32_t size;            // Number of bytes packed so far
+  uint32_t size_output;     // Number of bytes handed to the callback so far
+  int next_tile;            // Index of the first tile not packed yet
+  int is_first_tg;          // Flag to indicate no tile group is packed yet
+  FrameHeaderInfo fh_info;  // Frame header OBU, copied in error resilient mode
+} TileGroupStream;
+
 /*!\endcond */
 
 // Writes only the OBU Sequence Header payload, and returns the size of the
@@ -116,6 +127,20 @@ void av1_write_last_tile_info(
 int av1_pack_bitstream(struct AV1_COMP *const cpi, uint8_t *dst, size_t *size,
                        int *const largest_tile_id);
 
+// Writes the OBUs preceding the tile groups of a frame whose tile groups are
+// packed as soon as their tiles are encoded, at cpi->tg_stream.dst. With
+// several tile groups, the OBUs are handed to the tile group callback at once.
+int av1_start_tile_group_stream(struct AV1_COMP *const cpi);
+
+// Packs the tile groups not packed yet whose tiles are all among the first
+// num_tiles_encoded tiles of the frame, and hands each of them to the tile
+// group callback.
+void av1_stream_tile_groups(struct AV1_COMP *const cpi, int num_tiles_encoded);
+
+// Hands size bytes of the frame at data to the tile group callback.
+void av1_output_tile_group(const struct AV1_COMP *const cpi,
+                           const uint8_t *data, size_t size);
+
 void av1_write_tx_type(const AV1_COMMON *const cm, const MACROBLOCKD *xd,
                        TX_TYPE tx_type, TX_SIZE tx_size, aom_writer *w);
 
@@ -1290,6 +1290,12 @@ typedef struct macroblock {
    * search_sine_config buffer here and use it for motion search.
    */
   search_site_config search_site_cfg_buf[NUM_DISTINCT_SEARCH_METHODS];
+
+  /*! \brief Distortions computed by the full pixel searches of the block.
+   *
+   * Reset for each frame, and whenever the searched block changes.
+   */
+  FullPelSearchCache fullpel_search_cache;
   /**@}*/
 
   /*****************************************************************************
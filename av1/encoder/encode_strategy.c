@@ -719,9 +719,7 @@ static int denoise_and_encode(AV1_COMP *const cpi, uint8_t *const dest,
                               EncodeFrameInput *const frame_input,
                               const EncodeFrameParams *const frame_params,
                               EncodeFrameResults *const frame_results) {
-#if CONFIG_COLLECT_COMPONENT_TIMING
   if (cpi->oxcf.pass == 2) start_timing(cpi, denoise_and_encode_time);
-#endif
   const AV1EncoderConfig *const oxcf = &cpi->oxcf;
   AV1_COMMON *const cm = &cpi->common;
 
@@ -762,9 +760,7 @@ static int denoise_and_encode(AV1_COMP *const cpi, uint8_t *const dest,
     }
   }
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   if (cpi->oxcf.pass == 2) start_timing(cpi, apply_filtering_time);
-#endif
   // Save the pointer to the original source image.
   YV12_BUFFER_CONFIG *source_buffer = frame_input->source;
   // apply filtering to frame
@@ -839,9 +835,7 @@ static int denoise_and_encode(AV1_COMP *const cpi, uint8_t *const dest,
           "Failed to copy source metadata to the temporal filtered frame");
     }
   }
-#if CONFIG_COLLECT_COMPONENT_TIMING
   if (cpi->oxcf.pass == 2) end_timing(cpi, apply_filtering_time);
-#endif
 
   int set_mv_params = frame_params->frame_type == KEY_FRAME ||
                       update_type == ARF_UPDATE || update_type == GF_UPDATE;
@@ -912,9 +906,7 @@ static int denoise_and_encode(AV1_COMP *const cpi, uint8_t *const dest,
         false, true, cpi->oxcf.border_in_pixels, cpi->image_pyramid_levels);
     cpi->unscaled_source = source_buffer;
   }
-#if CONFIG_COLLECT_COMPONENT_TIMING
   if (cpi->oxcf.pass == 2) end_timing(cpi, denoise_and_encode_time);
-#endif
   return AOM_CODEC_OK;
 }
 #endif  // !CONFIG_REALTIME_ONLY
@@ -1323,9 +1315,7 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
   cpi->twopass_frame.this_frame = NULL;
   const int use_one_pass_rt_params = is_one_pass_rt_params(cpi);
   if (!use_one_pass_rt_params && !is_stat_generation_stage(cpi)) {
-#if CONFIG_COLLECT_COMPONENT_TIMING
     start_timing(cpi, av1_get_second_pass_params_time);
-#endif
 
     // Initialise frame_level_rate_correction_factors with value previous
     // to the parallel frames.
@@ -1344,9 +1334,7 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
     // copy mv_stats from ppi to frame_level cpi.
     cpi->mv_stats = cpi->ppi->mv_stats;
     av1_get_second_pass_params(cpi, &frame_params, *frame_flags);
-#if CONFIG_COLLECT_COMPONENT_TIMING
     end_timing(cpi, av1_get_second_pass_params_time);
-#endif
   }
 #endif
 
@@ -1428,7 +1416,10 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
 
   // Source may be changed if temporal filtered later.
   frame_input.source = &source->img;
-  if ((cpi->ppi->use_svc || cpi->rc.prev_frame_is_dropped) &&
+  // A previous frame dropped as it repeated its own previous source has the
+  // same source as the last encoded frame.
+  if ((cpi->ppi->use_svc || (cpi->rc.prev_frame_is_dropped &&
+                             !cpi->rc.prev_drop_was_static)) &&
       last_source != NULL)
     av1_svc_set_last_source(cpi, &frame_input, &last_source->img);
   else
@@ -1436,6 +1427,7 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
   frame_input.ts_duration = source->ts_end - source->ts_start;
   // Save unfiltered source. It is used in av1_get_second_pass_params().
   cpi->unfiltered_source = frame_input.source;
+  cpi->mv_hints = &source->mv_hints;
 
   *time_stamp = source->ts_start;
   *time_end = source->ts_end;
@@ -1475,9 +1467,7 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
     cm->frame_presentation_time = (uint32_t)pts64;
   }
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_get_one_pass_rt_params_time);
-#endif
 #if CONFIG_REALTIME_ONLY
   av1_get_one_pass_rt_params(cpi, &frame_params.frame_type, &frame_input,
                              *frame_flags);
@@ -1491,9 +1481,7 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
       av1_set_rtc_reference_structure_one_layer(cpi, cpi->gf_frame_index == 0);
   }
 #endif
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_get_one_pass_rt_params_time);
-#endif
 
   FRAME_UPDATE_TYPE frame_update_type =
       get_frame_update_type(gf_group, cpi->gf_frame_index);
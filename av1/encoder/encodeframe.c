@@ -64,6 +64,7 @@
 #include "av1/encoder/partition_model_weights.h"
 #endif
 #include "av1/encoder/partition_search.h"
+#include "av1/encoder/picklpf.h"
 #include "av1/encoder/rd.h"
 #include "av1/encoder/rdopt.h"
 #include "av1/encoder/reconinter_enc.h"
@@ -1100,6 +1101,52 @@ static AOM_INLINE void grade_source_content_sb(AV1_COMP *cpi,
     av1_source_content_sb(cpi, x, tile_data, mi_row, mi_col);
 }
 
+// Records the statistics of the superblock at mi_row, mi_col once encoded.
+static AOM_INLINE void update_sb_stats(const AV1_COMP *cpi, int mi_row,
+                                       int mi_col, int64_t encode_us) {
+  const AV1_COMMON *const cm = &cpi->common;
+  const CommonModeInfoParams *const mi_params = &cm->mi_params;
+  const int mib_size = cm->seq_params->mib_size;
+  const int mib_size_log2 = cm->seq_params->mib_size_log2;
+  aom_sb_stats_t *const stats =
+      &cpi->sb_stats[(mi_row >> mib_size_log2) * cpi->sb_stats_cols +
+                     (mi_col >> mib_size_log2)];
+  stats->encode_us += (uint32_t)encode_us;
+
+  // Each square split halves the largest dimension of the blocks below it.
+  const int mi_row_end = AOMMIN(mi_row + mib_size, mi_params->mi_rows);
+  const int mi_col_end = AOMMIN(mi_col + mib_size, mi_params->mi_cols);
+  int depth = 0;
+  for (int r = mi_row; r < mi_row_end; ++r) {
+    for (int c = mi_col; c < mi_col_end; ++c) {
+      const BLOCK_SIZE bsize =
+          mi_params->mi_grid_base[r * mi_params->mi_stride + c]->bsize;
+      const int size_log2 =
+          AOMMAX(mi_size_wide_log2[bsize], mi_size_high_log2[bsize]);
+      depth = AOMMAX(depth, mib_size_log2 - size_log2);
+    }
+  }
+  stats->partition_depth = (uint8_t)depth;
+
+  const YV12_BUFFER_CONFIG *const src = cpi->source;
+  const YV12_BUFFER_CONFIG *const recon = &cm->cur_frame->buf;
+  const int x = mi_col * MI_SIZE;
+  const int y = mi_row * MI_SIZE;
+  const int width = AOMMIN(mib_size * MI_SIZE, src->y_crop_width - x);
+  const int height = AOMMIN(mib_size * MI_SIZE, src->y_crop_height - y);
+  const uint8_t *const src_buf = src->y_buffer + y * src->y_stride + x;
+  const uint8_t *const recon_buf = recon->y_buffer + y * recon->y_stride + x;
+#if CONFIG_AV1_HIGHBITDEPTH
+  if (cm->seq_params->use_highbitdepth) {
+    stats->sse = aom_highbd_sse(src_buf, src->y_stride, recon_buf,
+                                recon->y_stride, width, height);
+    return;
+  }
+#endif
+  stats->sse =
+      aom_sse(src_buf, src->y_stride, recon_buf, recon->y_stride, width, height);
+}
+
 /*!\brief Encode a superblock row by breaking it into superblocks
  *
  * \ingroup partition_search
@@ -1227,6 +1274,9 @@ static AOM_INLINE void encode_sb_row(AV1_COMP *cpi, ThreadData *td,
     // fast mode search strategy for coding blocks
     grade_source_content_sb(cpi, x, tile_data, mi_row, mi_col);
 
+    struct aom_usec_timer sb_timer;
+    if (cpi->sb_stats != NULL) aom_usec_timer_start(&sb_timer);
+
     // encode the superblock
     if (use_nonrd_mode) {
       encode_nonrd_sb(cpi, td, tile_data, tp, mi_row, mi_col, seg_skip);
@@ -1234,6 +1284,11 @@ static AOM_INLINE void encode_sb_row(AV1_COMP *cpi, ThreadData *td,
       encode_rd_sb(cpi, td, tile_data, tp, mi_row, mi_col, seg_skip);
     }
 
+    if (cpi->sb_stats != NULL) {
+      aom_usec_timer_mark(&sb_timer);
+      update_sb_stats(cpi, mi_row, mi_col, aom_usec_timer_elapsed(&sb_timer));
+    }
+
     // Update the top-right context in row_mt coding
     if (update_cdf && (tile_info->mi_row_end > (mi_row + mib_size))) {
       if (sb_cols_in_tile == 1)
@@ -1480,6 +1535,8 @@ static AOM_INLINE void encode_tiles(AV1_COMP *cpi) {
       cpi->palette_pixel_num += cpi->td.mb.palette_pixels;
       cpi->intrabc_used |= cpi->td.intrabc_used;
       cpi->deltaq_used |= cpi->td.deltaq_used;
+      if (cpi->stream_tile_groups)
+        av1_stream_tile_groups(cpi, tile_row * tile_cols + tile_col + 1);
     }
   }
 
@@ -1712,17 +1769,62 @@ static void populate_thresh_to_force_zeromv_skip(AV1_COMP *cpi) {
   }
 }
 
-static void free_block_hash_buffers(uint32_t *block_hash_values[2][2],
-                                    int8_t *is_block_same[2][3]) {
-  for (int k = 0; k < 2; ++k) {
-    for (int j = 0; j < 2; ++j) {
-      aom_free(block_hash_values[k][j]);
-    }
+// Returns the transform mode of the frame, which only depends on the speed
+// features.
+static TX_MODE get_frame_tx_mode(const AV1_COMP *cpi) {
+  const MODE_EVAL_TYPE eval_type =
+      cpi->sf.winner_mode_sf.enable_winner_mode_for_tx_size_srch
+          ? WINNER_MODE_EVAL
+          : DEFAULT_EVAL;
+  const TX_SIZE_SEARCH_METHOD tx_search_type =
+      cpi->winner_mode_params.tx_size_search_methods[eval_type];
+  assert(cpi->oxcf.txfm_cfg.enable_tx64 || tx_search_type != USE_LARGESTALL);
+  return select_tx_mode(&cpi->common, tx_search_type);
+}
 
-    for (int j = 0; j < 3; ++j) {
-      aom_free(is_block_same[k][j]);
-    }
-  }
+// Returns whether the frame header can be written before the tiles are
+// encoded, so that each tile group is packed and handed to the tile group
+// callback as soon as its tiles are encoded. This holds in the real-time mode
+// when the loop filter and CDEF levels come from Q and the loop restoration is
+// off. The header fields which are otherwise only settled once the tiles are
+// encoded keep the values they have before.
+static int can_stream_tile_groups(const AV1_COMP *cpi) {
+  const AV1_COMMON *const cm = &cpi->common;
+  const AV1EncoderConfig *const oxcf = &cpi->oxcf;
+  const LOOP_FILTER_SPEED_FEATURES *const lpf_sf = &cpi->sf.lpf_sf;
+  if (cpi->ppi->tile_group_cb.callback == NULL) return 0;
+  if (oxcf->mode != REALTIME || oxcf->save_as_annexb) return 0;
+  if (cpi->sf.hl_sf.recode_loop != DISALLOW_RECODE ||
+      cpi->ppi->gf_group.frame_parallel_level[cpi->gf_frame_index] > 0)
+    return 0;
+  if (is_loopfilter_used(cm) &&
+      (lpf_sf->lpf_pick < LPF_PICK_FROM_Q ||
+       oxcf->algo_cfg.loopfilter_control == LOOPFILTER_SELECTIVELY))
+    return 0;
+  if (is_cdef_used(cm) && lpf_sf->cdef_pick_method != CDEF_PICK_FROM_Q)
+    return 0;
+  return !is_restoration_used(cm) &&
+         oxcf->superres_cfg.superres_mode == AOM_SUPERRES_NONE &&
+         oxcf->tile_cfg.mtu == 0 && !cm->tiles.large_scale &&
+         !cm->features.allow_intrabc &&
+         !cm->delta_q_info.delta_q_present_flag &&
+         !cm->seq_params->film_grain_params_present;
+}
+
+// Settles the frame header fields which are otherwise set once the tiles are
+// encoded, and writes the OBUs preceding the tile groups.
+static void start_tile_group_stream(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  // The segment ids are coded without temporal prediction.
+  cm->seg.temporal_update = 0;
+  cm->features.tx_mode = get_frame_tx_mode(cpi);
+  set_postproc_filter_default_params(cm);
+  if (is_loopfilter_used(cm))
+    av1_pick_filter_level(cpi->source, cpi, cpi->sf.lpf_sf.lpf_pick);
+  if (is_cdef_used(cm)) av1_cdef_search(cpi);
+  if (av1_start_tile_group_stream(cpi) != AOM_CODEC_OK)
+    aom_internal_error(cm->error, AOM_CODEC_ERROR,
+                       "Error writing the frame header");
 }
 
 /*!\brief Encoder setup(only for the current frame), encoding, and recontruction
@@ -1787,73 +1889,17 @@ static AOM_INLINE void encode_frame_internal(AV1_COMP *cpi) {
       features->allow_warped_motion = 0;
   }
 
-  int hash_table_created = 0;
   if (!is_stat_generation_stage(cpi) && av1_use_hash_me(cpi) &&
       !cpi->sf.rt_sf.use_nonrd_pick_mode) {
-    // TODO(any): move this outside of the recoding loop to avoid recalculating
-    // the hash table.
-    // add to hash table
-    const int pic_width = cpi->source->y_crop_width;
-    const int pic_height = cpi->source->y_crop_height;
-    uint32_t *block_hash_values[2][2] = { { NULL } };
-    int8_t *is_block_same[2][3] = { { NULL } };
-    int k, j;
-    bool error = false;
-
-    for (k = 0; k < 2 && !error; ++k) {
-      for (j = 0; j < 2; ++j) {
-        block_hash_values[k][j] = (uint32_t *)aom_malloc(
-            sizeof(*block_hash_values[0][0]) * pic_width * pic_height);
-        if (!block_hash_values[k][j]) {
-          error = true;
-          break;
-        }
-      }
-
-      for (j = 0; j < 3 && !error; ++j) {
-        is_block_same[k][j] = (int8_t *)aom_malloc(
-            sizeof(*is_block_same[0][0]) * pic_width * pic_height);
-        if (!is_block_same[k][j]) error = true;
-      }
-    }
-
-    av1_hash_table_init(intrabc_hash_info);
-    if (error ||
-        !av1_hash_table_create(&intrabc_hash_info->intrabc_hash_table)) {
-      free_block_hash_buffers(block_hash_values, is_block_same);
-      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
-                         "Error allocating intrabc_hash_table and buffers");
-    }
-    hash_table_created = 1;
-    av1_generate_block_2x2_hash_value(intrabc_hash_info, cpi->source,
-                                      block_hash_values[0], is_block_same[0]);
-    // Hash data generated for screen contents is used for intraBC ME
+    // Hash data generated for screen contents is used for intraBC ME. Only
+    // the superblocks changed since the previous update are hashed again,
+    // which also makes the update cheap within the recoding loop.
     const int min_alloc_size = block_size_wide[mi_params->mi_alloc_bsize];
-    const int max_sb_size =
-        (1 << (cm->seq_params->mib_size_log2 + MI_SIZE_LOG2));
-    int src_idx = 0;
-    for (int size = 4; size <= max_sb_size; size *= 2, src_idx = !src_idx) {
-      const int dst_idx = !src_idx;
-      av1_generate_block_hash_value(
-          intrabc_hash_info, cpi->source, size, block_hash_values[src_idx],
-          block_hash_values[dst_idx], is_block_same[src_idx],
-          is_block_same[dst_idx]);
-      if (size >= min_alloc_size) {
-        if (!av1_add_to_hash_map_by_row_with_precal_data(
-                &intrabc_hash_info->intrabc_hash_table,
-                block_hash_values[dst_idx], is_block_same[dst_idx][2],
-                pic_width, pic_height, size)) {
-          error = true;
-          break;
-        }
-      }
-    }
-
-    free_block_hash_buffers(block_hash_values, is_block_same);
-
-    if (error) {
+    av1_hash_table_init(intrabc_hash_info);
+    if (!av1_hash_table_update(intrabc_hash_info, cpi->source, min_alloc_size,
+                               cm->seq_params->mib_size_log2 + MI_SIZE_LOG2)) {
       aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
-                         "Error adding data to intrabc_hash_table");
+                         "Error updating intrabc_hash_table");
     }
   }
 
@@ -1960,26 +2006,23 @@ static AOM_INLINE void encode_frame_internal(AV1_COMP *cpi) {
   x->txfm_search_info.txb_split_count = 0;
 #if CONFIG_SPEED_STATS
   x->txfm_search_info.tx_search_count = 0;
+  x->fullpel_search_cache.lookups = 0;
+  x->fullpel_search_cache.hits = 0;
 #endif  // CONFIG_SPEED_STATS
+  // The source and reference frames at the cached addresses change with the
+  // frame.
+  av1_reset_fullpel_search_cache(&x->fullpel_search_cache);
 
 #if !CONFIG_REALTIME_ONLY
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_compute_global_motion_time);
-#endif
   av1_compute_global_motion_facade(cpi);
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_compute_global_motion_time);
-#endif
 #endif  // !CONFIG_REALTIME_ONLY
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_setup_motion_field_time);
-#endif
   av1_calculate_ref_frame_side(cm);
   if (features->allow_ref_frame_mvs) av1_setup_motion_field(cm);
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_setup_motion_field_time);
-#endif
 
   cm->current_frame.skip_mode_info.skip_mode_flag =
       check_skip_mode_enabled(cpi);
@@ -1993,6 +2036,9 @@ static AOM_INLINE void encode_frame_internal(AV1_COMP *cpi) {
   av1_set_sad_per_bit(cpi, &x->sadperbit, quant_params->base_qindex);
   populate_thresh_to_force_zeromv_skip(cpi);
 
+  cpi->stream_tile_groups = can_stream_tile_groups(cpi);
+  if (cpi->stream_tile_groups) start_tile_group_stream(cpi);
+
   enc_row_mt->sync_read_ptr = av1_row_mt_sync_read_dummy;
   enc_row_mt->sync_write_ptr = av1_row_mt_sync_write_dummy;
   mt_info->row_mt_enabled = 0;
@@ -2027,6 +2073,11 @@ static AOM_INLINE void encode_frame_internal(AV1_COMP *cpi) {
     }
   }
 
+  // With several threads, the tile groups are packed once all the tiles are
+  // encoded.
+  if (cpi->stream_tile_groups)
+    av1_stream_tile_groups(cpi, cm->tiles.rows * cm->tiles.cols);
+
   // If intrabc is allowed but never selected, reset the allow_intrabc flag.
   if (features->allow_intrabc && !cpi->intrabc_used) {
     features->allow_intrabc = 0;
@@ -2040,14 +2091,7 @@ static AOM_INLINE void encode_frame_internal(AV1_COMP *cpi) {
   }
 
   // Set the transform size appropriately before bitstream creation
-  const MODE_EVAL_TYPE eval_type =
-      cpi->sf.winner_mode_sf.enable_winner_mode_for_tx_size_srch
-          ? WINNER_MODE_EVAL
-          : DEFAULT_EVAL;
-  const TX_SIZE_SEARCH_METHOD tx_search_type =
-      cpi->winner_mode_params.tx_size_search_methods[eval_type];
-  assert(oxcf->txfm_cfg.enable_tx64 || tx_search_type != USE_LARGESTALL);
-  features->tx_mode = select_tx_mode(cm, tx_search_type);
+  features->tx_mode = get_frame_tx_mode(cpi);
 
   // Retain the frame level probability update conditions for parallel frames.
   // These conditions will be consumed during postencode stage to update the
@@ -2127,7 +2171,7 @@ static AOM_INLINE void encode_frame_internal(AV1_COMP *cpi) {
     }
   }
 
-  if (cm->seg.enabled) {
+  if (cm->seg.enabled && !cpi->stream_tile_groups) {
     cm->seg.temporal_update = 1;
     if (rdc->seg_tmp_pred_cost[0] < rdc->seg_tmp_pred_cost[1])
       cm->seg.temporal_update = 0;
@@ -2275,9 +2319,23 @@ static AOM_INLINE void encode_frame_internal(AV1_COMP *cpi) {
       }
     }
   }
-  if (hash_table_created) {
-    av1_hash_table_destroy(&intrabc_hash_info->intrabc_hash_table);
-  }
+}
+
+// Allocates the statistics of the superblocks of the frame, if enabled.
+static AOM_INLINE void alloc_sb_stats(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int mib_size_log2 = cm->seq_params->mib_size_log2;
+  const int rows = CEIL_POWER_OF_TWO(cm->mi_params.mi_rows, mib_size_log2);
+  const int cols = CEIL_POWER_OF_TWO(cm->mi_params.mi_cols, mib_size_log2);
+  if (cpi->sb_stats != NULL && rows == cpi->sb_stats_rows &&
+      cols == cpi->sb_stats_cols)
+    return;
+  aom_free(cpi->sb_stats);
+  cpi->sb_stats = NULL;
+  CHECK_MEM_ERROR(cm, cpi->sb_stats,
+                  aom_calloc(rows * cols, sizeof(*cpi->sb_stats)));
+  cpi->sb_stats_rows = rows;
+  cpi->sb_stats_cols = cols;
 }
 
 /*!\brief Setup reference frame buffers and encode a frame
@@ -2312,6 +2370,8 @@ void av1_encode_frame(AV1_COMP *cpi) {
     }
   }
 
+  if (cpi->ppi->collect_sb_stats) alloc_sb_stats(cpi);
+
   av1_setup_frame_buf_refs(cm);
   enforce_max_ref_frames(cpi, &cpi->ref_frame_flags,
                          cm->cur_frame->ref_display_order_hint,
@@ -2359,6 +2419,8 @@ void av1_encode_frame(AV1_COMP *cpi) {
     rdc->skip_mode_used_flag = 0;
 
     encode_frame_internal(cpi);
+    // The frame header is already written when the tile groups are streamed.
+    if (cpi->stream_tile_groups) return;
 
     if (current_frame->reference_mode == REFERENCE_MODE_SELECT) {
       // Use a flag that includes 4x4 blocks
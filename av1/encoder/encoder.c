@@ -38,6 +38,7 @@
 #if CONFIG_BITSTREAM_DEBUG
 #include "aom_util/debug_util.h"
 #endif  // CONFIG_BITSTREAM_DEBUG
+#include "aom_util/thread_trace.h"
 
 #include "av1/common/alloccommon.h"
 #include "av1/common/filter.h"
@@ -48,6 +49,7 @@
 #include "av1/common/tile_common.h"
 
 #include "av1/encoder/allintra_vis.h"
+#include "av1/encoder/analysis_file.h"
 #include "av1/encoder/aq_complexity.h"
 #include "av1/encoder/aq_cyclicrefresh.h"
 #include "av1/encoder/aq_variance.h"
@@ -1416,6 +1418,7 @@ AV1_COMP *av1_create_compressor(AV1_PRIMARY *ppi, const AV1EncoderConfig *oxcf,
   cm->current_frame.frame_number = 0;
   cpi->rc.frame_number_encoded = 0;
   cpi->rc.prev_frame_is_dropped = 0;
+  cpi->rc.prev_drop_was_static = 0;
   cpi->rc.max_consec_drop = INT_MAX;
   cpi->rc.drop_count_consec = 0;
   cm->current_frame_id = -1;
@@ -1427,6 +1430,8 @@ AV1_COMP *av1_create_compressor(AV1_PRIMARY *ppi, const AV1EncoderConfig *oxcf,
 
 #if CONFIG_SPEED_STATS
   cpi->tx_search_count = 0;
+  cpi->fullpel_search_cache_lookups = 0;
+  cpi->fullpel_search_cache_hits = 0;
 #endif  // CONFIG_SPEED_STATS
 
   cpi->time_stamps.first_ts_start = INT64_MAX;
@@ -1645,6 +1650,7 @@ void av1_remove_primary_compressor(AV1_PRIMARY *ppi) {
 
 #if !CONFIG_REALTIME_ONLY
   av1_tpl_dealloc(&tpl_data->tpl_mt_sync);
+  av1_analysis_file_close(ppi->analysis_file);
 #endif
 
   av1_terminate_workers(ppi);
@@ -1666,12 +1672,17 @@ void av1_remove_compressor(AV1_COMP *cpi) {
     rc_log_show(&cpi->rc_log);
   }
 #endif  // CONFIG_RATECTRL_LOG
+  THREAD_TRACE_WRITE();
 
   AV1_COMMON *cm = &cpi->common;
   if (cm->current_frame.frame_number > 0) {
 #if CONFIG_SPEED_STATS
     if (!is_stat_generation_stage(cpi)) {
       fprintf(stdout, "tx_search_count = %d\n", cpi->tx_search_count);
+      fprintf(stdout,
+              "fullpel_search_cache hits = %" PRIu64 " / %" PRIu64 "\n",
+              cpi->fullpel_search_cache_hits,
+              cpi->fullpel_search_cache_lookups);
     }
 #endif  // CONFIG_SPEED_STATS
 
@@ -2290,9 +2301,7 @@ static void cdef_restoration_frame(AV1_COMP *cpi, AV1_COMMON *cm,
 #endif
 
   if (use_cdef) {
-#if CONFIG_COLLECT_COMPONENT_TIMING
     start_timing(cpi, cdef_time);
-#endif
     const int num_workers = cpi->mt_info.num_mod_workers[MOD_CDEF];
     // Find CDEF parameters
     av1_cdef_search(cpi);
@@ -2312,9 +2321,7 @@ static void cdef_restoration_frame(AV1_COMP *cpi, AV1_COMMON *cm,
         av1_cdef_frame(&cm->cur_frame->buf, cm, xd, av1_cdef_init_fb_row);
       }
     }
-#if CONFIG_COLLECT_COMPONENT_TIMING
     end_timing(cpi, cdef_time);
-#endif
   }
 
   const int use_superres = av1_superres_scaled(cm);
@@ -2325,9 +2332,7 @@ static void cdef_restoration_frame(AV1_COMP *cpi, AV1_COMMON *cm,
   }
 
 #if !CONFIG_REALTIME_ONLY
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, loop_restoration_time);
-#endif
   if (use_restoration) {
     MultiThreadInfo *const mt_info = &cpi->mt_info;
     const int num_workers = mt_info->num_mod_workers[MOD_LR];
@@ -2350,9 +2355,7 @@ static void cdef_restoration_frame(AV1_COMP *cpi, AV1_COMMON *cm,
       }
     }
   }
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, loop_restoration_time);
-#endif
 #endif  // !CONFIG_REALTIME_ONLY
 }
 
@@ -2395,9 +2398,7 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
       derive_skip_apply_postproc_filters(cpi, use_loopfilter, use_cdef,
                                          use_superres, use_restoration);
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, loop_filter_time);
-#endif
   if (use_loopfilter) {
     av1_pick_filter_level(cpi->source, cpi, cpi->sf.lpf_sf.lpf_pick);
     struct loopfilter *lf = &cm->lf;
@@ -2419,9 +2420,7 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
     }
   }
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, loop_filter_time);
-#endif
 
   cdef_restoration_frame(cpi, cm, xd, use_restoration, use_cdef,
                          skip_apply_postproc_filters);
@@ -2682,9 +2681,7 @@ static int encode_without_recode(AV1_COMP *cpi) {
     aom_yv12_copy_v(cpi->source, &cpi->orig_source);
   }
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_encode_frame_time);
-#endif
 
   // Set the motion vector precision based on mv stats from the last coded
   // frame.
@@ -2701,12 +2698,10 @@ static int encode_without_recode(AV1_COMP *cpi) {
   if (!frame_is_intra_only(cm) && cpi->oxcf.rc_cfg.mode == AOM_CBR &&
       cpi->oxcf.mode == REALTIME && svc->number_spatial_layers == 1 &&
       svc->number_temporal_layers == 1 && !cpi->rc.rtc_external_ratectrl &&
-      sf->rt_sf.gf_refresh_based_on_qp)
+      sf->rt_sf.gf_refresh_based_on_qp && !cpi->stream_tile_groups)
     av1_adjust_gf_refresh_qp_one_pass_rt(cpi);
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_encode_frame_time);
-#endif
 #if CONFIG_INTERNAL_STATS
   ++cpi->frame_recode_hits;
 #endif
@@ -2956,9 +2951,7 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
     segfeatures_copy(&cm->cur_frame->seg, &cm->seg);
     cm->cur_frame->seg.enabled = cm->seg.enabled;
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
     start_timing(cpi, av1_encode_frame_time);
-#endif
     // Set the motion vector precision based on mv stats from the last coded
     // frame.
     if (!frame_is_intra_only(cm)) {
@@ -2989,9 +2982,7 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
       av1_collect_mv_stats(cpi, q);
     }
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
     end_timing(cpi, av1_encode_frame_time);
-#endif
 
 #if CONFIG_BITRATE_ACCURACY || CONFIG_RD_COMMAND
     const int do_dummy_pack = 1;
@@ -3141,9 +3132,7 @@ static int encode_with_recode_loop_and_filter(AV1_COMP *cpi, size_t *size,
                                               uint8_t *dest, int64_t *sse,
                                               int64_t *rate,
                                               int *largest_tile_id) {
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, encode_with_or_without_recode_time);
-#endif
   for (int i = 0; i < NUM_RECODES_PER_FRAME; i++) {
     cpi->do_update_frame_probs_txtype[i] = 0;
     cpi->do_update_frame_probs_obmc[i] = 0;
@@ -3152,6 +3141,10 @@ static int encode_with_recode_loop_and_filter(AV1_COMP *cpi, size_t *size,
   }
 
   cpi->do_update_vbr_bits_off_target_fast = 0;
+  if (cpi->sb_stats != NULL) {
+    memset(cpi->sb_stats, 0,
+           cpi->sb_stats_rows * cpi->sb_stats_cols * sizeof(*cpi->sb_stats));
+  }
   int err;
 #if CONFIG_REALTIME_ONLY
   err = encode_without_recode(cpi);
@@ -3161,9 +3154,7 @@ static int encode_with_recode_loop_and_filter(AV1_COMP *cpi, size_t *size,
   else
     err = encode_with_recode_loop(cpi, size, dest);
 #endif
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, encode_with_or_without_recode_time);
-#endif
   if (err != AOM_CODEC_OK) {
     if (err == -1) {
       // special case as described in encode_with_recode_loop().
@@ -3234,15 +3225,11 @@ static int encode_with_recode_loop_and_filter(AV1_COMP *cpi, size_t *size,
 
   av1_finalize_encoded_frame(cpi);
   // Build the bitstream
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_pack_bitstream_final_time);
-#endif
   cpi->rc.coefficient_size = 0;
   if (av1_pack_bitstream(cpi, dest, size, largest_tile_id) != AOM_CODEC_OK)
     return AOM_CODEC_ERROR;
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_pack_bitstream_final_time);
-#endif
 
   // Compute sse and rate.
   if (sse != NULL) {
@@ -3525,6 +3512,17 @@ static void calculate_frame_avg_haar_energy(AV1_COMP *cpi) {
 extern void av1_print_frame_contexts(const FRAME_CONTEXT *fc,
                                      const char *filename);
 
+// Hands a frame whose tile groups were not streamed to the tile group
+// callback in one chunk, once it is packed.
+static void output_packed_frame(const AV1_COMP *cpi, const uint8_t *dest,
+                                size_t size) {
+  if (cpi->stream_tile_groups || cpi->oxcf.save_as_annexb ||
+      cpi->common.tiles.large_scale ||
+      cpi->ppi->gf_group.frame_parallel_level[cpi->gf_frame_index] > 0)
+    return;
+  av1_output_tile_group(cpi, dest, size);
+}
+
 /*!\brief Run the final pass encoding for 1-pass/2-pass encoding mode, and pack
  * the bitstream
  *
@@ -3551,10 +3549,10 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size,
   const TileConfig *const tile_cfg = &oxcf->tile_cfg;
   assert(cpi->source != NULL);
   cpi->td.mb.e_mbd.cur_buf = cpi->source;
+  cpi->stream_tile_groups = 0;
+  cpi->tg_stream.dst = dest;
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, encode_frame_to_data_rate_time);
-#endif
 
 #if !CONFIG_REALTIME_ONLY
   calculate_frame_avg_haar_energy(cpi);
@@ -3605,6 +3603,7 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size,
     cpi->rc.coefficient_size = 0;
     if (av1_pack_bitstream(cpi, dest, size, &largest_tile_id) != AOM_CODEC_OK)
       return AOM_CODEC_ERROR;
+    output_packed_frame(cpi, dest, *size);
 
     if (seq_params->frame_id_numbers_present_flag &&
         current_frame->frame_type == KEY_FRAME) {
@@ -3834,9 +3833,11 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size,
   }
 
 #if !CONFIG_REALTIME_ONLY
-  if (cpi->oxcf.tool_cfg.enable_global_motion && !frame_is_intra_only(cm)) {
+  if (cpi->oxcf.tool_cfg.enable_global_motion && !frame_is_intra_only(cm) &&
+      cpi->source != cpi->unfiltered_source) {
     // Flush any stale global motion information, which may be left over
-    // from a previous frame
+    // from a previous frame. Lookahead buffers are flushed when the frame is
+    // pushed, and may already hold the pyramid of this frame.
     aom_invalidate_pyramid(cpi->source->y_pyramid);
     av1_invalidate_corner_list(cpi->source->corners);
   }
@@ -3857,6 +3858,7 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size,
     }
     cpi->superres_mode = orig_superres_mode;  // restore
   }
+  output_packed_frame(cpi, dest, *size);
 
   // Update reference frame ids for reference frames this frame will overwrite
   if (seq_params->frame_id_numbers_present_flag) {
@@ -3943,9 +3945,7 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size,
     update_counters_for_show_frame(cpi);
   }
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, encode_frame_to_data_rate_time);
-#endif
 
   return AOM_CODEC_OK;
 }
@@ -4050,7 +4050,7 @@ static int apply_denoise_2d(AV1_COMP *cpi, YV12_BUFFER_CONFIG *sd,
 
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time) {
+                          int64_t end_time, const MvHintMap *mv_hints) {
   AV1_COMMON *const cm = &cpi->common;
   const SequenceHeader *const seq_params = cm->seq_params;
   int res = 0;
@@ -4112,7 +4112,7 @@ int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
 
   if (av1_lookahead_push(cpi->ppi->lookahead, sd, time_stamp, end_time,
                          use_highbitdepth, cpi->image_pyramid_levels,
-                         frame_flags)) {
+                         frame_flags, mv_hints)) {
     aom_internal_error(cm->error, AOM_CODEC_ERROR,
                        "av1_lookahead_push() failed");
     res = -1;
@@ -4723,57 +4723,62 @@ int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
                        "Failed to allocate new cur_frame");
   }
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   // Accumulate 2nd pass time in 2-pass case or 1 pass time in 1-pass case.
   if (cpi->oxcf.pass == 2 || cpi->oxcf.pass == 0)
     start_timing(cpi, av1_encode_strategy_time);
-#endif
 
+  struct aom_usec_timer frame_timer;
+  aom_usec_timer_start(&frame_timer);
   const int result = av1_encode_strategy(
       cpi, &cpi_data->frame_size, cpi_data->cx_data, &cpi_data->lib_flags,
       &cpi_data->ts_frame_start, &cpi_data->ts_frame_end,
       cpi_data->timestamp_ratio, &cpi_data->pop_lookahead, cpi_data->flush);
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
-  if (cpi->oxcf.pass == 2 || cpi->oxcf.pass == 0)
-    end_timing(cpi, av1_encode_strategy_time);
+  if (result == AOM_CODEC_OK && cpi_data->frame_size > 0 &&
+      oxcf->frame_time_budget_us > 0) {
+    aom_usec_timer_mark(&frame_timer);
+    av1_update_frame_time_budget(cpi, aom_usec_timer_elapsed(&frame_timer));
+  }
 
-  // Print out timing information.
-  // Note: Use "cpi->frame_component_time[0] > 100 us" to avoid showing of
-  // show_existing_frame and lag-in-frames.
+  // Note: Use "cpi->frame_component_time[0] > 100 us" to avoid counting
+  // show_existing_frame and lag-in-frames as frames.
   if ((cpi->oxcf.pass == 2 || cpi->oxcf.pass == 0) &&
-      cpi->frame_component_time[0] > 100) {
-    int i;
-    uint64_t frame_total = 0, total = 0;
-    const GF_GROUP *const gf_group = &cpi->ppi->gf_group;
-    FRAME_UPDATE_TYPE frame_update_type =
-        get_frame_update_type(gf_group, cpi->gf_frame_index);
-
-    fprintf(stderr,
-            "\n Frame number: %d, Frame type: %s, Show Frame: %d, Frame Update "
-            "Type: %d, Q: %d\n",
-            cm->current_frame.frame_number,
-            get_frame_type_enum(cm->current_frame.frame_type), cm->show_frame,
-            frame_update_type, cm->quant_params.base_qindex);
-    for (i = 0; i < kTimingComponents; i++) {
-      cpi->component_time[i] += cpi->frame_component_time[i];
-      // Use av1_encode_strategy_time (i = 0) as the total time.
-      if (i == 0) {
-        frame_total = cpi->frame_component_time[0];
-        total = cpi->component_time[0];
+      is_component_timing_enabled(cpi)) {
+    end_timing(cpi, av1_encode_strategy_time);
+    if (cpi->frame_component_time[0] > 100) {
+      for (int i = 0; i < kTimingComponents; i++) {
+        cpi->last_frame_component_time[i] = cpi->frame_component_time[i];
+        cpi->component_time[i] += cpi->frame_component_time[i];
+        cpi->frame_component_time[i] = 0;
       }
+#if CONFIG_COLLECT_COMPONENT_TIMING
+      // Print out timing information.
+      const GF_GROUP *const gf_group = &cpi->ppi->gf_group;
+      FRAME_UPDATE_TYPE frame_update_type =
+          get_frame_update_type(gf_group, cpi->gf_frame_index);
+
       fprintf(stderr,
-              " %50s:  %15" PRId64 " us [%6.2f%%] (total: %15" PRId64
-              " us [%6.2f%%])\n",
-              get_component_name(i), cpi->frame_component_time[i],
-              (float)((float)cpi->frame_component_time[i] * 100.0 /
-                      (float)frame_total),
-              cpi->component_time[i],
-              (float)((float)cpi->component_time[i] * 100.0 / (float)total));
-      cpi->frame_component_time[i] = 0;
+              "\n Frame number: %d, Frame type: %s, Show Frame: %d, Frame "
+              "Update Type: %d, Q: %d\n",
+              cm->current_frame.frame_number,
+              get_frame_type_enum(cm->current_frame.frame_type),
+              cm->show_frame, frame_update_type, cm->quant_params.base_qindex);
+      // Use av1_encode_strategy_time (i = 0) as the total time.
+      const uint64_t frame_total = cpi->last_frame_component_time[0];
+      const uint64_t total = cpi->component_time[0];
+      for (int i = 0; i < kTimingComponents; i++) {
+        fprintf(stderr,
+                " %50s:  %15" PRId64 " us [%6.2f%%] (total: %15" PRId64
+                " us [%6.2f%%])\n",
+                get_component_name(i), cpi->last_frame_component_time[i],
+                (float)((float)cpi->last_frame_component_time[i] * 100.0 /
+                        (float)frame_total),
+                cpi->component_time[i],
+                (float)((float)cpi->component_time[i] * 100.0 / (float)total));
+      }
+#endif
     }
   }
-#endif
 
   // Reset the flag to 0 afer encoding.
   cpi->rc.use_external_qp_one_pass = 0;
@@ -4796,6 +4801,9 @@ int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
   if (!is_stat_generation_stage(cpi) && !cm->show_existing_frame) {
     cpi->tx_search_count += cpi->td.mb.txfm_search_info.tx_search_count;
     cpi->td.mb.txfm_search_info.tx_search_count = 0;
+    cpi->fullpel_search_cache_lookups +=
+        cpi->td.mb.fullpel_search_cache.lookups;
+    cpi->fullpel_search_cache_hits += cpi->td.mb.fullpel_search_cache.hits;
   }
 #endif  // CONFIG_SPEED_STATS
 
@@ -59,6 +59,7 @@
 #include "aom_dsp/ssim.h"
 #endif
 #include "aom_dsp/variance.h"
+#include "aom_ports/aom_timer.h"
 #if CONFIG_DENOISE
 #include "aom_dsp/noise_model.h"
 #endif
@@ -571,6 +572,11 @@ typedef struct {
    * Indicates the frame drop threshold.
    */
   int drop_frames_water_mark;
+  /*!
+   * Indicates if the frames repeating a static screen content source are
+   * dropped.
+   */
+  unsigned int drop_static_frames;
   /*!
    * under_shoot_pct indicates the tolerance of the VBR algorithm to
    * undershoot and is used as a trigger threshold for more aggressive
@@ -747,6 +753,8 @@ typedef struct {
   unsigned int motion_vector_unit_test;
   // Indicates if superblock multipass unit test should be enabled or not.
   unsigned int sb_multipass_unit_test;
+  // Indicates if the cache of full pixel search distortions is disabled.
+  unsigned int fullpel_search_cache_unit_test;
 } UnitTestCfg;
 
 typedef struct {
@@ -1088,6 +1096,19 @@ typedef struct AV1EncoderConfig {
 
   // A flag to control if we enable the superblock qp sweep for a given lambda
   int sb_qp_sweep;
+
+  // Memory budget in MiB for the frame-sized encoder buffers. 0 means no limit.
+  unsigned int mem_budget_mb;
+
+  // Target encode time per frame in microseconds in real-time mode, reached by
+  // adapting the speed features. 0 means no target.
+  unsigned int frame_time_budget_us;
+
+  // Analysis file read to reuse the TPL motion search of a previous encode.
+  const char *analysis_import_path;
+
+  // Analysis file written with the TPL motion search results of this encode.
+  const char *analysis_export_path;
   /*!\endcond */
 } AV1EncoderConfig;
 
@@ -1908,9 +1929,10 @@ typedef struct FramePartitionTimingStats {
 } FramePartitionTimingStats;
 #endif  // CONFIG_COLLECT_PARTITION_STATS
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
-#include "aom_ports/aom_timer.h"
-// Adjust the following to add new components.
+// Adjust the following to add new components. The components up to
+// av1_setup_motion_field_time run on the main thread of a frame, and are also
+// timed when enabled at runtime with AV1E_SET_COMPONENT_TIMING. The others are
+// only timed in builds with CONFIG_COLLECT_COMPONENT_TIMING.
 enum {
   av1_encode_strategy_time,
   av1_get_one_pass_rt_params_time,
@@ -2033,7 +2055,6 @@ static INLINE char const *get_component_name(int index) {
   }
   return "error";
 }
-#endif
 
 // The maximum number of internal ARFs except ALTREF_FRAME
 #define MAX_INTERNAL_ARFS (REF_FRAMES - BWDREF_FRAME - 1)
@@ -2437,6 +2458,10 @@ typedef struct {
    * Pointer to the entropy_ctx buffer.
    */
   uint8_t *entropy_ctx;
+  /*!
+   * Number of coefficients allocated in tcoeff.
+   */
+  int num_tcoeffs;
 } CoeffBufferPool;
 
 #if !CONFIG_REALTIME_ONLY
@@ -2779,6 +2804,12 @@ typedef struct AV1_PRIMARY {
    */
   TplParams tpl_data;
 
+  /*!
+   * Analysis file imported from or exported to, when either
+   * oxcf.analysis_import_path or oxcf.analysis_export_path is set.
+   */
+  struct AV1AnalysisFile *analysis_file;
+
   /*!
    * Motion vector stats of the previous encoded frame.
    */
@@ -2864,6 +2895,30 @@ typedef struct AV1_PRIMARY {
    * when --deltaq-mode=3.
    */
   AV1EncRowMultiThreadSync intra_row_mt_sync;
+
+  /*!
+   * Live and peak memory usage of the encoder subsystems, sampled once per
+   * call to encoder_encode().
+   */
+  aom_mem_usage_t mem_usage;
+
+  /*!
+   * Whether the main thread components are timed, set with
+   * AV1E_SET_COMPONENT_TIMING.
+   */
+  int collect_component_timing;
+
+  /*!
+   * Whether the statistics of each superblock are collected, set with
+   * AV1E_SET_SB_STATS.
+   */
+  int collect_sb_stats;
+
+  /*!
+   * Callback receiving the OBUs of each frame as they are packed, set with
+   * AV1E_SET_TILE_GROUP_CALLBACK.
+   */
+  aom_tile_group_cb_t tile_group_cb;
 } AV1_PRIMARY;
 
 /*!
@@ -2968,6 +3023,12 @@ typedef struct AV1_COMP {
    */
   YV12_BUFFER_CONFIG *unfiltered_source;
 
+  /*!
+   * Motion vector hints supplied with the source frame being encoded, see
+   * AV1E_SET_MV_HINTS.
+   */
+  const MvHintMap *mv_hints;
+
   /*!
    * Frame buffer holding the orig source frame for PSNR calculation in rtc tf
    * case.
@@ -3098,6 +3159,11 @@ typedef struct AV1_COMP {
    */
   SPEED_FEATURES sf;
 
+  /*!
+   * Speed adaptation to oxcf.frame_time_budget_us.
+   */
+  FrameTimeBudgetState time_budget;
+
   /*!
    * Parameters for motion vector search process.
    */
@@ -3144,6 +3210,13 @@ typedef struct AV1_COMP {
    * For debugging: number of transform searches we have performed.
    */
   unsigned int tx_search_count;
+
+  /*!
+   * For debugging: number of lookups in the caches of full pixel search
+   * results, and number of them that hit.
+   */
+  uint64_t fullpel_search_cache_lookups;
+  uint64_t fullpel_search_cache_hits;
 #endif  // CONFIG_SPEED_STATS
 
   /*!
@@ -3348,9 +3421,9 @@ typedef struct AV1_COMP {
   FramePartitionTimingStats partition_stats;
 #endif  // CONFIG_COLLECT_PARTITION_STATS
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   /*!
-   * component_time[] are initialized to zero while encoder starts.
+   * component_time[] are initialized to zero while encoder starts, and when
+   * the timing is enabled with AV1E_SET_COMPONENT_TIMING.
    */
   uint64_t component_time[kTimingComponents];
   /*!
@@ -3362,7 +3435,25 @@ typedef struct AV1_COMP {
    * frame_component_time[] are initialized to zero at beginning of each frame.
    */
   uint64_t frame_component_time[kTimingComponents];
-#endif
+  /*!
+   * Component times of the last encoded frame.
+   */
+  uint64_t last_frame_component_time[kTimingComponents];
+
+  /*!
+   * Statistics of each superblock of the current frame, in raster order, when
+   * enabled with AV1E_SET_SB_STATS. Each superblock is only written by the
+   * thread encoding it.
+   */
+  aom_sb_stats_t *sb_stats;
+  /*!
+   * Number of superblock rows of sb_stats.
+   */
+  int sb_stats_rows;
+  /*!
+   * Number of superblock cols of sb_stats.
+   */
+  int sb_stats_cols;
 
   /*!
    * Count the number of OBU_FRAME and OBU_FRAME_HEADER for level calculation.
@@ -3421,6 +3512,17 @@ typedef struct AV1_COMP {
    */
   int num_tg;
 
+  /*!
+   * Whether the tile groups of the current frame are packed and handed to
+   * ppi->tile_group_cb as soon as their tiles are encoded.
+   */
+  int stream_tile_groups;
+
+  /*!
+   * Packing state of the current frame when stream_tile_groups is set.
+   */
+  TileGroupStream tg_stream;
+
   /*!
    * Super-resolution mode currently being used by the encoder.
    * This may / may not be same as user-supplied mode in oxcf->superres_mode
@@ -3795,6 +3897,7 @@ int av1_init_parallel_frame_context(const AV1_COMP_DATA *const first_cpi_data,
  * \param[in,out] sd             Contain raw frame data
  * \param[in]     time_stamp     Time stamp of the frame
  * \param[in]     end_time_stamp End time stamp
+ * \param[in]     mv_hints       Motion vector hints of the frame, may be NULL
  *
  * \return Returns a value to indicate if the frame data is received
  * successfully.
@@ -3803,7 +3906,7 @@ int av1_init_parallel_frame_context(const AV1_COMP_DATA *const first_cpi_data,
  */
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time_stamp);
+                          int64_t end_time_stamp, const MvHintMap *mv_hints);
 
 /*!\brief Encode a frame
  *
@@ -4476,15 +4579,26 @@ static INLINE int av1_get_bsize_idx_for_part_stats(BLOCK_SIZE bsize) {
 }
 #endif  // CONFIG_COLLECT_PARTITION_STATS
 
+static INLINE int is_component_timing_enabled(const AV1_COMP *cpi) {
 #if CONFIG_COLLECT_COMPONENT_TIMING
+  (void)cpi;
+  return 1;
+#else
+  return cpi->ppi->collect_component_timing;
+#endif
+}
 static INLINE void start_timing(AV1_COMP *cpi, int component) {
+  if (!is_component_timing_enabled(cpi)) return;
   aom_usec_timer_start(&cpi->component_timer[component]);
 }
 static INLINE void end_timing(AV1_COMP *cpi, int component) {
+  if (!is_component_timing_enabled(cpi)) return;
   aom_usec_timer_mark(&cpi->component_timer[component]);
   cpi->frame_component_time[component] +=
       aom_usec_timer_elapsed(&cpi->component_timer[component]);
 }
+
+#if CONFIG_COLLECT_COMPONENT_TIMING
 static INLINE char const *get_frame_type_enum(int type) {
   switch (type) {
     case 0: return "KEY_FRAME";
@@ -204,6 +204,9 @@ static AOM_INLINE void dealloc_compressor_data(AV1_COMP *cpi) {
   aom_free(cpi->tpl_rdmult_scaling_factors);
   cpi->tpl_rdmult_scaling_factors = NULL;
 
+  aom_free(cpi->sb_stats);
+  cpi->sb_stats = NULL;
+
 #if CONFIG_TUNE_VMAF
   aom_free(cpi->vmaf_info.rdmult_scaling_factors);
   cpi->vmaf_info.rdmult_scaling_factors = NULL;
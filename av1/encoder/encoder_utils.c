@@ -1191,6 +1191,9 @@ void av1_finalize_encoded_frame(AV1_COMP *const cpi) {
       cm->film_grain_params.random_seed = 7391;
   }
 
+  // The tiles of a frame whose tile groups are streamed are already packed.
+  if (cpi->stream_tile_groups) return;
+
   // Initialise all tiles' contexts from the global frame context
   for (int tile_col = 0; tile_col < cm->tiles.cols; tile_col++) {
     for (int tile_row = 0; tile_row < cm->tiles.rows; tile_row++) {
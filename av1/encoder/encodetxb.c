@@ -55,6 +55,7 @@ void av1_alloc_txb_buf(AV1_COMP *cpi) {
   CHECK_MEM_ERROR(cm, coeff_buf_pool->entropy_ctx,
                   aom_malloc(sizeof(*coeff_buf_pool->entropy_ctx) *
                              num_tcoeffs / txb_unit_size));
+  coeff_buf_pool->num_tcoeffs = num_tcoeffs;
 
   tran_low_t *tcoeff_ptr = coeff_buf_pool->tcoeff;
   uint16_t *eob_ptr = coeff_buf_pool->eobs;
@@ -79,6 +80,7 @@ void av1_free_txb_buf(AV1_COMP *cpi) {
   aom_free(coeff_buf_pool->tcoeff);
   aom_free(coeff_buf_pool->eobs);
   aom_free(coeff_buf_pool->entropy_ctx);
+  coeff_buf_pool->num_tcoeffs = 0;
 }
 
 static void write_golomb(aom_writer *w, int level) {
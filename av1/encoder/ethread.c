@@ -11,6 +11,8 @@
 
 #include <assert.h>
 
+#include "aom_util/thread_trace.h"
+
 #include "av1/common/warped_motion.h"
 #include "av1/common/thread_common.h"
 
@@ -118,6 +120,7 @@ void av1_row_mt_sync_read(AV1EncRowMultiThreadSync *row_mt_sync, int r, int c) {
 
   if (r) {
     pthread_mutex_t *const mutex = &row_mt_sync->mutex_[r - 1];
+    THREAD_TRACE_BEGIN(enc_row_sync_wait);
     pthread_mutex_lock(mutex);
 
     while (c > row_mt_sync->num_finished_cols[r - 1] - nsync -
@@ -125,6 +128,7 @@ void av1_row_mt_sync_read(AV1EncRowMultiThreadSync *row_mt_sync, int r, int c) {
       pthread_cond_wait(&row_mt_sync->cond_[r - 1], mutex);
     }
     pthread_mutex_unlock(mutex);
+    THREAD_TRACE_END(enc_row_sync_wait);
   }
 #else
   (void)row_mt_sync;
@@ -526,6 +530,7 @@ static void launch_loop_filter_rows(AV1_COMMON *cm, EncWorkerData *thread_data,
     const int cur_sb_row = cur_job_info->mi_row >> mib_size_log2;
     const int next_sb_row = AOMMIN(sb_rows - 1, cur_sb_row + 1);
     // Wait for current and next superblock row to finish encoding.
+    THREAD_TRACE_BEGIN(enc_lpf_wait);
     pthread_mutex_lock(enc_row_mt_mutex_);
     while (!enc_row_mt->row_mt_exit &&
            (enc_row_mt->num_tile_cols_done[cur_sb_row] < cm->tiles.cols ||
@@ -534,6 +539,7 @@ static void launch_loop_filter_rows(AV1_COMMON *cm, EncWorkerData *thread_data,
     }
     row_mt_exit = enc_row_mt->row_mt_exit;
     pthread_mutex_unlock(enc_row_mt_mutex_);
+    THREAD_TRACE_END(enc_lpf_wait);
 #endif
     if (row_mt_exit) return;
 
@@ -705,7 +711,9 @@ static int enc_row_mt_worker_hook(void *arg1, void *unused) {
           &td->mb.txfm_search_info.mb_rd_record->crc_calculator);
     }
 
+    THREAD_TRACE_BEGIN(enc_sb_row);
     av1_encode_sb_row(cpi, td, tile_row, tile_col, current_mi_row);
+    THREAD_TRACE_END(enc_sb_row);
 #if CONFIG_MULTITHREAD
     pthread_mutex_lock(enc_row_mt_mutex_);
 #endif
@@ -1178,6 +1186,16 @@ int av1_check_fpmt_config(AV1_PRIMARY *const ppi,
   return 0;
 }
 
+// Returns the number of threads the worker pool of the encoder may use. When
+// the lookahead builds image pyramids on a thread of its own, that thread is
+// counted against max_threads.
+static AOM_INLINE int get_max_pool_threads(const AV1_PRIMARY *ppi,
+                                           int max_threads) {
+  if (ppi->lookahead != NULL && ppi->lookahead->async_pyramid)
+    return AOMMAX(1, max_threads - 1);
+  return max_threads;
+}
+
 // A large value for threads used to compute the max num_enc_workers
 // possible for each resolution.
 #define MAX_THREADS 100
@@ -1217,7 +1235,7 @@ int av1_compute_num_fp_contexts(AV1_PRIMARY *ppi, AV1EncoderConfig *oxcf) {
   int workers_per_frame =
       AOMMAX(1, (max_num_enc_workers + rounding_factor[index]) /
                     scaling_factor[index]);
-  int max_threads = oxcf->max_threads;
+  int max_threads = get_max_pool_threads(ppi, oxcf->max_threads);
   int num_fp_contexts = max_threads / workers_per_frame;
   // Based on empirical results, FPMT gains with multi-tile are significant when
   // more parallel frames are available. Use FPMT with multi-tile encode only
@@ -1234,7 +1252,7 @@ int av1_compute_num_fp_contexts(AV1_PRIMARY *ppi, AV1EncoderConfig *oxcf) {
                         : AOMMIN(num_fp_contexts, ppi->num_fp_contexts);
   if (num_fp_contexts > 1) {
     ppi->p_mt_info.num_mod_workers[MOD_FRAME_ENC] =
-        AOMMIN(max_num_enc_workers * num_fp_contexts, oxcf->max_threads);
+        AOMMIN(max_num_enc_workers * num_fp_contexts, max_threads);
   }
   return num_fp_contexts;
 }
@@ -1464,6 +1482,7 @@ static AOM_INLINE void sync_enc_workers(MultiThreadInfo *const mt_info,
   }
 
   // Encoding ends.
+  THREAD_TRACE_BEGIN(enc_sync_workers);
   for (int i = num_workers - 1; i > 0; i--) {
     AVxWorker *const worker = &mt_info->workers[i];
     if (!winterface->sync(worker)) {
@@ -1471,6 +1490,7 @@ static AOM_INLINE void sync_enc_workers(MultiThreadInfo *const mt_info,
       error_info = ((EncWorkerData *)worker->data1)->error_info;
     }
   }
+  THREAD_TRACE_END(enc_sync_workers);
 
   if (had_error)
     aom_internal_error(cm->error, error_info.error_code, "%s",
@@ -1517,6 +1537,10 @@ static AOM_INLINE void accumulate_counters_enc_workers(AV1_COMP *cpi,
 #if CONFIG_SPEED_STATS
       cpi->td.mb.txfm_search_info.tx_search_count +=
           thread_data->td->mb.txfm_search_info.tx_search_count;
+      cpi->td.mb.fullpel_search_cache.lookups +=
+          thread_data->td->mb.fullpel_search_cache.lookups;
+      cpi->td.mb.fullpel_search_cache.hits +=
+          thread_data->td->mb.fullpel_search_cache.hits;
 #endif  // CONFIG_SPEED_STATS
     }
   }
@@ -1693,7 +1717,8 @@ int av1_get_max_num_workers(const AV1_COMP *cpi) {
     max_num_workers =
         AOMMAX(cpi->ppi->p_mt_info.num_mod_workers[i], max_num_workers);
   assert(max_num_workers >= 1);
-  return AOMMIN(max_num_workers, cpi->oxcf.max_threads);
+  return AOMMIN(max_num_workers,
+                get_max_pool_threads(cpi->ppi, cpi->oxcf.max_threads));
 }
 
 // Computes the number of workers for encoding stage (row/tile multi-threading)
@@ -1790,7 +1815,8 @@ int av1_fp_compute_num_enc_workers(AV1_COMP *cpi) {
           AOMMIN((num_mb_cols_in_tile + 1) >> 1, num_mb_rows_in_tile);
     }
   }
-  return AOMMIN(cpi->oxcf.max_threads, total_num_threads_row_mt);
+  return AOMMIN(get_max_pool_threads(cpi->ppi, cpi->oxcf.max_threads),
+                total_num_threads_row_mt);
 }
 
 // Computes the maximum number of mb_rows for row multi-threading of firstpass
@@ -1842,7 +1868,9 @@ static void lpf_pipeline_mt_init(AV1_COMP *cpi, int num_workers) {
 
   if (!mt_info->pipeline_lpf_mt_with_enc) return;
 
-  set_postproc_filter_default_params(cm);
+  // The filter levels are already in the frame header when the tile groups
+  // are streamed.
+  if (!cpi->stream_tile_groups) set_postproc_filter_default_params(cm);
 
   if (!use_loopfilter) return;
 
@@ -2051,11 +2079,13 @@ void av1_tpl_row_mt_sync_read(AV1TplRowMultiThreadSync *tpl_row_mt_sync, int r,
 
   if (r) {
     pthread_mutex_t *const mutex = &tpl_row_mt_sync->mutex_[r - 1];
+    THREAD_TRACE_BEGIN(tpl_row_sync_wait);
     pthread_mutex_lock(mutex);
 
     while (c > tpl_row_mt_sync->num_finished_cols[r - 1] - nsync)
       pthread_cond_wait(&tpl_row_mt_sync->cond_[r - 1], mutex);
     pthread_mutex_unlock(mutex);
+    THREAD_TRACE_END(tpl_row_sync_wait);
   }
 #else
   (void)tpl_row_mt_sync;
@@ -2166,8 +2196,10 @@ static int tpl_worker_hook(void *arg1, void *unused) {
     xd->mb_to_top_edge = -GET_MV_SUBPEL(mi_row * MI_SIZE);
     xd->mb_to_bottom_edge =
         GET_MV_SUBPEL((mi_params->mi_rows - mi_height - mi_row) * MI_SIZE);
+    THREAD_TRACE_BEGIN(tpl_row);
     av1_mc_flow_dispenser_row(cpi, tpl_txfm_stats, tpl_tmp_buffers, x, mi_row,
                               bsize, tx_size);
+    THREAD_TRACE_END(tpl_row);
   }
   error_info->setjmp = 0;
   return 1;
@@ -2391,8 +2423,11 @@ static int tf_worker_hook(void *arg1, void *unused) {
 
   int current_mb_row = -1;
 
-  while (tf_get_next_job(tf_sync, &current_mb_row, tf_ctx->mb_rows))
+  while (tf_get_next_job(tf_sync, &current_mb_row, tf_ctx->mb_rows)) {
+    THREAD_TRACE_BEGIN(tf_row);
     av1_tf_do_filtering_row(cpi, td, current_mb_row);
+    THREAD_TRACE_END(tf_row);
+  }
 
   tf_restore_state(mbd, input_mb_mode_info, input_buffer, num_planes);
 
@@ -2570,10 +2605,12 @@ static int gm_mt_worker_hook(void *arg1, void *unused) {
     if (gm_mt_exit || ref_buf_idx == -1) break;
 
     // Compute global motion for the given ref_buf_idx.
+    THREAD_TRACE_BEGIN(gm_ref_frame);
     av1_compute_gm_for_valid_ref_frames(
         cpi, error_info, gm_info->ref_buf, ref_buf_idx,
         gm_thread_data->motion_models, gm_thread_data->segment_map,
         gm_info->segment_map_w, gm_info->segment_map_h);
+    THREAD_TRACE_END(gm_ref_frame);
 
 #if CONFIG_MULTITHREAD
     pthread_mutex_lock(gm_mt_mutex_);
@@ -3386,8 +3423,15 @@ static int compute_num_mod_workers(AV1_COMP *cpi,
 }
 // Computes the number of workers for each MT modules in the encoder
 void av1_compute_num_workers_for_mt(AV1_COMP *cpi) {
+  const int max_pool_threads =
+      get_max_pool_threads(cpi->ppi, cpi->oxcf.max_threads);
   for (int i = MOD_FP; i < NUM_MT_MODULES; i++) {
-    cpi->ppi->p_mt_info.num_mod_workers[i] =
+    int num_mod_workers =
         compute_num_mod_workers(cpi, (MULTI_THREADED_MODULES)i);
+    // Leave the thread of the pyramid worker out of the pool. Without it,
+    // max_threads may be 0 and must not clamp the module to no worker.
+    if (max_pool_threads < cpi->oxcf.max_threads)
+      num_mod_workers = AOMMIN(num_mod_workers, max_pool_threads);
+    cpi->ppi->p_mt_info.num_mod_workers[i] = num_mod_workers;
   }
 }
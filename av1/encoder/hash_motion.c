@@ -11,6 +11,7 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "config/av1_rtcd.h"
 
@@ -97,114 +98,64 @@ void av1_hash_table_init(IntraBCHashInfo *intrabc_hash_info) {
   if (!intrabc_hash_info->g_crc_initialized) {
     av1_crc_calculator_init(&intrabc_hash_info->crc_calculator1, 24, 0x5D6DCB);
     av1_crc_calculator_init(&intrabc_hash_info->crc_calculator2, 24, 0x864CFB);
+    av1_crc32c_calculator_init(&intrabc_hash_info->crc32c_calculator);
     intrabc_hash_info->g_crc_initialized = 1;
   }
-  intrabc_hash_info->intrabc_hash_table.p_lookup_table = NULL;
-}
-
-void av1_hash_table_clear_all(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table == NULL) {
-    return;
-  }
-  for (int i = 0; i < kMaxAddr; i++) {
-    if (p_hash_table->p_lookup_table[i] != NULL) {
-      aom_vector_destroy(p_hash_table->p_lookup_table[i]);
-      aom_free(p_hash_table->p_lookup_table[i]);
-      p_hash_table->p_lookup_table[i] = NULL;
-    }
-  }
 }
 
 void av1_hash_table_destroy(hash_table *p_hash_table) {
-  av1_hash_table_clear_all(p_hash_table);
-  aom_free(p_hash_table->p_lookup_table);
-  p_hash_table->p_lookup_table = NULL;
-}
-
-bool av1_hash_table_create(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table != NULL) {
-    av1_hash_table_clear_all(p_hash_table);
-    return true;
-  }
-  p_hash_table->p_lookup_table =
-      (Vector **)aom_calloc(kMaxAddr, sizeof(p_hash_table->p_lookup_table[0]));
-  if (!p_hash_table->p_lookup_table) return false;
-  return true;
-}
-
-static bool hash_table_add_to_table(hash_table *p_hash_table,
-                                    uint32_t hash_value,
-                                    block_hash *curr_block_hash) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    p_hash_table->p_lookup_table[hash_value] =
-        aom_malloc(sizeof(p_hash_table->p_lookup_table[0][0]));
-    if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-      return false;
-    }
-    if (aom_vector_setup(p_hash_table->p_lookup_table[hash_value], 10,
-                         sizeof(curr_block_hash[0])) == VECTOR_ERROR)
-      return false;
-    if (aom_vector_push_back(p_hash_table->p_lookup_table[hash_value],
-                             curr_block_hash) == VECTOR_ERROR)
-      return false;
-  } else {
-    if (aom_vector_push_back(p_hash_table->p_lookup_table[hash_value],
-                             curr_block_hash) == VECTOR_ERROR)
-      return false;
-  }
-  return true;
+  aom_free(p_hash_table->bucket_start);
+  p_hash_table->bucket_start = NULL;
+  aom_free(p_hash_table->entries);
+  p_hash_table->entries = NULL;
+  aom_free(p_hash_table->sb_checksums);
+  p_hash_table->sb_checksums = NULL;
 }
 
 int32_t av1_hash_table_count(const hash_table *p_hash_table,
                              uint32_t hash_value) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    return 0;
-  } else {
-    return (int32_t)(p_hash_table->p_lookup_table[hash_value]->size);
-  }
+  if (p_hash_table->bucket_start == NULL) return 0;
+  return (int32_t)(p_hash_table->bucket_start[hash_value + 1] -
+                   p_hash_table->bucket_start[hash_value]);
 }
 
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value) {
+const block_hash *av1_hash_get_first_block(const hash_table *p_hash_table,
+                                           uint32_t hash_value) {
   assert(av1_hash_table_count(p_hash_table, hash_value) > 0);
-  return aom_vector_begin(p_hash_table->p_lookup_table[hash_value]);
+  return &p_hash_table->entries[p_hash_table->bucket_start[hash_value]];
 }
 
-int32_t av1_has_exact_match(hash_table *p_hash_table, uint32_t hash_value1,
-                            uint32_t hash_value2) {
-  if (p_hash_table->p_lookup_table[hash_value1] == NULL) {
-    return 0;
-  }
-  Iterator iterator =
-      aom_vector_begin(p_hash_table->p_lookup_table[hash_value1]);
-  Iterator last = aom_vector_end(p_hash_table->p_lookup_table[hash_value1]);
-  for (; !aom_iterator_equals(&iterator, &last);
-       aom_iterator_increment(&iterator)) {
-    if ((*(block_hash *)aom_iterator_get(&iterator)).hash_value2 ==
-        hash_value2) {
-      return 1;
-    }
+int32_t av1_has_exact_match(const hash_table *p_hash_table,
+                            uint32_t hash_value1, uint32_t hash_value2) {
+  const int32_t count = av1_hash_table_count(p_hash_table, hash_value1);
+  if (count == 0) return 0;
+  const block_hash *block = av1_hash_get_first_block(p_hash_table, hash_value1);
+  for (int32_t i = 0; i < count; i++) {
+    if (block[i].hash_value2 == hash_value2) return 1;
   }
   return 0;
 }
 
-void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intrabc_hash_info,
-                                       const YV12_BUFFER_CONFIG *picture,
-                                       uint32_t *pic_block_hash[2],
-                                       int8_t *pic_block_same_info[3]) {
+// Computes the hash values of the 2x2 blocks at the positions
+// [x_start, x_end) x [y_start, y_end) of the picture.
+static void generate_block_2x2_hash_value(
+    IntraBCHashInfo *intrabc_hash_info, const YV12_BUFFER_CONFIG *picture,
+    int x_start, int y_start, int x_end, int y_end, uint32_t *pic_block_hash[2],
+    int8_t *pic_block_same_info[3]) {
   const int width = 2;
   const int height = 2;
-  const int x_end = picture->y_crop_width - width + 1;
-  const int y_end = picture->y_crop_height - height + 1;
+  const int pic_width = picture->y_crop_width;
+  x_end = AOMMIN(x_end, picture->y_crop_width - width + 1);
+  y_end = AOMMIN(y_end, picture->y_crop_height - height + 1);
   CRC_CALCULATOR *calc_1 = &intrabc_hash_info->crc_calculator1;
   CRC_CALCULATOR *calc_2 = &intrabc_hash_info->crc_calculator2;
 
   const int length = width * 2;
   if (picture->flags & YV12_FLAG_HIGHBITDEPTH) {
     uint16_t p[4];
-    int pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
+    for (int y_pos = y_start; y_pos < y_end; y_pos++) {
+      int pos = y_pos * pic_width + x_start;
+      for (int x_pos = x_start; x_pos < x_end; x_pos++) {
         get_pixels_in_1D_short_array_by_block_2x2(
             CONVERT_TO_SHORTPTR(picture->y_buffer) + y_pos * picture->y_stride +
                 x_pos,
@@ -218,13 +169,12 @@ void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intrabc_hash_info,
             av1_get_crc_value(calc_2, (uint8_t *)p, length * sizeof(p[0]));
         pos++;
       }
-      pos += width - 1;
     }
   } else {
     uint8_t p[4];
-    int pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
+    for (int y_pos = y_start; y_pos < y_end; y_pos++) {
+      int pos = y_pos * pic_width + x_start;
+      for (int x_pos = x_start; x_pos < x_end; x_pos++) {
         get_pixels_in_1D_char_array_by_block_2x2(
             picture->y_buffer + y_pos * picture->y_stride + x_pos,
             picture->y_stride, p);
@@ -237,24 +187,24 @@ void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intrabc_hash_info,
             av1_get_crc_value(calc_2, p, length * sizeof(p[0]));
         pos++;
       }
-      pos += width - 1;
     }
   }
 }
 
-void av1_generate_block_hash_value(IntraBCHashInfo *intrabc_hash_info,
-                                   const YV12_BUFFER_CONFIG *picture,
-                                   int block_size,
-                                   uint32_t *src_pic_block_hash[2],
-                                   uint32_t *dst_pic_block_hash[2],
-                                   int8_t *src_pic_block_same_info[3],
-                                   int8_t *dst_pic_block_same_info[3]) {
+// Computes the hash values of the blocks of size block_size at the positions
+// [x_start, x_end) x [y_start, y_end) of the picture, from the ones of the
+// blocks of half the size.
+static void generate_block_hash_value(
+    IntraBCHashInfo *intrabc_hash_info, const YV12_BUFFER_CONFIG *picture,
+    int block_size, int x_start, int y_start, int x_end, int y_end,
+    uint32_t *src_pic_block_hash[2], uint32_t *dst_pic_block_hash[2],
+    int8_t *src_pic_block_same_info[3], int8_t *dst_pic_block_same_info[3]) {
   CRC_CALCULATOR *calc_1 = &intrabc_hash_info->crc_calculator1;
   CRC_CALCULATOR *calc_2 = &intrabc_hash_info->crc_calculator2;
 
   const int pic_width = picture->y_crop_width;
-  const int x_end = picture->y_crop_width - block_size + 1;
-  const int y_end = picture->y_crop_height - block_size + 1;
+  x_end = AOMMIN(x_end, picture->y_crop_width - block_size + 1);
+  y_end = AOMMIN(y_end, picture->y_crop_height - block_size + 1);
 
   const int src_size = block_size >> 1;
   const int quad_size = block_size >> 2;
@@ -262,9 +212,9 @@ void av1_generate_block_hash_value(IntraBCHashInfo *intrabc_hash_info,
   uint32_t p[4];
   const int length = sizeof(p);
 
-  int pos = 0;
-  for (int y_pos = 0; y_pos < y_end; y_pos++) {
-    for (int x_pos = 0; x_pos < x_end; x_pos++) {
+  for (int y_pos = y_start; y_pos < y_end; y_pos++) {
+    int pos = y_pos * pic_width + x_start;
+    for (int x_pos = x_start; x_pos < x_end; x_pos++) {
       p[0] = src_pic_block_hash[0][pos];
       p[1] = src_pic_block_hash[0][pos + src_size];
       p[2] = src_pic_block_hash[0][pos + src_size * pic_width];
@@ -296,60 +246,392 @@ void av1_generate_block_hash_value(IntraBCHashInfo *intrabc_hash_info,
           src_pic_block_same_info[1][pos + src_size * pic_width + src_size];
       pos++;
     }
-    pos += block_size - 1;
   }
 
   if (block_size >= 4) {
     const int size_minus_1 = block_size - 1;
-    pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
+    for (int y_pos = y_start; y_pos < y_end; y_pos++) {
+      int pos = y_pos * pic_width + x_start;
+      for (int x_pos = x_start; x_pos < x_end; x_pos++) {
         dst_pic_block_same_info[2][pos] =
             (!dst_pic_block_same_info[0][pos] &&
              !dst_pic_block_same_info[1][pos]) ||
             (((x_pos & size_minus_1) == 0) && ((y_pos & size_minus_1) == 0));
         pos++;
       }
-      pos += block_size - 1;
     }
   }
 }
 
-bool av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
-                                                 uint32_t *pic_hash[2],
-                                                 int8_t *pic_is_same,
-                                                 int pic_width, int pic_height,
-                                                 int block_size) {
+// A block to add to the hash table, with its hash value.
+typedef struct _new_block_hash {
+  uint32_t hash_value1;
+  block_hash block;
+} new_block_hash;
+
+typedef struct {
+  new_block_hash *blocks;
+  int count;
+  int allocated;
+} new_block_list;
+
+static bool add_new_block(new_block_list *list, uint32_t hash_value1, int x,
+                          int y, uint32_t hash_value2) {
+  if (list->count == list->allocated) {
+    const int allocated = AOMMAX(2 * list->allocated, 1024);
+    new_block_hash *const blocks =
+        (new_block_hash *)aom_malloc(allocated * sizeof(*blocks));
+    if (blocks == NULL) return false;
+    if (list->count > 0) {
+      memcpy(blocks, list->blocks, list->count * sizeof(*blocks));
+    }
+    aom_free(list->blocks);
+    list->blocks = blocks;
+    list->allocated = allocated;
+  }
+  new_block_hash *const new_block = &list->blocks[list->count++];
+  new_block->hash_value1 = hash_value1;
+  new_block->block.x = x;
+  new_block->block.y = y;
+  new_block->block.hash_value2 = hash_value2;
+  return true;
+}
+
+// Returns whether the block overlaps a changed superblock. The block is not
+// larger than a superblock.
+static int is_block_changed(const uint8_t *sb_changed, int sb_cols,
+                            int sb_size_log2, int x, int y, int block_size) {
+  const int col0 = x >> sb_size_log2;
+  const int col1 = (x + block_size - 1) >> sb_size_log2;
+  const uint8_t *row0 = sb_changed + (y >> sb_size_log2) * sb_cols;
+  const uint8_t *row1 =
+      sb_changed + ((y + block_size - 1) >> sb_size_log2) * sb_cols;
+  return row0[col0] | row0[col1] | row1[col0] | row1[col1];
+}
+
+// Adds the blocks of size block_size overlapping a changed superblock to the
+// list, by increasing x, then y.
+static bool add_changed_blocks(new_block_list *list, uint32_t *pic_hash[2],
+                               const int8_t *pic_is_added, int pic_width,
+                               int pic_height, int block_size,
+                               const uint8_t *sb_changed, int sb_cols,
+                               int sb_rows, int sb_size_log2) {
   const int x_end = pic_width - block_size + 1;
   const int y_end = pic_height - block_size + 1;
 
-  const int8_t *src_is_added = pic_is_same;
-  const uint32_t *src_hash[2] = { pic_hash[0], pic_hash[1] };
-
   int add_value = hash_block_size_to_index(block_size);
   assert(add_value >= 0);
   add_value <<= kSrcBits;
   const int crc_mask = (1 << kSrcBits) - 1;
 
   for (int x_pos = 0; x_pos < x_end; x_pos++) {
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      const int pos = y_pos * pic_width + x_pos;
-      // valid data
-      if (src_is_added[pos]) {
-        block_hash curr_block_hash;
-        curr_block_hash.x = x_pos;
-        curr_block_hash.y = y_pos;
-
-        const uint32_t hash_value1 = (src_hash[0][pos] & crc_mask) + add_value;
-        curr_block_hash.hash_value2 = src_hash[1][pos];
-
-        if (!hash_table_add_to_table(p_hash_table, hash_value1,
-                                     &curr_block_hash)) {
+    const int col0 = x_pos >> sb_size_log2;
+    const int col1 = (x_pos + block_size - 1) >> sb_size_log2;
+    for (int sb_row = 0; sb_row < sb_rows; sb_row++) {
+      // Blocks starting in this superblock row may extend to the next one.
+      const uint8_t *row = sb_changed + sb_row * sb_cols;
+      const int next_changed = sb_row + 1 < sb_rows &&
+                               (row[sb_cols + col0] | row[sb_cols + col1]);
+      if (!(row[col0] | row[col1]) && !next_changed) continue;
+      const int y_start = sb_row << sb_size_log2;
+      const int y_stop = AOMMIN(y_start + (1 << sb_size_log2), y_end);
+      for (int y_pos = y_start; y_pos < y_stop; y_pos++) {
+        const int pos = y_pos * pic_width + x_pos;
+        if (!pic_is_added[pos] ||
+            !is_block_changed(sb_changed, sb_cols, sb_size_log2, x_pos, y_pos,
+                              block_size))
+          continue;
+        const uint32_t hash_value1 = (pic_hash[0][pos] & crc_mask) + add_value;
+        if (!add_new_block(list, hash_value1, x_pos, y_pos, pic_hash[1][pos]))
           return false;
+      }
+    }
+  }
+  return true;
+}
+
+static int is_block_before(const block_hash *a, const block_hash *b) {
+  return a->x < b->x || (a->x == b->x && a->y < b->y);
+}
+
+// Replaces the blocks of the table overlapping a changed superblock with the
+// new ones.
+static bool merge_blocks(hash_table *p_hash_table,
+                         const new_block_list *new_blocks,
+                         const uint8_t *sb_changed, int sb_cols,
+                         int sb_size_log2) {
+  const uint32_t *old_start = p_hash_table->bucket_start;
+  const block_hash *old_entries = p_hash_table->entries;
+  uint32_t *bucket_start =
+      (uint32_t *)aom_calloc(kMaxAddr + 1, sizeof(*bucket_start));
+  uint32_t *new_end = (uint32_t *)aom_calloc(kMaxAddr, sizeof(*new_end));
+  block_hash *sorted_new = (block_hash *)aom_malloc(
+      AOMMAX(new_blocks->count, 1) * sizeof(*sorted_new));
+  if (!bucket_start || !new_end || !sorted_new) {
+    aom_free(bucket_start);
+    aom_free(new_end);
+    aom_free(sorted_new);
+    return false;
+  }
+
+  // Count the blocks of each bucket.
+  for (int i = 0; i < new_blocks->count; i++) {
+    new_end[new_blocks->blocks[i].hash_value1]++;
+  }
+  for (int i = 0; i < kMaxAddr; i++) {
+    uint32_t count = new_end[i];
+    if (old_start != NULL) {
+      const int block_size = 4 << (i >> kSrcBits);
+      for (uint32_t j = old_start[i]; j < old_start[i + 1]; j++) {
+        count += !is_block_changed(sb_changed, sb_cols, sb_size_log2,
+                                   old_entries[j].x, old_entries[j].y,
+                                   block_size);
+      }
+    }
+    bucket_start[i + 1] = bucket_start[i] + count;
+    if (i > 0) new_end[i] += new_end[i - 1];
+  }
+
+  block_hash *entries = (block_hash *)aom_malloc(
+      AOMMAX(bucket_start[kMaxAddr], 1) * sizeof(*entries));
+  if (!entries) {
+    aom_free(bucket_start);
+    aom_free(new_end);
+    aom_free(sorted_new);
+    return false;
+  }
+
+  // Sort the new blocks by bucket, keeping their order within a bucket. The
+  // blocks of bucket i then end at new_end[i].
+  for (int i = new_blocks->count - 1; i >= 0; i--) {
+    const new_block_hash *new_block = &new_blocks->blocks[i];
+    sorted_new[--new_end[new_block->hash_value1]] = new_block->block;
+  }
+
+  // Merge the unchanged blocks with the new ones.
+  for (int i = 0; i < kMaxAddr; i++) {
+    const uint32_t new_stop = i + 1 < kMaxAddr ? new_end[i + 1]
+                                               : (uint32_t)new_blocks->count;
+    uint32_t k = new_end[i];
+    uint32_t pos = bucket_start[i];
+    if (old_start != NULL) {
+      const int block_size = 4 << (i >> kSrcBits);
+      for (uint32_t j = old_start[i]; j < old_start[i + 1]; j++) {
+        const block_hash *old_block = &old_entries[j];
+        if (is_block_changed(sb_changed, sb_cols, sb_size_log2, old_block->x,
+                             old_block->y, block_size))
+          continue;
+        while (k < new_stop && is_block_before(&sorted_new[k], old_block)) {
+          entries[pos++] = sorted_new[k++];
+        }
+        entries[pos++] = *old_block;
+      }
+    }
+    while (k < new_stop) entries[pos++] = sorted_new[k++];
+    assert(pos == bucket_start[i + 1]);
+  }
+
+  aom_free(new_end);
+  aom_free(sorted_new);
+  aom_free(p_hash_table->bucket_start);
+  aom_free(p_hash_table->entries);
+  p_hash_table->bucket_start = bucket_start;
+  p_hash_table->entries = entries;
+  return true;
+}
+
+static uint32_t get_sb_checksum(IntraBCHashInfo *intrabc_hash_info,
+                                const YV12_BUFFER_CONFIG *picture, int x,
+                                int y, int sb_size) {
+  const int use_highbitdepth = (picture->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+  const int width = AOMMIN(sb_size, picture->y_crop_width - x);
+  const int height = AOMMIN(sb_size, picture->y_crop_height - y);
+  uint32_t row_checksums[MAX_SB_SIZE];
+  for (int r = 0; r < height; r++) {
+    const int offset = (y + r) * picture->y_stride + x;
+    uint8_t *row = use_highbitdepth
+                       ? (uint8_t *)(CONVERT_TO_SHORTPTR(picture->y_buffer) +
+                                     offset)
+                       : picture->y_buffer + offset;
+    row_checksums[r] =
+        av1_get_crc32c_value(&intrabc_hash_info->crc32c_calculator, row,
+                             width << use_highbitdepth);
+  }
+  return av1_get_crc32c_value(&intrabc_hash_info->crc32c_calculator,
+                              (uint8_t *)row_checksums,
+                              height * sizeof(row_checksums[0]));
+}
+
+static void free_block_hash_buffers(uint32_t *block_hash_values[2][2],
+                                    int8_t *is_block_same[2][3]) {
+  for (int k = 0; k < 2; ++k) {
+    for (int j = 0; j < 2; ++j) {
+      aom_free(block_hash_values[k][j]);
+    }
+
+    for (int j = 0; j < 3; ++j) {
+      aom_free(is_block_same[k][j]);
+    }
+  }
+}
+
+// Hashes the blocks overlapping the changed superblocks and replaces them in
+// the table.
+static bool rehash_changed_blocks(IntraBCHashInfo *intrabc_hash_info,
+                                  const YV12_BUFFER_CONFIG *picture,
+                                  int min_block_size, int sb_size_log2,
+                                  const uint8_t *sb_changed, int sb_cols,
+                                  int sb_rows) {
+  const int pic_width = picture->y_crop_width;
+  const int pic_height = picture->y_crop_height;
+  const int sb_size = 1 << sb_size_log2;
+  uint32_t *block_hash_values[2][2] = { { NULL } };
+  int8_t *is_block_same[2][3] = { { NULL } };
+  bool error = false;
+
+  for (int k = 0; k < 2 && !error; ++k) {
+    for (int j = 0; j < 2; ++j) {
+      block_hash_values[k][j] = (uint32_t *)aom_calloc(
+          pic_width * pic_height, sizeof(*block_hash_values[0][0]));
+      if (!block_hash_values[k][j]) {
+        error = true;
+        break;
+      }
+    }
+
+    for (int j = 0; j < 3 && !error; ++j) {
+      is_block_same[k][j] = (int8_t *)aom_calloc(
+          pic_width * pic_height, sizeof(*is_block_same[0][0]));
+      if (!is_block_same[k][j]) error = true;
+    }
+  }
+  uint8_t *sb_to_hash = (uint8_t *)aom_calloc(sb_rows * sb_cols, 1);
+  if (error || !sb_to_hash) {
+    free_block_hash_buffers(block_hash_values, is_block_same);
+    aom_free(sb_to_hash);
+    return false;
+  }
+
+  // A changed block starts in a changed superblock, or in the one above or to
+  // the left of it. Its hash values depend on the ones of the blocks starting
+  // within it, up to the superblock below or to the right.
+  for (int r = 0; r < sb_rows; r++) {
+    for (int c = 0; c < sb_cols; c++) {
+      if (!sb_changed[r * sb_cols + c]) continue;
+      for (int i = AOMMAX(r - 1, 0); i <= AOMMIN(r + 1, sb_rows - 1); i++) {
+        for (int j = AOMMAX(c - 1, 0); j <= AOMMIN(c + 1, sb_cols - 1); j++) {
+          sb_to_hash[i * sb_cols + j] = 1;
         }
       }
     }
   }
+
+  for (int r = 0; r < sb_rows; r++) {
+    for (int c = 0; c < sb_cols; c++) {
+      if (!sb_to_hash[r * sb_cols + c]) continue;
+      generate_block_2x2_hash_value(
+          intrabc_hash_info, picture, c * sb_size, r * sb_size,
+          (c + 1) * sb_size, (r + 1) * sb_size, block_hash_values[0],
+          is_block_same[0]);
+    }
+  }
+
+  new_block_list new_blocks = { NULL, 0, 0 };
+  int src_idx = 0;
+  for (int size = 4; size <= sb_size; size *= 2, src_idx = !src_idx) {
+    const int dst_idx = !src_idx;
+    for (int r = 0; r < sb_rows; r++) {
+      for (int c = 0; c < sb_cols; c++) {
+        if (!sb_to_hash[r * sb_cols + c]) continue;
+        generate_block_hash_value(
+            intrabc_hash_info, picture, size, c * sb_size, r * sb_size,
+            (c + 1) * sb_size, (r + 1) * sb_size, block_hash_values[src_idx],
+            block_hash_values[dst_idx], is_block_same[src_idx],
+            is_block_same[dst_idx]);
+      }
+    }
+    if (size >= min_block_size &&
+        !add_changed_blocks(&new_blocks, block_hash_values[dst_idx],
+                            is_block_same[dst_idx][2], pic_width, pic_height,
+                            size, sb_changed, sb_cols, sb_rows,
+                            sb_size_log2)) {
+      error = true;
+      break;
+    }
+  }
+
+  free_block_hash_buffers(block_hash_values, is_block_same);
+  aom_free(sb_to_hash);
+  if (!error) {
+    error = !merge_blocks(&intrabc_hash_info->intrabc_hash_table, &new_blocks,
+                          sb_changed, sb_cols, sb_size_log2);
+  }
+  aom_free(new_blocks.blocks);
+  return !error;
+}
+
+bool av1_hash_table_update(IntraBCHashInfo *intrabc_hash_info,
+                           const YV12_BUFFER_CONFIG *picture,
+                           int min_block_size, int sb_size_log2) {
+  hash_table *const p_hash_table = &intrabc_hash_info->intrabc_hash_table;
+  const int pic_width = picture->y_crop_width;
+  const int pic_height = picture->y_crop_height;
+  const int use_highbitdepth = (picture->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+  const int sb_size = 1 << sb_size_log2;
+  const int sb_cols = (pic_width + sb_size - 1) >> sb_size_log2;
+  const int sb_rows = (pic_height + sb_size - 1) >> sb_size_log2;
+  const int num_sbs = sb_rows * sb_cols;
+
+  // Start from an empty table if the blocks cannot be reused.
+  if (p_hash_table->sb_checksums == NULL || p_hash_table->width != pic_width ||
+      p_hash_table->height != pic_height ||
+      p_hash_table->use_highbitdepth != use_highbitdepth ||
+      p_hash_table->sb_size_log2 != sb_size_log2 ||
+      p_hash_table->min_block_size != min_block_size) {
+    av1_hash_table_destroy(p_hash_table);
+  }
+
+  uint32_t *sb_checksums =
+      (uint32_t *)aom_malloc(num_sbs * sizeof(*sb_checksums));
+  uint8_t *sb_changed = (uint8_t *)aom_malloc(num_sbs);
+  if (!sb_checksums || !sb_changed) {
+    aom_free(sb_checksums);
+    aom_free(sb_changed);
+    av1_hash_table_destroy(p_hash_table);
+    return false;
+  }
+
+  int num_changed = 0;
+  for (int r = 0; r < sb_rows; r++) {
+    for (int c = 0; c < sb_cols; c++) {
+      const int i = r * sb_cols + c;
+      sb_checksums[i] = get_sb_checksum(intrabc_hash_info, picture,
+                                        c * sb_size, r * sb_size, sb_size);
+      sb_changed[i] = p_hash_table->sb_checksums == NULL ||
+                      sb_checksums[i] != p_hash_table->sb_checksums[i];
+      num_changed += sb_changed[i];
+    }
+  }
+
+  bool ok = true;
+  if (num_changed > 0) {
+    ok = rehash_changed_blocks(intrabc_hash_info, picture, min_block_size,
+                               sb_size_log2, sb_changed, sb_cols, sb_rows);
+  }
+  aom_free(sb_changed);
+  if (!ok) {
+    aom_free(sb_checksums);
+    av1_hash_table_destroy(p_hash_table);
+    return false;
+  }
+
+  aom_free(p_hash_table->sb_checksums);
+  p_hash_table->sb_checksums = sb_checksums;
+  p_hash_table->width = pic_width;
+  p_hash_table->height = pic_height;
+  p_hash_table->use_highbitdepth = use_highbitdepth;
+  p_hash_table->sb_size_log2 = sb_size_log2;
+  p_hash_table->min_block_size = min_block_size;
   return true;
 }
 
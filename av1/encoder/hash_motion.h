@@ -19,7 +19,7 @@
 #include "aom/aom_integer.h"
 #include "aom_scale/yv12config.h"
 #include "av1/encoder/hash.h"
-#include "third_party/vector/vector.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -36,8 +36,23 @@ typedef struct _block_hash {
   uint32_t hash_value2;
 } block_hash;
 
+// The table keeps the blocks of all sizes of a picture, by hash value. It is
+// updated incrementally: only the blocks overlapping superblocks whose
+// checksum changed since the previous update are hashed again.
 typedef struct _hash_table {
-  Vector **p_lookup_table;
+  // The blocks with hash value i are entries[bucket_start[i]] to
+  // entries[bucket_start[i + 1] - 1], by increasing x, then y.
+  uint32_t *bucket_start;
+  block_hash *entries;
+  // Checksums of the superblocks of the picture the table was built from,
+  // NULL if the table is empty.
+  uint32_t *sb_checksums;
+  // Parameters the table was built with.
+  int width;
+  int height;
+  int use_highbitdepth;
+  int sb_size_log2;
+  int min_block_size;
 } hash_table;
 
 struct intrabc_hash_info;
@@ -52,35 +67,28 @@ typedef struct intrabc_hash_info {
 
   CRC_CALCULATOR crc_calculator1;
   CRC_CALCULATOR crc_calculator2;
+  // Used for the superblock checksums.
+  CRC32C crc32c_calculator;
   int g_crc_initialized;
 } IntraBCHashInfo;
 
 void av1_hash_table_init(IntraBCHashInfo *intra_bc_hash_info);
-void av1_hash_table_clear_all(hash_table *p_hash_table);
 void av1_hash_table_destroy(hash_table *p_hash_table);
-bool av1_hash_table_create(hash_table *p_hash_table);
 int32_t av1_hash_table_count(const hash_table *p_hash_table,
                              uint32_t hash_value);
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value);
-int32_t av1_has_exact_match(hash_table *p_hash_table, uint32_t hash_value1,
-                            uint32_t hash_value2);
-void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intra_bc_hash_info,
-                                       const YV12_BUFFER_CONFIG *picture,
-                                       uint32_t *pic_block_hash[2],
-                                       int8_t *pic_block_same_info[3]);
-void av1_generate_block_hash_value(IntraBCHashInfo *intra_bc_hash_info,
-                                   const YV12_BUFFER_CONFIG *picture,
-                                   int block_size,
-                                   uint32_t *src_pic_block_hash[2],
-                                   uint32_t *dst_pic_block_hash[2],
-                                   int8_t *src_pic_block_same_info[3],
-                                   int8_t *dst_pic_block_same_info[3]);
-bool av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
-                                                 uint32_t *pic_hash[2],
-                                                 int8_t *pic_is_same,
-                                                 int pic_width, int pic_height,
-                                                 int block_size);
+const block_hash *av1_hash_get_first_block(const hash_table *p_hash_table,
+                                           uint32_t hash_value);
+int32_t av1_has_exact_match(const hash_table *p_hash_table,
+                            uint32_t hash_value1, uint32_t hash_value2);
+
+// Updates the hash table with the blocks of the luma plane of 'picture', of
+// sizes min_block_size to the superblock size. Only the blocks overlapping the
+// superblocks that changed since the previous update are hashed again, unless
+// the frame size, bit depth or block sizes changed. The table is left empty on
+// failure. Returns false on memory allocation failure.
+bool av1_hash_table_update(IntraBCHashInfo *intrabc_hash_info,
+                           const YV12_BUFFER_CONFIG *picture,
+                           int min_block_size, int sb_size_log2);
 
 // check whether the block starts from (x_start, y_start) with the size of
 // block_size x block_size has the same color in all rows
@@ -13,6 +13,8 @@
 
 #include "config/aom_config.h"
 
+#include "aom_dsp/pyramid.h"
+#include "aom_dsp/flow_estimation/corner_detect.h"
 #include "aom_scale/yv12config.h"
 #include "av1/common/common.h"
 #include "av1/encoder/encoder.h"
@@ -30,12 +32,25 @@ static struct lookahead_entry *pop(struct lookahead_ctx *ctx, int *idx) {
   return buf;
 }
 
+#if !CONFIG_REALTIME_ONLY
+static int compute_pyramid_hook(void *arg1, void *arg2) {
+  struct lookahead_entry *const buf = (struct lookahead_entry *)arg1;
+  const struct lookahead_ctx *const ctx = (const struct lookahead_ctx *)arg2;
+  return aom_compute_pyramid(&buf->img, ctx->bit_depth, buf->img.y_pyramid);
+}
+#endif  // !CONFIG_REALTIME_ONLY
+
 void av1_lookahead_destroy(struct lookahead_ctx *ctx) {
   if (ctx) {
+    if (ctx->async_pyramid)
+      aom_get_worker_interface()->end(&ctx->pyramid_worker);
     if (ctx->buf) {
       int i;
 
-      for (i = 0; i < ctx->max_sz; i++) aom_free_frame_buffer(&ctx->buf[i].img);
+      for (i = 0; i < ctx->max_sz; i++) {
+        aom_free_frame_buffer(&ctx->buf[i].img);
+        av1_free_mv_hints(&ctx->buf[i].mv_hints);
+      }
       free(ctx->buf);
     }
     free(ctx);
@@ -46,7 +61,8 @@ struct lookahead_ctx *av1_lookahead_init(
     unsigned int width, unsigned int height, unsigned int subsampling_x,
     unsigned int subsampling_y, int use_highbitdepth, unsigned int depth,
     const int border_in_pixels, int byte_alignment, int num_lap_buffers,
-    bool is_all_intra, int num_pyramid_levels) {
+    bool is_all_intra, int num_pyramid_levels, int bit_depth,
+    int async_pyramid) {
   int lag_in_frames = AOMMAX(1, depth);
 
   // For all-intra frame encoding, previous source frames are not required.
@@ -70,6 +86,7 @@ struct lookahead_ctx *av1_lookahead_init(
     ctx->max_sz = depth;
     ctx->push_frame_count = 0;
     ctx->max_pre_frames = max_pre_frames;
+    ctx->bit_depth = bit_depth;
     ctx->read_ctxs[ENCODE_STAGE].pop_sz = ctx->max_sz - ctx->max_pre_frames;
     ctx->read_ctxs[ENCODE_STAGE].valid = 1;
     if (num_lap_buffers) {
@@ -86,6 +103,20 @@ struct lookahead_ctx *av1_lookahead_init(
         goto fail;
       }
     }
+#if !CONFIG_REALTIME_ONLY
+    if (async_pyramid && num_pyramid_levels > 0) {
+      const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+      AVxWorker *const worker = &ctx->pyramid_worker;
+      winterface->init(worker);
+      worker->thread_name = "aom pyramid";
+      worker->hook = compute_pyramid_hook;
+      worker->data2 = ctx;
+      // Without a thread, pyramids are built on first use instead.
+      ctx->async_pyramid = winterface->reset(worker);
+    }
+#else
+    (void)async_pyramid;
+#endif  // !CONFIG_REALTIME_ONLY
   }
   return ctx;
 fail:
@@ -100,7 +131,8 @@ int av1_lookahead_full(const struct lookahead_ctx *ctx) {
 
 int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       int num_pyramid_levels, aom_enc_frame_flags_t flags) {
+                       int num_pyramid_levels, aom_enc_frame_flags_t flags,
+                       const MvHintMap *mv_hints) {
   int width = src->y_crop_width;
   int height = src->y_crop_height;
   int uv_width = src->uv_crop_width;
@@ -113,6 +145,10 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
   if (ctx->read_ctxs[ENCODE_STAGE].sz + ctx->max_pre_frames > ctx->max_sz)
     return 1;
 
+  // The previous pyramid must be done before any frame buffer is written.
+  if (ctx->async_pyramid)
+    aom_get_worker_interface()->sync(&ctx->pyramid_worker);
+
   ctx->read_ctxs[ENCODE_STAGE].sz++;
   if (ctx->read_ctxs[LAP_STAGE].valid) {
     ctx->read_ctxs[LAP_STAGE].sz++;
@@ -148,17 +184,30 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
   }
   // Partial copy not implemented yet
   av1_copy_and_extend_frame(src, &buf->img);
+#if !CONFIG_REALTIME_ONLY
+  // The global motion data of the previous frame held in this buffer is
+  // stale.
+  aom_invalidate_pyramid(buf->img.y_pyramid);
+  av1_invalidate_corner_list(buf->img.corners);
+#endif  // !CONFIG_REALTIME_ONLY
 
   buf->ts_start = ts_start;
   buf->ts_end = ts_end;
   buf->display_idx = ctx->push_frame_count;
   buf->flags = flags;
+  if (av1_copy_mv_hints(&buf->mv_hints, mv_hints)) return 1;
   ++ctx->push_frame_count;
   aom_remove_metadata_from_frame_buffer(&buf->img);
   if (src->metadata &&
       aom_copy_metadata_to_frame_buffer(&buf->img, src->metadata)) {
     return 1;
   }
+#if !CONFIG_REALTIME_ONLY
+  if (ctx->async_pyramid && buf->img.y_pyramid) {
+    ctx->pyramid_worker.data1 = buf;
+    aom_get_worker_interface()->launch(&ctx->pyramid_worker);
+  }
+#endif  // !CONFIG_REALTIME_ONLY
   return 0;
 }
 
@@ -18,7 +18,9 @@
 #include <stdbool.h>
 
 #include "aom_scale/yv12config.h"
+#include "aom_util/aom_thread.h"
 #include "aom/aom_integer.h"
+#include "av1/encoder/mv_hints.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,6 +38,7 @@ struct lookahead_entry {
   int64_t ts_end;
   int display_idx;
   aom_enc_frame_flags_t flags;
+  MvHintMap mv_hints;
 };
 
 // The max of past frames we want to keep in the queue.
@@ -58,6 +61,11 @@ struct lookahead_ctx {
   int push_frame_count; /* Number of frames that have been pushed in the queue*/
   uint8_t
       max_pre_frames; /* Maximum number of past frames allowed in the queue */
+  int bit_depth;      /* Bit depth used to build the image pyramids */
+  /* Worker building the image pyramid of the last pushed frame, so that the
+   * consumers (global motion) find it ready. Only used if async_pyramid. */
+  AVxWorker pyramid_worker;
+  int async_pyramid;
 };
 /*!\endcond */
 
@@ -65,12 +73,17 @@ struct lookahead_ctx {
  *
  * The lookahead stage is a queue of frame buffers on which some analysis
  * may be done when buffers are enqueued.
+ *
+ * If async_pyramid is set and the frame buffers have image pyramids, the
+ * pyramid of each frame is built on a separate thread as soon as the frame is
+ * pushed. Otherwise pyramids are built on first use.
  */
 struct lookahead_ctx *av1_lookahead_init(
     unsigned int width, unsigned int height, unsigned int subsampling_x,
     unsigned int subsampling_y, int use_highbitdepth, unsigned int depth,
     const int border_in_pixels, int byte_alignment, int num_lap_buffers,
-    bool is_all_intra, int num_pyramid_levels);
+    bool is_all_intra, int num_pyramid_levels, int bit_depth,
+    int async_pyramid);
 
 /**\brief Destroys the lookahead stage
  */
@@ -93,10 +106,12 @@ int av1_lookahead_full(const struct lookahead_ctx *ctx);
  * \param[in] num_pyramid_levels Number of pyramid levels to allocate
                           for each frame buffer
  * \param[in] flags       Flags set on this frame
+ * \param[in] mv_hints    Motion vector hints of this frame, may be NULL
  */
 int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       int num_pyramid_levels, aom_enc_frame_flags_t flags);
+                       int num_pyramid_levels, aom_enc_frame_flags_t flags,
+                       const MvHintMap *mv_hints);
 
 /**\brief Get the next source buffer to encode
  *
@@ -108,6 +108,7 @@ void av1_make_default_fullpel_ms_params(
   ms_params->sdf = ms_params->vfp->sdf;
   ms_params->sdx4df = ms_params->vfp->sdx4df;
   ms_params->sdx3df = ms_params->vfp->sdx3df;
+  ms_params->search_cache = NULL;
 
   if (mv_sf->use_downsampled_sad == 2 && block_size_high[bsize] >= 16) {
     ms_params->sdf = ms_params->vfp->sdsf;
@@ -158,6 +159,15 @@ void av1_set_ms_to_intra_mode(FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
   mv_cost_params->mvcost[1] = dv_costs->dv_costs[1];
 }
 
+void av1_reset_fullpel_search_cache(FullPelSearchCache *cache) {
+  cache->src = NULL;
+  if (++cache->generation == 0) {
+    // Entries of a former generation 0 would look valid again.
+    memset(cache->entries, 0, sizeof(cache->entries));
+    cache->generation = 1;
+  }
+}
+
 void av1_make_default_subpel_ms_params(SUBPEL_MOTION_SEARCH_PARAMS *ms_params,
                                        const struct AV1_COMP *cpi,
                                        const MACROBLOCK *x, BLOCK_SIZE bsize,
@@ -217,6 +227,26 @@ void av1_set_mv_search_range(FullMvLimits *mv_limits, const MV *mv) {
   mv_limits->row_max = AOMMAX(mv_limits->row_min, mv_limits->row_max);
 }
 
+void av1_set_fullmv_search_window(FullMvLimits *mv_limits, FULLPEL_MV center,
+                                  int range) {
+  clamp_fullmv(&center, mv_limits);
+  mv_limits->col_min = AOMMAX(mv_limits->col_min, center.col - range);
+  mv_limits->col_max = AOMMIN(mv_limits->col_max, center.col + range);
+  mv_limits->row_min = AOMMAX(mv_limits->row_min, center.row - range);
+  mv_limits->row_max = AOMMIN(mv_limits->row_max, center.row + range);
+}
+
+int av1_get_search_range_step_param(const search_site_config *search_site_cfg,
+                                    int step_param, int search_range) {
+  // Max step_param is search_site_cfg->num_search_steps.
+  if (search_range < 1) return search_site_cfg->num_search_steps;
+  while (search_site_cfg->radius[search_site_cfg->num_search_steps -
+                                 step_param - 1] > (search_range << 1) &&
+         search_site_cfg->num_search_steps - step_param - 1 > 0)
+    step_param++;
+  return step_param;
+}
+
 int av1_init_search_range(int size) {
   int sr = 0;
   // Minimum search size no matter what the passed in value.
@@ -653,21 +683,97 @@ static INLINE int check_bounds(const FullMvLimits *mv_limits, int row, int col,
          ((col + range) <= mv_limits->col_max);
 }
 
+// Returns the cache of the distortions of the searched block, or NULL if they
+// are not cached.
+static INLINE FullPelSearchCache *get_search_cache(
+    const FULLPEL_MOTION_SEARCH_PARAMS *ms_params) {
+  FullPelSearchCache *const cache = ms_params->search_cache;
+  if (cache == NULL) return NULL;
+  const uint8_t *const src = ms_params->ms_buffers.src->buf;
+  if (cache->src != src || cache->bsize != ms_params->bsize) {
+    av1_reset_fullpel_search_cache(cache);
+    cache->src = src;
+    cache->bsize = ms_params->bsize;
+  }
+  return cache;
+}
+
+// Returns the entry of the cache for a kind of distortion of the reference
+// block at 'ref'. It holds the distortion if it was computed before, which is
+// returned in 'hit'.
+static INLINE FullPelCacheEntry *get_cache_entry(FullPelSearchCache *cache,
+                                                 const uint8_t *ref,
+                                                 FULLPEL_CACHE_KIND kind,
+                                                 int *hit) {
+  const uint64_t key = (uint64_t)(uintptr_t)ref;
+  const uint32_t hash = (uint32_t)(key ^ (key >> 32)) * 2654435761u;
+  FullPelCacheEntry *const entry =
+      &cache->entries[((hash >> (32 - FULLPEL_SEARCH_CACHE_BITS)) + kind) &
+                      (FULLPEL_SEARCH_CACHE_SIZE - 1)];
+  *hit = entry->ref == ref && entry->kind == kind &&
+         entry->generation == cache->generation;
+#if CONFIG_SPEED_STATS
+  ++cache->lookups;
+  cache->hits += *hit;
+#endif  // CONFIG_SPEED_STATS
+  return entry;
+}
+
+static INLINE void set_cache_entry(const FullPelSearchCache *cache,
+                                   FullPelCacheEntry *entry, const uint8_t *ref,
+                                   FULLPEL_CACHE_KIND kind, unsigned int dist,
+                                   unsigned int sse) {
+  entry->ref = ref;
+  entry->generation = cache->generation;
+  entry->kind = kind;
+  entry->dist = dist;
+  entry->sse = sse;
+}
+
+// Returns the kind of SAD computed by ms_params->sdf, or FULLPEL_CACHE_KINDS if
+// it is not cached.
+static INLINE FULLPEL_CACHE_KIND get_sad_kind(
+    const FULLPEL_MOTION_SEARCH_PARAMS *ms_params) {
+  if (ms_params->sdf == ms_params->vfp->sdf) return FULLPEL_CACHE_SAD;
+  if (ms_params->sdf == ms_params->vfp->sdsf) return FULLPEL_CACHE_SKIP_SAD;
+  return FULLPEL_CACHE_KINDS;
+}
+
+// Computes the variance of the block at 'ref_address', through the cache when
+// there is one.
+static INLINE unsigned int get_var(
+    const FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
+    const uint8_t *const ref_address, unsigned int *sse) {
+  const struct buf_2d *const src = ms_params->ms_buffers.src;
+  const int ref_stride = ms_params->ms_buffers.ref->stride;
+  FullPelSearchCache *const cache = get_search_cache(ms_params);
+  if (cache == NULL) {
+    return ms_params->vfp->vf(src->buf, src->stride, ref_address, ref_stride,
+                              sse);
+  }
+  int hit;
+  FullPelCacheEntry *const entry =
+      get_cache_entry(cache, ref_address, FULLPEL_CACHE_VAR, &hit);
+  if (hit) {
+    *sse = entry->sse;
+    return entry->dist;
+  }
+  const unsigned int var =
+      ms_params->vfp->vf(src->buf, src->stride, ref_address, ref_stride, sse);
+  set_cache_entry(cache, entry, ref_address, FULLPEL_CACHE_VAR, var, *sse);
+  return var;
+}
+
 static INLINE int get_mvpred_var_cost(
     const FULLPEL_MOTION_SEARCH_PARAMS *ms_params, const FULLPEL_MV *this_mv,
     FULLPEL_MV_STATS *mv_stats) {
-  const aom_variance_fn_ptr_t *vfp = ms_params->vfp;
   const MV sub_this_mv = get_mv_from_fullmv(this_mv);
-  const struct buf_2d *const src = ms_params->ms_buffers.src;
   const struct buf_2d *const ref = ms_params->ms_buffers.ref;
-  const uint8_t *src_buf = src->buf;
-  const int src_stride = src->stride;
-  const int ref_stride = ref->stride;
 
   int bestsme;
 
-  bestsme = vfp->vf(src_buf, src_stride, get_buf_from_fullmv(ref, this_mv),
-                    ref_stride, &mv_stats->sse);
+  bestsme = get_var(ms_params, get_buf_from_fullmv(ref, this_mv),
+                    &mv_stats->sse);
   mv_stats->distortion = bestsme;
 
   mv_stats->err_cost = mv_err_cost_(&sub_this_mv, &ms_params->mv_cost_params);
@@ -683,7 +789,48 @@ static INLINE int get_mvpred_sad(const FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
   const uint8_t *src_buf = src->buf;
   const int src_stride = src->stride;
 
-  return ms_params->sdf(src_buf, src_stride, ref_address, ref_stride);
+  FullPelSearchCache *const cache = get_search_cache(ms_params);
+  const FULLPEL_CACHE_KIND kind = get_sad_kind(ms_params);
+  if (cache == NULL || kind == FULLPEL_CACHE_KINDS ||
+      src != ms_params->ms_buffers.src) {
+    return ms_params->sdf(src_buf, src_stride, ref_address, ref_stride);
+  }
+  int hit;
+  FullPelCacheEntry *const entry =
+      get_cache_entry(cache, ref_address, kind, &hit);
+  if (hit) return entry->dist;
+  const unsigned int sad =
+      ms_params->sdf(src_buf, src_stride, ref_address, ref_stride);
+  set_cache_entry(cache, entry, ref_address, kind, sad, 0);
+  return sad;
+}
+
+// Computes the SADs of 4 reference blocks with ms_params->sdx4df, unless they
+// are all in the cache. The computed SADs are added to the cache.
+static INLINE void get_mvpred_sad4(
+    const FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
+    const uint8_t *const ref_addresses[4], unsigned int sads[4]) {
+  const struct buf_2d *const src = ms_params->ms_buffers.src;
+  const int ref_stride = ms_params->ms_buffers.ref->stride;
+  FullPelSearchCache *const cache = get_search_cache(ms_params);
+  const FULLPEL_CACHE_KIND kind = get_sad_kind(ms_params);
+  if (cache == NULL || kind == FULLPEL_CACHE_KINDS) {
+    ms_params->sdx4df(src->buf, src->stride, ref_addresses, ref_stride, sads);
+    return;
+  }
+  FullPelCacheEntry *entries[4];
+  int num_hits = 0;
+  for (int j = 0; j < 4; j++) {
+    int hit;
+    entries[j] = get_cache_entry(cache, ref_addresses[j], kind, &hit);
+    if (hit) sads[j] = entries[j]->dist;
+    num_hits += hit;
+  }
+  if (num_hits == 4) return;
+  ms_params->sdx4df(src->buf, src->stride, ref_addresses, ref_stride, sads);
+  for (int j = 0; j < 4; j++) {
+    set_cache_entry(cache, entries[j], ref_addresses[j], kind, sads[j], 0);
+  }
 }
 
 static INLINE int get_mvpred_compound_var_cost(
@@ -710,8 +857,8 @@ static INLINE int get_mvpred_compound_var_cost(
     bestsme = vfp->svaf(get_buf_from_fullmv(ref, this_mv), ref_stride, 0, 0,
                         src_buf, src_stride, &mv_stats->sse, second_pred);
   } else {
-    bestsme = vfp->vf(src_buf, src_stride, get_buf_from_fullmv(ref, this_mv),
-                      ref_stride, &mv_stats->sse);
+    bestsme = get_var(ms_params, get_buf_from_fullmv(ref, this_mv),
+                      &mv_stats->sse);
   }
   mv_stats->distortion = bestsme;
 
@@ -883,15 +1030,11 @@ static AOM_INLINE void calc_sad4_update_bestmv(
     const FULLPEL_MV center_mv, const uint8_t *center_address,
     unsigned int *bestsad, unsigned int *raw_bestsad, int search_step,
     int *best_site, int cand_start, int *cost_list) {
-  const struct buf_2d *const src = ms_params->ms_buffers.src;
-  const struct buf_2d *const ref = ms_params->ms_buffers.ref;
   const search_site *site = ms_params->search_sites->site[search_step];
 
   unsigned char const *block_offset[4];
   unsigned int sads_buf[4];
   unsigned int *sads;
-  const uint8_t *src_buf = src->buf;
-  const int src_stride = src->stride;
   if (cost_list) {
     sads = (unsigned int *)(cost_list + 1);
   } else {
@@ -902,7 +1045,7 @@ static AOM_INLINE void calc_sad4_update_bestmv(
     block_offset[j] = site[cand_start + j].offset + center_address;
 
   // 4-point sad calculation.
-  ms_params->sdx4df(src_buf, src_stride, block_offset, ref->stride, sads);
+  get_mvpred_sad4(ms_params, block_offset, sads);
 
   for (int j = 0; j < 4; j++) {
     const FULLPEL_MV this_mv = { center_mv.row + site[cand_start + j].mv.row,
@@ -1351,8 +1494,6 @@ static int diamond_search_sad(FULLPEL_MV start_mv, unsigned int start_mv_sad,
   const struct buf_2d *const src = ms_params->ms_buffers.src;
   const struct buf_2d *const ref = ms_params->ms_buffers.ref;
 
-  const uint8_t *src_buf = src->buf;
-  const int src_stride = src->stride;
   const int ref_stride = ref->stride;
 
   const MV_COST_PARAMS *mv_cost_params = &ms_params->mv_cost_params;
@@ -1426,8 +1567,7 @@ static int diamond_search_sad(FULLPEL_MV start_mv, unsigned int start_mv_sad,
           for (int j = 0; j < 4; j++)
             block_offset[j] = site[idx + j].offset + best_address;
 
-          ms_params->sdx4df(src_buf, src_stride, block_offset, ref_stride,
-                            sads);
+          get_mvpred_sad4(ms_params, block_offset, sads);
           for (int j = 0; j < 4; j++) {
             if (sads[j] < bestsad) {
               const FULLPEL_MV this_mv = { best_mv->row + site[idx + j].mv.row,
@@ -1600,7 +1740,7 @@ static int exhaustive_mesh_search(FULLPEL_MV start_mv,
             addrs[i] = get_buf_from_fullmv(ref, &mv);
           }
 
-          ms_params->sdx4df(src->buf, src->stride, addrs, ref_stride, sads);
+          get_mvpred_sad4(ms_params, addrs, sads);
 
           for (i = 0; i < 4; ++i) {
             if (sads[i] < best_sad) {
@@ -1966,9 +2106,10 @@ int av1_intrabc_hash_search(const AV1_COMP *cpi, const MACROBLOCKD *xd,
     return INT_MAX;
   }
 
-  Iterator iterator = av1_hash_get_first_iterator(ref_frame_hash, hash_value1);
-  for (int i = 0; i < count; i++, aom_iterator_increment(&iterator)) {
-    block_hash ref_block_hash = *(block_hash *)(aom_iterator_get(&iterator));
+  const block_hash *ref_blocks =
+      av1_hash_get_first_block(ref_frame_hash, hash_value1);
+  for (int i = 0; i < count; i++) {
+    const block_hash ref_block_hash = ref_blocks[i];
     if (hash_value2 == ref_block_hash.hash_value2) {
       // Make sure the prediction is from valid area.
       const MV dv = { GET_MV_SUBPEL(ref_block_hash.y - y_pos),
@@ -138,6 +138,10 @@ typedef struct {
   aom_sad_fn_t sdf;
   aom_sad_multi_d_fn_t sdx4df;
   aom_sad_multi_d_fn_t sdx3df;
+
+  // Cache of the distortions computed for the block, NULL if they are not to
+  // be cached. Only av1_single_motion_search() sets it.
+  FullPelSearchCache *search_cache;
 } FULLPEL_MOTION_SEARCH_PARAMS;
 
 typedef struct {
@@ -158,6 +162,9 @@ void av1_make_default_fullpel_ms_params(
 void av1_set_ms_to_intra_mode(FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
                               const IntraBCMVCosts *dv_costs);
 
+/*! Drops the distortions kept in a cache of full pixel search results. */
+void av1_reset_fullpel_search_cache(FullPelSearchCache *cache);
+
 // Sets up configs for fullpixel DIAMOND / CLAMPED_DIAMOND search method.
 void av1_init_dsmotion_compensation(search_site_config *cfg, int stride,
                                     int level);
@@ -260,6 +267,16 @@ static INLINE void av1_set_mv_limits(
 
 void av1_set_mv_search_range(FullMvLimits *mv_limits, const MV *mv);
 
+// Restricts the full pixel search to +/- range around center, after clamping
+// center to the current limits.
+void av1_set_fullmv_search_window(FullMvLimits *mv_limits, FULLPEL_MV center,
+                                  int range);
+
+// Increases step_param until the first search step is no larger than twice
+// search_range.
+int av1_get_search_range_step_param(const search_site_config *search_site_cfg,
+                                    int step_param, int search_range);
+
 int av1_init_search_range(int size);
 
 unsigned int av1_int_pro_motion_estimation(
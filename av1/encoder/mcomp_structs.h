@@ -12,6 +12,7 @@
 #ifndef AOM_AV1_ENCODER_MCOMP_STRUCTS_H_
 #define AOM_AV1_ENCODER_MCOMP_STRUCTS_H_
 
+#include "av1/common/enums.h"
 #include "av1/common/mv.h"
 
 // The maximum number of steps in a step search given the largest
@@ -88,6 +89,49 @@ enum {
   NUM_DISTINCT_SEARCH_METHODS = SQUARE + 1,
 } UENUM1BYTE(SEARCH_METHODS);
 
+// Number of entries in the cache of full pixel search results, a power of 2.
+#define FULLPEL_SEARCH_CACHE_BITS 8
+#define FULLPEL_SEARCH_CACHE_SIZE (1 << FULLPEL_SEARCH_CACHE_BITS)
+
+// Distortions kept in the cache of full pixel search results.
+enum {
+  FULLPEL_CACHE_SAD,
+  // SAD of every other row, see MV_SPEED_FEATURES::use_downsampled_sad.
+  FULLPEL_CACHE_SKIP_SAD,
+  FULLPEL_CACHE_VAR,
+  FULLPEL_CACHE_KINDS,
+} UENUM1BYTE(FULLPEL_CACHE_KIND);
+
+typedef struct {
+  // Address of the reference block, which identifies both the reference frame
+  // and the full pixel position.
+  const uint8_t *ref;
+  uint32_t generation;
+  FULLPEL_CACHE_KIND kind;
+  unsigned int dist;
+  // Only set for FULLPEL_CACHE_VAR.
+  unsigned int sse;
+} FullPelCacheEntry;
+
+// Distortions of the full pixel positions evaluated for a block. They are
+// shared by the search patterns and the searches around each reference vector
+// candidate of av1_single_motion_search(). Other searches, including the
+// compound ones, do not use the cache. The cost of the vectors is not cached,
+// as it depends on the reference vector.
+typedef struct {
+  FullPelCacheEntry entries[FULLPEL_SEARCH_CACHE_SIZE];
+  // Entries of other generations are stale.
+  uint32_t generation;
+  // Source block the entries were computed for.
+  const uint8_t *src;
+  BLOCK_SIZE bsize;
+#if CONFIG_SPEED_STATS
+  //! For debugging. Used to check how often the cache is hit.
+  unsigned int lookups;
+  unsigned int hits;
+#endif  // CONFIG_SPEED_STATS
+} FullPelSearchCache;
+
 typedef struct warp_search_config {
   int num_neighbors;
   MV neighbors[MAX_WARP_SEARCH_NEIGHBORS];
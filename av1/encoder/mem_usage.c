@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+
+#include "aom_dsp/flow_estimation/flow_estimation.h"
+#include "aom_dsp/pyramid.h"
+#include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
+#include "av1/encoder/mem_usage.h"
+
+// Accounts the frame data of 'buf' and, separately, its image pyramid.
+static void add_frame_buffer_usage(const YV12_BUFFER_CONFIG *buf,
+                                   aom_mem_category_t category,
+                                   uint64_t live_bytes[AOM_MEM_CATEGORIES]) {
+  // Externally owned frame buffers are not charged to the encoder.
+  if (buf->use_external_reference_buffers) return;
+  live_bytes[category] += buf->buffer_alloc_sz;
+#if !CONFIG_REALTIME_ONLY
+  if (buf->y_pyramid != NULL) {
+    live_bytes[AOM_MEM_PYRAMID] += buf->y_pyramid->buffer_alloc_sz;
+  }
+#endif  // !CONFIG_REALTIME_ONLY
+}
+
+static uint64_t get_thread_data_usage(const ThreadData *td) {
+  uint64_t bytes = 0;
+  if (td->counts != NULL) bytes += sizeof(*td->counts);
+  if (td->palette_buffer != NULL) bytes += sizeof(*td->palette_buffer);
+  if (td->tctx != NULL) bytes += sizeof(*td->tctx);
+  if (td->tmp_conv_dst != NULL) {
+    bytes += MAX_SB_SIZE * MAX_SB_SIZE * sizeof(*td->tmp_conv_dst);
+  }
+  for (int x = 0; x < 2; x++) {
+    for (int y = 0; y < 2; y++) {
+      if (td->hash_value_buffer[x][y] != NULL) {
+        bytes += AOM_BUFFER_SIZE_FOR_BLOCK_HASH *
+                 sizeof(*td->hash_value_buffer[x][y]);
+      }
+    }
+  }
+  for (int j = 0; j < 2; ++j) {
+    if (td->tmp_pred_bufs[j] != NULL) {
+      bytes += 2 * MAX_MB_PLANE * MAX_SB_SQUARE * sizeof(*td->tmp_pred_bufs[j]);
+    }
+  }
+  if (td->obmc_buffer.wsrc != NULL) {
+    const OBMCBuffer *obmc = &td->obmc_buffer;
+    bytes += MAX_SB_SQUARE * (sizeof(*obmc->wsrc) + sizeof(*obmc->mask)) +
+             MAX_MB_PLANE * MAX_SB_SQUARE *
+                 (sizeof(*obmc->above_pred) + sizeof(*obmc->left_pred));
+  }
+  if (td->comp_rd_buffer.pred0 != NULL) {
+    const CompoundTypeRdBuffers *bufs = &td->comp_rd_buffer;
+    bytes += 2 * MAX_SB_SQUARE *
+                 (sizeof(*bufs->pred0) + sizeof(*bufs->pred1) +
+                  sizeof(*bufs->tmp_best_mask_buf)) +
+             MAX_SB_SQUARE * (sizeof(*bufs->residual1) + sizeof(*bufs->diff10));
+  }
+  if (td->pixel_gradient_info != NULL) {
+    bytes += PLANE_TYPES * MAX_SB_SQUARE * sizeof(*td->pixel_gradient_info);
+  }
+  if (td->src_var_info_of_4x4_sub_blocks != NULL) {
+    bytes += MAX_SB_SQUARE / 16 * sizeof(*td->src_var_info_of_4x4_sub_blocks);
+  }
+  if (td->vt64x64 != NULL) bytes += 4 * sizeof(*td->vt64x64);
+  return bytes;
+}
+
+void av1_get_live_mem_usage(const AV1_PRIMARY *ppi,
+                            uint64_t live_bytes[AOM_MEM_CATEGORIES]) {
+  memset(live_bytes, 0, AOM_MEM_CATEGORIES * sizeof(*live_bytes));
+  const AV1_COMP *const cpi = ppi->cpi;
+  if (cpi == NULL) return;
+
+  // Lookahead, including the LAP stage buffers which share the same queue.
+  const struct lookahead_ctx *lookahead = ppi->lookahead;
+  if (lookahead != NULL && lookahead->buf != NULL) {
+    for (int i = 0; i < lookahead->max_sz; i++) {
+      add_frame_buffer_usage(&lookahead->buf[i].img, AOM_MEM_LOOKAHEAD,
+                             live_bytes);
+    }
+    live_bytes[AOM_MEM_LOOKAHEAD] +=
+        lookahead->max_sz * sizeof(*lookahead->buf);
+  }
+
+  // TPL stats and reconstruction buffers.
+  const TplParams *const tpl_data = &ppi->tpl_data;
+  if (tpl_data->txfm_stats_list != NULL) {
+    live_bytes[AOM_MEM_TPL] +=
+        MAX_LENGTH_TPL_FRAME_STATS * sizeof(*tpl_data->txfm_stats_list);
+  }
+  for (int frame = 0; frame < MAX_LAG_BUFFERS; ++frame) {
+    if (tpl_data->tpl_stats_pool[frame] != NULL) {
+      const TplDepFrame *tpl_frame = &tpl_data->tpl_stats_buffer[frame];
+      live_bytes[AOM_MEM_TPL] += (uint64_t)tpl_frame->width *
+                                 tpl_frame->height *
+                                 sizeof(*tpl_data->tpl_stats_pool[frame]);
+    }
+    add_frame_buffer_usage(&tpl_data->tpl_rec_pool[frame], AOM_MEM_TPL,
+                           live_bytes);
+  }
+
+  // Temporal filter output buffers.
+  const TEMPORAL_FILTER_INFO *const tf_info = &ppi->tf_info;
+  for (int i = 0; i < TF_INFO_BUF_COUNT; ++i) {
+    add_frame_buffer_usage(&tf_info->tf_buf[i], AOM_MEM_TEMPORAL_FILTER,
+                           live_bytes);
+  }
+  add_frame_buffer_usage(&tf_info->tf_buf_second_arf, AOM_MEM_TEMPORAL_FILTER,
+                         live_bytes);
+
+  // Thread data. The main thread uses each frame context's own ThreadData,
+  // the remaining workers own theirs.
+  for (int i = 0; i < ppi->num_fp_contexts; i++) {
+    const AV1_COMP *const fp_cpi = ppi->parallel_cpi[i];
+    if (fp_cpi == NULL) continue;
+    live_bytes[AOM_MEM_THREAD_DATA] += get_thread_data_usage(&fp_cpi->td);
+    // Transform coefficient buffers.
+    const CoeffBufferPool *coeff_buf_pool = &fp_cpi->coeff_buffer_pool;
+    const uint64_t num_tcoeffs = coeff_buf_pool->num_tcoeffs;
+    const uint64_t num_txb_units =
+        num_tcoeffs / (TX_SIZE_W_MIN * TX_SIZE_H_MIN);
+    live_bytes[AOM_MEM_TXB] +=
+        num_tcoeffs * sizeof(*coeff_buf_pool->tcoeff) +
+        num_txb_units * (sizeof(*coeff_buf_pool->eobs) +
+                         sizeof(*coeff_buf_pool->entropy_ctx));
+  }
+  const PrimaryMultiThreadInfo *const p_mt_info = &ppi->p_mt_info;
+  if (p_mt_info->tile_thr_data != NULL) {
+    for (int i = 1; i < p_mt_info->num_workers; i++) {
+      const ThreadData *td = p_mt_info->tile_thr_data[i].original_td;
+      if (td == NULL) continue;
+      live_bytes[AOM_MEM_THREAD_DATA] +=
+          sizeof(*td) + get_thread_data_usage(td);
+    }
+  }
+
+  // Frame buffer pool shared by reference and reconstructed frames.
+  const BufferPool *const pool = cpi->common.buffer_pool;
+  if (pool != NULL && pool->frame_bufs != NULL) {
+    for (int i = 0; i < pool->num_frame_bufs; i++) {
+      add_frame_buffer_usage(&pool->frame_bufs[i].buf,
+                             AOM_MEM_FRAME_BUFFER_POOL, live_bytes);
+    }
+  }
+}
+
+void av1_update_mem_usage(AV1_PRIMARY *ppi) {
+  aom_mem_usage_t *const usage = &ppi->mem_usage;
+  av1_get_live_mem_usage(ppi, usage->live_bytes);
+  usage->total_live_bytes = 0;
+  for (int i = 0; i < AOM_MEM_CATEGORIES; i++) {
+    usage->total_live_bytes += usage->live_bytes[i];
+    usage->peak_bytes[i] = AOMMAX(usage->peak_bytes[i], usage->live_bytes[i]);
+  }
+  usage->total_peak_bytes =
+      AOMMAX(usage->total_peak_bytes, usage->total_live_bytes);
+}
+
+static uint64_t estimate_frame_size(const AV1EncoderConfig *oxcf, int border,
+                                    int use_highbitdepth) {
+  const int aligned_width = (oxcf->frm_dim_cfg.width + 7) & ~7;
+  const int aligned_height = (oxcf->frm_dim_cfg.height + 7) & ~7;
+  const uint64_t y_size =
+      (uint64_t)(aligned_width + 2 * border) * (aligned_height + 2 * border);
+  // Profile 0 is 4:2:0 (or monochrome), profile 1 is 4:4:4 and profile 2 is
+  // assumed to be 4:2:2.
+  uint64_t uv_size;
+  switch (oxcf->profile) {
+    case PROFILE_1: uv_size = 2 * y_size; break;
+    case PROFILE_2: uv_size = y_size; break;
+    default: uv_size = y_size / 2; break;
+  }
+  return (y_size + uv_size) << use_highbitdepth;
+}
+
+uint64_t av1_estimate_frame_buffers_mem(const AV1EncoderConfig *oxcf,
+                                        int lag_in_frames,
+                                        int enable_global_motion) {
+  const int use_highbitdepth =
+      oxcf->use_highbitdepth || oxcf->tool_cfg.bit_depth > AOM_BITS_8;
+  const uint64_t src_frame_size =
+      estimate_frame_size(oxcf, AOM_BORDER_IN_PIXELS, use_highbitdepth);
+  const uint64_t enc_frame_size =
+      estimate_frame_size(oxcf, AOM_ENC_NO_SCALE_BORDER, use_highbitdepth);
+  // TPL only needs a border large enough for its motion search.
+  const uint64_t tpl_frame_size =
+      estimate_frame_size(oxcf, 32, use_highbitdepth);
+
+  const int num_src_frames = AOMMAX(1, lag_in_frames) + MAX_PRE_FRAMES;
+  const int num_tpl_frames = lag_in_frames > 1 ? lag_in_frames : 0;
+  const int num_tf_frames =
+      (lag_in_frames > 1 && oxcf->algo_cfg.arnr_max_frames > 0)
+          ? TF_INFO_BUF_COUNT + 1
+          : 0;
+  const int num_pool_frames =
+      oxcf->mode == ALLINTRA ? FRAME_BUFFERS_ALLINTRA : FRAME_BUFFERS;
+
+  uint64_t bytes = num_src_frames * src_frame_size +
+                   num_tpl_frames * tpl_frame_size +
+                   (num_tf_frames + num_pool_frames) * enc_frame_size;
+#if !CONFIG_REALTIME_ONLY
+  if (enable_global_motion) {
+    const uint64_t pyr_size = aom_get_pyramid_alloc_size(
+        oxcf->frm_dim_cfg.width, oxcf->frm_dim_cfg.height,
+        global_motion_pyr_levels[default_global_motion_method],
+        use_highbitdepth);
+    bytes += (num_src_frames + num_tf_frames + num_pool_frames) * pyr_size;
+  }
+#else
+  (void)enable_global_motion;
+#endif  // !CONFIG_REALTIME_ONLY
+  return bytes;
+}
+
+void av1_fit_config_to_mem_budget(AV1EncoderConfig *oxcf) {
+  if (oxcf->mem_budget_mb == 0) return;
+  const uint64_t budget = (uint64_t)oxcf->mem_budget_mb << 20;
+  GFConfig *const gf_cfg = &oxcf->gf_cfg;
+  ToolCfg *const tool_cfg = &oxcf->tool_cfg;
+
+  if (tool_cfg->enable_global_motion &&
+      av1_estimate_frame_buffers_mem(oxcf, gf_cfg->lag_in_frames, 1) >
+          budget) {
+    tool_cfg->enable_global_motion = 0;
+  }
+  // With lookahead processing (LAP) the number of lookahead buffers is fixed
+  // when the encoder is created, so only the pyramids can be dropped.
+  const int lap_enabled = oxcf->pass == AOM_RC_ONE_PASS &&
+                          oxcf->mode == GOOD && oxcf->rc_cfg.mode != AOM_CBR;
+  if (lap_enabled) return;
+  while (gf_cfg->lag_in_frames > 0 &&
+         av1_estimate_frame_buffers_mem(oxcf, gf_cfg->lag_in_frames,
+                                        tool_cfg->enable_global_motion) >
+             budget) {
+    --gf_cfg->lag_in_frames;
+  }
+}
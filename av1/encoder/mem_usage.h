@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AV1_ENCODER_MEM_USAGE_H_
+#define AOM_AV1_ENCODER_MEM_USAGE_H_
+
+#include "aom/aomcx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct AV1_PRIMARY;
+struct AV1EncoderConfig;
+
+/*!\brief Computes the bytes currently held by each encoder subsystem
+ *
+ * The live byte counts are derived from the buffers owned by the encoder
+ * rather than by intercepting every allocation, so only the large
+ * per-subsystem buffers are accounted for.
+ *
+ * \param[in]    ppi          Top-level encoder structure
+ * \param[out]   live_bytes   Live bytes indexed by aom_mem_category_t
+ */
+void av1_get_live_mem_usage(const struct AV1_PRIMARY *ppi,
+                            uint64_t live_bytes[AOM_MEM_CATEGORIES]);
+
+/*!\brief Samples the live memory usage and updates the recorded peaks
+ *
+ * \param[in]    ppi          Top-level encoder structure
+ */
+void av1_update_mem_usage(struct AV1_PRIMARY *ppi);
+
+/*!\brief Estimates the bytes needed by the frame-sized encoder buffers
+ *
+ * Covers the lookahead queue, the TPL reconstruction buffers, the temporal
+ * filter output buffers, the frame buffer pool and the image pyramids
+ * attached to them, for the given lookahead depth.
+ *
+ * \param[in]    oxcf                  Encoder configuration
+ * \param[in]    lag_in_frames         Lookahead depth to evaluate
+ * \param[in]    enable_global_motion  Whether image pyramids are allocated
+ *
+ * \return Estimated size in bytes
+ */
+uint64_t av1_estimate_frame_buffers_mem(const struct AV1EncoderConfig *oxcf,
+                                        int lag_in_frames,
+                                        int enable_global_motion);
+
+/*!\brief Adjusts the configuration so that the frame-sized buffers fit in
+ * oxcf->mem_budget_mb
+ *
+ * The image pyramids are dropped first, by disabling global motion, and then
+ * the lookahead is shortened. A shorter lookahead also shrinks the TPL
+ * reconstruction pool and, once it reaches a single frame, disables temporal
+ * filtering and TPL altogether.
+ *
+ * \param[in,out]  oxcf          Encoder configuration
+ */
+void av1_fit_config_to_mem_budget(struct AV1EncoderConfig *oxcf);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AV1_ENCODER_MEM_USAGE_H_
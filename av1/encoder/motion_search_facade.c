@@ -176,8 +176,23 @@ void av1_single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
   int cnt = 1;
   int total_weight = 0;
 
-  if (!cpi->sf.mv_sf.full_pixel_search_level &&
-      mbmi->motion_mode == SIMPLE_TRANSLATION) {
+  // A motion vector hint supplied with the source frame replaces the other
+  // candidates, and is only refined in a small window.
+  int hint_range = 0;
+  MV hint_mv;
+  if (mbmi->motion_mode == SIMPLE_TRANSLATION &&
+      av1_get_mv_hint(
+          cpi->mv_hints, cm->width, cm->height,
+          mi_col * MI_SIZE + block_size_wide[bsize] / 2,
+          mi_row * MI_SIZE + block_size_high[bsize] / 2,
+          (int)get_ref_frame_buf(cm, ref)->display_order_hint -
+              (int)cm->current_frame.display_order_hint,
+          &hint_mv)) {
+    hint_range = cpi->mv_hints->search_range;
+    search_range = AOMMIN(search_range, hint_range);
+    cand[0].fmv.as_fullmv = get_fullmv_from_mv(&hint_mv);
+  } else if (!cpi->sf.mv_sf.full_pixel_search_level &&
+             mbmi->motion_mode == SIMPLE_TRANSLATION) {
     get_mv_candidate_from_tpl(cpi, x, bsize, ref, cand, &cnt, &total_weight);
   }
 
@@ -247,17 +262,9 @@ void av1_single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
 
   // Further reduce the search range.
   if (search_range < INT_MAX) {
-    const search_site_config *search_site_cfg =
-        &src_search_site_cfg[search_method_lookup[search_method]];
-    // Max step_param is search_site_cfg->num_search_steps.
-    if (search_range < 1) {
-      step_param = search_site_cfg->num_search_steps;
-    } else {
-      while (search_site_cfg->radius[search_site_cfg->num_search_steps -
-                                     step_param - 1] > (search_range << 1) &&
-             search_site_cfg->num_search_steps - step_param - 1 > 0)
-        step_param++;
-    }
+    step_param = av1_get_search_range_step_param(
+        &src_search_site_cfg[search_method_lookup[search_method]], step_param,
+        search_range);
   }
 
   int cost_list[5];
@@ -283,6 +290,13 @@ void av1_single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
         av1_make_default_fullpel_ms_params(
             &full_ms_params, cpi, x, bsize, &ref_mv, smv.as_fullmv,
             src_search_site_cfg, search_method, fine_search_interval);
+        // The searches around each candidate share the distortions.
+        if (!cpi->oxcf.unit_test_cfg.fullpel_search_cache_unit_test)
+          full_ms_params.search_cache = &x->fullpel_search_cache;
+        if (hint_range > 0) {
+          av1_set_fullmv_search_window(&full_ms_params.mv_limits,
+                                       smv.as_fullmv, hint_range);
+        }
 
         const int thissme =
             av1_full_pixel_search(smv.as_fullmv, &full_ms_params, step_param,
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
+#include "av1/common/entropymv.h"
+#include "av1/encoder/mcomp_structs.h"
+#include "av1/encoder/mv_hints.h"
+
+static int alloc_hints(MvHintMap *map, int size) {
+  if (map->alloc_size < size) {
+    aom_free(map->hints);
+    map->alloc_size = 0;
+    map->hints = aom_malloc(size * sizeof(*map->hints));
+    if (!map->hints) return -1;
+    map->alloc_size = size;
+  }
+  return 0;
+}
+
+aom_codec_err_t av1_set_mv_hints(MvHintMap *map, const aom_mv_hint_map_t *src,
+                                 int width, int height) {
+  map->rows = 0;
+  if (src == NULL) return AOM_CODEC_OK;
+  if (src->hints == NULL ||
+      (src->block_size != 8 && src->block_size != 16) ||
+      (int)src->rows != (height + (int)src->block_size - 1) /
+                            (int)src->block_size ||
+      (int)src->cols != (width + (int)src->block_size - 1) /
+                            (int)src->block_size ||
+      src->search_range > MAX_FULL_PEL_VAL) {
+    return AOM_CODEC_INVALID_PARAM;
+  }
+  const int size = src->rows * src->cols;
+  if (alloc_hints(map, size)) return AOM_CODEC_MEM_ERROR;
+  memcpy(map->hints, src->hints, size * sizeof(*map->hints));
+  map->rows = src->rows;
+  map->cols = src->cols;
+  map->block_size_log2 = src->block_size == 8 ? 3 : 4;
+  map->search_range =
+      src->search_range ? (int)src->search_range : MV_HINT_DEFAULT_SEARCH_RANGE;
+  map->width = width;
+  map->height = height;
+  return AOM_CODEC_OK;
+}
+
+int av1_copy_mv_hints(MvHintMap *dst, const MvHintMap *src) {
+  dst->rows = 0;
+  if (src == NULL || src->rows == 0) return 0;
+  const int size = src->rows * src->cols;
+  if (alloc_hints(dst, size)) return -1;
+  memcpy(dst->hints, src->hints, size * sizeof(*dst->hints));
+  dst->rows = src->rows;
+  dst->cols = src->cols;
+  dst->block_size_log2 = src->block_size_log2;
+  dst->search_range = src->search_range;
+  dst->width = src->width;
+  dst->height = src->height;
+  return 0;
+}
+
+void av1_free_mv_hints(MvHintMap *map) {
+  aom_free(map->hints);
+  map->hints = NULL;
+  map->alloc_size = 0;
+  map->rows = 0;
+}
+
+// Returns v * num / den, rounded to the nearest integer and clamped to the
+// valid motion vector range.
+static int16_t scale_mv_component(int v, int num, int den) {
+  int64_t p = (int64_t)v * num;
+  if (den < 0) {
+    p = -p;
+    den = -den;
+  }
+  const int64_t q = p >= 0 ? (p + den / 2) / den : -((-p + den / 2) / den);
+  return (int16_t)clamp64(q, MV_LOW + 1, MV_UPP - 1);
+}
+
+int av1_get_mv_hint(const MvHintMap *map, int width, int height, int x, int y,
+                    int ref_distance, MV *mv) {
+  if (map == NULL || map->rows == 0 || ref_distance == 0) return 0;
+  if (width != map->width || height != map->height) return 0;
+  const int row = clamp(y, 0, height - 1) >> map->block_size_log2;
+  const int col = clamp(x, 0, width - 1) >> map->block_size_log2;
+  const aom_mv_hint_t *hint = &map->hints[row * map->cols + col];
+  if (hint->ref_distance == 0) return 0;
+  mv->row = scale_mv_component(hint->row, ref_distance, hint->ref_distance);
+  mv->col = scale_mv_component(hint->col, ref_distance, hint->ref_distance);
+  return 1;
+}
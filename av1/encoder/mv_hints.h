@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AV1_ENCODER_MV_HINTS_H_
+#define AOM_AV1_ENCODER_MV_HINTS_H_
+
+#include "aom/aomcx.h"
+#include "av1/common/mv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!\cond */
+
+// Refinement range, in full pels, used when the map does not set one.
+#define MV_HINT_DEFAULT_SEARCH_RANGE 8
+
+// Motion vector hints attached to a source frame, see AV1E_SET_MV_HINTS.
+// 'rows' is 0 when the frame has no hints.
+typedef struct MvHintMap {
+  aom_mv_hint_t *hints;
+  int alloc_size;
+  int rows;
+  int cols;
+  int block_size_log2;
+  int search_range;
+  // Size of the source frame the hints were given for.
+  int width;
+  int height;
+} MvHintMap;
+
+/*!\endcond */
+
+/*!\brief Checks and copies hints passed through AV1E_SET_MV_HINTS
+ *
+ * \param[out]   map       Hint map of the next frame
+ * \param[in]    src       Hints from the application, NULL to clear them
+ * \param[in]    width     Width of the source frames
+ * \param[in]    height    Height of the source frames
+ *
+ * \return AOM_CODEC_OK, or an error if the map does not match the frame size
+ */
+aom_codec_err_t av1_set_mv_hints(MvHintMap *map, const aom_mv_hint_map_t *src,
+                                 int width, int height);
+
+/*!\brief Copies a hint map, reusing the allocation of dst
+ *
+ * \return 0 on success, -1 if memory allocation fails
+ */
+int av1_copy_mv_hints(MvHintMap *dst, const MvHintMap *src);
+
+/*!\brief Frees the hints held by a map */
+void av1_free_mv_hints(MvHintMap *map);
+
+/*!\brief Gets the hint of the block covering a pixel
+ *
+ * \param[in]    map           Hint map of the frame, may be NULL
+ * \param[in]    width         Width of the frame being searched
+ * \param[in]    height        Height of the frame being searched
+ * \param[in]    x             Column of the pixel, usually a block center
+ * \param[in]    y             Row of the pixel
+ * \param[in]    ref_distance  Display order distance to the reference frame
+ * \param[out]   mv            Hinted vector, scaled to ref_distance
+ *
+ * \return 1 if there is a hint, 0 otherwise
+ */
+int av1_get_mv_hint(const MvHintMap *map, int width, int height, int x, int y,
+                    int ref_distance, MV *mv);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AV1_ENCODER_MV_HINTS_H_
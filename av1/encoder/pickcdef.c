@@ -815,7 +815,9 @@ void av1_pick_cdef_from_qp(AV1_COMMON *const cm, int skip_cdef,
   for (int r = 0; r < nvfb; ++r) {
     for (int c = 0; c < nhfb; ++c) {
       MB_MODE_INFO *current_mbmi = mbmi[MI_SIZE_64X64 * c];
-      current_mbmi->cdef_strength = 0;
+      // The superblocks are not encoded yet when the strengths are picked
+      // before the tiles, for AV1E_SET_TILE_GROUP_CALLBACK.
+      if (current_mbmi != NULL) current_mbmi->cdef_strength = 0;
     }
     mbmi += MI_SIZE_64X64 * mi_params->mi_stride;
   }
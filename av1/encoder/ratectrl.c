@@ -458,11 +458,20 @@ int av1_rc_drop_frame(AV1_COMP *cpi) {
   if (cpi->common.current_frame.frame_type == KEY_FRAME ||
       (cpi->ppi->use_svc &&
        cpi->svc.layer_context[cpi->svc.temporal_layer_id].is_key_frame) ||
-      !oxcf->rc_cfg.drop_frames_water_mark ||
       (rc->max_consec_drop > 0 &&
        rc->drop_count_consec >= rc->max_consec_drop)) {
     return 0;
+  } else if (!oxcf->rc_cfg.drop_frames_water_mark) {
+    return 0;
+  } else if (cpi->sf.rt_sf.drop_static_frames_screen &&
+             rc->static_source_frames > 30) {
+    // The frame repeats the previous one, and the quality of the static
+    // content had enough frames to ramp up.
+    rc->drop_count_consec++;
+    rc->prev_drop_was_static = 1;
+    return 1;
   } else {
+    rc->prev_drop_was_static = 0;
     if (buffer_level < 0) {
       // Always drop if buffer is below 0.
       rc->drop_count_consec++;
@@ -3117,6 +3126,38 @@ static void rc_scene_detection_onepass_rt(AV1_COMP *cpi,
   }
 }
 
+// Returns true if the visible pixels of all the planes of the two sources are
+// identical.
+static bool is_source_unchanged(const YV12_BUFFER_CONFIG *src,
+                                const YV12_BUFFER_CONFIG *last_src) {
+  if (src->y_crop_width != last_src->y_crop_width ||
+      src->y_crop_height != last_src->y_crop_height ||
+      src->uv_crop_width != last_src->uv_crop_width ||
+      src->uv_crop_height != last_src->uv_crop_height ||
+      (src->flags & YV12_FLAG_HIGHBITDEPTH) !=
+          (last_src->flags & YV12_FLAG_HIGHBITDEPTH))
+    return false;
+  const int use_hbd = (src->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+  const int num_planes = src->monochrome ? 1 : MAX_MB_PLANE;
+  for (int plane = 0; plane < num_planes; ++plane) {
+    const int is_uv = plane > 0;
+    const size_t row_bytes = (size_t)src->crop_widths[is_uv] << use_hbd;
+    const uint8_t *buf = src->buffers[plane];
+    const uint8_t *last_buf = last_src->buffers[plane];
+    if (use_hbd) {
+      buf = (const uint8_t *)CONVERT_TO_SHORTPTR(buf);
+      last_buf = (const uint8_t *)CONVERT_TO_SHORTPTR(last_buf);
+    }
+    const size_t stride = (size_t)src->strides[is_uv] << use_hbd;
+    const size_t last_stride = (size_t)last_src->strides[is_uv] << use_hbd;
+    for (int row = 0; row < src->crop_heights[is_uv]; ++row) {
+      if (memcmp(buf + row * stride, last_buf + row * last_stride, row_bytes))
+        return false;
+    }
+  }
+  return true;
+}
+
 /*!\brief Set the GF baseline interval for 1 pass real-time mode.
  *
  *
@@ -3421,6 +3462,15 @@ void av1_get_one_pass_rt_params(AV1_COMP *cpi, FRAME_TYPE *const frame_type,
       cpi->src_sad_blk_64x64 = NULL;
     }
   }
+  // Count the frames repeating the previous source. The source sad is only a
+  // shortcut, it is not computed over the whole frame.
+  if (cpi->sf.rt_sf.drop_static_frames_screen &&
+      cpi->sf.rt_sf.check_scene_detection && rc->frame_source_sad == 0 &&
+      frame_input->last_source != NULL &&
+      is_source_unchanged(frame_input->source, frame_input->last_source))
+    ++rc->static_source_frames;
+  else
+    rc->static_source_frames = 0;
   // Check for dynamic resize, for single spatial layer for now.
   // For temporal layers only check on base temporal layer.
   if (cpi->oxcf.resize_cfg.resize_mode == RESIZE_DYNAMIC) {
@@ -205,6 +205,9 @@ typedef struct {
   int decimation_factor;
   int decimation_count;
   int prev_frame_is_dropped;
+  // Whether the last frame dropped by av1_rc_drop_frame() repeated its
+  // previous source, rather than being dropped for the buffer level.
+  int prev_drop_was_static;
   int drop_count_consec;
   int max_consec_drop;
 
@@ -252,6 +255,11 @@ typedef struct {
   // Maximum value of source sad across all blocks of frame.
   uint64_t max_block_source_sad;
 
+  // Number of consecutive frames, up to the current one, whose source is
+  // identical to the previous source. Only counted with the speed feature
+  // drop_static_frames_screen.
+  int static_source_frames;
+
   // For dynamic resize, 1 pass cbr.
   RESIZE_STATE resize_state;
   int resize_avg_qp;
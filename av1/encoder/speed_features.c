@@ -1520,6 +1520,8 @@ static void set_rt_speed_feature_framesize_dependent(const AV1_COMP *const cpi,
   }
   // Screen settings.
   if (cpi->oxcf.tune_cfg.content == AOM_CONTENT_SCREEN) {
+    if (cpi->oxcf.rc_cfg.drop_static_frames && !cpi->ppi->use_svc)
+      sf->rt_sf.drop_static_frames_screen = 1;
     // TODO(marpan): Check settings for speed 7 and 8.
     if (speed >= 7) {
       sf->rt_sf.reduce_mv_pel_precision_highmotion = 1;
@@ -2235,6 +2237,7 @@ static AOM_INLINE void init_rt_sf(REAL_TIME_SPEED_FEATURES *rt_sf) {
   rt_sf->part_early_exit_zeromv = 0;
   rt_sf->sse_early_term_inter_search = EARLY_TERM_DISABLED;
   rt_sf->skip_lf_screen = 0;
+  rt_sf->drop_static_frames_screen = 0;
   rt_sf->sad_based_adp_altref_lag = 0;
   rt_sf->partition_direct_merging = 0;
   rt_sf->var_part_based_on_qidx = 0;
@@ -2281,6 +2284,103 @@ static void set_subpel_search_method(
     mv_search_params->find_fractional_mv_step = av1_return_min_sub_pixel_mv;
 }
 
+// Speeds up the non-rd path by level steps, towards the settings of the faster
+// presets. Each step only makes the features more aggressive than the preset,
+// and leaves alone the features the preset turns off on purpose. sf is rebuilt
+// from the speed preset at the start of every frame (see
+// set_size_independent_vars()), so lowering the level undoes the steps above
+// it.
+static void set_rt_speed_features_time_budget(const AV1_COMP *const cpi,
+                                              SPEED_FEATURES *const sf,
+                                              int level) {
+  REAL_TIME_SPEED_FEATURES *const rt_sf = &sf->rt_sf;
+  // Scene changes and intra frames keep the preset settings.
+  if (level <= 0 || !rt_sf->use_nonrd_pick_mode ||
+      frame_is_intra_only(&cpi->common) || cpi->rc.high_source_sad)
+    return;
+
+  if (level >= 1) {
+    rt_sf->sse_early_term_inter_search =
+        AOMMAX(rt_sf->sse_early_term_inter_search, EARLY_TERM_IDX_2);
+    rt_sf->nonrd_prune_ref_frame_search =
+        AOMMAX(rt_sf->nonrd_prune_ref_frame_search, 2);
+  }
+  if (level >= 2) {
+    rt_sf->var_part_split_threshold_shift =
+        AOMMAX(rt_sf->var_part_split_threshold_shift, 8);
+    // Screen content turns the merging off. short_circuit_low_temp_var stays
+    // with the preset, which clears it at speed 7 and at speed 8 without SVC.
+    if (cpi->oxcf.tune_cfg.content != AOM_CONTENT_SCREEN)
+      rt_sf->partition_direct_merging = 1;
+  }
+  if (level >= 3) {
+    rt_sf->sse_early_term_inter_search =
+        AOMMAX(rt_sf->sse_early_term_inter_search, EARLY_TERM_IDX_3);
+    rt_sf->skip_intra_pred = AOMMAX(rt_sf->skip_intra_pred, 2);
+    for (int i = 0; i < BLOCK_SIZES; ++i)
+      rt_sf->intra_y_mode_bsize_mask_nrd[i] = INTRA_DC;
+  }
+  if (level >= 4) {
+    rt_sf->var_part_split_threshold_shift =
+        AOMMAX(rt_sf->var_part_split_threshold_shift, 9);
+    rt_sf->prefer_large_partition_blocks =
+        AOMMAX(rt_sf->prefer_large_partition_blocks, 1);
+    rt_sf->check_only_zero_zeromv_on_large_blocks = true;
+  }
+  if (level >= 5) {
+    rt_sf->sse_early_term_inter_search = EARLY_TERM_IDX_4;
+    rt_sf->nonrd_prune_ref_frame_search =
+        AOMMAX(rt_sf->nonrd_prune_ref_frame_search, 3);
+    rt_sf->var_part_split_threshold_shift =
+        AOMMAX(rt_sf->var_part_split_threshold_shift, 10);
+    sf->mv_sf.subpel_search_method =
+        AOMMAX(sf->mv_sf.subpel_search_method, SUBPEL_TREE_PRUNED_MORE);
+  }
+  if (level >= 6) {
+    rt_sf->prefer_large_partition_blocks = 3;
+    if (!cpi->ppi->rtc_ref.bias_recovery_frame)
+      rt_sf->nonrd_aggressive_skip = 1;
+    rt_sf->skip_cdef_sb = AOMMAX(rt_sf->skip_cdef_sb, 1);
+  }
+  if (level >= 7) {
+    sf->lpf_sf.cdef_pick_method = CDEF_PICK_FROM_Q;
+    rt_sf->reduce_mv_pel_precision_highmotion =
+        AOMMAX(rt_sf->reduce_mv_pel_precision_highmotion, 2);
+  }
+}
+
+void av1_update_frame_time_budget(AV1_COMP *cpi, int64_t frame_time_us) {
+  FrameTimeBudgetState *const state = &cpi->time_budget;
+  const int64_t budget_us = cpi->oxcf.frame_time_budget_us;
+  // Intra frames are not sped up, and their time would mislead the average.
+  if (budget_us == 0 || cpi->oxcf.mode != REALTIME ||
+      frame_is_intra_only(&cpi->common))
+    return;
+
+  state->avg_frame_time_us =
+      state->avg_frame_time_us == 0
+          ? frame_time_us
+          : (3 * state->avg_frame_time_us + frame_time_us) / 4;
+  ++state->frames_since_change;
+  // Speed up as soon as the average settles above the budget, or at once on a
+  // large overshoot. Slow down after a longer period of headroom, so that the
+  // level does not oscillate around the budget.
+  int change = 0;
+  if (state->avg_frame_time_us > budget_us &&
+      (state->frames_since_change >= 2 ||
+       state->avg_frame_time_us > budget_us * 3 / 2)) {
+    change = 1;
+  } else if (state->avg_frame_time_us < budget_us * 3 / 4 &&
+             state->frames_since_change >= 8) {
+    change = -1;
+  }
+  const int level = clamp(state->level + change, 0, MAX_TIME_BUDGET_LEVEL);
+  if (level != state->level) {
+    state->level = level;
+    state->frames_since_change = 0;
+  }
+}
+
 void av1_set_speed_features_framesize_dependent(AV1_COMP *cpi, int speed) {
   SPEED_FEATURES *const sf = &cpi->sf;
   const AV1EncoderConfig *const oxcf = &cpi->oxcf;
@@ -2294,6 +2394,8 @@ void av1_set_speed_features_framesize_dependent(AV1_COMP *cpi, int speed) {
       break;
     case REALTIME:
       set_rt_speed_feature_framesize_dependent(cpi, sf, speed);
+      if (oxcf->frame_time_budget_us > 0)
+        set_rt_speed_features_time_budget(cpi, sf, cpi->time_budget.level);
       break;
   }
 
@@ -1735,6 +1735,12 @@ typedef struct REAL_TIME_SPEED_FEATURES {
   // where rc->high_source_sad = 0 (no slide-changes).
   int skip_lf_screen;
 
+  // For screen content in 1 pass CBR mode: drop the frames whose source is
+  // identical to the one of the previous frame, once the source has been
+  // static long enough for the quality to ramp up. Only set when enabled with
+  // AV1E_SET_DROP_STATIC_FRAMES.
+  int drop_static_frames_screen;
+
   // For nonrd: early exit out of variance partition that sets the
   // block size to superblock size, and sets mode to zeromv-last skip.
   // 0: disabled
@@ -1937,7 +1943,30 @@ typedef struct SPEED_FEATURES {
    */
   REAL_TIME_SPEED_FEATURES rt_sf;
 } SPEED_FEATURES;
+
+/*!\brief State of the speed adaptation to the frame time budget
+ *
+ * See AV1E_SET_FRAME_TIME_BUDGET.
+ */
+typedef struct FrameTimeBudgetState {
+  /*!
+   * Number of steps of the real-time speed feature ladder applied on top of
+   * the speed preset, from 0 to MAX_TIME_BUDGET_LEVEL.
+   */
+  int level;
+  /*!
+   * Number of frames encoded since the last change of the level.
+   */
+  int frames_since_change;
+  /*!
+   * Moving average of the frame encode time, in microseconds. 0 before the
+   * first frame.
+   */
+  int64_t avg_frame_time_us;
+} FrameTimeBudgetState;
+
 /*!\cond */
+#define MAX_TIME_BUDGET_LEVEL 7
 
 struct AV1_COMP;
 
@@ -1982,6 +2011,21 @@ void av1_set_speed_features_framesize_dependent(struct AV1_COMP *cpi,
  */
 void av1_set_speed_features_qindex_dependent(struct AV1_COMP *cpi, int speed);
 
+/*!\brief Adapts the speed features to the frame time budget
+ *
+ *\ingroup speed_features
+ *
+ * \param[in]    cpi            Top - level encoder instance structure
+ * \param[in]    frame_time_us  Encode time of the last frame, in microseconds
+ *
+ * \remark No return value but updates cpi->time_budget, which selects the
+ *         speed features of the next frames. Encoding is sped up when the
+ *         average frame time exceeds oxcf.frame_time_budget_us, and slowed
+ *         down again, no further than the speed preset, when it falls well
+ *         below.
+ */
+void av1_update_frame_time_budget(struct AV1_COMP *cpi, int64_t frame_time_us);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -127,7 +127,7 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
                              const YV12_BUFFER_CONFIG *frame_to_filter,
                              const YV12_BUFFER_CONFIG *ref_frame,
                              const BLOCK_SIZE block_size, const int mb_row,
-                             const int mb_col, MV *ref_mv,
+                             const int mb_col, MV *ref_mv, int search_range,
                              bool allow_me_for_sub_blks, MV *subblock_mvs,
                              int *subblock_mses) {
   // Frame information
@@ -152,7 +152,7 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
   // Parameters used for motion search.
   FULLPEL_MOTION_SEARCH_PARAMS full_ms_params;
   SUBPEL_MOTION_SEARCH_PARAMS ms_params;
-  const int step_param = av1_init_search_range(
+  int step_param = av1_init_search_range(
       AOMMAX(frame_to_filter->y_crop_width, frame_to_filter->y_crop_height));
   const SUBPEL_SEARCH_TYPE subpel_search_type = USE_8_TAPS;
   const int force_integer_mv = cpi->common.features.cur_frame_force_integer_mv;
@@ -202,6 +202,12 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
     full_ms_params.prune_mesh_search = (q <= 20) ? 0 : 1;
     full_ms_params.mesh_search_mv_diff_threshold = 2;
   }
+  if (search_range < INT_MAX) {
+    av1_set_fullmv_search_window(&full_ms_params.mv_limits, start_mv,
+                                 search_range);
+    step_param = av1_get_search_range_step_param(full_ms_params.search_sites,
+                                                 step_param, search_range);
+  }
 
   av1_full_pixel_search(start_mv, &full_ms_params, step_param,
                         cond_cost_list(cpi, cost_list), &best_mv.as_fullmv,
@@ -263,6 +269,10 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
             full_ms_params.prune_mesh_search = (q <= 20) ? 0 : 1;
             full_ms_params.mesh_search_mv_diff_threshold = 2;
           }
+          if (search_range < INT_MAX) {
+            av1_set_fullmv_search_window(&full_ms_params.mv_limits, start_mv,
+                                         search_range);
+          }
           av1_full_pixel_search(start_mv, &full_ms_params, step_param,
                                 cond_cost_list(cpi, cost_list),
                                 &best_mv.as_fullmv, &best_mv_stats, NULL);
@@ -929,9 +939,21 @@ void av1_tf_do_filtering_row(AV1_COMP *cpi, ThreadData *td, int mb_row) {
         ref_mv.row *= -1;
         ref_mv.col *= -1;
       } else {  // Other reference frames.
+        // Start from the motion vector supplied with the source frame, if
+        // any, and only refine it.
+        int search_range = INT_MAX;
+        MV hint_mv;
+        if (av1_get_mv_hint(tf_ctx->mv_hints, frame_to_filter->y_crop_width,
+                            frame_to_filter->y_crop_height,
+                            mb_col * mb_width + mb_width / 2,
+                            mb_row * mb_height + mb_height / 2,
+                            frame - filter_frame_idx, &hint_mv)) {
+          ref_mv = hint_mv;
+          search_range = tf_ctx->mv_hints->search_range;
+        }
         tf_motion_search(cpi, mb, frame_to_filter, frames[frame], block_size,
-                         mb_row, mb_col, &ref_mv, allow_me_for_sub_blks,
-                         subblock_mvs, subblock_mses);
+                         mb_row, mb_col, &ref_mv, search_range,
+                         allow_me_for_sub_blks, subblock_mvs, subblock_mses);
       }
 
       // Perform weighted averaging.
@@ -1204,6 +1226,7 @@ static void tf_setup_filtering_buffer(AV1_COMP *cpi,
   tf_ctx->num_frames = num_frames;
   tf_ctx->filter_frame_idx = num_before;
   assert(frames[tf_ctx->filter_frame_idx] == to_filter_frame);
+  tf_ctx->mv_hints = &to_filter_buf->mv_hints;
 
   av1_setup_src_planes(&cpi->td.mb, &to_filter_buf->img, 0, 0, num_planes,
                        cpi->common.seq_params->sb_size);
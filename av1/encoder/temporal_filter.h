@@ -144,6 +144,10 @@ typedef struct {
    * Quantization factor used in temporal filtering.
    */
   int q_factor;
+  /*!
+   * Motion vector hints supplied with the frame to be filtered.
+   */
+  const MvHintMap *mv_hints;
 } TemporalFilterCtx;
 
 /*!
@@ -25,6 +25,7 @@
 #include "av1/common/idct.h"
 #include "av1/common/reconintra.h"
 
+#include "av1/encoder/analysis_file.h"
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/ethread.h"
 #include "av1/encoder/encodeframe_utils.h"
@@ -254,7 +255,7 @@ static uint32_t motion_estimation(AV1_COMP *cpi, MACROBLOCK *x,
                                   uint8_t *ref_frame_buf, int stride,
                                   int ref_stride, int width, int ref_width,
                                   BLOCK_SIZE bsize, MV center_mv,
-                                  int_mv *best_mv) {
+                                  int search_range, int_mv *best_mv) {
   AV1_COMMON *cm = &cpi->common;
   MACROBLOCKD *const xd = &x->e_mbd;
   TPL_SPEED_FEATURES *tpl_sf = &cpi->sf.tpl_sf;
@@ -288,6 +289,12 @@ static uint32_t motion_estimation(AV1_COMP *cpi, MACROBLOCK *x,
                                      start_mv, search_site_cfg,
                                      tpl_sf->search_method,
                                      /*fine_search_interval=*/0);
+  if (search_range < INT_MAX) {
+    av1_set_fullmv_search_window(&full_ms_params.mv_limits, start_mv,
+                                 search_range);
+    step_param = av1_get_search_range_step_param(full_ms_params.search_sites,
+                                                 step_param, search_range);
+  }
 
   bestsme = av1_full_pixel_search(start_mv, &full_ms_params, step_param,
                                   cond_cost_list(cpi, cost_list),
@@ -792,6 +799,32 @@ static AOM_INLINE void mode_estimation(AV1_COMP *cpi,
       }
     }
 
+    // Refine the motion vector supplied with the source frame in a small
+    // window, instead of searching around the neighboring vectors.
+    int search_range = INT_MAX;
+    MV hint_mv;
+    if (av1_get_mv_hint(tpl_frame->mv_hints, cm->width, cm->height,
+                        mi_col * MI_SIZE + bw / 2, mi_row * MI_SIZE + bh / 2,
+                        tpl_data->ref_display_distance[rf_idx], &hint_mv)) {
+      center_mvs[0].mv.as_mv = hint_mv;
+      refmv_count = 1;
+      search_range = tpl_frame->mv_hints->search_range;
+    }
+
+    // Reuse the motion vector found by a previous encode of the same source
+    // when the analysis file has one, instead of searching again.
+    if (tpl_data->imported_mvs[rf_idx] != NULL) {
+      const int_mv imported_mv =
+          tpl_data->imported_mvs[rf_idx][av1_tpl_ptr_pos(
+              mi_row, mi_col, tpl_frame->stride, block_mis_log2)];
+      if (imported_mv.as_int != INVALID_MV &&
+          av1_is_fullmv_in_range(&x->mv_limits,
+                                 get_fullmv_from_mv(&imported_mv.as_mv))) {
+        best_rfidx_mv = imported_mv;
+        refmv_count = 0;
+      }
+    }
+
     // Prune starting mvs
     if (tpl_sf->prune_starting_mv && refmv_count > 1) {
       // Get each center mv's sad.
@@ -820,7 +853,8 @@ static AOM_INLINE void mode_estimation(AV1_COMP *cpi,
       int_mv this_mv;
       uint32_t thissme = motion_estimation(
           cpi, x, src_mb_buffer, ref_mb, src_stride, ref_stride, src_width,
-          ref_width, bsize, center_mvs[idx].mv.as_mv, &this_mv);
+          ref_width, bsize, center_mvs[idx].mv.as_mv, search_range,
+          &this_mv);
 
       if (thissme < bestsme) {
         bestsme = thissme;
@@ -1270,6 +1304,35 @@ static AOM_INLINE void tpl_reset_src_ref_frames(TplParams *tpl_data) {
   for (int i = 0; i < INTER_REFS_PER_FRAME; ++i) {
     tpl_data->ref_frame[i] = NULL;
     tpl_data->src_ref_frame[i] = NULL;
+    tpl_data->imported_mvs[i] = NULL;
+  }
+}
+
+// TPL display indices restart at key frames that reset the reference buffers,
+// while the analysis file is indexed by display order in the whole sequence.
+static AOM_INLINE uint32_t get_analysis_display_index(
+    const AV1_COMP *cpi, uint32_t tpl_display_index) {
+  return tpl_display_index + cpi->frame_index_set.show_frame_count -
+         cpi->common.current_frame.frame_number;
+}
+
+// Writes the motion fields found for the frame 'frame_idx' against each of its
+// reference frames to the analysis file.
+static AOM_INLINE void export_tpl_mvs(AV1_COMP *cpi, int frame_idx) {
+  TplParams *const tpl_data = &cpi->ppi->tpl_data;
+  const TplDepFrame *tpl_frame = &tpl_data->tpl_frame[frame_idx];
+  for (int idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
+    if (tpl_data->ref_frame[idx] == NULL ||
+        tpl_data->src_ref_frame[idx] == NULL)
+      continue;
+    const TplDepFrame *tpl_ref_frame =
+        &tpl_data->tpl_frame[tpl_frame->ref_map_index[idx]];
+    av1_analysis_file_write_tpl_mvs(
+        cpi->ppi->analysis_file,
+        get_analysis_display_index(cpi, tpl_frame->frame_display_index),
+        get_analysis_display_index(cpi, tpl_ref_frame->frame_display_index),
+        idx, tpl_frame->tpl_stats_ptr, tpl_frame->width, tpl_frame->height,
+        cpi->common.error);
   }
 }
 
@@ -1320,6 +1383,9 @@ static AOM_INLINE void init_mc_flow_dispenser(AV1_COMP *cpi, int frame_idx,
     tpl_data->ref_frame[idx] = tpl_ref_frame->rec_picture;
     tpl_data->src_ref_frame[idx] = tpl_ref_frame->gf_picture;
     ref_frame_display_indices[idx] = tpl_ref_frame->frame_display_index;
+    tpl_data->ref_display_distance[idx] =
+        (int)tpl_ref_frame->frame_display_index -
+        (int)tpl_frame->frame_display_index;
   }
 
   // Store the reference frames based on priority order
@@ -1358,6 +1424,21 @@ static AOM_INLINE void init_mc_flow_dispenser(AV1_COMP *cpi, int frame_idx,
     }
   }
 
+  // Motion search is skipped for the reference frames whose motion field was
+  // saved in the analysis file by a previous encode.
+  if (cpi->ppi->analysis_file != NULL) {
+    for (idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
+      if (tpl_data->ref_frame[idx] == NULL ||
+          tpl_data->src_ref_frame[idx] == NULL)
+        continue;
+      tpl_data->imported_mvs[idx] = av1_analysis_file_read_tpl_mvs(
+          cpi->ppi->analysis_file,
+          get_analysis_display_index(cpi, tpl_frame->frame_display_index),
+          get_analysis_display_index(cpi, ref_frame_display_indices[idx]), idx,
+          tpl_frame->width, tpl_frame->height, cm->error);
+    }
+  }
+
   // Make a temporary mbmi for tpl model
   MB_MODE_INFO mbmi;
   memset(&mbmi, 0, sizeof(mbmi));
@@ -1565,6 +1646,7 @@ static AOM_INLINE void init_gop_frames_for_tpl(
         cpi->ppi->lookahead, lookahead_index, cpi->compressor_stage);
     if (buf == NULL) break;
     tpl_frame->gf_picture = &buf->img;
+    tpl_frame->mv_hints = &buf->mv_hints;
 
     // Use filtered frame buffer if available. This will make tpl stats more
     // precise.
@@ -1649,6 +1731,7 @@ static AOM_INLINE void init_gop_frames_for_tpl(
     if (buf == NULL) break;
 
     tpl_frame->gf_picture = &buf->img;
+    tpl_frame->mv_hints = &buf->mv_hints;
     tpl_frame->rec_picture = &tpl_data->tpl_rec_pool[process_frame_count];
     tpl_frame->tpl_stats_ptr = tpl_data->tpl_stats_pool[process_frame_count];
     // 'cm->current_frame.frame_number' is the display number
@@ -1810,9 +1893,7 @@ static AOM_INLINE int skip_tpl_for_frame(const GF_GROUP *gf_group,
 
 int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
                         const EncodeFrameParams *const frame_params) {
-#if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_tpl_setup_stats_time);
-#endif
   assert(cpi->gf_frame_index == 0);
   AV1_COMMON *cm = &cpi->common;
   MultiThreadInfo *const mt_info = &cpi->mt_info;
@@ -1828,6 +1909,14 @@ int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
     return 0;
   }
 
+  if ((cpi->oxcf.analysis_import_path || cpi->oxcf.analysis_export_path) &&
+      cpi->ppi->analysis_file == NULL) {
+    av1_analysis_file_open(&cpi->ppi->analysis_file,
+                           cpi->oxcf.analysis_import_path,
+                           cpi->oxcf.analysis_export_path,
+                           tpl_data->tpl_bsize_1d, cm->error);
+  }
+
   cm->current_frame.frame_type = frame_params->frame_type;
   for (int gf_index = cpi->gf_frame_index; gf_index < gf_group->size;
        ++gf_index) {
@@ -1897,6 +1986,7 @@ int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
     } else {
       mc_flow_dispenser(cpi);
     }
+    if (cpi->ppi->analysis_file != NULL) export_tpl_mvs(cpi, frame_idx);
 #if CONFIG_BITRATE_ACCURACY
     av1_tpl_txfm_stats_update_abs_coeff_mean(&cpi->td.tpl_txfm_stats);
     av1_tpl_store_txfm_stats(tpl_data, &cpi->td.tpl_txfm_stats, frame_idx);
@@ -1930,12 +2020,10 @@ int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
   cm->current_frame.frame_type = frame_params->frame_type;
   cm->show_frame = frame_params->show_frame;
 
-#if CONFIG_COLLECT_COMPONENT_TIMING
   // Record the time if the function returns.
   if (cpi->common.tiles.large_scale || gf_group->max_layer_depth_allowed == 0 ||
       !gop_eval)
     end_timing(cpi, av1_tpl_setup_stats_time);
-#endif
 
   tpl_dealloc_temp_buffers(tpl_tmp_buffers);
 
@@ -1953,9 +2041,7 @@ int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
       AOMMIN(tpl_gf_group_frames - 1, gf_group->arf_index + 1);
   beta[0] = av1_tpl_get_frame_importance(tpl_data, frame_idx_0);
   beta[1] = av1_tpl_get_frame_importance(tpl_data, frame_idx_1);
-#if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_tpl_setup_stats_time);
-#endif
   return eval_gop_length(beta, gop_eval);
 }
 
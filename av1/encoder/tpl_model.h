@@ -153,6 +153,8 @@ typedef struct TplDepFrame {
   int mi_cols;
   int base_rdmult;
   uint32_t frame_display_index;
+  // Motion vector hints supplied with the source frame, see AV1E_SET_MV_HINTS.
+  const MvHintMap *mv_hints;
   // When set, SAD metric is used for intra and inter mode decision.
   int use_pred_sad;
 } TplDepFrame;
@@ -234,6 +236,19 @@ typedef struct TplParams {
    */
   const YV12_BUFFER_CONFIG *ref_frame[INTER_REFS_PER_FRAME];
 
+  /*!
+   * Motion fields of the current frame read from the analysis file.
+   * imported_mvs[i] is NULL when there is no field for the ith reference
+   * frame type, in which case motion search is run.
+   */
+  const int_mv *imported_mvs[INTER_REFS_PER_FRAME];
+
+  /*!
+   * Display order distance from the current frame to each reference frame,
+   * used to scale motion vector hints.
+   */
+  int ref_display_distance[INTER_REFS_PER_FRAME];
+
   /*!
    * Parameters related to synchronization for top-right dependency in row based
    * multi-threading of tpl
@@ -11,8 +11,11 @@
 
 #include "av1/ratectrl_rtc.h"
 
+#include <cstddef>
+#include <cstring>
 #include <memory>
 #include <new>
+#include <vector>
 
 #include "aom/aomcx.h"
 #include "aom/aom_encoder.h"
@@ -74,42 +77,38 @@ std::unique_ptr<AV1RateControlRTC> AV1RateControlRTC::Create(
   rc_api->cpi_->common.seq_params = &rc_api->cpi_->ppi->seq_params;
   av1_zero(*rc_api->cpi_->common.seq_params);
   if (!rc_api->InitRateControl(cfg)) return nullptr;
-  if (cfg.aq_mode) {
-    AV1_COMP *const cpi = rc_api->cpi_;
-    cpi->enc_seg.map = static_cast<uint8_t *>(aom_calloc(
-        cpi->common.mi_params.mi_rows * cpi->common.mi_params.mi_cols,
-        sizeof(*cpi->enc_seg.map)));
-    if (!cpi->enc_seg.map) return nullptr;
-    cpi->cyclic_refresh = av1_cyclic_refresh_alloc(
-        cpi->common.mi_params.mi_rows, cpi->common.mi_params.mi_cols);
-    if (!cpi->cyclic_refresh) return nullptr;
-  }
   return rc_api;
 }
 
 AV1RateControlRTC::~AV1RateControlRTC() {
   if (cpi_) {
-    if (cpi_->svc.number_spatial_layers > 1 ||
-        cpi_->svc.number_temporal_layers > 1) {
-      for (int sl = 0; sl < cpi_->svc.number_spatial_layers; sl++) {
-        for (int tl = 0; tl < cpi_->svc.number_temporal_layers; tl++) {
-          int layer =
-              LAYER_IDS_TO_IDX(sl, tl, cpi_->svc.number_temporal_layers);
-          LAYER_CONTEXT *const lc = &cpi_->svc.layer_context[layer];
-          aom_free(lc->map);
-        }
+    FreeBuffers();
+    aom_free(cpi_->ppi);
+    aom_free(cpi_);
+  }
+}
+
+void AV1RateControlRTC::FreeBuffers() {
+  if (cpi_->svc.layer_context != nullptr &&
+      (cpi_->svc.number_spatial_layers > 1 ||
+       cpi_->svc.number_temporal_layers > 1)) {
+    for (int sl = 0; sl < cpi_->svc.number_spatial_layers; sl++) {
+      for (int tl = 0; tl < cpi_->svc.number_temporal_layers; tl++) {
+        int layer = LAYER_IDS_TO_IDX(sl, tl, cpi_->svc.number_temporal_layers);
+        LAYER_CONTEXT *const lc = &cpi_->svc.layer_context[layer];
+        aom_free(lc->map);
       }
     }
-    aom_free(cpi_->svc.layer_context);
-    cpi_->svc.layer_context = nullptr;
+  }
+  aom_free(cpi_->svc.layer_context);
+  cpi_->svc.layer_context = nullptr;
+  cpi_->svc.num_allocated_layers = 0;
 
-    if (cpi_->oxcf.q_cfg.aq_mode == CYCLIC_REFRESH_AQ) {
-      aom_free(cpi_->enc_seg.map);
-      cpi_->enc_seg.map = nullptr;
-      av1_cyclic_refresh_free(cpi_->cyclic_refresh);
-    }
-    aom_free(cpi_->ppi);
-    aom_free(cpi_);
+  if (cpi_->oxcf.q_cfg.aq_mode == CYCLIC_REFRESH_AQ) {
+    aom_free(cpi_->enc_seg.map);
+    cpi_->enc_seg.map = nullptr;
+    av1_cyclic_refresh_free(cpi_->cyclic_refresh);
+    cpi_->cyclic_refresh = nullptr;
   }
 }
 
@@ -151,6 +150,15 @@ bool AV1RateControlRTC::InitRateControl(const AV1RateControlRtcConfig &rc_cfg) {
   // Enable external rate control.
   cpi_->rc.rtc_external_ratectrl = 1;
   cpi_->sf.rt_sf.use_nonrd_pick_mode = 1;
+  if (rc_cfg.aq_mode) {
+    cpi_->enc_seg.map = static_cast<uint8_t *>(
+        aom_calloc(cm->mi_params.mi_rows * cm->mi_params.mi_cols,
+                   sizeof(*cpi_->enc_seg.map)));
+    if (!cpi_->enc_seg.map) return false;
+    cpi_->cyclic_refresh = av1_cyclic_refresh_alloc(cm->mi_params.mi_rows,
+                                                    cm->mi_params.mi_cols);
+    if (!cpi_->cyclic_refresh) return false;
+  }
   return true;
 }
 
@@ -371,4 +379,256 @@ void AV1RateControlRTC::PostEncodeUpdate(uint64_t encoded_frame_size) {
     av1_save_layer_context(cpi_);
 }
 
+namespace {
+
+// The part of PRIMARY_RATE_CONTROL used by the real-time rate control: the
+// regions are only used by the two pass encoder, and the q history with
+// RT_PASSIVE_STRATEGY.
+constexpr size_t kPrimaryRcHeadSize = offsetof(PRIMARY_RATE_CONTROL, regions);
+constexpr size_t kPrimaryRcBodyOffset =
+    offsetof(PRIMARY_RATE_CONTROL, regions_offset);
+#if RT_PASSIVE_STRATEGY
+constexpr size_t kPrimaryRcBodyEnd = sizeof(PRIMARY_RATE_CONTROL);
+#else
+constexpr size_t kPrimaryRcBodyEnd = offsetof(PRIMARY_RATE_CONTROL, q_history);
+#endif
+
+struct PrimaryRcState {
+  uint8_t head[kPrimaryRcHeadSize];
+  uint8_t body[kPrimaryRcBodyEnd - kPrimaryRcBodyOffset];
+};
+
+// The rest of the state of a stream in AV1_COMP and AV1_PRIMARY.
+struct FrameState {
+  CurrentFrame current_frame;
+  int width;
+  int height;
+  CommonModeInfoParams mi_params;
+  int base_qindex;
+  struct segmentation seg;
+  BLOCK_SIZE sb_size;
+  int mib_size;
+  int mib_size_log2;
+  RateControlCfg rc_cfg;
+  RefreshFrameInfo refresh_frame;
+  FRAME_UPDATE_TYPE update_type;
+  FRAME_TYPE frame_type;
+  REFBUF_STATE refbuf_state;
+  FRAME_INDEX_SET frame_index_set;
+  double framerate;
+  int is_screen_content_type;
+  bool is_dropped_frame;
+  uint64_t rec_sse;
+  int max_mv_magnitude;
+  uint8_t *seg_map;
+  CYCLIC_REFRESH *cyclic_refresh;
+  int use_svc;
+  int initial_width;
+  int initial_height;
+};
+
+template <typename T>
+void Transfer(bool load, T *encoder_value, T *stream_value) {
+  if (load)
+    *encoder_value = *stream_value;
+  else
+    *stream_value = *encoder_value;
+}
+
+void TransferFrameState(bool load, AV1_COMP *cpi, int *initial_width,
+                        int *initial_height, FrameState *f) {
+  AV1_COMMON *const cm = &cpi->common;
+  GF_GROUP *const gf_group = &cpi->ppi->gf_group;
+  Transfer(load, &cm->current_frame, &f->current_frame);
+  Transfer(load, &cm->width, &f->width);
+  Transfer(load, &cm->height, &f->height);
+  Transfer(load, &cm->mi_params, &f->mi_params);
+  Transfer(load, &cm->quant_params.base_qindex, &f->base_qindex);
+  Transfer(load, &cm->seg, &f->seg);
+  Transfer(load, &cm->seq_params->sb_size, &f->sb_size);
+  Transfer(load, &cm->seq_params->mib_size, &f->mib_size);
+  Transfer(load, &cm->seq_params->mib_size_log2, &f->mib_size_log2);
+  Transfer(load, &cpi->oxcf.rc_cfg, &f->rc_cfg);
+  Transfer(load, &cpi->refresh_frame, &f->refresh_frame);
+  Transfer(load, &gf_group->update_type[cpi->gf_frame_index], &f->update_type);
+  Transfer(load, &gf_group->frame_type[cpi->gf_frame_index], &f->frame_type);
+  Transfer(load, &gf_group->refbuf_state[cpi->gf_frame_index],
+           &f->refbuf_state);
+  Transfer(load, &cpi->frame_index_set, &f->frame_index_set);
+  Transfer(load, &cpi->framerate, &f->framerate);
+  Transfer(load, &cpi->is_screen_content_type, &f->is_screen_content_type);
+  Transfer(load, &cpi->is_dropped_frame, &f->is_dropped_frame);
+  Transfer(load, &cpi->rec_sse, &f->rec_sse);
+  Transfer(load, &cpi->mv_search_params.max_mv_magnitude,
+           &f->max_mv_magnitude);
+  Transfer(load, &cpi->enc_seg.map, &f->seg_map);
+  Transfer(load, &cpi->cyclic_refresh, &f->cyclic_refresh);
+  Transfer(load, &cpi->ppi->use_svc, &f->use_svc);
+  Transfer(load, initial_width, &f->initial_width);
+  Transfer(load, initial_height, &f->initial_height);
+}
+
+}  // namespace
+
+// The state of the streams, indexed by stream.
+struct AV1RateControlRTCBatch::Streams {
+  // The configuration, only changed by AddStream() and UpdateRateControl()
+  // apart from rc_cfg, which is in FrameState.
+  std::vector<AV1EncoderConfig> oxcf;
+  std::vector<RATE_CONTROL> rc;
+  std::vector<PrimaryRcState> p_rc;
+  std::vector<SVC> svc;
+  std::vector<RTC_REF> rtc_ref;
+  std::vector<FrameState> frame;
+  std::vector<bool> in_use;
+};
+
+std::unique_ptr<AV1RateControlRTCBatch> AV1RateControlRTCBatch::Create() {
+  std::unique_ptr<AV1RateControlRTCBatch> batch(new (std::nothrow)
+                                                    AV1RateControlRTCBatch());
+  if (!batch) return nullptr;
+  batch->rc_ = AV1RateControlRTC::Create(AV1RateControlRtcConfig());
+  if (!batch->rc_) return nullptr;
+  batch->streams_.reset(new (std::nothrow) Streams());
+  if (!batch->streams_) return nullptr;
+  return batch;
+}
+
+AV1RateControlRTCBatch::~AV1RateControlRTCBatch() {
+  if (!rc_ || !streams_) return;
+  for (int stream = 0; stream < static_cast<int>(streams_->in_use.size());
+       ++stream) {
+    if (streams_->in_use[stream]) RemoveStream(stream);
+  }
+}
+
+bool AV1RateControlRTCBatch::IsValid(int stream) const {
+  return stream >= 0 && stream < static_cast<int>(streams_->in_use.size()) &&
+         streams_->in_use[stream];
+}
+
+void AV1RateControlRTCBatch::Load(int stream) {
+  if (stream == loaded_stream_) return;
+  if (loaded_stream_ >= 0) Save(loaded_stream_);
+  AV1_COMP *const cpi = rc_->cpi_;
+  uint8_t *const p_rc = reinterpret_cast<uint8_t *>(&cpi->ppi->p_rc);
+  Streams &s = *streams_;
+  cpi->oxcf = s.oxcf[stream];
+  cpi->rc = s.rc[stream];
+  memcpy(p_rc, s.p_rc[stream].head, sizeof(s.p_rc[stream].head));
+  memcpy(p_rc + kPrimaryRcBodyOffset, s.p_rc[stream].body,
+         sizeof(s.p_rc[stream].body));
+  cpi->svc = s.svc[stream];
+  cpi->ppi->rtc_ref = s.rtc_ref[stream];
+  TransferFrameState(true, cpi, &rc_->initial_width_, &rc_->initial_height_,
+                     &s.frame[stream]);
+  loaded_stream_ = stream;
+}
+
+void AV1RateControlRTCBatch::Save(int stream) {
+  AV1_COMP *const cpi = rc_->cpi_;
+  const uint8_t *const p_rc = reinterpret_cast<uint8_t *>(&cpi->ppi->p_rc);
+  Streams &s = *streams_;
+  s.rc[stream] = cpi->rc;
+  memcpy(s.p_rc[stream].head, p_rc, sizeof(s.p_rc[stream].head));
+  memcpy(s.p_rc[stream].body, p_rc + kPrimaryRcBodyOffset,
+         sizeof(s.p_rc[stream].body));
+  s.svc[stream] = cpi->svc;
+  s.rtc_ref[stream] = cpi->ppi->rtc_ref;
+  TransferFrameState(false, cpi, &rc_->initial_width_, &rc_->initial_height_,
+                     &s.frame[stream]);
+}
+
+int AV1RateControlRTCBatch::AddStream(const AV1RateControlRtcConfig &rc_cfg) {
+  Streams &s = *streams_;
+  int stream = 0;
+  while (stream < static_cast<int>(s.in_use.size()) && s.in_use[stream])
+    ++stream;
+  if (stream == static_cast<int>(s.in_use.size())) {
+    s.oxcf.emplace_back();
+    s.rc.emplace_back();
+    s.p_rc.emplace_back();
+    s.svc.emplace_back();
+    s.rtc_ref.emplace_back();
+    s.frame.emplace_back();
+    s.in_use.push_back(false);
+  }
+  // Start from the zeroed state of a new AV1RateControlRTC.
+  s.oxcf[stream] = AV1EncoderConfig();
+  s.rc[stream] = RATE_CONTROL();
+  s.p_rc[stream] = PrimaryRcState();
+  s.svc[stream] = SVC();
+  s.rtc_ref[stream] = RTC_REF();
+  s.frame[stream] = FrameState();
+  if (loaded_stream_ >= 0) Save(loaded_stream_);
+  loaded_stream_ = -1;
+  Load(stream);
+  if (!rc_->InitRateControl(rc_cfg)) {
+    rc_->FreeBuffers();
+    loaded_stream_ = -1;
+    return -1;
+  }
+  s.oxcf[stream] = rc_->cpi_->oxcf;
+  s.in_use[stream] = true;
+  return stream;
+}
+
+bool AV1RateControlRTCBatch::RemoveStream(int stream) {
+  if (!IsValid(stream)) return false;
+  Load(stream);
+  rc_->FreeBuffers();
+  loaded_stream_ = -1;
+  streams_->in_use[stream] = false;
+  return true;
+}
+
+bool AV1RateControlRTCBatch::UpdateRateControl(
+    int stream, const AV1RateControlRtcConfig &rc_cfg) {
+  if (!IsValid(stream)) return false;
+  Load(stream);
+  const bool ok = rc_->UpdateRateControl(rc_cfg);
+  streams_->oxcf[stream] = rc_->cpi_->oxcf;
+  return ok;
+}
+
+bool AV1RateControlRTCBatch::ComputeQP(const int *streams,
+                                       const AV1FrameParamsRTC *frame_params,
+                                       size_t num_frames,
+                                       AV1FrameDecisionRTC *decisions) {
+  for (size_t i = 0; i < num_frames; ++i) {
+    if (!IsValid(streams[i])) return false;
+  }
+  for (size_t i = 0; i < num_frames; ++i) {
+    Load(streams[i]);
+    AV1FrameDecisionRTC *const decision = &decisions[i];
+    decision->drop_decision = rc_->ComputeQP(frame_params[i]);
+    if (decision->drop_decision == FrameDropDecision::kOk) {
+      decision->qp = rc_->GetQP();
+      decision->loopfilter_level = rc_->GetLoopfilterLevel();
+      decision->cdef_info = rc_->GetCdefInfo();
+    }
+  }
+  return true;
+}
+
+bool AV1RateControlRTCBatch::PostEncodeUpdate(
+    const int *streams, const uint64_t *encoded_frame_sizes,
+    size_t num_frames) {
+  for (size_t i = 0; i < num_frames; ++i) {
+    if (!IsValid(streams[i])) return false;
+  }
+  for (size_t i = 0; i < num_frames; ++i) {
+    Load(streams[i]);
+    rc_->PostEncodeUpdate(encoded_frame_sizes[i]);
+  }
+  return true;
+}
+
+bool AV1RateControlRTCBatch::GetSegmentationData(
+    int stream, AV1SegmentationData *segmentation_data) {
+  if (!IsValid(stream)) return false;
+  Load(stream);
+  return rc_->GetSegmentationData(segmentation_data);
+}
+
 }  // namespace aom
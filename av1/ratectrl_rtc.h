@@ -12,6 +12,7 @@
 #ifndef AOM_AV1_RATECTRL_RTC_H_
 #define AOM_AV1_RATECTRL_RTC_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
@@ -91,6 +92,17 @@ enum class FrameDropDecision {
   kDrop,  // Frame is dropped.
 };
 
+// Decisions of AV1RateControlRTCBatch::ComputeQP() for one frame. qp,
+// loopfilter_level and cdef_info are only set when the frame is not dropped,
+// to the values of AV1RateControlRTC::GetQP(), GetLoopfilterLevel() and
+// GetCdefInfo().
+struct AV1FrameDecisionRTC {
+  FrameDropDecision drop_decision;
+  int qp;
+  AV1LoopfilterLevel loopfilter_level;
+  AV1CdefInfo cdef_info;
+};
+
 class AV1RateControlRTC {
  public:
   static std::unique_ptr<AV1RateControlRTC> Create(
@@ -115,13 +127,63 @@ class AV1RateControlRTC {
   void PostEncodeUpdate(uint64_t encoded_frame_size);
 
  private:
+  friend class AV1RateControlRTCBatch;
+
   AV1RateControlRTC() = default;
   bool InitRateControl(const AV1RateControlRtcConfig &cfg);
+  // Frees the layer contexts and the cyclic refresh buffers.
+  void FreeBuffers();
   AV1_COMP *cpi_;
   int initial_width_;
   int initial_height_;
 };
 
+// Rate control of many streams, making the same decisions as one
+// AV1RateControlRTC per stream. Only the rate control state of each stream is
+// kept, in arrays indexed by stream, and the frames of all the streams are
+// processed with a single encoder instance: a stream takes a few kilobytes
+// instead of the ~750 kilobytes of an AV1RateControlRTC, plus the layer
+// contexts of SVC streams. An instance must only be used by one thread at a
+// time; use one instance per thread to spread the streams over threads.
+class AV1RateControlRTCBatch {
+ public:
+  static std::unique_ptr<AV1RateControlRTCBatch> Create();
+  ~AV1RateControlRTCBatch();
+
+  // Adds a stream and returns its index, or -1 on error. The index of a
+  // removed stream is reused by the next stream added.
+  int AddStream(const AV1RateControlRtcConfig &rc_cfg);
+  bool RemoveStream(int stream);
+  bool UpdateRateControl(int stream, const AV1RateControlRtcConfig &rc_cfg);
+  // Makes the decisions of num_frames frames, the i-th frame being from
+  // streams[i], as AV1RateControlRTC::ComputeQP() would on each frame in
+  // order. A stream must not appear twice without a PostEncodeUpdate() in
+  // between. Returns false, and does nothing, if a stream index is invalid.
+  bool ComputeQP(const int *streams, const AV1FrameParamsRTC *frame_params,
+                 size_t num_frames, AV1FrameDecisionRTC *decisions);
+  // Feedback to rate control with the sizes of the encoded frames which were
+  // not dropped, the i-th frame being from streams[i].
+  bool PostEncodeUpdate(const int *streams,
+                        const uint64_t *encoded_frame_sizes, size_t num_frames);
+  // Returns the segmentation data of the last frame of stream, which is valid
+  // until its next ComputeQP().
+  bool GetSegmentationData(int stream, AV1SegmentationData *segmentation_data);
+
+ private:
+  struct Streams;
+
+  AV1RateControlRTCBatch() = default;
+  bool IsValid(int stream) const;
+  // Moves the state of stream to the encoder instance, saving the state of
+  // the stream it held.
+  void Load(int stream);
+  void Save(int stream);
+  // Encoder instance running the rate control of the loaded stream.
+  std::unique_ptr<AV1RateControlRTC> rc_;
+  std::unique_ptr<Streams> streams_;
+  int loaded_stream_ = -1;
+};
+
 }  // namespace aom
 
 #endif  // AOM_AV1_RATECTRL_RTC_H_
@@ -159,6 +159,9 @@ set_aom_config_var(
 set_aom_config_var(CONFIG_SPEED_STATS 0 "AV1 experiment.")
 set_aom_config_var(CONFIG_TFLITE 0
                    "AV1 experiment: Enable tensorflow lite library.")
+set_aom_config_var(
+  CONFIG_THREAD_TRACE 0
+  "AV1 experiment: Write a Chrome trace of the worker thread activity.")
 set_aom_config_var(CONFIG_THREE_PASS 0
                    "AV1 experiment: Enable three-pass encoding.")
 set_aom_config_var(CONFIG_OUTPUT_FRAME_SIZE 0
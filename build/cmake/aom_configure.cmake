@@ -478,6 +478,16 @@ foreach(NUM RANGE ${AOM_RTCD_CUSTOM_COMMAND_COUNT})
       --sym=${AOM_RTCD_SYMBOL} ${AOM_RTCD_FLAGS}
       --config=${AOM_CONFIG_DIR}/config/aom_config.h ${AOM_RTCD_CONFIG_FILE}
     OUTPUT_FILE ${AOM_RTCD_HEADER_FILE})
+  if(ENABLE_TESTS)
+    # The function table of test_rtcd_speed.
+    execute_process(
+      COMMAND
+        ${PERL_EXECUTABLE} "${AOM_ROOT}/build/cmake/rtcd.pl"
+        --arch=${AOM_TARGET_CPU}
+        --sym=${AOM_RTCD_SYMBOL} ${AOM_RTCD_FLAGS} --bench
+        --config=${AOM_CONFIG_DIR}/config/aom_config.h ${AOM_RTCD_CONFIG_FILE}
+      OUTPUT_FILE "${AOM_CONFIG_DIR}/config/${AOM_RTCD_SYMBOL}_bench.inc")
+  endif()
 endforeach()
 
 # Generate aom_version.h.
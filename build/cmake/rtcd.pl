@@ -37,6 +37,7 @@ GetOptions(
   'arch=s',
   'sym=s',
   'config=s',
+  'bench',
 );
 
 foreach my $opt (qw/arch config/) {
@@ -374,6 +375,271 @@ EOF
   common_bottom;
 }
 
+#
+# Benchmark table generation
+#
+
+# Returns the C expression of a buffer of the benchmark holding elements of
+# type $base, or undef if the type is not supported. $pool_count counts the
+# buffers used by the function so far.
+sub bench_buffer {
+  my ($fn, $base, $name, $has_u16, $pool_count) = @_;
+  my ($pool, $type);
+  return "a->filter"
+    if $base eq "int16_t" && $name =~ /^(filter_[xy]|x_filters)$/;
+  return "a->scan" if $base eq "int16_t" && $name eq "scan";
+  return "a->iscan" if $base eq "int16_t" && $name eq "iscan";
+  return "a->$1" if $base eq "int16_t" &&
+                    $name =~ /^(zbin|round|quant|quant_shift|dequant)_ptr$/;
+  return "NULL" if $base eq "qm_val_t";
+  return "a->warp_mat" if $base eq "int32_t" && $name eq "mat";
+  return "a->kernels" if $base eq "InterpKernel";
+  if ($base eq "InterpFilterParams") {
+    return $fn =~ /intrabc/ ? "&av1_intrabc_filter_params" :
+                              "a->filter_params";
+  }
+  if ($base eq "ConvolveParams") {
+    # The distance weighted and the d16 functions take the intermediate
+    # buffer of a compound prediction.
+    return $fn =~ /dist_wtd|d16/ ? "a->compound_params" : "a->conv_params";
+  }
+  return "a->wiener_params" if $base eq "WienerConvolveParams";
+  return "a->jcp_param" if $base eq "DIST_WTD_COMP_PARAMS";
+  return "a->txfm_param" if $base eq "TxfmParam";
+  if ($base =~ /^(struct yv12_buffer_config|YV12_BUFFER_CONFIG)$/) {
+    my $k = $pool_count->{frames}++;
+    return if $k >= 2;
+    return "a->frames[$k]";
+  }
+  $base = "uint8_t" if $base eq "void" && $name eq "dst8";
+  $base = "uint16_t" if $base eq "void" && $name eq "dst16";
+  $base = "uint16_t" if $base eq "CONV_BUF_TYPE";
+  if ($base eq "uint8_t" || $base eq "unsigned char") {
+    # Blending masks hold weights up to 64.
+    return "a->mask" if $name =~ /^(msk|mask|m)$/;
+    # The high bitdepth functions without uint16_t pointers pass the pixels as
+    # uint8_t pointers made by CONVERT_TO_BYTEPTR().
+    if ($fn =~ /highbd|_u16$/ && !$has_u16) {
+      my $k = $pool_count->{pix16}++;
+      return if $k >= 8;
+      return "CONVERT_TO_BYTEPTR((uint16_t *)a->pix16[$k])";
+    }
+    ($pool, $type) = ("pix8", "uint8_t");
+  } elsif ($base eq "uint16_t") {
+    ($pool, $type) = ("pix16", "uint16_t");
+  } elsif ($base eq "int16_t") {
+    ($pool, $type) = ("coeff16", "int16_t");
+  } elsif ($base eq "int32_t" || $base eq "tran_low_t") {
+    ($pool, $type) = ("coeff32", $base);
+  } elsif ($base =~ /^(int|unsigned|unsigned\ int|uint32_t|int64_t|uint64_t|
+                       int8_t|float|double)$/x) {
+    ($pool, $type) = ("out", $base);
+  } else {
+    return;
+  }
+  my $k = $pool_count->{$pool}++;
+  return if $k >= 8;
+  return "($type *)a->${pool}[$k]";
+}
+
+# Returns the C expression of a scalar argument of $fn, and sets the keys
+# sized, tx_sized and has_bd of %$info when it is the block size, the
+# transform size or the bit depth. Returns undef if the argument is not
+# supported.
+sub bench_scalar {
+  my ($fn, $base, $name, $info) = @_;
+  return "DCT_DCT" if $base eq "TX_TYPE";
+  return "TX_CLASS_2D" if $base eq "TX_CLASS";
+  return "DIFFWTD_38" if $base eq "DIFFWTD_MASK_TYPE";
+  return "EIGHTTAP_REGULAR" if $base eq "InterpFilter";
+  if ($base eq "TX_SIZE") {
+    $info->{tx_sized} = 1;
+    return "a->tx_size";
+  }
+  return if $base !~ /^(int|unsigned|unsigned\ int|uint16_t|uint32_t|int16_t|
+                        int32_t|int64_t|ptrdiff_t|intptr_t)$/x;
+
+  # The CDEF filters work on 8x8 blocks. The warp filter and the optical flow
+  # work on 8x8 blocks of a 64x64 frame.
+  return "8" if $fn =~ /^cdef_/ && $name =~ /^block_(width|height)$/;
+  return "64"
+    if $fn =~ /warp_affine|flow_at_point/ && $name =~ /^(width|height)$/;
+  return "8" if $name =~ /^p_(width|height)$/;
+
+  if ($name =~ /stride|pitch/ || $name =~ /^[a-z]?p$/) {
+    return "a->stride";
+  } elsif ($name =~ /^(bd|bit_depth|bps)$/) {
+    $info->{has_bd} = 1;
+    return "a->bd";
+  } elsif ($name =~ /^(w|bw|width|block_width|cols|source_width|dest_width)$/) {
+    $info->{sized} = 1;
+    return "a->w";
+  } elsif ($name =~ /^(h|bh|height|block_height|rows)$/) {
+    $info->{sized} = 1;
+    return "a->h";
+  } elsif ($name =~ /^(n_coeffs|block_size|length|eob)$/) {
+    $info->{tx_sized} = 1;
+    return "a->n_coeffs";
+  } elsif ($name eq "log_scale") {
+    $info->{tx_sized} = 1;
+    return "a->log_scale";
+  } elsif ($name =~ /^(N|n|size)$/) {
+    $info->{sized} = 1;
+    return "a->w * a->h";
+  } elsif ($name eq "sz") {
+    # The edges are upsampled for blocks up to 16 pixels.
+    return "16" if $fn =~ /upsample/;
+    $info->{sized} = 1;
+    return "a->w";
+  } elsif ($name eq "bwl") {
+    $info->{sized} = 1;
+    return "get_msb(a->w) - 2";
+  } elsif ($name =~ /^([xy]_?offset|[xy]0_q4|subpel_[xy]_qn)$/) {
+    # The intra block copy filters only take half pixel positions.
+    return $fn =~ /intrabc/ ? "8" : "a->subpel";
+  } elsif ($name =~ /^[xy]_step_q4$/) {
+    return "16";
+  } elsif ($name =~ /^[xy]_step_qn$/) {
+    return $fn =~ /_rs$/ ? "1 << RS_SCALE_SUBPEL_BITS" : "SCALE_SUBPEL_SHIFTS";
+  } elsif ($name =~ /^(hend\d?|vend\d?|v_end)$/) {
+    # The chroma planes of the 4:2:0 frames are half the size.
+    my $size = $name =~ /^h/ ? "kFrameWidth" : "kFrameHeight";
+    return $fn =~ /_[uv]$/ ? "$size / 2" : $size;
+  } elsif ($name eq "num_planes") {
+    return "MAX_MB_PLANE";
+  } elsif ($name eq "k") {
+    return "PALETTE_MAX_SIZE";
+  } elsif ($name =~ /^(pri_strength|norm_factor)$/) {
+    return "4";
+  } elsif ($name =~ /^(sec_strength|dir|strength|bit)$/) {
+    return "2";
+  } elsif ($name =~ /^(pri|sec)_damping$/) {
+    return "5";
+  } elsif ($name =~ /^d[xy]$/) {
+    return "64";
+  } elsif ($name eq "edge_thresh") {
+    return "50";
+  } elsif ($name =~ /^([xy]\d?|[xy]16_idx|[hv]start\d?|v_start|p_col|p_row|
+                       plane|phase|mode|subsampling_[xy]|sub[wh]|invert_mask|
+                       upsample_(above|left)|coeff_shift|x0_qn|alpha|beta|
+                       gamma|delta|limit)$/x) {
+    return "0";
+  }
+  return;
+}
+
+# Returns the local declarations and the argument list the benchmark calls $fn
+# with, and a hash telling whether the block size, the transform size and the
+# bit depth are arguments. Returns an empty list if some argument cannot be
+# made up.
+sub bench_call {
+  my ($fn, $args) = @_;
+  my $has_u16 = $args =~ /uint16_t\s*\*/;
+  my %pool_count = ();
+  my %info = ();
+  my ($decls, @exprs) = ("");
+  foreach my $arg (split /,/, $args) {
+    $arg =~ s/^\s+|\s+$//g;
+    my $size = 0;
+    if ($arg =~ s/\s*\[\s*(\d*)\s*\]$//) {
+      return () if $1 eq "";
+      $size = $1;
+    }
+    # Unnamed arguments are only supported for pointers.
+    my $name = $arg =~ s/(\w+)$// ? $1 : "";
+    my $ptr = ($arg =~ tr/*//);
+    my $const_elem = $arg =~ /\bconst\b[^*]*\*/;
+    $arg =~ s/\*|\bconst\b//g;
+    $arg =~ s/^\s+|\s+$//g;
+    $arg =~ s/\s+/ /g;
+    my $base = $arg;
+    return () if $base eq "" || $ptr > 1;
+    if ($ptr == 0 && $size == 0) {
+      my $expr = bench_scalar($fn, $base, $name, \%info);
+      return () if !defined $expr;
+      push @exprs, $expr;
+    } elsif ($ptr == 1 && $size > 0) {
+      # An array of pointers, to nearby positions of one buffer.
+      my $buf = bench_buffer($fn, $base, $name, $has_u16, \%pool_count);
+      return () if !defined $buf;
+      my $type = $buf =~ /^CONVERT/ ? "uint8_t" : $base;
+      my @ptrs = map { $_ ? "$buf + $_" : $buf } (0 .. $size - 1);
+      my $local = "arg" . scalar(@exprs);
+      $type = "const $type" if $const_elem && $buf !~ /^CONVERT/;
+      $decls .= "  $type *$local\[$size\] = { " . join(", ", @ptrs) .
+                " };\n";
+      push @exprs, $local;
+    } else {
+      my $buf = bench_buffer($fn, $base, $name, $has_u16, \%pool_count);
+      return () if !defined $buf;
+      $info{tx_sized} = 1 if $buf =~ /txfm_param|scan/;
+      $info{frames} = 1 if $buf =~ /frames/;
+      push @exprs, $buf;
+    }
+  }
+  return ($decls, join(", ", @exprs), \%info);
+}
+
+# Prototypes with no C version in the tree, which cannot be linked.
+my %bench_undefined = map { $_ => 1 } qw/
+  av1_highbd_convolve8 av1_highbd_convolve8_horiz av1_highbd_convolve8_vert
+  av1_highbd_convolve_avg av1_highbd_convolve_copy av1_quantize_b
+/;
+
+# Writes the table of all the specializations of the functions, read by
+# test/rtcd_speed.cc. The functions with arguments the benchmark cannot make
+# up are listed as unsupported.
+sub bench() {
+  my @entries;
+  my @unsupported;
+  print "// This file is generated. Do not edit.\n\n";
+  foreach my $fn (sort keys %ALL_FUNCS) {
+    my @val = @{$ALL_FUNCS{$fn}};
+    my $args = pop @val;
+    my $rtyp = "@val";
+    my ($decls, $call, $info) = bench_call($fn, $args);
+    if (!defined $call || $bench_undefined{$fn}) {
+      push @unsupported, $fn;
+      next;
+    }
+    print <<EOF;
+static void ${fn}_bench(RtcdBenchFn fn, const RtcdBenchArgs *a) {
+  typedef $rtyp (*fn_t)($args);
+$decls  ((fn_t)fn)($call);
+}
+
+
+EOF
+    my ($w, $h) = $fn =~ /(?<!\d)(\d+)x(\d+)/ ? ($1, $2) : (0, 0);
+    ($w, $h) = (8, 8) if $fn =~ /^cdef_|warp_affine|flow_at_point/;
+    ($w, $h) = ("kFrameWidth", "kFrameHeight") if $info->{frames};
+    my $bd = $fn =~ /highbd_(8|10|12)_/ ? $1 : $fn =~ /highbd/ ? 10 : 8;
+    my @flags;
+    # The transform size follows the block size, when it is not in the name.
+    push @flags, "RTCD_BENCH_SIZE_ARGS"
+      if $info->{sized} || ($info->{tx_sized} && !$w);
+    push @flags, "RTCD_BENCH_BIT_DEPTH_ARG" if $info->{has_bd};
+    # The vector variance and the wedge functions take at least 16 pixels
+    # per row, and the filter intra predictor at most 32x32 blocks.
+    push @flags, "RTCD_BENCH_MIN_SIZE_16" if $fn =~ /vector_var|wedge/;
+    push @flags, "RTCD_BENCH_MAX_SIZE_32" if $fn =~ /filter_intra_predictor/;
+    my $flags = @flags ? join(" | ", @flags) : "0";
+    foreach my $opt ("c", @ALL_ARCHS) {
+      my $ofn = eval "\$${fn}_${opt}";
+      next if !$ofn;
+      my $caps = $opt eq "c" ? "0" : "HAS_" . uc($opt);
+      push @entries, "  { \"$fn\", \"$opt\", $caps, (RtcdBenchFn)$ofn, " .
+                     "${fn}_bench, $w, $h, $bd, $flags },\n";
+    }
+  }
+  print "static const RtcdBenchEntry $opts{sym}_bench_entries[] = {\n";
+  print @entries;
+  print "  { NULL, NULL, 0, NULL, NULL, 0, 0, 0, 0 }\n};\n\n";
+  print "static const char *const $opts{sym}_bench_unsupported[] = {\n";
+  print map { "  \"$_\",\n" } @unsupported;
+  print "  NULL\n};\n";
+}
+
 #
 # Main Driver
 #
@@ -382,25 +648,25 @@ EOF
 &require(keys %required);
 if ($opts{arch} eq 'x86') {
   @ALL_ARCHS = filter(qw/mmx sse sse2 sse3 ssse3 sse4_1 sse4_2 avx avx2/);
-  x86;
+  $opts{bench} ? bench : x86;
 } elsif ($opts{arch} eq 'x86_64') {
   @ALL_ARCHS = filter(qw/mmx sse sse2 sse3 ssse3 sse4_1 sse4_2 avx avx2/);
   @REQUIRES = filter(qw/mmx sse sse2/);
   &require(@REQUIRES);
-  x86;
+  $opts{bench} ? bench : x86;
 } elsif ($opts{arch} =~ /armv[78]\w?/) {
   @ALL_ARCHS = filter(qw/neon/);
-  arm;
+  $opts{bench} ? bench : arm;
 } elsif ($opts{arch} eq 'arm64' ) {
   @ALL_ARCHS = filter(qw/neon arm_crc32 neon_dotprod neon_i8mm sve/);
   @REQUIRES = filter(qw/neon/);
   &require(@REQUIRES);
-  arm;
+  $opts{bench} ? bench : arm;
 } elsif ($opts{arch} eq 'ppc') {
   @ALL_ARCHS = filter(qw/vsx/);
-  ppc;
+  $opts{bench} ? bench : ppc;
 } else {
-  unoptimized;
+  $opts{bench} ? bench : unoptimized;
 }
 
 __END__
@@ -427,4 +693,6 @@ Options:
   --disable-EXT     Disable support for EXT extensions
   --require-EXT     Require support for EXT extensions
   --sym=SYMBOL      Unique symbol to use for RTCD initialization function
+  --bench           Generate the benchmark table of test/rtcd_speed.cc
+                    instead of the header
   --config=FILE     Path to file containing C preprocessor directives to parse
@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// Enable POSIX extensions in glibc so that we can call fileno() and
+// posix_madvise(). This must be before any #include statements.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "common/mmapdec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#elif CONFIG_OS_SUPPORT
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "aom/aom_integer.h"
+#include "aom_ports/mem_ops.h"
+#include "av1/common/obu_util.h"
+
+#define MMAPDEC_MAX_FRAME_SIZE (256 * 1024 * 1024)
+
+static int map_file(struct MmapDecInputContext *mmap_ctx, FILE *file) {
+#if defined(_WIN32)
+  const HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+  LARGE_INTEGER size;
+  if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &size) ||
+      size.QuadPart <= 0 || (uint64_t)size.QuadPart > SIZE_MAX) {
+    return 0;
+  }
+  const HANDLE mapping =
+      CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL) return 0;
+  const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == NULL) {
+    CloseHandle(mapping);
+    return 0;
+  }
+  mmap_ctx->mapping = mapping;
+  mmap_ctx->data = (const uint8_t *)data;
+  mmap_ctx->data_size = (size_t)size.QuadPart;
+  return 1;
+#elif CONFIG_OS_SUPPORT
+  const int fd = fileno(file);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+      st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX) {
+    return 0;
+  }
+  void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) return 0;
+#if defined(POSIX_MADV_SEQUENTIAL)
+  // Frames are normally consumed in order; let the kernel read ahead.
+  posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+  mmap_ctx->data = (const uint8_t *)data;
+  mmap_ctx->data_size = (size_t)st.st_size;
+  return 1;
+#else
+  (void)mmap_ctx;
+  (void)file;
+  return 0;
+#endif
+}
+
+static void unmap_file(struct MmapDecInputContext *mmap_ctx) {
+  if (!mmap_ctx->data) return;
+#if defined(_WIN32)
+  UnmapViewOfFile(mmap_ctx->data);
+  CloseHandle((HANDLE)mmap_ctx->mapping);
+  mmap_ctx->mapping = NULL;
+#elif CONFIG_OS_SUPPORT
+  munmap((void *)mmap_ctx->data, mmap_ctx->data_size);
+#endif
+  mmap_ctx->data = NULL;
+  mmap_ctx->data_size = 0;
+}
+
+// Appends a frame to the index, doubling its capacity as needed. Returns 0 on
+// success.
+static int add_frame(struct MmapDecInputContext *mmap_ctx, size_t *capacity,
+                     size_t offset, size_t size, aom_codec_pts_t pts) {
+  if (mmap_ctx->num_frames == *capacity) {
+    const size_t new_capacity = *capacity ? 2 * *capacity : 256;
+    struct MmapDecFrame *const new_frames = (struct MmapDecFrame *)realloc(
+        mmap_ctx->frames, new_capacity * sizeof(*new_frames));
+    if (!new_frames) {
+      fprintf(stderr, "mmapdec: Failed to allocate frame index.\n");
+      return -1;
+    }
+    mmap_ctx->frames = new_frames;
+    *capacity = new_capacity;
+  }
+  struct MmapDecFrame *const frame = &mmap_ctx->frames[mmap_ctx->num_frames++];
+  frame->offset = offset;
+  frame->size = size;
+  frame->pts = pts;
+  frame->is_keyframe = 0;
+  return 0;
+}
+
+static int index_ivf(struct MmapDecInputContext *mmap_ctx) {
+  const uint8_t *const data = mmap_ctx->data;
+  const size_t data_size = mmap_ctx->data_size;
+  size_t capacity = 0;
+  size_t pos = IVF_FILE_HDR_SZ;
+
+  if (data_size < IVF_FILE_HDR_SZ) return -1;
+  while (data_size - pos >= IVF_FRAME_HDR_SZ) {
+    const size_t frame_size = mem_get_le32(data + pos);
+    aom_codec_pts_t pts = mem_get_le32(data + pos + 4);
+    pts += ((aom_codec_pts_t)mem_get_le32(data + pos + 8) << 32);
+    pos += IVF_FRAME_HDR_SZ;
+
+    if (frame_size > MMAPDEC_MAX_FRAME_SIZE) {
+      fprintf(stderr, "Warning: Read invalid frame size (%u)\n",
+              (unsigned int)frame_size);
+      break;
+    }
+    if (frame_size > data_size - pos) {
+      fprintf(stderr, "Warning: Failed to read full frame\n");
+      break;
+    }
+    if (add_frame(mmap_ctx, &capacity, pos, frame_size, pts)) return -1;
+    pos += frame_size;
+  }
+  return 0;
+}
+
+static int index_annexb(struct MmapDecInputContext *mmap_ctx) {
+  const uint8_t *const data = mmap_ctx->data;
+  const size_t data_size = mmap_ctx->data_size;
+  size_t capacity = 0;
+  size_t pos = 0;
+
+  while (pos < data_size) {
+    uint64_t tu_size = 0;
+    size_t length_of_tu_size = 0;
+    if (aom_uleb_decode(data + pos, data_size - pos, &tu_size,
+                        &length_of_tu_size) != 0) {
+      fprintf(stderr, "mmapdec: Failure reading temporal unit header\n");
+      return -1;
+    }
+    if (tu_size > data_size - pos - length_of_tu_size) {
+      fprintf(stderr, "mmapdec: Failed to read full temporal unit\n");
+      return -1;
+    }
+    const size_t size = length_of_tu_size + (size_t)tu_size;
+    if (add_frame(mmap_ctx, &capacity, pos, size, 0)) return -1;
+    pos += size;
+  }
+  return 0;
+}
+
+// Splits a Section 5 low overhead bitstream into temporal units. Each unit
+// runs up to the next temporal delimiter, so a leading sequence header is
+// part of the first one.
+static int index_section5(struct MmapDecInputContext *mmap_ctx) {
+  const uint8_t *const data = mmap_ctx->data;
+  const size_t data_size = mmap_ctx->data_size;
+  size_t capacity = 0;
+  size_t pos = 0;
+  size_t tu_start = 0;
+
+  while (pos < data_size) {
+    ObuHeader obu_header;
+    size_t header_size = 0;
+    memset(&obu_header, 0, sizeof(obu_header));
+    if (aom_read_obu_header((uint8_t *)data + pos, data_size - pos,
+                            &header_size, &obu_header,
+                            /*is_annexb=*/0) != AOM_CODEC_OK ||
+        !obu_header.has_size_field) {
+      fprintf(stderr, "mmapdec: Error parsing OBU header.\n");
+      return -1;
+    }
+
+    uint64_t payload_size = 0;
+    size_t length_of_payload_size = 0;
+    if (aom_uleb_decode(data + pos + header_size, data_size - pos - header_size,
+                        &payload_size, &length_of_payload_size) != 0) {
+      fprintf(stderr, "mmapdec: Failure reading OBU payload length.\n");
+      return -1;
+    }
+    const size_t obu_start = pos;
+    pos += header_size + length_of_payload_size;
+    if (payload_size > data_size - pos) {
+      fprintf(stderr, "mmapdec: Failure reading OBU payload.\n");
+      return -1;
+    }
+    pos += (size_t)payload_size;
+
+    if (obu_header.type == OBU_TEMPORAL_DELIMITER && obu_start > tu_start) {
+      if (add_frame(mmap_ctx, &capacity, tu_start, obu_start - tu_start, 0)) {
+        return -1;
+      }
+      tu_start = obu_start;
+    }
+  }
+  if (pos > tu_start &&
+      add_frame(mmap_ctx, &capacity, tu_start, pos - tu_start, 0)) {
+    return -1;
+  }
+  return 0;
+}
+
+int mmapdec_open(struct MmapDecInputContext *mmap_ctx, FILE *file,
+                 enum VideoFileType file_type, int is_annexb) {
+  memset(mmap_ctx, 0, sizeof(*mmap_ctx));
+  mmap_ctx->is_annexb = file_type == FILE_TYPE_OBU && is_annexb;
+  if (file_type != FILE_TYPE_IVF && file_type != FILE_TYPE_OBU) return 0;
+  if (!map_file(mmap_ctx, file)) return 0;
+
+  int status;
+  if (file_type == FILE_TYPE_IVF) {
+    status = index_ivf(mmap_ctx);
+  } else if (is_annexb) {
+    status = index_annexb(mmap_ctx);
+  } else {
+    status = index_section5(mmap_ctx);
+  }
+  if (status != 0) {
+    mmapdec_close(mmap_ctx);
+    return 0;
+  }
+  return 1;
+}
+
+int mmapdec_read_frame(struct MmapDecInputContext *mmap_ctx,
+                       const uint8_t **buffer, size_t *bytes_read,
+                       aom_codec_pts_t *pts) {
+  if (mmap_ctx->next_frame >= mmap_ctx->num_frames) return 1;
+
+  const struct MmapDecFrame *const frame =
+      &mmap_ctx->frames[mmap_ctx->next_frame++];
+  *buffer = mmap_ctx->data + frame->offset;
+  *bytes_read = frame->size;
+  if (pts) *pts = frame->pts;
+  return 0;
+}
+
+int mmapdec_seek(struct MmapDecInputContext *mmap_ctx, size_t frame_index) {
+  if (frame_index > mmap_ctx->num_frames) return 1;
+  mmap_ctx->next_frame = frame_index;
+  return 0;
+}
+
+// Returns 1 if the first frame header in the frame unit 'data' codes a key
+// frame that is shown right away. A forward key frame (show_frame = 0) is only
+// displayed later through show_existing_frame, and the frames coded in between
+// may still reference frames from before it, so it is not a random access
+// point.
+static int is_shown_key_frame(const uint8_t *data, size_t data_size,
+                              int is_annexb) {
+  int reduced_still_picture_hdr = 0;
+  while (data_size > 0) {
+    ObuHeader obu_header;
+    size_t payload_size = 0;
+    size_t bytes_read = 0;
+    memset(&obu_header, 0, sizeof(obu_header));
+    if (aom_read_obu_header_and_size(data, data_size, is_annexb, &obu_header,
+                                     &payload_size, &bytes_read) !=
+            AOM_CODEC_OK ||
+        payload_size > data_size - bytes_read) {
+      return 0;
+    }
+    data += bytes_read;
+    data_size -= bytes_read;
+    if (obu_header.type == OBU_SEQUENCE_HEADER) {
+      // seq_profile (3 bits), still_picture (1 bit),
+      // reduced_still_picture_header (1 bit).
+      if (payload_size < 1) return 0;
+      reduced_still_picture_hdr = (data[0] >> 3) & 1;
+    } else if (obu_header.type == OBU_FRAME_HEADER ||
+               obu_header.type == OBU_FRAME) {
+      if (reduced_still_picture_hdr) return 1;
+      if (payload_size < 1) return 0;
+      // show_existing_frame (1 bit), frame_type (2 bits), show_frame (1 bit).
+      const int show_existing_frame = data[0] >> 7;
+      const int is_key_frame = ((data[0] >> 5) & 3) == 0;  // KEY_FRAME
+      const int show_frame = (data[0] >> 4) & 1;
+      return !show_existing_frame && is_key_frame && show_frame;
+    }
+    data += payload_size;
+    data_size -= payload_size;
+  }
+  return 0;
+}
+
+int mmapdec_index_keyframes(struct MmapDecInputContext *mmap_ctx,
+                            aom_codec_iface_t *iface) {
+  if (mmap_ctx->keyframes_indexed) return 0;
+
+  for (size_t i = 0; i < mmap_ctx->num_frames; ++i) {
+    struct MmapDecFrame *const frame = &mmap_ctx->frames[i];
+    const uint8_t *data = mmap_ctx->data + frame->offset;
+    size_t data_size = frame->size;
+
+    if (mmap_ctx->is_annexb) {
+      // Skip the temporal_unit_size and the first frame_unit_size fields; the
+      // peek function expects the OBUs of a frame unit.
+      for (int j = 0; j < 2; ++j) {
+        uint64_t unit_size = 0;
+        size_t length_of_unit_size = 0;
+        if (aom_uleb_decode(data, data_size, &unit_size,
+                            &length_of_unit_size) != 0) {
+          return -1;
+        }
+        data += length_of_unit_size;
+        data_size -= length_of_unit_size;
+        if (j == 1 && unit_size < data_size) data_size = (size_t)unit_size;
+      }
+    }
+
+    aom_codec_stream_info_t si;
+    memset(&si, 0, sizeof(si));
+    si.is_annexb = mmap_ctx->is_annexb;
+    if (data_size > 0 &&
+        aom_codec_peek_stream_info(iface, data, data_size, &si) ==
+            AOM_CODEC_OK) {
+      frame->is_keyframe =
+          si.is_kf &&
+          is_shown_key_frame(data, data_size, mmap_ctx->is_annexb);
+    }
+  }
+  mmap_ctx->keyframes_indexed = 1;
+  return 0;
+}
+
+size_t mmapdec_find_keyframe(const struct MmapDecInputContext *mmap_ctx,
+                             size_t frame_index) {
+  if (mmap_ctx->num_frames == 0) return 0;
+  if (frame_index >= mmap_ctx->num_frames) {
+    frame_index = mmap_ctx->num_frames - 1;
+  }
+  for (size_t i = frame_index + 1; i > 0; --i) {
+    if (mmap_ctx->frames[i - 1].is_keyframe) return i - 1;
+  }
+  return 0;
+}
+
+void mmapdec_close(struct MmapDecInputContext *mmap_ctx) {
+  unmap_file(mmap_ctx);
+  free(mmap_ctx->frames);
+  mmap_ctx->frames = NULL;
+  mmap_ctx->num_frames = 0;
+  mmap_ctx->next_frame = 0;
+  mmap_ctx->keyframes_indexed = 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+#ifndef AOM_COMMON_MMAPDEC_H_
+#define AOM_COMMON_MMAPDEC_H_
+
+#include <stdio.h>
+
+#include "aom/aom_codec.h"
+#include "aom/aom_decoder.h"
+#include "common/tools_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Location of one IVF frame or one OBU temporal unit within the mapped file.
+// For Annex-B streams the temporal_unit_size prefix is part of the frame, as
+// it is for data returned by obudec_read_temporal_unit().
+struct MmapDecFrame {
+  size_t offset;
+  size_t size;
+  aom_codec_pts_t pts;
+  // Set by mmapdec_index_keyframes() when the frame is a random access point.
+  int is_keyframe;
+};
+
+struct MmapDecInputContext {
+  const uint8_t *data;
+  size_t data_size;
+  struct MmapDecFrame *frames;
+  size_t num_frames;
+  size_t next_frame;
+  int is_annexb;
+  int keyframes_indexed;
+#if defined(_WIN32)
+  void *mapping;
+#endif
+};
+
+// Maps the whole of 'file' into memory and builds an index of its frames.
+// 'file_type' must be FILE_TYPE_IVF or FILE_TYPE_OBU; 'is_annexb' selects
+// Annex-B framing for the latter. The position of 'file' is not used or
+// modified. Returns 1 on success and 0 when the file cannot be mapped (e.g.
+// it is a pipe) or indexed, in which case the caller should fall back to the
+// stdio based readers.
+int mmapdec_open(struct MmapDecInputContext *mmap_ctx, FILE *file,
+                 enum VideoFileType file_type, int is_annexb);
+
+// Returns the next frame as a pointer into the mapped file, without copying.
+// The pointer stays valid until mmapdec_close() is called. 'pts' may be NULL
+// and is only meaningful for IVF input. Returns 0 on success and 1 at the
+// end of the stream.
+int mmapdec_read_frame(struct MmapDecInputContext *mmap_ctx,
+                       const uint8_t **buffer, size_t *bytes_read,
+                       aom_codec_pts_t *pts);
+
+// Positions the reader so that the next call to mmapdec_read_frame() returns
+// the frame with index 'frame_index'. Returns 0 on success and 1 if the index
+// is greater than the number of frames in the stream.
+int mmapdec_seek(struct MmapDecInputContext *mmap_ctx, size_t frame_index);
+
+// Scans the frame headers of every indexed frame with
+// aom_codec_peek_stream_info() and marks the random access points, i.e. the
+// temporal units that carry a sequence header and a shown key frame. Forward
+// key frames, which are only shown later, are not random access points. No tile
+// data is decoded. The scan runs once and is cached in 'mmap_ctx'. Returns 0 on
+// success.
+int mmapdec_index_keyframes(struct MmapDecInputContext *mmap_ctx,
+                            aom_codec_iface_t *iface);
+
+// Returns the index of the last random access point at or before
+// 'frame_index', or 0 if there is none. mmapdec_index_keyframes() must have
+// been called first.
+size_t mmapdec_find_keyframe(const struct MmapDecInputContext *mmap_ctx,
+                             size_t frame_index);
+
+void mmapdec_close(struct MmapDecInputContext *mmap_ctx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  // AOM_COMMON_MMAPDEC_H_
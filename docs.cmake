@@ -29,6 +29,7 @@ set(AOM_DOXYGEN_SOURCES
     "${AOM_ROOT}/aom/aom_frame_buffer.h"
     "${AOM_ROOT}/aom/aom_image.h"
     "${AOM_ROOT}/aom/aom_integer.h"
+    "${AOM_ROOT}/aom/aom_mv_hints.h"
     "${AOM_ROOT}/av1/common/av1_common_int.h"
     "${AOM_ROOT}/av1/common/av1_loopfilter.h"
     "${AOM_ROOT}/av1/common/blockd.h"
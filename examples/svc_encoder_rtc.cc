@@ -32,7 +32,11 @@
 #include "common/video_writer.h"
 #include "examples/encoder_util.h"
 #include "aom_ports/aom_timer.h"
+#include "aom_util/aom_thread.h"
 #include "av1/ratectrl_rtc.h"
+#if CONFIG_LIBYUV
+#include "third_party/libyuv/include/libyuv/scale.h"
+#endif
 
 #define OPTION_BUFFER_SIZE 1024
 
@@ -48,6 +52,7 @@ typedef struct {
   int tune_content;
   int show_psnr;
   bool use_external_rc;
+  int parallel_streams;
 } AppInput;
 
 typedef enum {
@@ -105,6 +110,11 @@ static const arg_def_t psnr_arg =
     ARG_DEF(NULL, "psnr", -1, "Show PSNR in status line.");
 static const arg_def_t ext_rc_arg =
     ARG_DEF(NULL, "use-ext-rc", 0, "Use external rate control.");
+static const arg_def_t parallel_streams_arg =
+    ARG_DEF(NULL, "parallel-streams", 0,
+            "Encode each spatial layer as a separate stream, in parallel "
+            "(layering mode 11 only). The combined output file only holds "
+            "the top layer.");
 static const struct arg_enum_list tune_content_enum[] = {
   { "default", AOM_CONTENT_DEFAULT },
   { "screen", AOM_CONTENT_SCREEN },
@@ -134,7 +144,8 @@ static const arg_def_t *svc_args[] = {
 #endif
   &speed_arg,           &bitrates_arg,   &dropframe_thresh_arg,
   &error_resilient_arg, &output_obu_arg, &test_decode_arg,
-  &tune_content_arg,    &psnr_arg,       NULL,
+  &tune_content_arg,    &psnr_arg,       &parallel_streams_arg,
+  NULL,
 };
 
 #define zero(Dest) memset(&(Dest), 0, sizeof(Dest))
@@ -380,6 +391,8 @@ static void parse_command_line(int argc, const char **argv_,
       app_input->show_psnr = 1;
     } else if (arg_match(&arg, &ext_rc_arg, argi)) {
       app_input->use_external_rc = true;
+    } else if (arg_match(&arg, &parallel_streams_arg, argi)) {
+      app_input->parallel_streams = 1;
     } else {
       ++argj;
     }
@@ -1442,6 +1455,115 @@ static int qindex_to_quantizer(int qindex) {
   return 63;
 }
 
+// Sets the encoder controls shared by all the encoders of this example.
+static void set_encoder_controls(aom_codec_ctx_t *codec,
+                                 const AppInput &app_input,
+                                 const aom_codec_enc_cfg_t &cfg,
+                                 aom_svc_params_t *svc_params) {
+  aom_codec_control(codec, AOME_SET_CPUUSED, app_input.speed);
+  aom_codec_control(codec, AV1E_SET_AQ_MODE, app_input.aq_mode ? 3 : 0);
+  aom_codec_control(codec, AV1E_SET_GF_CBR_BOOST_PCT, 0);
+  aom_codec_control(codec, AV1E_SET_ENABLE_CDEF, 1);
+  aom_codec_control(codec, AV1E_SET_LOOPFILTER_CONTROL, 1);
+  aom_codec_control(codec, AV1E_SET_ENABLE_WARPED_MOTION, 0);
+  aom_codec_control(codec, AV1E_SET_ENABLE_OBMC, 0);
+  aom_codec_control(codec, AV1E_SET_ENABLE_GLOBAL_MOTION, 0);
+  aom_codec_control(codec, AV1E_SET_ENABLE_ORDER_HINT, 0);
+  aom_codec_control(codec, AV1E_SET_ENABLE_TPL_MODEL, 0);
+  aom_codec_control(codec, AV1E_SET_DELTAQ_MODE, 0);
+  aom_codec_control(codec, AV1E_SET_COEFF_COST_UPD_FREQ, 3);
+  aom_codec_control(codec, AV1E_SET_MODE_COST_UPD_FREQ, 3);
+  aom_codec_control(codec, AV1E_SET_MV_COST_UPD_FREQ, 3);
+  aom_codec_control(codec, AV1E_SET_DV_COST_UPD_FREQ, 3);
+  aom_codec_control(codec, AV1E_SET_CDF_UPDATE_MODE, 1);
+
+  // Settings to reduce key frame encoding time.
+  aom_codec_control(codec, AV1E_SET_ENABLE_CFL_INTRA, 0);
+  aom_codec_control(codec, AV1E_SET_ENABLE_SMOOTH_INTRA, 0);
+  aom_codec_control(codec, AV1E_SET_ENABLE_ANGLE_DELTA, 0);
+  aom_codec_control(codec, AV1E_SET_ENABLE_FILTER_INTRA, 0);
+  aom_codec_control(codec, AV1E_SET_INTRA_DEFAULT_TX_ONLY, 1);
+
+  if (cfg.g_threads > 1) {
+    aom_codec_control(codec, AV1E_SET_TILE_COLUMNS,
+                      (unsigned int)log2(cfg.g_threads));
+  }
+
+  aom_codec_control(codec, AV1E_SET_TUNE_CONTENT, app_input.tune_content);
+  if (app_input.tune_content == AOM_CONTENT_SCREEN) {
+    aom_codec_control(codec, AV1E_SET_ENABLE_PALETTE, 1);
+    aom_codec_control(codec, AV1E_SET_ENABLE_CFL_INTRA, 1);
+    // INTRABC is currently disabled for rt mode, as it's too slow.
+    aom_codec_control(codec, AV1E_SET_ENABLE_INTRABC, 0);
+  }
+
+  if (app_input.use_external_rc) {
+    aom_codec_control(codec, AV1E_SET_RTC_EXTERNAL_RC, 1);
+  }
+
+  aom_codec_control(codec, AV1E_SET_MAX_CONSEC_FRAME_DROP_CBR, INT_MAX);
+
+  aom_codec_control(codec, AV1E_SET_SVC_PARAMS, svc_params);
+  // TODO(aomedia:3032): Configure KSVC in fixed mode.
+
+  // This controls the maximum target size of the key frame.
+  // For generating smaller key frames, use a smaller max_intra_size_pct
+  // value, like 100 or 200.
+  {
+    const int max_intra_size_pct = 300;
+    aom_codec_control(codec, AOME_SET_MAX_INTRA_BITRATE_PCT,
+                      max_intra_size_pct);
+  }
+}
+
+// With --parallel-streams, each spatial layer of the simulcast mode is coded
+// as an independent stream by its own encoder, and the layers of a
+// superframe are encoded concurrently. The streams are written to the layer
+// output files; they are not combined into one stream with spatial ids.
+// Layering modes with inter-layer prediction are not supported, and the rows
+// of a layer are not overlapped with the encode of the layer below it.
+typedef struct {
+  aom_codec_ctx_t codec;
+  // The source scaled to the resolution of the layer.
+  aom_image_t img;
+  // The source of the next encode, or NULL to flush the encoder.
+  const aom_image_t *source;
+  aom_codec_pts_t pts;
+  // Time of the last encode.
+  int64_t cx_time;
+} LayerEncoder;
+
+// Scales the source to the resolution of the layer and encodes it.
+static int encode_layer_worker_hook(void *arg1, void *unused) {
+  LayerEncoder *const layer_encoder = static_cast<LayerEncoder *>(arg1);
+  (void)unused;
+  struct aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+  const aom_image_t *img = layer_encoder->source;
+  if (img != NULL && (img->d_w != layer_encoder->img.d_w ||
+                      img->d_h != layer_encoder->img.d_h)) {
+#if CONFIG_LIBYUV
+    aom_image_t *const scaled = &layer_encoder->img;
+    libyuv::I420Scale(
+        img->planes[AOM_PLANE_Y], img->stride[AOM_PLANE_Y],
+        img->planes[AOM_PLANE_U], img->stride[AOM_PLANE_U],
+        img->planes[AOM_PLANE_V], img->stride[AOM_PLANE_V], img->d_w, img->d_h,
+        scaled->planes[AOM_PLANE_Y], scaled->stride[AOM_PLANE_Y],
+        scaled->planes[AOM_PLANE_U], scaled->stride[AOM_PLANE_U],
+        scaled->planes[AOM_PLANE_V], scaled->stride[AOM_PLANE_V], scaled->d_w,
+        scaled->d_h, libyuv::kFilterBox);
+    img = scaled;
+#else
+    return 0;
+#endif
+  }
+  const aom_codec_err_t res =
+      aom_codec_encode(&layer_encoder->codec, img, layer_encoder->pts, 1, 0);
+  aom_usec_timer_mark(&timer);
+  layer_encoder->cx_time = aom_usec_timer_elapsed(&timer);
+  return res == AOM_CODEC_OK;
+}
+
 int main(int argc, const char **argv) {
   AppInput app_input;
   AvxVideoWriter *outfile[AOM_MAX_LAYERS] = { NULL };
@@ -1469,7 +1591,7 @@ int main(int argc, const char **argv) {
   }
 #endif
 #if CONFIG_AV1_DECODER
-  aom_codec_ctx_t decoder;
+  aom_codec_ctx_t decoders[AOM_MAX_SS_LAYERS];
 #endif
 
   struct RateControlMetrics rc;
@@ -1541,6 +1663,22 @@ int main(int argc, const char **argv) {
     }
   }
 
+  if (app_input.parallel_streams) {
+    // Only the spatial layers of the simulcast mode have no dependency on
+    // each other.
+    if (app_input.layering_mode != 11)
+      die("--parallel-streams requires layering mode 11.");
+    if (app_input.use_external_rc)
+      die("--parallel-streams does not support external rate control.");
+    if (cfg.g_input_bit_depth != 8 ||
+        (app_input.input_ctx.file_type == FILE_TYPE_Y4M &&
+         app_input.input_ctx.fmt != AOM_IMG_FMT_I420))
+      die("--parallel-streams requires 8-bit 4:2:0 input.");
+#if !CONFIG_LIBYUV
+    die("--parallel-streams requires libyuv to scale the source.");
+#endif
+  }
+
   // Y4M reader has its own allocation.
   if (app_input.input_ctx.file_type != FILE_TYPE_Y4M) {
     if (!aom_img_alloc(&raw, AOM_IMG_FMT_I420, width, height, 32)) {
@@ -1617,64 +1755,6 @@ int main(int argc, const char **argv) {
       die("Failed to open %s for writing", app_input.output_filename);
   }
 
-  // Initialize codec.
-  aom_codec_ctx_t codec;
-  aom_codec_flags_t flag = 0;
-  flag |= cfg.g_input_bit_depth == AOM_BITS_8 ? 0 : AOM_CODEC_USE_HIGHBITDEPTH;
-  flag |= app_input.show_psnr ? AOM_CODEC_USE_PSNR : 0;
-  if (aom_codec_enc_init(&codec, encoder, &cfg, flag))
-    die_codec(&codec, "Failed to initialize encoder");
-
-#if CONFIG_AV1_DECODER
-  if (app_input.decode) {
-    if (aom_codec_dec_init(&decoder, get_aom_decoder_by_index(0), NULL, 0))
-      die_codec(&decoder, "Failed to initialize decoder");
-  }
-#endif
-
-  aom_codec_control(&codec, AOME_SET_CPUUSED, app_input.speed);
-  aom_codec_control(&codec, AV1E_SET_AQ_MODE, app_input.aq_mode ? 3 : 0);
-  aom_codec_control(&codec, AV1E_SET_GF_CBR_BOOST_PCT, 0);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_CDEF, 1);
-  aom_codec_control(&codec, AV1E_SET_LOOPFILTER_CONTROL, 1);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_WARPED_MOTION, 0);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_OBMC, 0);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_GLOBAL_MOTION, 0);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_ORDER_HINT, 0);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_TPL_MODEL, 0);
-  aom_codec_control(&codec, AV1E_SET_DELTAQ_MODE, 0);
-  aom_codec_control(&codec, AV1E_SET_COEFF_COST_UPD_FREQ, 3);
-  aom_codec_control(&codec, AV1E_SET_MODE_COST_UPD_FREQ, 3);
-  aom_codec_control(&codec, AV1E_SET_MV_COST_UPD_FREQ, 3);
-  aom_codec_control(&codec, AV1E_SET_DV_COST_UPD_FREQ, 3);
-  aom_codec_control(&codec, AV1E_SET_CDF_UPDATE_MODE, 1);
-
-  // Settings to reduce key frame encoding time.
-  aom_codec_control(&codec, AV1E_SET_ENABLE_CFL_INTRA, 0);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_SMOOTH_INTRA, 0);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_ANGLE_DELTA, 0);
-  aom_codec_control(&codec, AV1E_SET_ENABLE_FILTER_INTRA, 0);
-  aom_codec_control(&codec, AV1E_SET_INTRA_DEFAULT_TX_ONLY, 1);
-
-  if (cfg.g_threads > 1) {
-    aom_codec_control(&codec, AV1E_SET_TILE_COLUMNS,
-                      (unsigned int)log2(cfg.g_threads));
-  }
-
-  aom_codec_control(&codec, AV1E_SET_TUNE_CONTENT, app_input.tune_content);
-  if (app_input.tune_content == AOM_CONTENT_SCREEN) {
-    aom_codec_control(&codec, AV1E_SET_ENABLE_PALETTE, 1);
-    aom_codec_control(&codec, AV1E_SET_ENABLE_CFL_INTRA, 1);
-    // INTRABC is currently disabled for rt mode, as it's too slow.
-    aom_codec_control(&codec, AV1E_SET_ENABLE_INTRABC, 0);
-  }
-
-  if (app_input.use_external_rc) {
-    aom_codec_control(&codec, AV1E_SET_RTC_EXTERNAL_RC, 1);
-  }
-
-  aom_codec_control(&codec, AV1E_SET_MAX_CONSEC_FRAME_DROP_CBR, INT_MAX);
-
   svc_params.number_spatial_layers = ss_number_layers;
   svc_params.number_temporal_layers = ts_number_layers;
   for (i = 0; i < ss_number_layers * ts_number_layers; ++i) {
@@ -1694,18 +1774,79 @@ int main(int argc, const char **argv) {
     svc_params.scaling_factor_num[1] = 1;
     svc_params.scaling_factor_den[1] = 2;
   }
-  aom_codec_control(&codec, AV1E_SET_SVC_PARAMS, &svc_params);
-  // TODO(aomedia:3032): Configure KSVC in fixed mode.
 
-  // This controls the maximum target size of the key frame.
-  // For generating smaller key frames, use a smaller max_intra_size_pct
-  // value, like 100 or 200.
-  {
-    const int max_intra_size_pct = 300;
-    aom_codec_control(&codec, AOME_SET_MAX_INTRA_BITRATE_PCT,
-                      max_intra_size_pct);
+  // Initialize codec.
+  aom_codec_ctx_t codec;
+  aom_codec_flags_t flag = 0;
+  flag |= cfg.g_input_bit_depth == AOM_BITS_8 ? 0 : AOM_CODEC_USE_HIGHBITDEPTH;
+  flag |= app_input.show_psnr ? AOM_CODEC_USE_PSNR : 0;
+  LayerEncoder layer_encoders[AOM_MAX_SS_LAYERS];
+  AVxWorker workers[AOM_MAX_SS_LAYERS];
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  if (app_input.parallel_streams) {
+    for (int sl = 0; sl < ss_number_layers; ++sl) {
+      // Each spatial layer is a single layer stream at the resolution of the
+      // layer, with the bitrates of its temporal layers.
+      LayerEncoder *const layer_encoder = &layer_encoders[sl];
+      aom_codec_enc_cfg_t layer_cfg = cfg;
+      layer_cfg.g_w = cfg.g_w * svc_params.scaling_factor_num[sl] /
+                      svc_params.scaling_factor_den[sl];
+      layer_cfg.g_h = cfg.g_h * svc_params.scaling_factor_num[sl] /
+                      svc_params.scaling_factor_den[sl];
+      // Make height and width even, as the encoder does for spatial layers.
+      layer_cfg.g_w += layer_cfg.g_w % 2;
+      layer_cfg.g_h += layer_cfg.g_h % 2;
+      layer_cfg.rc_target_bitrate =
+          svc_params.layer_target_bitrate[sl * ts_number_layers +
+                                          ts_number_layers - 1];
+      // The layers are encoded concurrently, so they share the threads. The
+      // larger upper layers get the remainder.
+      layer_cfg.g_threads = (cfg.g_threads + sl) / ss_number_layers;
+      if (layer_cfg.g_threads == 0) layer_cfg.g_threads = 1;
+      aom_svc_params_t layer_svc_params = svc_params;
+      layer_svc_params.number_spatial_layers = 1;
+      layer_svc_params.scaling_factor_num[0] = 1;
+      layer_svc_params.scaling_factor_den[0] = 1;
+      for (int tl = 0; tl < ts_number_layers; ++tl) {
+        layer_svc_params.layer_target_bitrate[tl] =
+            svc_params.layer_target_bitrate[sl * ts_number_layers + tl];
+      }
+      if (!aom_img_alloc(&layer_encoder->img, AOM_IMG_FMT_I420, layer_cfg.g_w,
+                         layer_cfg.g_h, 32)) {
+        die("Failed to allocate image (%dx%d)", layer_cfg.g_w, layer_cfg.g_h);
+      }
+      if (aom_codec_enc_init(&layer_encoder->codec, encoder, &layer_cfg, flag))
+        die_codec(&layer_encoder->codec, "Failed to initialize encoder");
+      set_encoder_controls(&layer_encoder->codec, app_input, layer_cfg,
+                           &layer_svc_params);
+      // The top layer is encoded on the main thread.
+      AVxWorker *const worker = &workers[sl];
+      winterface->init(worker);
+      worker->thread_name = "svc layer worker";
+      worker->hook = encode_layer_worker_hook;
+      worker->data1 = layer_encoder;
+      worker->data2 = NULL;
+      if (sl < ss_number_layers - 1 && !winterface->reset(worker))
+        die("Failed to create a worker thread");
+    }
+  } else {
+    if (aom_codec_enc_init(&codec, encoder, &cfg, flag))
+      die_codec(&codec, "Failed to initialize encoder");
+    set_encoder_controls(&codec, app_input, cfg, &svc_params);
   }
 
+#if CONFIG_AV1_DECODER
+  // The independent layer streams are decoded separately.
+  const int num_decoders = app_input.parallel_streams ? ss_number_layers : 1;
+  if (app_input.decode) {
+    for (i = 0; i < num_decoders; ++i) {
+      if (aom_codec_dec_init(&decoders[i], get_aom_decoder_by_index(0), NULL,
+                             0))
+        die_codec(&decoders[i], "Failed to initialize decoder");
+    }
+  }
+#endif
+
   for (int lx = 0; lx < ts_number_layers * ss_number_layers; lx++) {
     cx_time_layer[lx] = 0;
     frame_cnt_layer[lx] = 0;
@@ -1724,15 +1865,55 @@ int main(int argc, const char **argv) {
   while (frame_avail || got_data) {
     struct aom_usec_timer timer;
     frame_avail = read_frame(&(app_input.input_ctx), &raw);
+    if (app_input.parallel_streams) {
+      // All the layers follow the pattern of the base layer, in the buffer
+      // slots of the base layer, as each layer has its own encoder.
+      int is_key_frame = (frame_cnt % cfg.kf_max_dist) == 0;
+      set_layer_pattern(app_input.layering_mode, frame_cnt, &layer_id,
+                        &ref_frame_config, &ref_frame_comp_pred,
+                        &use_svc_control, 0, is_key_frame, 0, app_input.speed);
+      aom_usec_timer_start(&timer);
+      for (int slx = 0; slx < ss_number_layers; slx++) {
+        LayerEncoder *const layer_encoder = &layer_encoders[slx];
+        aom_codec_control(&layer_encoder->codec, AV1E_SET_SVC_LAYER_ID,
+                          &layer_id);
+        aom_codec_control(&layer_encoder->codec, AV1E_SET_SVC_REF_FRAME_CONFIG,
+                          &ref_frame_config);
+        aom_codec_control(&layer_encoder->codec,
+                          AV1E_SET_SVC_REF_FRAME_COMP_PRED,
+                          &ref_frame_comp_pred);
+        layer_encoder->source = frame_avail ? &raw : NULL;
+        layer_encoder->pts = pts;
+        if (slx < ss_number_layers - 1)
+          winterface->launch(&workers[slx]);
+        else
+          winterface->execute(&workers[slx]);
+      }
+      for (int slx = 0; slx < ss_number_layers; slx++) {
+        if (!winterface->sync(&workers[slx]))
+          die_codec(&layer_encoders[slx].codec, "Failed to encode frame");
+      }
+      aom_usec_timer_mark(&timer);
+      cx_time += aom_usec_timer_elapsed(&timer);
+    }
     // Loop over spatial layers.
     for (int slx = 0; slx < ss_number_layers; slx++) {
+      aom_codec_ctx_t *const layer_codec =
+          app_input.parallel_streams ? &layer_encoders[slx].codec : &codec;
+#if CONFIG_AV1_DECODER
+      aom_codec_ctx_t *const layer_decoder =
+          &decoders[app_input.parallel_streams ? slx : 0];
+#endif
       aom_codec_iter_t iter = NULL;
       const aom_codec_cx_pkt_t *pkt;
       int layer = 0;
       // Flag for superframe whose base is key.
       int is_key_frame = (frame_cnt % cfg.kf_max_dist) == 0;
-      // For flexible mode:
-      if (app_input.layering_mode >= 0) {
+      if (app_input.parallel_streams) {
+        // The layer was encoded above.
+        layer_id.spatial_layer_id = slx;
+      } else if (app_input.layering_mode >= 0) {
+        // For flexible mode:
         // Set the reference/update flags, layer_id, and reference_map
         // buffer index.
         set_layer_pattern(app_input.layering_mode, frame_cnt, &layer_id,
@@ -1872,12 +2053,16 @@ int main(int argc, const char **argv) {
       }
 
       // Do the layer encode.
-      aom_usec_timer_start(&timer);
-      if (aom_codec_encode(&codec, frame_avail ? &raw : NULL, pts, 1, flags))
-        die_codec(&codec, "Failed to encode frame");
-      aom_usec_timer_mark(&timer);
-      cx_time += aom_usec_timer_elapsed(&timer);
-      cx_time_layer[layer] += aom_usec_timer_elapsed(&timer);
+      if (app_input.parallel_streams) {
+        cx_time_layer[layer] += layer_encoders[slx].cx_time;
+      } else {
+        aom_usec_timer_start(&timer);
+        if (aom_codec_encode(&codec, frame_avail ? &raw : NULL, pts, 1, flags))
+          die_codec(&codec, "Failed to encode frame");
+        aom_usec_timer_mark(&timer);
+        cx_time += aom_usec_timer_elapsed(&timer);
+        cx_time_layer[layer] += aom_usec_timer_elapsed(&timer);
+      }
       frame_cnt_layer[layer] += 1;
 
       got_data = 0;
@@ -1885,7 +2070,7 @@ int main(int argc, const char **argv) {
       int ss_layers_write = (app_input.layering_mode == 11)
                                 ? layer_id.spatial_layer_id + 1
                                 : ss_number_layers;
-      while ((pkt = aom_codec_get_cx_data(&codec, &iter))) {
+      while ((pkt = aom_codec_get_cx_data(layer_codec, &iter))) {
         switch (pkt->kind) {
           case AOM_CODEC_CX_FRAME_PKT:
             for (int sl = layer_id.spatial_layer_id; sl < ss_layers_write;
@@ -1907,15 +2092,18 @@ int main(int argc, const char **argv) {
               }
             }
             got_data = 1;
-            // Write everything into the top layer.
-            if (app_input.output_obu) {
-              fwrite(pkt->data.frame.buf, 1, pkt->data.frame.sz,
-                     total_layer_obu_file);
-            } else {
-              aom_video_writer_write_frame(
-                  total_layer_file,
-                  reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
-                  pkt->data.frame.sz, pts);
+            // Write everything into the top layer. The independent streams of
+            // --parallel-streams cannot be mixed: only write the top one.
+            if (!app_input.parallel_streams || slx == ss_number_layers - 1) {
+              if (app_input.output_obu) {
+                fwrite(pkt->data.frame.buf, 1, pkt->data.frame.sz,
+                       total_layer_obu_file);
+              } else {
+                aom_video_writer_write_frame(
+                    total_layer_file,
+                    reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
+                    pkt->data.frame.sz, pts);
+              }
             }
             // Keep count of rate control stats per layer (for non-key).
             if (!(pkt->data.frame.flags & AOM_FRAME_IS_KEY)) {
@@ -1966,10 +2154,10 @@ int main(int argc, const char **argv) {
 #if CONFIG_AV1_DECODER
             if (app_input.decode) {
               if (aom_codec_decode(
-                      &decoder,
+                      layer_decoder,
                       reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
                       pkt->data.frame.sz, NULL))
-                die_codec(&decoder, "Failed to decode frame");
+                die_codec(layer_decoder, "Failed to decode frame");
             }
 #endif
 
@@ -1994,7 +2182,7 @@ int main(int argc, const char **argv) {
         if ((ss_number_layers > 1 || ts_number_layers > 1) &&
             !(layer_id.temporal_layer_id > 0 &&
               layer_id.temporal_layer_id == ts_number_layers - 1)) {
-          if (test_decode(&codec, &decoder, frame_cnt)) {
+          if (test_decode(layer_codec, layer_decoder, frame_cnt)) {
 #if CONFIG_INTERNAL_STATS
             fprintf(stats_file, "First mismatch occurred in frame %d\n",
                     frame_cnt);
@@ -2033,12 +2221,24 @@ int main(int argc, const char **argv) {
     show_psnr(&psnr_stream, 255.0);
   }
 
-  if (aom_codec_destroy(&codec)) die_codec(&codec, "Failed to destroy encoder");
+  if (app_input.parallel_streams) {
+    for (int sl = 0; sl < ss_number_layers; ++sl) {
+      winterface->end(&workers[sl]);
+      if (aom_codec_destroy(&layer_encoders[sl].codec))
+        die_codec(&layer_encoders[sl].codec, "Failed to destroy encoder");
+      aom_img_free(&layer_encoders[sl].img);
+    }
+  } else {
+    if (aom_codec_destroy(&codec))
+      die_codec(&codec, "Failed to destroy encoder");
+  }
 
 #if CONFIG_AV1_DECODER
   if (app_input.decode) {
-    if (aom_codec_destroy(&decoder))
-      die_codec(&decoder, "Failed to destroy decoder");
+    for (i = 0; i < num_decoders; ++i) {
+      if (aom_codec_destroy(&decoders[i]))
+        die_codec(&decoders[i], "Failed to destroy decoder");
+    }
   }
 #endif
 
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// Transrater
+// ==========
+//
+// This is an example of re-encoding an AV1 stream at a new quality level,
+// e.g. to regenerate the lower rungs of a bitrate ladder, reusing the motion
+// decisions of the source stream.
+//
+// Each frame is decoded, and its motion field is read from the decoder with
+// the AV1D_GET_MV_HINTS control. The field is passed to the encoder with
+// AV1E_SET_MV_HINTS together with the decoded frame, so that the encoder only
+// refines the source motion vectors in a small window instead of running its
+// full motion searches. Partitioning, mode decision, transform and
+// quantization are run as usual at the new quality level.
+//
+// Blocks without a hint, such as intra blocks, are searched as usual. Frames
+// whose motion field is not available (the source stream was coded without
+// reference frame motion vectors) are encoded without hints.
+//
+// Scope
+// -----
+// Only the motion vectors of the source are reused. Its partitioning,
+// prediction modes and reference frame choices are not: the encoder has no
+// path that codes a frame from externally supplied block decisions, and its
+// reference buffers and GOP structure need not match those of the source. A
+// transrater which re-runs only transform, quantization and entropy coding
+// would need such a path in av1/encoder, with a full search only where the
+// source decisions cost too much at the new quality level. Since the motion
+// searches are the largest part of the search time, the speedup here is
+// smaller than that of such a transrater, but the output is an ordinary
+// encode at the new quality level.
+//
+// Usage
+// -----
+// transrater <infile.ivf> <outfile.ivf> <cq-level> [<cpu-used>]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config/aom_config.h"
+
+#include "aom/aom_decoder.h"
+#include "aom/aom_encoder.h"
+#include "aom/aomcx.h"
+#include "aom/aomdx.h"
+#include "common/tools_common.h"
+#include "common/video_reader.h"
+#include "common/video_writer.h"
+
+// Block size of the motion field passed to the encoder.
+#define HINT_BLOCK_SIZE 16
+
+static const char *exec_name;
+
+void usage_exit(void) {
+  fprintf(stderr,
+          "Usage: %s <infile.ivf> <outfile.ivf> <cq-level> [<cpu-used>]\n",
+          exec_name);
+  exit(EXIT_FAILURE);
+}
+
+static int encode_frame(aom_codec_ctx_t *codec, aom_image_t *img,
+                        int frame_index, AvxVideoWriter *writer) {
+  int got_pkts = 0;
+  aom_codec_iter_t iter = NULL;
+  const aom_codec_cx_pkt_t *pkt = NULL;
+  const aom_codec_err_t res = aom_codec_encode(codec, img, frame_index, 1, 0);
+  if (res != AOM_CODEC_OK) die_codec(codec, "Failed to encode frame");
+
+  while ((pkt = aom_codec_get_cx_data(codec, &iter)) != NULL) {
+    got_pkts = 1;
+    if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
+      if (!aom_video_writer_write_frame(writer, pkt->data.frame.buf,
+                                        pkt->data.frame.sz,
+                                        pkt->data.frame.pts)) {
+        die_codec(codec, "Failed to write compressed frame");
+      }
+    }
+  }
+  return got_pkts;
+}
+
+static void init_encoder(aom_codec_ctx_t *encoder, const aom_image_t *img,
+                         const AvxVideoInfo *info, int cq_level,
+                         int cpu_used) {
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+#if CONFIG_REALTIME_ONLY
+  const unsigned int usage = AOM_USAGE_REALTIME;
+#else
+  const unsigned int usage = AOM_USAGE_GOOD_QUALITY;
+#endif
+  if (aom_codec_enc_config_default(iface, &cfg, usage))
+    die("Failed to get default codec config.");
+  cfg.g_w = img->d_w;
+  cfg.g_h = img->d_h;
+  cfg.g_timebase.num = info->time_base.numerator;
+  cfg.g_timebase.den = info->time_base.denominator;
+  cfg.rc_end_usage = AOM_Q;
+  aom_codec_flags_t flags = 0;
+  if (img->fmt & AOM_IMG_FMT_HIGHBITDEPTH) {
+    cfg.g_bit_depth = (aom_bit_depth_t)img->bit_depth;
+    cfg.g_input_bit_depth = img->bit_depth;
+    flags |= AOM_CODEC_USE_HIGHBITDEPTH;
+  }
+  if (aom_codec_enc_init(encoder, iface, &cfg, flags))
+    die("Failed to initialize encoder.");
+  if (aom_codec_control(encoder, AOME_SET_CPUUSED, cpu_used))
+    die_codec(encoder, "Failed to set cpu-used");
+  if (aom_codec_control(encoder, AOME_SET_CQ_LEVEL, cq_level))
+    die_codec(encoder, "Failed to set cq-level");
+}
+
+int main(int argc, char **argv) {
+  exec_name = argv[0];
+  if (argc != 4 && argc != 5) die("Invalid number of arguments.");
+
+  const int cq_level = (int)strtol(argv[3], NULL, 0);
+  const int cpu_used = argc == 5 ? (int)strtol(argv[4], NULL, 0) : 5;
+
+  AvxVideoReader *reader = aom_video_reader_open(argv[1]);
+  if (!reader) die("Failed to open %s for reading.", argv[1]);
+  const AvxVideoInfo *info = aom_video_reader_get_info(reader);
+  aom_codec_iface_t *decoder_iface =
+      get_aom_decoder_by_fourcc(info->codec_fourcc);
+  if (!decoder_iface) die("Unknown input codec.");
+
+  // The reader does not report the frame rate, frames are numbered at 30 fps.
+  AvxVideoInfo out_info = *info;
+  out_info.codec_fourcc = get_fourcc_by_aom_encoder(aom_codec_av1_cx());
+  out_info.time_base.numerator = 1;
+  out_info.time_base.denominator = 30;
+  AvxVideoWriter *writer =
+      aom_video_writer_open(argv[2], kContainerIVF, &out_info);
+  if (!writer) die("Failed to open %s for writing.", argv[2]);
+
+  aom_codec_ctx_t decoder;
+  aom_codec_dec_cfg_t dec_cfg = { 0, 0, 0, 1 };
+  if (aom_codec_dec_init(&decoder, decoder_iface, &dec_cfg, 0))
+    die("Failed to initialize decoder.");
+
+  aom_codec_ctx_t encoder;
+  int encoder_initialized = 0;
+  aom_mv_hint_t *hints = NULL;
+  int frame_count = 0;
+  int hinted_frame_count = 0;
+
+  while (aom_video_reader_read_frame(reader)) {
+    size_t frame_size = 0;
+    const unsigned char *frame =
+        aom_video_reader_get_frame(reader, &frame_size);
+    if (aom_codec_decode(&decoder, frame, frame_size, NULL))
+      die_codec(&decoder, "Failed to decode frame.");
+
+    aom_codec_iter_t iter = NULL;
+    aom_image_t *img;
+    while ((img = aom_codec_get_frame(&decoder, &iter)) != NULL) {
+      if (!encoder_initialized) {
+        init_encoder(&encoder, img, &out_info, cq_level, cpu_used);
+        encoder_initialized = 1;
+        hints = (aom_mv_hint_t *)malloc(
+            sizeof(*hints) * ((img->d_w + HINT_BLOCK_SIZE - 1) /
+                              HINT_BLOCK_SIZE) *
+            ((img->d_h + HINT_BLOCK_SIZE - 1) / HINT_BLOCK_SIZE));
+        if (!hints) die("Failed to allocate motion vector hints.");
+      }
+
+      aom_mv_hint_map_t map;
+      map.hints = hints;
+      map.block_size = HINT_BLOCK_SIZE;
+      map.rows = (img->d_h + HINT_BLOCK_SIZE - 1) / HINT_BLOCK_SIZE;
+      map.cols = (img->d_w + HINT_BLOCK_SIZE - 1) / HINT_BLOCK_SIZE;
+      map.search_range = 0;
+      // Frames without a motion field are searched as usual.
+      const int has_hints =
+          aom_codec_control(&decoder, AV1D_GET_MV_HINTS, &map) == AOM_CODEC_OK;
+      if (aom_codec_control(&encoder, AV1E_SET_MV_HINTS,
+                            has_hints ? &map : NULL))
+        die_codec(&encoder, "Failed to set motion vector hints");
+      hinted_frame_count += has_hints;
+      encode_frame(&encoder, img, frame_count++, writer);
+    }
+  }
+
+  if (encoder_initialized) {
+    // Flush encoder.
+    while (encode_frame(&encoder, NULL, -1, writer)) continue;
+    if (aom_codec_destroy(&encoder))
+      die_codec(&encoder, "Failed to destroy encoder.");
+  }
+  free(hints);
+
+  printf("Processed %d frames, %d with motion vector hints.\n", frame_count,
+         hinted_frame_count);
+  if (aom_codec_destroy(&decoder))
+    die_codec(&decoder, "Failed to destroy decoder.");
+  aom_video_writer_close(writer);
+  aom_video_reader_close(reader);
+  return EXIT_SUCCESS;
+}
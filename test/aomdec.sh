@@ -121,6 +121,88 @@ aomdec_aom_ivf_pipe_input() {
   fi
 }
 
+# Decodes $1 with the additional parameters in $2 from the file, which uses
+# the memory-mapped reader, and from a pipe, which uses the stdio readers, and
+# checks that the MD5 of the output matches.
+aomdec_md5_mmap_matches_pipe() {
+  local file="$1"
+  local params="$2"
+  local decoder="$(aom_tool_path aomdec)"
+  local mmap_md5="${AOM_TEST_OUTPUT_DIR}/aomdec_mmap.md5"
+  local pipe_md5="${AOM_TEST_OUTPUT_DIR}/aomdec_pipe.md5"
+  # Note aomdec() and aomdec_pipe() are not used to avoid ${devnull} which may
+  # also redirect stdout.
+  eval "${AOM_TEST_PREFIX}" "${decoder}" --md5 ${params} "${file}" \
+    ">" "${mmap_md5}" || return 1
+  cat "${file}" | eval "${AOM_TEST_PREFIX}" "${decoder}" --md5 ${params} - \
+    ">" "${pipe_md5}" || return 1
+  if [ ! -s "${mmap_md5}" ]; then
+    elog "No MD5 from the memory-mapped reader."
+    return 1
+  fi
+  diff "${mmap_md5}" "${pipe_md5}"
+}
+
+aomdec_av1_ivf_mmap() {
+  if [ "$(aomdec_can_decode_av1)" = "yes" ]; then
+    local file="${AV1_IVF_FILE}"
+    if [ ! -e "${file}" ]; then
+      encode_yuv_raw_input_av1 "${file}" --ivf || return 1
+    fi
+    aomdec_md5_mmap_matches_pipe "${file}" ""
+  fi
+}
+
+aomdec_av1_obu_mmap() {
+  if [ "$(aomdec_can_decode_av1)" = "yes" ]; then
+    local file="${AV1_OBU_SEC5_FILE}"
+    if [ ! -e "${file}" ]; then
+      encode_yuv_raw_input_av1 "${file}" --obu || return 1
+    fi
+    aomdec_md5_mmap_matches_pipe "${file}" "" || return 1
+    file="${AV1_OBU_ANNEXB_FILE}"
+    if [ ! -e "${file}" ]; then
+      encode_yuv_raw_input_av1 "${file}" --obu --annexb=1 || return 1
+    fi
+    aomdec_md5_mmap_matches_pipe "${file}" "--annexb"
+  fi
+}
+
+# Decodes $1 from frame $2 on with --seek and checks the output against the
+# same frames of a full decode. Requires 352x288 I420 content.
+aomdec_seek_matches_full_decode() {
+  local file="$1"
+  local seek_frame="$2"
+  local decoder="$(aom_tool_path aomdec)"
+  local full_output="${AOM_TEST_OUTPUT_DIR}/aomdec_full.yuv"
+  local seek_output="${AOM_TEST_OUTPUT_DIR}/aomdec_seek.yuv"
+  local frame_size=$((352 * 288 * 3 / 2))
+  eval "${AOM_TEST_PREFIX}" "${decoder}" --rawvideo -o "${full_output}" \
+    "${file}" ${devnull} || return 1
+  eval "${AOM_TEST_PREFIX}" "${decoder}" --rawvideo --seek=${seek_frame} \
+    -o "${seek_output}" "${file}" ${devnull} || return 1
+  if [ ! -s "${seek_output}" ]; then
+    elog "No output after seeking to frame ${seek_frame}."
+    return 1
+  fi
+  tail -c +$((seek_frame * frame_size + 1)) "${full_output}" \
+    | cmp - "${seek_output}"
+}
+
+# The forward key frame is coded hidden in the temporal unit of frame 10 and
+# shown later, so it must not be used as the starting point of a seek.
+aomdec_av1_ivf_seek_fwd_kf() {
+  if [ "$(aomdec_can_decode_av1)" = "yes" ] && \
+     [ "$(av1_encode_available)" = "yes" ]; then
+    local file="${AOM_TEST_OUTPUT_DIR}/av1.fwd-kf.ivf"
+    encode_yuv_raw_input_av1 "${file}" --ivf --limit=24 --cpu-used=6 \
+      --lag-in-frames=19 --enable-fwd-kf=1 --fwd-kf-dist=8 || return 1
+    for seek_frame in 9 11 16; do
+      aomdec_seek_matches_full_decode "${file}" ${seek_frame} || return 1
+    done
+  fi
+}
+
 aomdec_av1_obu_annexb() {
   if [ "$(aomdec_can_decode_av1)" = "yes" ]; then
     local file="${AV1_OBU_ANNEXB_FILE}"
@@ -199,6 +281,7 @@ aomdec_tests="aomdec_av1_ivf
               aomdec_av1_ivf_multithread
               aomdec_av1_ivf_multithread_row_mt
               aomdec_aom_ivf_pipe_input
+              aomdec_av1_ivf_mmap
               aomdec_av1_monochrome_yuv_8bit"
 
 if [ ! "$(realtime_only_build)" = "yes" ]; then
@@ -208,6 +291,8 @@ if [ ! "$(realtime_only_build)" = "yes" ]; then
                 aomdec_av1_obu_section5
                 aomdec_av1_obu_annexb_pipe_input
                 aomdec_av1_obu_section5_pipe_input
+                aomdec_av1_obu_mmap
+                aomdec_av1_ivf_seek_fwd_kf
                 aomdec_av1_webm"
 fi
 
@@ -286,6 +286,26 @@ aomenc_av1_webm_cdf_update_mode() {
   fi
 }
 
+# With --share-first-pass every stream uses the first pass statistics of the
+# first stream. When the streams are identical this must reproduce a normal
+# two-pass encode.
+aomenc_av1_ivf_share_first_pass() {
+  if [ "$(aomenc_can_encode_av1)" = "yes" ]; then
+    local output="${AOM_TEST_OUTPUT_DIR}/av1_two_pass.ivf"
+    local shared_output_0="${AOM_TEST_OUTPUT_DIR}/av1_shared_pass_0.ivf"
+    local shared_output_1="${AOM_TEST_OUTPUT_DIR}/av1_shared_pass_1.ivf"
+    local params="$(aomenc_encode_test_fast_params) --limit=10
+                  --lag-in-frames=5 --passes=2 --ivf"
+    aomenc $(yuv_raw_input) ${params} --output="${output}" || return 1
+    aomenc $(yuv_raw_input) --share-first-pass \
+      ${params} --output="${shared_output_0}" -- \
+      ${params} --output="${shared_output_1}" || return 1
+
+    cmp "${output}" "${shared_output_0}" || return 1
+    cmp "${output}" "${shared_output_1}"
+  fi
+}
+
 if [ "$(realtime_only_build)" = "yes" ]; then
   aomenc_tests="aomenc_av1_ivf_rt"
 else
@@ -299,6 +319,7 @@ else
                 aomenc_av1_ivf_minq0_maxq0
                 aomenc_av1_ivf_use_16bit_internal
                 aomenc_av1_webm_lag5_frames10
+                aomenc_av1_ivf_share_first_pass
                 aomenc_av1_webm_non_square_par
                 aomenc_av1_webm_cdf_update_mode"
 fi
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "aom/aomdx.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+namespace {
+
+// Encodes a clip and checks that a decoder running with AV1D_SET_HEADER_ONLY
+// reports the same per frame header information as a full decoder, without
+// outputting any frames.
+class DecodeHeaderOnlyTest
+    : public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  DecodeHeaderOnlyTest()
+      : EncoderTest(GET_PARAM(0)), mode_(GET_PARAM(1)),
+        num_tile_groups_(GET_PARAM(2)), num_frames_(0),
+        num_shown_frames_(0) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.allow_lowbitdepth = 1;
+    full_dec_ = codec_->CreateDecoder(cfg, 0);
+    header_dec_ = codec_->CreateDecoder(cfg, 0);
+    header_dec_->Control(AV1D_SET_HEADER_ONLY, 1);
+  }
+
+  ~DecodeHeaderOnlyTest() override {
+    delete full_dec_;
+    delete header_dec_;
+  }
+
+  void SetUp() override { InitializeConfig(mode_); }
+
+  void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                          ::libaom_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, 6);
+      encoder->Control(AV1E_SET_TILE_COLUMNS, 1);
+      encoder->Control(AV1E_SET_NUM_TG, num_tile_groups_);
+    }
+  }
+
+  void FramePktHook(const aom_codec_cx_pkt_t *pkt) override {
+    const uint8_t *const data =
+        static_cast<const uint8_t *>(pkt->data.frame.buf);
+    ASSERT_EQ(AOM_CODEC_OK, full_dec_->DecodeFrame(data, pkt->data.frame.sz));
+    ASSERT_EQ(AOM_CODEC_OK, header_dec_->DecodeFrame(data, pkt->data.frame.sz));
+
+    aom_tu_parse_info full_info;
+    aom_tu_parse_info header_info;
+    ASSERT_EQ(AOM_CODEC_OK,
+              aom_codec_control(full_dec_->GetDecoder(), AV1D_GET_TU_PARSE_INFO,
+                                &full_info));
+    ASSERT_EQ(AOM_CODEC_OK,
+              aom_codec_control(header_dec_->GetDecoder(),
+                                AV1D_GET_TU_PARSE_INFO, &header_info));
+
+    ASSERT_GT(header_info.num_frames, 0);
+    ASSERT_EQ(full_info.num_frames, header_info.num_frames);
+    size_t total_size = 0;
+    for (int i = 0; i < header_info.num_frames; ++i) {
+      const aom_frame_parse_info &a = full_info.frames[i];
+      const aom_frame_parse_info &b = header_info.frames[i];
+      EXPECT_EQ(a.frame_type, b.frame_type);
+      EXPECT_EQ(a.show_frame, b.show_frame);
+      EXPECT_EQ(a.showable_frame, b.showable_frame);
+      EXPECT_EQ(a.show_existing_frame, b.show_existing_frame);
+      EXPECT_EQ(a.refresh_frame_flags, b.refresh_frame_flags);
+      EXPECT_EQ(a.base_q_idx, b.base_q_idx);
+      EXPECT_EQ(a.order_hint, b.order_hint);
+      EXPECT_EQ(a.width, b.width);
+      EXPECT_EQ(a.height, b.height);
+      EXPECT_EQ(a.size, b.size);
+      total_size += b.size;
+      if (b.show_frame || b.show_existing_frame) ++num_shown_frames_;
+    }
+    EXPECT_EQ(pkt->data.frame.sz, total_size);
+    num_frames_ += header_info.num_frames;
+
+    // The header only decoder never outputs frames.
+    EXPECT_EQ(header_dec_->GetDxData().Next(), nullptr);
+    EXPECT_NE(full_dec_->GetDxData().Next(), nullptr);
+  }
+
+  libaom_test::TestMode mode_;
+  int num_tile_groups_;
+  int num_frames_;
+  int num_shown_frames_;
+  ::libaom_test::Decoder *full_dec_;
+  ::libaom_test::Decoder *header_dec_;
+};
+
+TEST_P(DecodeHeaderOnlyTest, MatchesFullDecode) {
+  const int kFrames = 20;
+  ::libaom_test::RandomVideoSource video;
+  video.SetSize(176, 144);
+  video.set_limit(kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_EQ(kFrames, num_shown_frames_);
+  EXPECT_GE(num_frames_, kFrames);
+}
+
+AV1_INSTANTIATE_TEST_SUITE(DecodeHeaderOnlyTest, ONE_PASS_TEST_MODES,
+                           ::testing::Values(1, 2));
+
+}  // namespace
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "aom/aomcx.h"
+#include "aom/aomdx.h"
+#include "aom/aom_decoder.h"
+#include "aom/aom_encoder.h"
+#include "aom/aom_integer.h"
+
+namespace {
+
+// 4x3 superblocks of 64x64, coded as 2x2 tiles.
+const unsigned int kWidth = 256;
+const unsigned int kHeight = 192;
+const int kFrames = 6;
+
+const int kObuTemporalDelimiter = 2;
+const int kObuTileGroup = 4;
+
+typedef std::vector<std::vector<uint8_t>> Chunks;
+
+// Splits a temporal unit into the chunks a transport would send one at a
+// time: the OBUs up to the frame header, then each tile group OBU. The
+// temporal delimiter is dropped.
+Chunks SplitAtTileGroups(const uint8_t *data, size_t size) {
+  Chunks chunks(1);
+  size_t pos = 0;
+  while (pos < size) {
+    const int obu_type = (data[pos] >> 3) & 0xf;
+    const size_t header_size = (data[pos] & 0x4) ? 2 : 1;
+    uint64_t payload_size;
+    size_t length_size;
+    EXPECT_EQ(aom_uleb_decode(data + pos + header_size,
+                              size - pos - header_size, &payload_size,
+                              &length_size),
+              0);
+    const uint8_t *const obu = data + pos;
+    pos += header_size + length_size + static_cast<size_t>(payload_size);
+    EXPECT_LE(pos, size);
+    if (obu_type == kObuTileGroup) {
+      chunks.emplace_back(obu, data + pos);
+    } else if (obu_type != kObuTemporalDelimiter) {
+      chunks[0].insert(chunks[0].end(), obu, data + pos);
+    }
+  }
+  return chunks;
+}
+
+// Encodes a moving pattern and returns the OBUs of each frame, split at the
+// tile groups.
+std::vector<Chunks> EncodeInChunks(int num_tg, bool enable_filters) {
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  EXPECT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_REALTIME),
+            AOM_CODEC_OK);
+  cfg.g_w = kWidth;
+  cfg.g_h = kHeight;
+  cfg.g_lag_in_frames = 0;
+  aom_codec_ctx_t enc;
+  EXPECT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AOME_SET_CPUUSED, 8), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_SUPERBLOCK_SIZE,
+                              AOM_SUPERBLOCK_SIZE_64X64),
+            AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_TILE_COLUMNS, 1), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_TILE_ROWS, 1), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_NUM_TG, num_tg), AOM_CODEC_OK);
+  if (!enable_filters) {
+    EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_LOOPFILTER_CONTROL, 0),
+              AOM_CODEC_OK);
+    EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_ENABLE_CDEF, 0), AOM_CODEC_OK);
+    EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_ENABLE_RESTORATION, 0),
+              AOM_CODEC_OK);
+  }
+
+  std::vector<Chunks> frames;
+  aom_image_t *image =
+      aom_img_alloc(nullptr, AOM_IMG_FMT_I420, kWidth, kHeight, 1);
+  for (int i = 0; i < kFrames; ++i) {
+    for (unsigned int plane = 0; plane < 3; ++plane) {
+      const unsigned int w = plane ? kWidth / 2 : kWidth;
+      const unsigned int h = plane ? kHeight / 2 : kHeight;
+      for (unsigned int r = 0; r < h; ++r) {
+        for (unsigned int c = 0; c < w; ++c) {
+          image->planes[plane][r * image->stride[plane] + c] =
+              static_cast<uint8_t>(((c + 3 * i) * (r + i) >> 4) + 40 * plane);
+        }
+      }
+    }
+    EXPECT_EQ(aom_codec_encode(&enc, image, i, 1, 0), AOM_CODEC_OK);
+    aom_codec_iter_t iter = nullptr;
+    const aom_codec_cx_pkt_t *pkt;
+    while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+      frames.push_back(
+          SplitAtTileGroups(static_cast<const uint8_t *>(pkt->data.frame.buf),
+                            pkt->data.frame.sz));
+    }
+  }
+  aom_img_free(image);
+  EXPECT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+  return frames;
+}
+
+void ExpectSameRows(const aom_image_t *a, const aom_image_t *b,
+                    unsigned int rows) {
+  for (int plane = 0; plane < 3; ++plane) {
+    const unsigned int h = plane ? (rows + 1) / 2 : rows;
+    const unsigned int w = plane ? (a->d_w + 1) / 2 : a->d_w;
+    for (unsigned int r = 0; r < h; ++r) {
+      ASSERT_EQ(memcmp(a->planes[plane] + r * a->stride[plane],
+                       b->planes[plane] + r * b->stride[plane], w),
+                0)
+          << "plane " << plane << " row " << r;
+    }
+  }
+}
+
+class DecodeIncrementalTest
+    : public ::testing::TestWithParam<std::tuple<int, unsigned int>> {};
+
+// Decodes each chunk as it arrives and checks the progress and the output
+// against a decoder receiving whole frames.
+TEST_P(DecodeIncrementalTest, MatchesWholeFrameDecode) {
+  const int num_tg = std::get<0>(GetParam());
+  const std::vector<Chunks> frames = EncodeInChunks(num_tg, true);
+  ASSERT_EQ(frames.size(), static_cast<size_t>(kFrames));
+
+  aom_codec_iface_t *iface = aom_codec_av1_dx();
+  aom_codec_dec_cfg_t cfg = { std::get<1>(GetParam()), 0, 0, 1 };
+  aom_codec_ctx_t whole_dec;
+  aom_codec_ctx_t incr_dec;
+  ASSERT_EQ(aom_codec_dec_init(&whole_dec, iface, nullptr, 0), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_dec_init(&incr_dec, iface, &cfg, 0), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&incr_dec, AV1D_SET_INCREMENTAL_DECODE, 1),
+            AOM_CODEC_OK);
+  aom_decode_progress_t progress;
+  EXPECT_EQ(aom_codec_control(&incr_dec, AV1D_GET_DECODE_PROGRESS, &progress),
+            AOM_CODEC_ERROR);
+
+  for (const Chunks &chunks : frames) {
+    ASSERT_EQ(chunks.size(), num_tg == 1 ? 1u : 1u + num_tg);
+    std::vector<uint8_t> frame;
+    unsigned int last_decoded_sb_rows = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      frame.insert(frame.end(), chunks[i].begin(), chunks[i].end());
+      ASSERT_EQ(aom_codec_decode(&incr_dec, chunks[i].data(), chunks[i].size(),
+                                 nullptr),
+                AOM_CODEC_OK);
+      ASSERT_EQ(
+          aom_codec_control(&incr_dec, AV1D_GET_DECODE_PROGRESS, &progress),
+          AOM_CODEC_OK);
+      EXPECT_EQ(progress.sb_rows, 3u);
+      EXPECT_EQ(progress.sb_size, 64u);
+      EXPECT_GE(progress.decoded_sb_rows, last_decoded_sb_rows);
+      last_decoded_sb_rows = progress.decoded_sb_rows;
+      if (i + 1 < chunks.size()) {
+        // The frame is only output with its last tile group.
+        aom_codec_iter_t iter = nullptr;
+        EXPECT_EQ(aom_codec_get_frame(&incr_dec, &iter), nullptr);
+        EXPECT_LT(progress.decoded_sb_rows, progress.sb_rows);
+        EXPECT_NE(progress.img.planes[0], nullptr);
+      }
+    }
+    EXPECT_EQ(progress.decoded_sb_rows, progress.sb_rows);
+    EXPECT_EQ(progress.img.planes[0], nullptr);
+
+    ASSERT_EQ(
+        aom_codec_decode(&whole_dec, frame.data(), frame.size(), nullptr),
+        AOM_CODEC_OK);
+    aom_codec_iter_t whole_iter = nullptr;
+    aom_codec_iter_t incr_iter = nullptr;
+    const aom_image_t *whole_img = aom_codec_get_frame(&whole_dec, &whole_iter);
+    const aom_image_t *incr_img = aom_codec_get_frame(&incr_dec, &incr_iter);
+    ASSERT_NE(whole_img, nullptr);
+    ASSERT_NE(incr_img, nullptr);
+    ASSERT_NO_FATAL_FAILURE(ExpectSameRows(whole_img, incr_img, kHeight));
+  }
+  EXPECT_EQ(aom_codec_destroy(&whole_dec), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_destroy(&incr_dec), AOM_CODEC_OK);
+}
+
+// Without the in-loop filters, the rows reported as decoded hold their final
+// pixels before the rest of the frame arrives.
+TEST_P(DecodeIncrementalTest, DecodedRowsAreFinalWithoutFilters) {
+  const int num_tg = std::get<0>(GetParam());
+  if (num_tg == 1) GTEST_SKIP() << "Whole frames only";
+  const std::vector<Chunks> frames = EncodeInChunks(num_tg, false);
+
+  aom_codec_dec_cfg_t cfg = { std::get<1>(GetParam()), 0, 0, 1 };
+  aom_codec_ctx_t dec;
+  ASSERT_EQ(aom_codec_dec_init(&dec, aom_codec_av1_dx(), &cfg, 0),
+            AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&dec, AV1D_SET_INCREMENTAL_DECODE, 1),
+            AOM_CODEC_OK);
+  std::vector<uint8_t> partial(kWidth * kHeight * 3 / 2);
+  for (const Chunks &chunks : frames) {
+    // Decode all but the last tile group, and copy the decoded rows.
+    for (size_t i = 0; i + 1 < chunks.size(); ++i) {
+      ASSERT_EQ(aom_codec_decode(&dec, chunks[i].data(), chunks[i].size(),
+                                 nullptr),
+                AOM_CODEC_OK);
+    }
+    aom_decode_progress_t progress;
+    ASSERT_EQ(aom_codec_control(&dec, AV1D_GET_DECODE_PROGRESS, &progress),
+              AOM_CODEC_OK);
+    const unsigned int rows = progress.decoded_sb_rows * progress.sb_size;
+    EXPECT_GT(rows, 0u);
+    aom_image_t copy = progress.img;
+    uint8_t *dst = partial.data();
+    for (int plane = 0; plane < 3; ++plane) {
+      const unsigned int w = plane ? kWidth / 2 : kWidth;
+      const unsigned int h = plane ? kHeight / 2 : kHeight;
+      for (unsigned int r = 0; r < h; ++r) {
+        memcpy(dst + r * w, progress.img.planes[plane] +
+                                r * progress.img.stride[plane], w);
+      }
+      copy.planes[plane] = dst;
+      copy.stride[plane] = static_cast<int>(w);
+      dst += w * h;
+    }
+
+    ASSERT_EQ(aom_codec_decode(&dec, chunks.back().data(),
+                               chunks.back().size(), nullptr),
+              AOM_CODEC_OK);
+    aom_codec_iter_t iter = nullptr;
+    const aom_image_t *img = aom_codec_get_frame(&dec, &iter);
+    ASSERT_NE(img, nullptr);
+    ASSERT_NO_FATAL_FAILURE(ExpectSameRows(img, &copy, rows));
+  }
+  EXPECT_EQ(aom_codec_destroy(&dec), AOM_CODEC_OK);
+}
+
+INSTANTIATE_TEST_SUITE_P(AV1, DecodeIncrementalTest,
+                         ::testing::Combine(::testing::Values(1, 2, 4),
+                                            ::testing::Values(1u, 4u)));
+
+}  // namespace
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "aom/aomcx.h"
+#include "aom/aomdx.h"
+#include "aom/aom_decoder.h"
+#include "aom/aom_encoder.h"
+
+namespace {
+
+const unsigned int kWidth = 160;
+const unsigned int kHeight = 96;
+const int kFrames = 10;
+
+// Fills 'image' with a pattern translating by 2 pixels right and 1 down per
+// frame.
+void FillTranslatingFrame(aom_image_t *image, int frame) {
+  for (unsigned int plane = 0; plane < 3; ++plane) {
+    const unsigned int w = plane ? (image->d_w + 1) / 2 : image->d_w;
+    const unsigned int h = plane ? (image->d_h + 1) / 2 : image->d_h;
+    const int dx = plane ? frame : 2 * frame;
+    const int dy = plane ? frame / 2 : frame;
+    for (unsigned int r = 0; r < h; ++r) {
+      for (unsigned int c = 0; c < w; ++c) {
+        const int x = static_cast<int>(c) - dx;
+        const int y = static_cast<int>(r) - dy;
+        image->planes[plane][r * image->stride[plane] + c] =
+            static_cast<uint8_t>(((x * 7) ^ (y * 13)) & 0xff);
+      }
+    }
+  }
+}
+
+// Encodes the translating pattern and returns the compressed frames.
+std::vector<std::vector<uint8_t>> EncodeTranslatingClip(int ref_frame_mvs) {
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  EXPECT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_GOOD_QUALITY),
+            AOM_CODEC_OK);
+  cfg.g_w = kWidth;
+  cfg.g_h = kHeight;
+  cfg.g_lag_in_frames = 0;
+  cfg.rc_end_usage = AOM_Q;
+  aom_codec_ctx_t enc;
+  EXPECT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AOME_SET_CPUUSED, 5), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AOME_SET_CQ_LEVEL, 30), AOM_CODEC_OK);
+  EXPECT_EQ(
+      aom_codec_control(&enc, AV1E_SET_ENABLE_REF_FRAME_MVS, ref_frame_mvs),
+      AOM_CODEC_OK);
+
+  aom_image_t *image =
+      aom_img_alloc(nullptr, AOM_IMG_FMT_I420, kWidth, kHeight, 1);
+  EXPECT_NE(image, nullptr);
+  std::vector<std::vector<uint8_t>> frames;
+  for (int frame = 0; frame <= kFrames; ++frame) {
+    if (frame < kFrames) FillTranslatingFrame(image, frame);
+    // The last iteration flushes the encoder.
+    EXPECT_EQ(aom_codec_encode(&enc, frame < kFrames ? image : nullptr, frame,
+                               1, 0),
+              AOM_CODEC_OK);
+    aom_codec_iter_t iter = nullptr;
+    const aom_codec_cx_pkt_t *pkt;
+    while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+      const uint8_t *const buf = static_cast<uint8_t *>(pkt->data.frame.buf);
+      frames.emplace_back(buf, buf + pkt->data.frame.sz);
+    }
+  }
+  aom_img_free(image);
+  EXPECT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+  return frames;
+}
+
+TEST(DecodeMvHints, MatchesSourceMotion) {
+  const std::vector<std::vector<uint8_t>> frames = EncodeTranslatingClip(1);
+  ASSERT_EQ(frames.size(), static_cast<size_t>(kFrames));
+
+  aom_codec_ctx_t dec;
+  aom_codec_dec_cfg_t cfg = { 0, 0, 0, 1 };
+  ASSERT_EQ(aom_codec_dec_init(&dec, aom_codec_av1_dx(), &cfg, 0),
+            AOM_CODEC_OK);
+  const unsigned int block_size = 16;
+  std::vector<aom_mv_hint_t> hints((kWidth / block_size) *
+                                   (kHeight / block_size));
+  aom_mv_hint_map_t map = { hints.data(), block_size, kHeight / block_size,
+                            kWidth / block_size, 0 };
+  int num_hints = 0;
+  int num_matching_hints = 0;
+  for (const std::vector<uint8_t> &frame : frames) {
+    ASSERT_EQ(aom_codec_decode(&dec, frame.data(), frame.size(), nullptr),
+              AOM_CODEC_OK);
+    aom_codec_iter_t iter = nullptr;
+    ASSERT_NE(aom_codec_get_frame(&dec, &iter), nullptr);
+    ASSERT_EQ(aom_codec_control(&dec, AV1D_GET_MV_HINTS, &map), AOM_CODEC_OK);
+    for (const aom_mv_hint_t &hint : hints) {
+      if (hint.ref_distance == 0) continue;
+      ++num_hints;
+      // The content of each block comes from 2 pixels left and 1 above in
+      // the previous frame.
+      num_matching_hints += hint.ref_distance < 0 &&
+                            hint.row == 8 * hint.ref_distance &&
+                            hint.col == 16 * hint.ref_distance;
+    }
+  }
+  // All but the key frame are inter coded.
+  EXPECT_GT(num_hints, 0);
+  EXPECT_GT(num_matching_hints, num_hints * 3 / 4);
+
+  // The map must match the frame size.
+  map.rows = kHeight / block_size - 1;
+  EXPECT_EQ(aom_codec_control(&dec, AV1D_GET_MV_HINTS, &map),
+            AOM_CODEC_INVALID_PARAM);
+  map.rows = kHeight / block_size;
+  map.block_size = 32;
+  EXPECT_EQ(aom_codec_control(&dec, AV1D_GET_MV_HINTS, &map),
+            AOM_CODEC_INVALID_PARAM);
+  map.block_size = block_size;
+  map.hints = nullptr;
+  EXPECT_EQ(aom_codec_control(&dec, AV1D_GET_MV_HINTS, &map),
+            AOM_CODEC_INVALID_PARAM);
+  EXPECT_EQ(aom_codec_destroy(&dec), AOM_CODEC_OK);
+}
+
+TEST(DecodeMvHints, RequiresRefFrameMvs) {
+  const std::vector<std::vector<uint8_t>> frames = EncodeTranslatingClip(0);
+  ASSERT_FALSE(frames.empty());
+
+  aom_codec_ctx_t dec;
+  aom_codec_dec_cfg_t cfg = { 0, 0, 0, 1 };
+  ASSERT_EQ(aom_codec_dec_init(&dec, aom_codec_av1_dx(), &cfg, 0),
+            AOM_CODEC_OK);
+  std::vector<aom_mv_hint_t> hints((kWidth / 8) * (kHeight / 8));
+  aom_mv_hint_map_t map = { hints.data(), 8, kHeight / 8, kWidth / 8, 0 };
+  // No frame has been decoded yet.
+  EXPECT_EQ(aom_codec_control(&dec, AV1D_GET_MV_HINTS, &map), AOM_CODEC_ERROR);
+  ASSERT_EQ(aom_codec_decode(&dec, frames[0].data(), frames[0].size(), nullptr),
+            AOM_CODEC_OK);
+  aom_codec_iter_t iter = nullptr;
+  ASSERT_NE(aom_codec_get_frame(&dec, &iter), nullptr);
+  EXPECT_EQ(aom_codec_control(&dec, AV1D_GET_MV_HINTS, &map),
+            AOM_CODEC_INCAPABLE);
+  EXPECT_EQ(aom_codec_destroy(&dec), AOM_CODEC_OK);
+}
+
+}  // namespace
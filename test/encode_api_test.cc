@@ -9,10 +9,13 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
 
@@ -21,6 +24,7 @@
 #include "aom/aomcx.h"
 #include "aom/aom_encoder.h"
 #include "aom/aom_image.h"
+#include "test/video_source.h"
 
 namespace {
 
@@ -556,6 +560,232 @@ TEST(EncodeAPI, Buganizer310457427) {
   encoder.Encode(false);
 }
 
+// Encodes generated frames for the tests of the encoder controls. cfg()
+// starts from the defaults of the usage at the given size, without lag in
+// frames, and can be changed before Init().
+class ControlTestEncoder {
+ public:
+  ControlTestEncoder(unsigned int usage, unsigned int width,
+                     unsigned int height);
+  ~ControlTestEncoder();
+
+  aom_codec_enc_cfg_t &cfg() { return cfg_; }
+  aom_codec_ctx_t *ctx() { return &enc_; }
+  // The gray image allocated by Init() at the configured size.
+  aom_image_t *image() { return image_; }
+  // The frame packets output so far, concatenated.
+  const std::vector<uint8_t> &data() const { return data_; }
+  int num_frames() const { return num_frames_; }
+
+  // Initializes the encoder with cfg() at the given speed.
+  void Init(int speed);
+  // Encodes img, or flushes the encoder when img is nullptr, and collects the
+  // frame packets.
+  aom_codec_err_t Encode(const aom_image_t *img,
+                         aom_enc_frame_flags_t flags = 0);
+
+ private:
+  aom_codec_enc_cfg_t cfg_;
+  aom_codec_ctx_t enc_;
+  bool initialized_ = false;
+  aom_image_t *image_ = nullptr;
+  int frame_index_ = 0;
+  std::vector<uint8_t> data_;
+  int num_frames_ = 0;
+};
+
+ControlTestEncoder::ControlTestEncoder(unsigned int usage, unsigned int width,
+                                       unsigned int height) {
+  EXPECT_EQ(aom_codec_enc_config_default(aom_codec_av1_cx(), &cfg_, usage),
+            AOM_CODEC_OK);
+  cfg_.g_w = width;
+  cfg_.g_h = height;
+  cfg_.g_lag_in_frames = 0;
+}
+
+ControlTestEncoder::~ControlTestEncoder() {
+  aom_img_free(image_);
+  if (initialized_) {
+    EXPECT_EQ(aom_codec_destroy(&enc_), AOM_CODEC_OK);
+  }
+}
+
+void ControlTestEncoder::Init(int speed) {
+  ASSERT_EQ(aom_codec_enc_init(&enc_, aom_codec_av1_cx(), &cfg_, 0),
+            AOM_CODEC_OK);
+  initialized_ = true;
+  ASSERT_EQ(aom_codec_control(&enc_, AOME_SET_CPUUSED, speed), AOM_CODEC_OK);
+  image_ = CreateGrayImage(AOM_IMG_FMT_I420, cfg_.g_w, cfg_.g_h);
+  ASSERT_NE(image_, nullptr);
+}
+
+aom_codec_err_t ControlTestEncoder::Encode(const aom_image_t *img,
+                                           aom_enc_frame_flags_t flags) {
+  const aom_codec_err_t res =
+      aom_codec_encode(&enc_, img, frame_index_, 1, flags);
+  if (img != nullptr) ++frame_index_;
+  aom_codec_iter_t iter = nullptr;
+  const aom_codec_cx_pkt_t *pkt;
+  while ((pkt = aom_codec_get_cx_data(&enc_, &iter)) != nullptr) {
+    if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+    const uint8_t *buf = static_cast<const uint8_t *>(pkt->data.frame.buf);
+    data_.insert(data_.end(), buf, buf + pkt->data.frame.sz);
+    ++num_frames_;
+  }
+  return res;
+}
+
+void CheckMemoryUsage(unsigned int usage, unsigned int lag_in_frames,
+                      int speed) {
+  ControlTestEncoder encoder(usage, 352, 288);
+  encoder.cfg().g_lag_in_frames = lag_in_frames;
+  ASSERT_NO_FATAL_FAILURE(encoder.Init(speed));
+  ASSERT_EQ(aom_codec_control(encoder.ctx(), AV1E_GET_MEMORY_USAGE, nullptr),
+            AOM_CODEC_INVALID_PARAM);
+
+  // Encode until the first frame comes out of the lookahead.
+  for (unsigned int i = 0; i <= lag_in_frames; ++i) {
+    ASSERT_EQ(encoder.Encode(encoder.image()), AOM_CODEC_OK);
+  }
+
+  aom_mem_usage_t mem_usage;
+  ASSERT_EQ(
+      aom_codec_control(encoder.ctx(), AV1E_GET_MEMORY_USAGE, &mem_usage),
+      AOM_CODEC_OK);
+  uint64_t total = 0;
+  for (int i = 0; i < AOM_MEM_CATEGORIES; ++i) {
+    EXPECT_GE(mem_usage.peak_bytes[i], mem_usage.live_bytes[i]);
+    total += mem_usage.live_bytes[i];
+  }
+  EXPECT_EQ(mem_usage.total_live_bytes, total);
+  EXPECT_GE(mem_usage.total_peak_bytes, mem_usage.total_live_bytes);
+  EXPECT_GT(mem_usage.live_bytes[AOM_MEM_LOOKAHEAD], 0u);
+  EXPECT_GT(mem_usage.live_bytes[AOM_MEM_FRAME_BUFFER_POOL], 0u);
+  EXPECT_GT(mem_usage.live_bytes[AOM_MEM_TXB], 0u);
+  if (usage == AOM_USAGE_GOOD_QUALITY) {
+    EXPECT_GT(mem_usage.peak_bytes[AOM_MEM_TPL], 0u);
+  }
+}
+
+TEST(EncodeAPI, GetMemoryUsageRealtime) {
+  CheckMemoryUsage(AOM_USAGE_REALTIME, 0, 7);
+}
+
+#if !CONFIG_REALTIME_ONLY
+TEST(EncodeAPI, GetMemoryUsageGoodQuality) {
+  CheckMemoryUsage(AOM_USAGE_GOOD_QUALITY, 8, 5);
+}
+#endif  // !CONFIG_REALTIME_ONLY
+
+TEST(EncodeAPI, GetComponentTiming) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_REALTIME),
+            AOM_CODEC_OK);
+  cfg.g_w = 352;
+  cfg.g_h = 288;
+  cfg.g_lag_in_frames = 0;
+
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AOME_SET_CPUUSED, 7), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_COMPONENT_TIMING, nullptr),
+            AOM_CODEC_INVALID_PARAM);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_COMPONENT_TIMING, 1u),
+            AOM_CODEC_OK);
+
+  aom_image_t *image = CreateGrayImage(AOM_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(aom_codec_encode(&enc, image, i, 1, 0), AOM_CODEC_OK);
+  }
+  aom_img_free(image);
+
+  aom_component_timing_t timing;
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_COMPONENT_TIMING, &timing),
+            AOM_CODEC_OK);
+  ASSERT_GT(timing.num_components, 0);
+  ASSERT_LE(timing.num_components, AOM_MAX_TIMING_COMPONENTS);
+  EXPECT_STREQ(timing.names[0], "av1_encode_strategy_time");
+  EXPECT_GT(timing.frame_us[0], 0u);
+  // The first component includes the others.
+  for (int i = 0; i < timing.num_components; ++i) {
+    EXPECT_NE(timing.names[i], nullptr);
+    EXPECT_LE(timing.frame_us[i], timing.total_us[i]);
+    EXPECT_LE(timing.total_us[i], timing.total_us[0]);
+  }
+
+  ASSERT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+}
+
+TEST(EncodeAPI, GetSbStats) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_REALTIME),
+            AOM_CODEC_OK);
+  cfg.g_w = 352;
+  cfg.g_h = 288;
+  cfg.g_lag_in_frames = 0;
+
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AOME_SET_CPUUSED, 7), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_SUPERBLOCK_SIZE,
+                              AOM_SUPERBLOCK_SIZE_64X64),
+            AOM_CODEC_OK);
+  aom_sb_stats_map_t map = {};
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_SB_STATS, nullptr),
+            AOM_CODEC_INVALID_PARAM);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_SB_STATS, &map), AOM_CODEC_ERROR);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_SB_STATS, 1u), AOM_CODEC_OK);
+
+  aom_image_t *image = CreateGrayImage(AOM_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  // Texture the left half of the frame.
+  for (unsigned int r = 0; r < cfg.g_h; ++r) {
+    for (unsigned int c = 0; c < cfg.g_w / 2; ++c) {
+      image->planes[AOM_PLANE_Y][r * image->stride[AOM_PLANE_Y] + c] =
+          static_cast<unsigned char>((r * r + c * 7) * 13);
+    }
+  }
+  ASSERT_EQ(aom_codec_encode(&enc, image, 0, 1, 0), AOM_CODEC_OK);
+  aom_img_free(image);
+  size_t frame_bits = 0;
+  aom_codec_iter_t iter = nullptr;
+  const aom_codec_cx_pkt_t *pkt;
+  while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != nullptr) {
+    if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) frame_bits += pkt->data.frame.sz;
+  }
+  frame_bits *= 8;
+
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_SB_STATS, &map), AOM_CODEC_OK);
+  EXPECT_EQ(map.sb_size, 64u);
+  EXPECT_EQ(map.rows, 5u);
+  EXPECT_EQ(map.cols, 6u);
+  std::vector<aom_sb_stats_t> stats(map.rows * map.cols);
+  map.stats = stats.data();
+  map.rows = 1;
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_SB_STATS, &map),
+            AOM_CODEC_INVALID_PARAM);
+  map.rows = 5;
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_SB_STATS, &map), AOM_CODEC_OK);
+  size_t sb_bits = 0;
+  for (const aom_sb_stats_t &sb : stats) {
+    sb_bits += sb.bits;
+    EXPECT_LE(sb.partition_depth, 4);
+  }
+  EXPECT_GT(sb_bits, 0u);
+  EXPECT_LT(sb_bits, frame_bits);
+  // The textured superblocks cost more than the flat ones.
+  EXPECT_GT(stats[0].bits, stats[5].bits);
+  EXPECT_GT(stats[0].sse, stats[5].sse);
+  EXPECT_GE(stats[0].partition_depth, stats[5].partition_depth);
+
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_SB_STATS, 0u), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_SB_STATS, &map), AOM_CODEC_ERROR);
+  ASSERT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+}
+
 class EncodeAPIParameterized
     : public testing::TestWithParam<std::tuple<
           /*usage=*/unsigned int, /*speed=*/int, /*aq_mode=*/unsigned int>> {};
@@ -674,6 +904,438 @@ TEST(EncodeAPI, AllIntraAndNoRefLast) {
   aom_img_free(image);
   ASSERT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
 }
+
+// Encodes a few frames with the given memory budget and returns the memory
+// usage reported by the encoder.
+void EncodeWithMemoryBudget(unsigned int budget_mb, aom_mem_usage_t *usage) {
+  ControlTestEncoder encoder(AOM_USAGE_GOOD_QUALITY, 640, 480);
+  encoder.cfg().g_lag_in_frames = 35;
+  encoder.cfg().rc_end_usage = AOM_CBR;
+  ASSERT_NO_FATAL_FAILURE(encoder.Init(6));
+  ASSERT_EQ(
+      aom_codec_control(encoder.ctx(), AV1E_SET_MEMORY_BUDGET, budget_mb),
+      AOM_CODEC_OK);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(encoder.Encode(encoder.image()), AOM_CODEC_OK);
+  }
+
+  // The lookahead depth cannot change once frames have been queued.
+  EXPECT_EQ(aom_codec_control(encoder.ctx(), AV1E_SET_MEMORY_BUDGET, 0u),
+            AOM_CODEC_INCAPABLE);
+  ASSERT_EQ(aom_codec_control(encoder.ctx(), AV1E_GET_MEMORY_USAGE, usage),
+            AOM_CODEC_OK);
+}
+
+TEST(EncodeAPI, MemoryBudget) {
+  aom_mem_usage_t unlimited;
+  aom_mem_usage_t limited;
+  ASSERT_NO_FATAL_FAILURE(EncodeWithMemoryBudget(0, &unlimited));
+  ASSERT_NO_FATAL_FAILURE(EncodeWithMemoryBudget(64, &limited));
+  EXPECT_GT(unlimited.live_bytes[AOM_MEM_PYRAMID], 0u);
+  EXPECT_EQ(limited.live_bytes[AOM_MEM_PYRAMID], 0u);
+  EXPECT_LT(limited.live_bytes[AOM_MEM_LOOKAHEAD],
+            unlimited.live_bytes[AOM_MEM_LOOKAHEAD]);
+  EXPECT_LT(limited.total_live_bytes, unlimited.total_live_bytes);
+  EXPECT_FALSE(unlimited.lag_in_frames_lowered);
+  EXPECT_FALSE(unlimited.global_motion_disabled);
+  EXPECT_TRUE(limited.lag_in_frames_lowered);
+  EXPECT_TRUE(limited.global_motion_disabled);
+  EXPECT_LT(limited.lag_in_frames, unlimited.lag_in_frames);
+}
+
+// A resolution change keeps the lookahead depth picked by the memory budget
+// for the first frame, which the allocated lookahead was sized for.
+TEST(EncodeAPI, MemoryBudgetKeptAcrossResize) {
+  ControlTestEncoder encoder(AOM_USAGE_GOOD_QUALITY, 1280, 720);
+  aom_codec_enc_cfg_t &cfg = encoder.cfg();
+  cfg.g_lag_in_frames = 1;
+  cfg.rc_end_usage = AOM_CBR;
+  ASSERT_NO_FATAL_FAILURE(encoder.Init(6));
+  // Too small for a lookahead at 720p, but not at 360p.
+  ASSERT_EQ(aom_codec_control(encoder.ctx(), AV1E_SET_MEMORY_BUDGET, 30u),
+            AOM_CODEC_OK);
+  aom_mem_usage_t usage;
+  ASSERT_EQ(aom_codec_control(encoder.ctx(), AV1E_GET_MEMORY_USAGE, &usage),
+            AOM_CODEC_OK);
+  EXPECT_EQ(usage.lag_in_frames, 0u);
+  EXPECT_TRUE(usage.lag_in_frames_lowered);
+  EXPECT_TRUE(usage.global_motion_disabled);
+  ASSERT_EQ(encoder.Encode(encoder.image()), AOM_CODEC_OK);
+
+  cfg.g_w = 640;
+  cfg.g_h = 360;
+  ASSERT_EQ(aom_codec_enc_config_set(encoder.ctx(), &cfg), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(encoder.ctx(), AV1E_GET_MEMORY_USAGE, &usage),
+            AOM_CODEC_OK);
+  EXPECT_EQ(usage.lag_in_frames, 0u);
+  EXPECT_TRUE(usage.lag_in_frames_lowered);
+  aom_image_t *image = CreateGrayImage(AOM_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  EXPECT_EQ(encoder.Encode(image), AOM_CODEC_OK);
+  aom_img_free(image);
+}
+
+// Draws frame i of a moving texture into the luma plane of image.
+void DrawMovingTexture(aom_image_t *image, int i) {
+  for (unsigned int r = 0; r < image->d_h; ++r) {
+    for (unsigned int c = 0; c < image->d_w; ++c) {
+      const unsigned int x = c + 3 * i;
+      const unsigned int y = r + 2 * i;
+      image->planes[AOM_PLANE_Y][r * image->stride[AOM_PLANE_Y] + c] =
+          static_cast<unsigned char>((x * x + y * y / 3 + x * y) >> 4);
+    }
+  }
+}
+
+// Encodes num_frames frames of a moving texture in realtime mode at a fixed
+// quantizer, with a frame time budget of budget_us. The budget becomes
+// later_budget_us from change_frame on, and a key frame is forced at
+// key_frame, unless they are -1. Stores the compressed data of each frame in
+// *frames.
+void EncodeWithFrameTimeBudget(unsigned int budget_us, int change_frame,
+                               unsigned int later_budget_us, int key_frame,
+                               int num_frames,
+                               std::vector<std::vector<uint8_t>> *frames) {
+  ControlTestEncoder encoder(AOM_USAGE_REALTIME, 352, 288);
+  aom_codec_enc_cfg_t &cfg = encoder.cfg();
+  cfg.rc_end_usage = AOM_Q;
+  cfg.rc_min_quantizer = 40;
+  cfg.rc_max_quantizer = 40;
+  ASSERT_NO_FATAL_FAILURE(encoder.Init(7));
+  aom_codec_ctx_t *const enc = encoder.ctx();
+  ASSERT_EQ(aom_codec_control(enc, AOME_SET_CQ_LEVEL, 40), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(enc, AV1E_SET_AQ_MODE, 0), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(enc, AV1E_SET_FRAME_TIME_BUDGET, budget_us),
+            AOM_CODEC_OK);
+
+  frames->clear();
+  for (int i = 0; i < num_frames; ++i) {
+    if (i == change_frame) {
+      ASSERT_EQ(
+          aom_codec_control(enc, AV1E_SET_FRAME_TIME_BUDGET, later_budget_us),
+          AOM_CODEC_OK);
+    }
+    DrawMovingTexture(encoder.image(), i);
+    const size_t size = encoder.data().size();
+    ASSERT_EQ(encoder.Encode(encoder.image(),
+                             i == key_frame ? AOM_EFLAG_FORCE_KF : 0),
+              AOM_CODEC_OK);
+    frames->emplace_back(encoder.data().begin() + size, encoder.data().end());
+  }
+}
+
+TEST(EncodeAPI, FrameTimeBudget) {
+  std::vector<std::vector<uint8_t>> no_budget;
+  std::vector<std::vector<uint8_t>> large_budget;
+  std::vector<std::vector<uint8_t>> tiny_budget;
+  ASSERT_NO_FATAL_FAILURE(
+      EncodeWithFrameTimeBudget(0, -1, 0, -1, 10, &no_budget));
+  ASSERT_NO_FATAL_FAILURE(
+      EncodeWithFrameTimeBudget(100000000, -1, 0, -1, 10, &large_budget));
+  ASSERT_NO_FATAL_FAILURE(
+      EncodeWithFrameTimeBudget(1, -1, 0, -1, 10, &tiny_budget));
+  // A budget which is met keeps the speed preset. A budget which cannot be met
+  // raises the speed features after a few frames.
+  EXPECT_EQ(no_budget, large_budget);
+  EXPECT_NE(no_budget, tiny_budget);
+}
+
+// Removing the budget returns to the speed preset at once.
+TEST(EncodeAPI, FrameTimeBudgetRemoved) {
+  std::vector<std::vector<uint8_t>> no_budget;
+  std::vector<std::vector<uint8_t>> removed;
+  ASSERT_NO_FATAL_FAILURE(
+      EncodeWithFrameTimeBudget(0, -1, 0, 6, 12, &no_budget));
+  ASSERT_NO_FATAL_FAILURE(EncodeWithFrameTimeBudget(1, 6, 0, 6, 12, &removed));
+  EXPECT_NE(std::vector<std::vector<uint8_t>>(no_budget.begin() + 1,
+                                              no_budget.begin() + 6),
+            std::vector<std::vector<uint8_t>>(removed.begin() + 1,
+                                              removed.begin() + 6));
+  // The frames from the key frame on are coded with the speed preset again.
+  EXPECT_EQ(std::vector<std::vector<uint8_t>>(no_budget.begin() + 6,
+                                              no_budget.end()),
+            std::vector<std::vector<uint8_t>>(removed.begin() + 6,
+                                              removed.end()));
+}
+
+// A budget which is met lowers the speed steps one by one, back to the speed
+// preset.
+TEST(EncodeAPI, FrameTimeBudgetLowered) {
+  // The tiny budget raises the level by one step in each of the 5 inter
+  // frames before frame 6. The large budget then lowers it by one step every
+  // 8 frames, so it is back at 0 well before frame 56.
+  const int kKeyFrame = 56;
+  std::vector<std::vector<uint8_t>> no_budget;
+  std::vector<std::vector<uint8_t>> lowered;
+  ASSERT_NO_FATAL_FAILURE(
+      EncodeWithFrameTimeBudget(0, -1, 0, kKeyFrame, 60, &no_budget));
+  ASSERT_NO_FATAL_FAILURE(EncodeWithFrameTimeBudget(1, 6, 100000000, kKeyFrame,
+                                                    60, &lowered));
+  EXPECT_NE(std::vector<std::vector<uint8_t>>(no_budget.begin() + 1,
+                                              no_budget.begin() + 6),
+            std::vector<std::vector<uint8_t>>(lowered.begin() + 1,
+                                              lowered.begin() + 6));
+  EXPECT_EQ(std::vector<std::vector<uint8_t>>(no_budget.begin() + kKeyFrame,
+                                              no_budget.end()),
+            std::vector<std::vector<uint8_t>>(lowered.begin() + kKeyFrame,
+                                              lowered.end()));
+}
+
+// Draws static screen content into the luma plane of image. Each pattern is a
+// different noisy checkerboard.
+void DrawScreenPattern(aom_image_t *image, int pattern) {
+  uint32_t seed = 12345 + pattern;
+  for (unsigned int r = 0; r < image->d_h; ++r) {
+    for (unsigned int c = 0; c < image->d_w; ++c) {
+      seed = seed * 1103515245 + 12345;
+      const int base = (r / 16 + c / 16 + pattern) % 2 ? 40 : 200;
+      image->planes[AOM_PLANE_Y][r * image->stride[AOM_PLANE_Y] + c] =
+          static_cast<unsigned char>(base + (seed >> 27));
+    }
+  }
+}
+
+// Encodes num_frames frames of static screen content in CBR mode at
+// target_kbps. The content changes to another pattern at change_frame, unless
+// it is -1. Stores whether each frame was coded, rather than dropped, in
+// *coded.
+void EncodeStaticScreen(unsigned int drop_static_frames,
+                        unsigned int drop_frame_thresh,
+                        unsigned int target_kbps, int num_frames,
+                        int change_frame, std::vector<bool> *coded) {
+  ControlTestEncoder encoder(AOM_USAGE_REALTIME, 352, 288);
+  encoder.cfg().rc_end_usage = AOM_CBR;
+  encoder.cfg().rc_target_bitrate = target_kbps;
+  encoder.cfg().rc_dropframe_thresh = drop_frame_thresh;
+  ASSERT_NO_FATAL_FAILURE(encoder.Init(9));
+  ASSERT_EQ(aom_codec_control(encoder.ctx(), AV1E_SET_TUNE_CONTENT,
+                              AOM_CONTENT_SCREEN),
+            AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(encoder.ctx(), AV1E_SET_DROP_STATIC_FRAMES,
+                              drop_static_frames),
+            AOM_CODEC_OK);
+
+  coded->clear();
+  for (int i = 0; i < num_frames; ++i) {
+    if (i == 0 || i == change_frame) {
+      DrawScreenPattern(encoder.image(), i == 0 ? 0 : 1);
+    }
+    const int num_coded = encoder.num_frames();
+    ASSERT_EQ(encoder.Encode(encoder.image()), AOM_CODEC_OK);
+    coded->push_back(encoder.num_frames() > num_coded);
+  }
+}
+
+TEST(EncodeAPI, DropStaticFrames) {
+  std::vector<bool> coded;
+  ASSERT_NO_FATAL_FAILURE(EncodeStaticScreen(0, 30, 1000, 50, -1, &coded));
+  EXPECT_EQ(std::count(coded.begin(), coded.end(), true), 50);
+  ASSERT_NO_FATAL_FAILURE(EncodeStaticScreen(1, 30, 1000, 50, -1, &coded));
+  EXPECT_LT(std::count(coded.begin(), coded.end(), true), 50);
+  // Frame dropping is disabled with a drop frame threshold of 0.
+  ASSERT_NO_FATAL_FAILURE(EncodeStaticScreen(1, 0, 1000, 50, -1, &coded));
+  EXPECT_EQ(std::count(coded.begin(), coded.end(), true), 50);
+}
+
+// Frames dropped for the buffer level during a run of static frames do not
+// hide a later change of the content.
+TEST(EncodeAPI, DropStaticFramesAfterBufferDrop) {
+  std::vector<bool> coded;
+  ASSERT_NO_FATAL_FAILURE(EncodeStaticScreen(1, 30, 100, 100, 60, &coded));
+  // A frame is dropped for the buffer level before the static frames can be
+  // dropped.
+  ASSERT_LT(std::count(coded.begin() + 1, coded.begin() + 31, true), 30);
+  // The static frames are dropped once the quality ramped up.
+  EXPECT_FALSE(coded[59]);
+  // The new content is coded, then dropped again once it is static.
+  EXPECT_TRUE(coded[60]);
+  EXPECT_FALSE(coded[99]);
+}
+
+// Encodes a short clip with motion at the given cq-level, importing and
+// exporting analysis files when the paths are not empty. Returns the status of
+// the first failing aom_codec_encode() call.
+aom_codec_err_t EncodeWithAnalysisFiles(int cq_level,
+                                        const std::string &import_path,
+                                        const std::string &export_path) {
+  ControlTestEncoder encoder(AOM_USAGE_GOOD_QUALITY, 160, 96);
+  aom_codec_enc_cfg_t &cfg = encoder.cfg();
+  cfg.g_lag_in_frames = 10;
+  cfg.rc_end_usage = AOM_Q;
+  encoder.Init(5);
+  if (::testing::Test::HasFatalFailure()) return AOM_CODEC_ERROR;
+  EXPECT_EQ(aom_codec_control(encoder.ctx(), AOME_SET_CQ_LEVEL, cq_level),
+            AOM_CODEC_OK);
+  if (!import_path.empty()) {
+    EXPECT_EQ(aom_codec_control(encoder.ctx(), AV1E_SET_ANALYSIS_IMPORT_FILE,
+                                import_path.c_str()),
+              AOM_CODEC_OK);
+  }
+  if (!export_path.empty()) {
+    EXPECT_EQ(aom_codec_control(encoder.ctx(), AV1E_SET_ANALYSIS_EXPORT_FILE,
+                                export_path.c_str()),
+              AOM_CODEC_OK);
+  }
+
+  aom_image_t *image = encoder.image();
+  aom_codec_err_t res = AOM_CODEC_OK;
+  for (int frame = 0; frame <= 12 && res == AOM_CODEC_OK; ++frame) {
+    for (unsigned int plane = 0; plane < 3; ++plane) {
+      const unsigned int w = plane ? (cfg.g_w + 1) / 2 : cfg.g_w;
+      const unsigned int h = plane ? (cfg.g_h + 1) / 2 : cfg.g_h;
+      for (unsigned int r = 0; r < h; ++r) {
+        for (unsigned int c = 0; c < w; ++c) {
+          image->planes[plane][r * image->stride[plane] + c] =
+              static_cast<uint8_t>(((c + 2 * frame) ^ (r + frame)) * 8);
+        }
+      }
+    }
+    // The last iteration flushes the encoder.
+    res = encoder.Encode(frame < 12 ? image : nullptr);
+  }
+  return res;
+}
+
+std::string ReadFileContents(const std::string &path) {
+  std::string contents;
+  FILE *file = fopen(path.c_str(), "rb");
+  if (file == nullptr) return contents;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), file)) > 0) contents.append(buf, n);
+  fclose(file);
+  return contents;
+}
+
+TEST(EncodeAPI, AnalysisFileRoundTrip) {
+  libaom_test::TempOutFile first;
+  libaom_test::TempOutFile second;
+  ASSERT_NE(first.file(), nullptr);
+  ASSERT_NE(second.file(), nullptr);
+  ASSERT_EQ(EncodeWithAnalysisFiles(30, "", first.file_name()), AOM_CODEC_OK);
+  const std::string first_contents = ReadFileContents(first.file_name());
+  // The 16 byte header is followed by at least one motion field.
+  ASSERT_GT(first_contents.size(), 16u);
+
+  // A re-encode at another cq-level reuses every imported motion field, so it
+  // exports the same motion fields again.
+  ASSERT_EQ(EncodeWithAnalysisFiles(50, first.file_name(), second.file_name()),
+            AOM_CODEC_OK);
+  EXPECT_EQ(ReadFileContents(second.file_name()), first_contents);
+
+  // Importing and exporting the same file is rejected.
+  EXPECT_EQ(
+      EncodeWithAnalysisFiles(50, first.file_name(), first.file_name()),
+      AOM_CODEC_INVALID_PARAM);
+}
+
+TEST(EncodeAPI, AnalysisFileInvalid) {
+  libaom_test::TempOutFile file;
+  ASSERT_NE(file.file(), nullptr);
+  fputs("not an analysis file", file.file());
+  fflush(file.file());
+  EXPECT_EQ(EncodeWithAnalysisFiles(30, file.file_name(), ""),
+            AOM_CODEC_INVALID_PARAM);
+}
+
+// Encodes a clip translating by 2 pixels right and 1 down per frame. When
+// 'hint' is not null, every block of every frame gets it as its motion vector
+// hint, refined by 'search_range' full pels. Stores the compressed stream in
+// *data.
+void EncodeWithMvHints(const aom_mv_hint_t *hint, unsigned int search_range,
+                       std::vector<uint8_t> *data) {
+  ControlTestEncoder encoder(AOM_USAGE_GOOD_QUALITY, 160, 96);
+  aom_codec_enc_cfg_t &cfg = encoder.cfg();
+  cfg.g_lag_in_frames = 10;
+  cfg.rc_end_usage = AOM_Q;
+  ASSERT_NO_FATAL_FAILURE(encoder.Init(5));
+  ASSERT_EQ(aom_codec_control(encoder.ctx(), AOME_SET_CQ_LEVEL, 40),
+            AOM_CODEC_OK);
+
+  const unsigned int block_size = 16;
+  const unsigned int rows = (cfg.g_h + block_size - 1) / block_size;
+  const unsigned int cols = (cfg.g_w + block_size - 1) / block_size;
+  std::vector<aom_mv_hint_t> hints(rows * cols);
+  if (hint != nullptr) hints.assign(rows * cols, *hint);
+  aom_mv_hint_map_t map = { hints.data(), block_size, rows, cols,
+                            search_range };
+
+  aom_image_t *image = encoder.image();
+  for (int frame = 0; frame <= 12; ++frame) {
+    for (unsigned int plane = 0; plane < 3; ++plane) {
+      const unsigned int w = plane ? (cfg.g_w + 1) / 2 : cfg.g_w;
+      const unsigned int h = plane ? (cfg.g_h + 1) / 2 : cfg.g_h;
+      const int dx = plane ? frame : 2 * frame;
+      const int dy = plane ? frame / 2 : frame;
+      for (unsigned int r = 0; r < h; ++r) {
+        for (unsigned int c = 0; c < w; ++c) {
+          const int x = static_cast<int>(c) - dx;
+          const int y = static_cast<int>(r) - dy;
+          image->planes[plane][r * image->stride[plane] + c] =
+              static_cast<uint8_t>(((x * 7) ^ (y * 13)) & 0xff);
+        }
+      }
+    }
+    if (hint != nullptr && frame < 12) {
+      ASSERT_EQ(aom_codec_control(encoder.ctx(), AV1E_SET_MV_HINTS, &map),
+                AOM_CODEC_OK);
+    }
+    // The last iteration flushes the encoder.
+    ASSERT_EQ(encoder.Encode(frame < 12 ? image : nullptr), AOM_CODEC_OK);
+  }
+  *data = encoder.data();
+}
+
+TEST(EncodeAPI, MvHints) {
+  std::vector<uint8_t> no_hints;
+  ASSERT_NO_FATAL_FAILURE(EncodeWithMvHints(nullptr, 0, &no_hints));
+  ASSERT_FALSE(no_hints.empty());
+
+  // The content of each block comes from 2 pixels left and 1 above in the
+  // previous frame. Exact hints refined in a small window find the same
+  // motion.
+  const aom_mv_hint_t exact = { -1 * 8, -2 * 8, -1 };
+  std::vector<uint8_t> exact_hints;
+  ASSERT_NO_FATAL_FAILURE(EncodeWithMvHints(&exact, 4, &exact_hints));
+  EXPECT_LT(exact_hints.size(), no_hints.size() + no_hints.size() / 10);
+
+  // Hints far from the motion, which the search may not leave, cost bits.
+  const aom_mv_hint_t wrong = { 12 * 8, 20 * 8, -1 };
+  std::vector<uint8_t> wrong_hints;
+  ASSERT_NO_FATAL_FAILURE(EncodeWithMvHints(&wrong, 1, &wrong_hints));
+  EXPECT_NE(wrong_hints, no_hints);
+  EXPECT_GT(wrong_hints.size(), exact_hints.size());
+}
+
+TEST(EncodeAPI, MvHintsInvalid) {
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_GOOD_QUALITY),
+            AOM_CODEC_OK);
+  cfg.g_w = 100;
+  cfg.g_h = 60;
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+
+  std::vector<aom_mv_hint_t> hints(13 * 8);
+  aom_mv_hint_map_t map = { hints.data(), 8, 8, 13, 0 };
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_MV_HINTS, &map), AOM_CODEC_OK);
+  map.rows = 7;
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_MV_HINTS, &map),
+            AOM_CODEC_INVALID_PARAM);
+  map.rows = 8;
+  map.block_size = 32;
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_MV_HINTS, &map),
+            AOM_CODEC_INVALID_PARAM);
+  map.block_size = 8;
+  map.hints = nullptr;
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_MV_HINTS, &map),
+            AOM_CODEC_INVALID_PARAM);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_MV_HINTS,
+                              static_cast<aom_mv_hint_map_t *>(nullptr)),
+            AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+}
 #endif  // !CONFIG_REALTIME_ONLY
 
 }  // namespace
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "test/yuv_video_source.h"
+
+namespace {
+
+// Checks that the cache of the full pixel search distortions does not change
+// the encoded bitstream.
+class FullPelSearchCacheTest
+    : public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  FullPelSearchCacheTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        cpu_used_(GET_PARAM(2)), disable_cache_(0) {}
+  ~FullPelSearchCacheTest() override = default;
+
+  void SetUp() override {
+    InitializeConfig(encoding_mode_);
+    cfg_.g_lag_in_frames = 5;
+    cfg_.rc_end_usage = AOM_VBR;
+    cfg_.rc_target_bitrate = 500;
+  }
+
+  void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                          ::libaom_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, cpu_used_);
+      encoder->Control(AV1E_DISABLE_FULLPEL_SEARCH_CACHE_UNIT_TEST,
+                       disable_cache_);
+    }
+  }
+
+  void FramePktHook(const aom_codec_cx_pkt_t *pkt) override {
+    ::libaom_test::MD5 md5_enc;
+    md5_enc.Add(reinterpret_cast<uint8_t *>(pkt->data.frame.buf),
+                pkt->data.frame.sz);
+    md5_enc_.push_back(md5_enc.Get());
+  }
+
+  void DoTest() {
+    ::libaom_test::YUVVideoSource video("hantro_collage_w352h288.yuv",
+                                       AOM_IMG_FMT_I420, 352, 288, 30, 1, 0, 8);
+
+    disable_cache_ = 0;
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    const std::vector<std::string> md5_with_cache = md5_enc_;
+    md5_enc_.clear();
+
+    disable_cache_ = 1;
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    const std::vector<std::string> md5_without_cache = md5_enc_;
+    md5_enc_.clear();
+
+    ASSERT_FALSE(md5_with_cache.empty());
+    ASSERT_EQ(md5_with_cache, md5_without_cache);
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  int cpu_used_;
+  unsigned int disable_cache_;
+  std::vector<std::string> md5_enc_;
+};
+
+TEST_P(FullPelSearchCacheTest, MatchesWithoutCache) { DoTest(); }
+
+AV1_INSTANTIATE_TEST_SUITE(FullPelSearchCacheTest,
+                           ::testing::Values(::libaom_test::kOnePassGood,
+                                             ::libaom_test::kTwoPassGood),
+                           ::testing::Values(2, 4));
+
+}  // namespace
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "av1/encoder/hash_motion.h"
+#include "test/acm_random.h"
+
+namespace {
+
+const int kWidth = 200;
+const int kHeight = 136;
+const int kSbSizeLog2 = 6;
+
+class HashTableUpdateTest : public ::testing::Test {
+ protected:
+  HashTableUpdateTest() : pixels_(kWidth * kHeight) {
+    rnd_.Reset(libaom_test::ACMRandom::DeterministicSeed());
+    memset(&picture_, 0, sizeof(picture_));
+    picture_.y_buffer = pixels_.data();
+    picture_.y_stride = kWidth;
+    picture_.y_crop_width = kWidth;
+    picture_.y_crop_height = kHeight;
+    // Flat areas are only hashed at aligned positions.
+    for (int i = 0; i < kWidth * kHeight; ++i) {
+      pixels_[i] = (i % kWidth) < kWidth / 2 ? rnd_.Rand8() : 128;
+    }
+  }
+
+  void Update(IntraBCHashInfo *info, int min_block_size) {
+    av1_hash_table_init(info);
+    ASSERT_TRUE(
+        av1_hash_table_update(info, &picture_, min_block_size, kSbSizeLog2));
+  }
+
+  // Fills a rectangle with new random pixels.
+  void ChangeRect(int x, int y, int width, int height) {
+    for (int r = y; r < y + height; ++r) {
+      for (int c = x; c < x + width; ++c) pixels_[r * kWidth + c] = rnd_.Rand8();
+    }
+  }
+
+  static void ExpectSameTables(const hash_table &a, const hash_table &b) {
+    const uint32_t kNumBuckets = 1 << 19;
+    ASSERT_EQ(memcmp(a.bucket_start, b.bucket_start,
+                     (kNumBuckets + 1) * sizeof(a.bucket_start[0])),
+              0);
+    EXPECT_GT(a.bucket_start[kNumBuckets], 0u);
+    EXPECT_EQ(memcmp(a.entries, b.entries,
+                     a.bucket_start[kNumBuckets] * sizeof(a.entries[0])),
+              0);
+  }
+
+  libaom_test::ACMRandom rnd_;
+  std::vector<uint8_t> pixels_;
+  YV12_BUFFER_CONFIG picture_;
+};
+
+TEST_F(HashTableUpdateTest, MatchesFullBuild) {
+  for (int min_block_size = 4; min_block_size <= 8; min_block_size *= 2) {
+    IntraBCHashInfo incremental = {};
+    Update(&incremental, min_block_size);
+    // Change the inside of a superblock, an area across several superblocks,
+    // and the bottom right corner.
+    ChangeRect(70, 10, 20, 20);
+    ChangeRect(100, 50, 40, 40);
+    ChangeRect(kWidth - 3, kHeight - 3, 3, 3);
+    Update(&incremental, min_block_size);
+
+    IntraBCHashInfo full = {};
+    Update(&full, min_block_size);
+    ExpectSameTables(incremental.intrabc_hash_table, full.intrabc_hash_table);
+
+    // Nothing changed.
+    Update(&incremental, min_block_size);
+    ExpectSameTables(incremental.intrabc_hash_table, full.intrabc_hash_table);
+
+    av1_hash_table_destroy(&incremental.intrabc_hash_table);
+    av1_hash_table_destroy(&full.intrabc_hash_table);
+  }
+}
+
+TEST_F(HashTableUpdateTest, FindsMovedBlock) {
+  IntraBCHashInfo info = {};
+  Update(&info, 4);
+  // Copy a 16x16 block of the random area to the flat one.
+  for (int r = 0; r < 16; ++r) {
+    memcpy(&pixels_[(80 + r) * kWidth + 150], &pixels_[(8 + r) * kWidth + 8],
+           16);
+  }
+  Update(&info, 4);
+
+  uint32_t hash_value1, hash_value2;
+  std::vector<uint32_t> buffers(4 * AOM_BUFFER_SIZE_FOR_BLOCK_HASH);
+  for (int i = 0; i < 4; ++i) {
+    info.hash_value_buffer[i / 2][i % 2] =
+        &buffers[i * AOM_BUFFER_SIZE_FOR_BLOCK_HASH];
+  }
+  av1_get_block_hash_value(&info, &pixels_[80 * kWidth + 150], kWidth, 16,
+                           &hash_value1, &hash_value2, 0);
+  const hash_table *table = &info.intrabc_hash_table;
+  const int count = av1_hash_table_count(table, hash_value1);
+  ASSERT_GE(count, 2);
+  const block_hash *blocks = av1_hash_get_first_block(table, hash_value1);
+  int num_found = 0;
+  for (int i = 0; i < count; ++i) {
+    if (blocks[i].hash_value2 != hash_value2) continue;
+    EXPECT_TRUE((blocks[i].x == 8 && blocks[i].y == 8) ||
+                (blocks[i].x == 150 && blocks[i].y == 80));
+    ++num_found;
+  }
+  EXPECT_EQ(num_found, 2);
+  av1_hash_table_destroy(&info.intrabc_hash_table);
+}
+
+}  // namespace
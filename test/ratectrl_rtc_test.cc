@@ -11,7 +11,9 @@
 
 #include "av1/ratectrl_rtc.h"
 
+#include <cstring>
 #include <memory>
+#include <vector>
 
 #include "test/codec_factory.h"
 #include "test/encode_test_driver.h"
@@ -502,4 +504,168 @@ TEST_P(RcInterfaceTest, SvcDynamicSpatial) { RunSvcDynamicSpatial(); }
 
 AV1_INSTANTIATE_TEST_SUITE(RcInterfaceTest, ::testing::Values(0, 3));
 
+// Returns the configuration of the i-th stream of RcBatchTest: single layer,
+// 1x3 or 3x3 SVC, with and without cyclic refresh, screen content and frame
+// drops.
+aom::AV1RateControlRtcConfig GetBatchStreamConfig(int i) {
+  aom::AV1RateControlRtcConfig cfg;
+  cfg.width = 320 + 160 * (i % 3);
+  cfg.height = cfg.width * 3 / 4;
+  cfg.max_quantizer = 52;
+  cfg.min_quantizer = 2;
+  cfg.target_bandwidth = 300 + 100 * i;
+  cfg.max_intra_bitrate_pct = 1000;
+  cfg.aq_mode = i % 2 ? 3 : 0;
+  cfg.is_screen = i % 4 == 2;
+  if (i % 5 == 3) {
+    cfg.target_bandwidth = 60;
+    cfg.frame_drop_thresh = 30;
+    cfg.max_consec_drop = 8;
+  }
+  cfg.ss_number_layers = i % 3 == 1 ? 3 : 1;
+  cfg.ts_number_layers = i % 3 == 0 ? 1 : 3;
+  if (cfg.ss_number_layers > 1 || cfg.ts_number_layers > 1) {
+    cfg.target_bandwidth = 0;
+    for (int sl = 0; sl < cfg.ss_number_layers; ++sl) {
+      const int spatial_bitrate =
+          cfg.ss_number_layers == 1 ? 600 : kSpatialLayerBitrate[sl];
+      cfg.scaling_factor_num[sl] = 1;
+      cfg.scaling_factor_den[sl] = 1 << (cfg.ss_number_layers - 1 - sl);
+      for (int tl = 0; tl < cfg.ts_number_layers; ++tl) {
+        const int layer = sl * cfg.ts_number_layers + tl;
+        cfg.layer_target_bitrate[layer] =
+            kTemporalRateAllocation3Layer[tl] * spatial_bitrate / 100;
+        cfg.max_quantizers[layer] = cfg.max_quantizer;
+        cfg.min_quantizers[layer] = cfg.min_quantizer;
+      }
+      cfg.target_bandwidth += spatial_bitrate;
+    }
+    for (int tl = 0; tl < cfg.ts_number_layers; ++tl)
+      cfg.ts_rate_decimator[tl] = 1 << (cfg.ts_number_layers - 1 - tl);
+  }
+  return cfg;
+}
+
+// Returns a frame size decreasing with the qp, around the target bitrate.
+uint64_t GetBatchFrameSize(const aom::AV1RateControlRtcConfig &cfg, int frame,
+                           const aom::AV1FrameParamsRTC &frame_params,
+                           int qp) {
+  const uint64_t bytes_per_frame =
+      static_cast<uint64_t>(cfg.target_bandwidth) * 1000 / 8 / 30 /
+      cfg.ss_number_layers;
+  const uint64_t size = bytes_per_frame * 3 * 64 / (qp + 64);
+  return (frame_params.frame_type == aom::kKeyFrame ? 4 * size : size) +
+         (frame * 7919 + qp * 31) % 400;
+}
+
+// Runs streams of all kinds with one AV1RateControlRTC each and with an
+// AV1RateControlRTCBatch, and checks that they make the same decisions.
+TEST(RcBatchTest, MatchesPerStreamRateControl) {
+  const int kNumStreams = 12;
+  const int kNumSuperframes = 300;
+  std::vector<aom::AV1RateControlRtcConfig> cfgs;
+  std::vector<std::unique_ptr<aom::AV1RateControlRTC>> rc_apis;
+  std::unique_ptr<aom::AV1RateControlRTCBatch> batch =
+      aom::AV1RateControlRTCBatch::Create();
+  ASSERT_NE(batch, nullptr);
+  for (int i = 0; i < kNumStreams; ++i) {
+    cfgs.push_back(GetBatchStreamConfig(i));
+    rc_apis.push_back(aom::AV1RateControlRTC::Create(cfgs[i]));
+    ASSERT_NE(rc_apis[i], nullptr);
+    ASSERT_EQ(batch->AddStream(cfgs[i]), i);
+  }
+
+  int num_drops = 0;
+  for (int frame = 0; frame < kNumSuperframes; ++frame) {
+    if (frame == 100) {
+      // Replace stream 1, whose index is reused.
+      ASSERT_TRUE(batch->RemoveStream(1));
+      cfgs[1] = GetBatchStreamConfig(kNumStreams);
+      rc_apis[1] = aom::AV1RateControlRTC::Create(cfgs[1]);
+      ASSERT_EQ(batch->AddStream(cfgs[1]), 1);
+    } else if (frame == 150) {
+      for (int i = 0; i < kNumStreams; i += 4) {
+        cfgs[i].target_bandwidth /= 2;
+        for (int layer = 0; layer < 9; ++layer)
+          cfgs[i].layer_target_bitrate[layer] /= 2;
+        ASSERT_TRUE(rc_apis[i]->UpdateRateControl(cfgs[i]));
+        ASSERT_TRUE(batch->UpdateRateControl(i, cfgs[i]));
+      }
+    }
+    // One batch per spatial layer, with the streams which have the layer.
+    for (int sl = 0; sl < 3; ++sl) {
+      std::vector<int> streams;
+      std::vector<aom::AV1FrameParamsRTC> frame_params;
+      for (int i = 0; i < kNumStreams; ++i) {
+        if (sl >= cfgs[i].ss_number_layers) continue;
+        aom::AV1FrameParamsRTC params;
+        params.frame_type =
+            frame % 100 == 0 && sl == 0 ? aom::kKeyFrame : aom::kInterFrame;
+        params.spatial_layer_id = sl;
+        params.temporal_layer_id =
+            cfgs[i].ts_number_layers == 3 ? kTemporalId3Layer[frame % 4] : 0;
+        streams.push_back(i);
+        frame_params.push_back(params);
+      }
+      std::vector<aom::AV1FrameDecisionRTC> decisions(streams.size());
+      ASSERT_TRUE(batch->ComputeQP(streams.data(), frame_params.data(),
+                                   streams.size(), decisions.data()));
+      std::vector<int> encoded_streams;
+      std::vector<uint64_t> sizes;
+      for (size_t j = 0; j < streams.size(); ++j) {
+        const int i = streams[j];
+        aom::AV1RateControlRTC *const rc_api = rc_apis[i].get();
+        const aom::AV1FrameDecisionRTC &decision = decisions[j];
+        ASSERT_EQ(rc_api->ComputeQP(frame_params[j]), decision.drop_decision)
+            << "stream " << i << " frame " << frame << " layer " << sl;
+        if (decision.drop_decision == aom::FrameDropDecision::kDrop) {
+          ++num_drops;
+          continue;
+        }
+        ASSERT_EQ(rc_api->GetQP(), decision.qp)
+            << "stream " << i << " frame " << frame << " layer " << sl;
+        const aom::AV1LoopfilterLevel lpf = rc_api->GetLoopfilterLevel();
+        const aom::AV1LoopfilterLevel &batch_lpf = decision.loopfilter_level;
+        EXPECT_EQ(lpf.filter_level[0], batch_lpf.filter_level[0]);
+        EXPECT_EQ(lpf.filter_level[1], batch_lpf.filter_level[1]);
+        EXPECT_EQ(lpf.filter_level_u, batch_lpf.filter_level_u);
+        EXPECT_EQ(lpf.filter_level_v, batch_lpf.filter_level_v);
+        const aom::AV1CdefInfo cdef = rc_api->GetCdefInfo();
+        EXPECT_EQ(cdef.cdef_strength_y, decision.cdef_info.cdef_strength_y);
+        EXPECT_EQ(cdef.cdef_strength_uv, decision.cdef_info.cdef_strength_uv);
+        EXPECT_EQ(cdef.damping, decision.cdef_info.damping);
+        aom::AV1SegmentationData seg;
+        aom::AV1SegmentationData batch_seg;
+        const bool has_seg = rc_api->GetSegmentationData(&seg);
+        ASSERT_EQ(batch->GetSegmentationData(i, &batch_seg), has_seg);
+        if (has_seg) {
+          ASSERT_EQ(seg.segmentation_map_size, batch_seg.segmentation_map_size);
+          EXPECT_EQ(memcmp(seg.segmentation_map, batch_seg.segmentation_map,
+                           seg.segmentation_map_size),
+                    0);
+          EXPECT_EQ(memcmp(seg.delta_q, batch_seg.delta_q,
+                           seg.delta_q_size * sizeof(*seg.delta_q)),
+                    0);
+        }
+        const uint64_t size =
+            GetBatchFrameSize(cfgs[i], frame, frame_params[j], decision.qp);
+        rc_api->PostEncodeUpdate(size);
+        encoded_streams.push_back(i);
+        sizes.push_back(size);
+      }
+      ASSERT_TRUE(batch->PostEncodeUpdate(encoded_streams.data(), sizes.data(),
+                                          sizes.size()));
+    }
+  }
+  // Check that some frames were dropped, otherwise the test misses the drop
+  // path.
+  EXPECT_GT(num_drops, 0);
+
+  const int invalid_stream = kNumStreams;
+  aom::AV1FrameParamsRTC params = { aom::kInterFrame, 0, 0 };
+  aom::AV1FrameDecisionRTC decision;
+  EXPECT_FALSE(batch->ComputeQP(&invalid_stream, &params, 1, &decision));
+  EXPECT_FALSE(batch->RemoveStream(invalid_stream));
+}
+
 }  // namespace
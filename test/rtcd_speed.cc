@@ -0,0 +1,521 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+//  Times every specialization of the rtcd functions against C.
+//
+//  The table of the functions is generated from the rtcd_defs.pl files by
+//  build/cmake/rtcd.pl --bench. The arguments are made up from their types
+//  and names: pixel, coefficient, mask and output buffers, strides, block and
+//  transform sizes, bit depths, filters, convolution, transform and warp
+//  parameters, scan orders, quantizers and frame buffers. The functions taking
+//  other arguments are listed as unsupported. The functions taking the block
+//  size, the transform size or the bit depth as arguments are timed for each
+//  of kSizes and kBitDepths.
+//
+//  Usage: test_rtcd_speed [--filter=<substring>] [--min_time_us=<n>]
+//                         [--ghz=<f>] [--output=<file>]
+//
+//  The results are written as JSON. The cycles are derived from the time and
+//  --ghz when given, and read from the time stamp counter on x86 otherwise.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "config/aom_config.h"
+#include "config/aom_dsp_rtcd.h"
+#include "config/aom_scale_rtcd.h"
+#include "config/av1_rtcd.h"
+
+#include "aom/aom_integer.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_ports/aom_timer.h"
+#include "aom_ports/bitops.h"
+#include "aom_ports/mem.h"
+#include "aom_scale/yv12config.h"
+#include "av1/common/blockd.h"
+#include "av1/common/common_data.h"
+#include "av1/common/convolve.h"
+#include "av1/common/enums.h"
+#include "av1/common/filter.h"
+#include "av1/common/scan.h"
+#include "av1/common/warped_motion.h"
+#include "test/acm_random.h"
+
+#if AOM_ARCH_X86 || AOM_ARCH_X86_64
+#include "aom_ports/x86.h"
+#elif AOM_ARCH_ARM || AOM_ARCH_AARCH64
+#include "aom_ports/arm.h"
+#elif AOM_ARCH_PPC
+#include "aom_ports/ppc.h"
+#endif
+
+namespace {
+
+// Each buffer holds kBufferSize x kBufferSize elements. The functions are given
+// pointers kBorder rows and columns into the buffers, so that they may read
+// the pixels above and left of the block, and the filter taps around it.
+const int kBufferSize = 192;
+const int kBorder = 32;
+const int kNumBuffers = 8;
+
+const int kSizes[] = { 4, 8, 16, 32, 64 };
+const int kNumSizes = sizeof(kSizes) / sizeof(kSizes[0]);
+const int kBitDepths[] = { 8, 10, 12 };
+const int kNumBitDepths = sizeof(kBitDepths) / sizeof(kBitDepths[0]);
+
+// Size of the frames given to the frame buffer functions.
+const int kFrameWidth = 352;
+const int kFrameHeight = 288;
+
+DECLARE_ALIGNED(16, const int16_t, kFilter[8]) = { 0, 2, -6, 126,
+                                                   8, -2, 0,  0 };
+
+// Quantizers of the DC and AC steps 56 and 63, as made by
+// av1_init_quantizer().
+DECLARE_ALIGNED(16, const int16_t, kZbin[8]) = { 37, 41, 41, 41,
+                                                 41, 41, 41, 41 };
+DECLARE_ALIGNED(16, const int16_t, kRound[8]) = { 21, 24, 24, 24,
+                                                  24, 24, 24, 24 };
+DECLARE_ALIGNED(16, const int16_t, kQuant[8]) = { -28086, -32247, -32247,
+                                                  -32247, -32247, -32247,
+                                                  -32247, -32247 };
+DECLARE_ALIGNED(16, const int16_t, kQuantShift[8]) = { 2048, 2048, 2048, 2048,
+                                                       2048, 2048, 2048, 2048 };
+DECLARE_ALIGNED(16, const int16_t, kDequant[8]) = { 56, 63, 63, 63,
+                                                    63, 63, 63, 63 };
+
+// The identity warp.
+DECLARE_ALIGNED(16, const int32_t, kWarpMat[8]) = {
+  0, 0, 1 << WARPEDMODEL_PREC_BITS, 0, 0, 1 << WARPEDMODEL_PREC_BITS, 0, 0
+};
+
+typedef void (*RtcdBenchFn)(void);
+
+struct RtcdBenchArgs {
+  void *pix8[kNumBuffers];
+  void *pix16[kNumBuffers];
+  void *coeff16[kNumBuffers];
+  void *coeff32[kNumBuffers];
+  void *out[kNumBuffers];
+  // Blending weights, from 0 to 64.
+  uint8_t *mask;
+  const int16_t *filter;
+  const InterpKernel *kernels;
+  const InterpFilterParams *filter_params;
+  ConvolveParams *conv_params;
+  // Compound prediction into an intermediate buffer.
+  ConvolveParams *compound_params;
+  WienerConvolveParams *wiener_params;
+  DIST_WTD_COMP_PARAMS *jcp_param;
+  const int32_t *warp_mat;
+  const int16_t *zbin;
+  const int16_t *round;
+  const int16_t *quant;
+  const int16_t *quant_shift;
+  const int16_t *dequant;
+  YV12_BUFFER_CONFIG *frames[2];
+  int stride;
+  int w;
+  int h;
+  int bd;
+  int subpel;
+  // Transform of a w x h block, set by Buffers::SetBlockSize().
+  TX_SIZE tx_size;
+  TxfmParam *txfm_param;
+  const int16_t *scan;
+  const int16_t *iscan;
+  int n_coeffs;
+  int log_scale;
+};
+
+typedef void (*RtcdBenchCall)(RtcdBenchFn fn, const RtcdBenchArgs *a);
+
+enum {
+  RTCD_BENCH_SIZE_ARGS = 1 << 0,
+  RTCD_BENCH_BIT_DEPTH_ARG = 1 << 1,
+  // Limits of the sizes of kSizes the function is timed for.
+  RTCD_BENCH_MIN_SIZE_16 = 1 << 2,
+  RTCD_BENCH_MAX_SIZE_32 = 1 << 3,
+};
+
+struct RtcdBenchEntry {
+  const char *name;
+  const char *isa;
+  int caps;
+  RtcdBenchFn fn;
+  RtcdBenchCall call;
+  // Block size in the name of the function, 0 if none.
+  int width;
+  int height;
+  // Bit depth of the pixels when it is not an argument.
+  int bit_depth;
+  int flags;
+};
+
+#include "config/aom_dsp_rtcd_bench.inc"
+#include "config/aom_scale_rtcd_bench.inc"
+#include "config/av1_rtcd_bench.inc"
+
+const RtcdBenchEntry *const kTables[] = { aom_dsp_rtcd_bench_entries,
+                                          aom_scale_rtcd_bench_entries,
+                                          av1_rtcd_bench_entries };
+const char *const *const kUnsupported[] = { aom_dsp_rtcd_bench_unsupported,
+                                            aom_scale_rtcd_bench_unsupported,
+                                            av1_rtcd_bench_unsupported };
+const int kNumTables = sizeof(kTables) / sizeof(kTables[0]);
+
+int GetCpuCaps() {
+#if AOM_ARCH_X86 || AOM_ARCH_X86_64
+  return x86_simd_caps();
+#elif AOM_ARCH_ARM || AOM_ARCH_AARCH64
+  return aom_arm_cpu_caps();
+#elif AOM_ARCH_PPC
+  return ppc_simd_caps();
+#else
+  return 0;
+#endif
+}
+
+uint64_t ReadCycles() {
+#if AOM_ARCH_X86 || AOM_ARCH_X86_64
+  return x86_readtsc64();
+#else
+  return 0;
+#endif
+}
+
+// Buffers of each element type given to the functions.
+enum { kPix8, kPix16, kCoeff16, kCoeff32, kOut, kNumPools };
+const int kElementSize[kNumPools] = { 1, 2, 2, 4, 8 };
+const size_t kBufferBytes = kBufferSize * kBufferSize * sizeof(int64_t);
+
+class Buffers {
+ public:
+  Buffers() {
+    for (int p = 0; p < kNumPools; ++p) {
+      for (int i = 0; i < kNumBuffers; ++i) {
+        buffers_[p][i] = static_cast<uint8_t *>(aom_memalign(32, kBufferBytes));
+      }
+    }
+    // The contents are made once, and copied before each function is timed.
+    libaom_test::ACMRandom rnd(libaom_test::ACMRandom::DeterministicSeed());
+    const size_t size = kNumBuffers * kBufferBytes;
+    pix8_.resize(size);
+    for (size_t j = 0; j < size; ++j) pix8_[j] = rnd.Rand8();
+    for (int b = 0; b < kNumBitDepths; ++b) {
+      pix16_[b].resize(size / 2);
+      for (size_t j = 0; j < size / 2; ++j) {
+        pix16_[b][j] = rnd.Rand16() & ((1 << kBitDepths[b]) - 1);
+      }
+    }
+    // Small coefficients, as large ones would overflow some functions.
+    coeff16_.resize(size / 2);
+    for (size_t j = 0; j < size / 2; ++j) coeff16_[j] = rnd.Rand8() - 128;
+    coeff32_.resize(size / 4);
+    for (size_t j = 0; j < size / 4; ++j) coeff32_[j] = rnd.Rand8() - 128;
+    mask_.resize(kBufferBytes);
+    for (size_t j = 0; j < kBufferBytes; ++j) mask_[j] = rnd.PseudoUniform(65);
+    mask_buffer_ = static_cast<uint8_t *>(aom_memalign(32, kBufferBytes));
+    compound_buffer_ =
+        static_cast<CONV_BUF_TYPE *>(aom_memalign(32, kBufferBytes));
+
+    frames_allocated_ = true;
+    for (int i = 0; i < 2; ++i) {
+      memset(&frames_[i], 0, sizeof(frames_[i]));
+      if (aom_alloc_frame_buffer(&frames_[i], kFrameWidth, kFrameHeight, 1, 1,
+                                 0, AOM_BORDER_IN_PIXELS, 0, 0, false)) {
+        frames_allocated_ = false;
+        continue;
+      }
+      for (size_t j = 0; j < frames_[i].frame_size; ++j) {
+        frames_[i].buffer_alloc[j] = pix8_[j % size];
+      }
+    }
+
+    filter_params_ =
+        av1_get_interp_filter_params_with_block_size(EIGHTTAP_REGULAR, 8);
+    jcp_param_.use_dist_wtd_comp_avg = 1;
+    jcp_param_.fwd_offset = 9;
+    jcp_param_.bck_offset = 7;
+  }
+
+  ~Buffers() {
+    for (int p = 0; p < kNumPools; ++p) {
+      for (int i = 0; i < kNumBuffers; ++i) aom_free(buffers_[p][i]);
+    }
+    aom_free(mask_buffer_);
+    aom_free(compound_buffer_);
+    for (int i = 0; i < 2; ++i) aom_free_frame_buffer(&frames_[i]);
+  }
+
+  bool Allocated() const {
+    for (int p = 0; p < kNumPools; ++p) {
+      for (int i = 0; i < kNumBuffers; ++i) {
+        if (!buffers_[p][i]) return false;
+      }
+    }
+    return mask_buffer_ && compound_buffer_ && frames_allocated_;
+  }
+
+  // Restores the contents of the buffers, with pixels of bit depth bd, and
+  // points args at them.
+  void Reset(int bd, RtcdBenchArgs *args) {
+    int b = 0;
+    while (b < kNumBitDepths - 1 && kBitDepths[b] < bd) ++b;
+    const uint8_t *const contents[kNumPools] = {
+      pix8_.data(), reinterpret_cast<const uint8_t *>(pix16_[b].data()),
+      reinterpret_cast<const uint8_t *>(coeff16_.data()),
+      reinterpret_cast<const uint8_t *>(coeff32_.data()), nullptr
+    };
+    void **const pointers[kNumPools] = { args->pix8, args->pix16, args->coeff16,
+                                         args->coeff32, args->out };
+    const int offset = kBorder * kBufferSize + kBorder;
+    for (int p = 0; p < kNumPools; ++p) {
+      for (int i = 0; i < kNumBuffers; ++i) {
+        if (contents[p]) {
+          memcpy(buffers_[p][i], contents[p] + i * kBufferBytes, kBufferBytes);
+        } else {
+          memset(buffers_[p][i], 0, kBufferBytes);
+        }
+        pointers[p][i] = buffers_[p][i] + offset * kElementSize[p];
+      }
+    }
+    memcpy(mask_buffer_, mask_.data(), kBufferBytes);
+    memset(compound_buffer_, 0, kBufferBytes);
+    args->mask = mask_buffer_ + offset;
+    args->filter = kFilter;
+    args->kernels =
+        reinterpret_cast<const InterpKernel *>(filter_params_->filter_ptr);
+    args->filter_params = filter_params_;
+    conv_params_ = get_conv_params_no_round(0, 0, nullptr, 0, 0, bd);
+    args->conv_params = &conv_params_;
+    compound_params_ = get_conv_params_no_round(
+        1, 0, compound_buffer_ + offset, kBufferSize, 1, bd);
+    compound_params_.use_dist_wtd_comp_avg = 1;
+    compound_params_.fwd_offset = jcp_param_.fwd_offset;
+    compound_params_.bck_offset = jcp_param_.bck_offset;
+    args->compound_params = &compound_params_;
+    wiener_params_ = get_conv_params_wiener(bd);
+    args->wiener_params = &wiener_params_;
+    args->jcp_param = &jcp_param_;
+    args->warp_mat = kWarpMat;
+    args->zbin = kZbin;
+    args->round = kRound;
+    args->quant = kQuant;
+    args->quant_shift = kQuantShift;
+    args->dequant = kDequant;
+    args->frames[0] = &frames_[0];
+    args->frames[1] = &frames_[1];
+    args->stride = kBufferSize;
+    args->bd = bd;
+    args->subpel = 3;
+    args->txfm_param = &txfm_param_;
+  }
+
+  // Sets the transform of args to the largest one fitting in the w x h block,
+  // with the DCT.
+  void SetBlockSize(RtcdBenchArgs *args) {
+    TX_SIZE tx_size = TX_4X4;
+    for (int t = 0; t < TX_SIZES_ALL; ++t) {
+      if (tx_size_wide[t] == args->w && tx_size_high[t] == args->h) {
+        tx_size = static_cast<TX_SIZE>(t);
+      }
+    }
+    const int pixels = tx_size_wide[tx_size] * tx_size_high[tx_size];
+    args->tx_size = tx_size;
+    args->scan = av1_scan_orders[tx_size][DCT_DCT].scan;
+    args->iscan = av1_scan_orders[tx_size][DCT_DCT].iscan;
+    // The coefficients of 64 point transforms are only coded up to 32.
+    args->n_coeffs = AOMMIN(tx_size_wide[tx_size], 32) *
+                     AOMMIN(tx_size_high[tx_size], 32);
+    args->log_scale = (pixels > 256) + (pixels > 1024);
+    txfm_param_.tx_type = DCT_DCT;
+    txfm_param_.tx_size = tx_size;
+    txfm_param_.lossless = 0;
+    txfm_param_.bd = args->bd;
+    txfm_param_.is_hbd = args->bd > 8;
+    txfm_param_.tx_set_type = EXT_TX_SET_ALL16;
+    txfm_param_.eob = args->n_coeffs;
+  }
+
+ private:
+  uint8_t *buffers_[kNumPools][kNumBuffers];
+  std::vector<uint8_t> pix8_;
+  std::vector<uint16_t> pix16_[kNumBitDepths];
+  std::vector<int16_t> coeff16_;
+  std::vector<int32_t> coeff32_;
+  std::vector<uint8_t> mask_;
+  uint8_t *mask_buffer_;
+  CONV_BUF_TYPE *compound_buffer_;
+  YV12_BUFFER_CONFIG frames_[2];
+  bool frames_allocated_;
+  const InterpFilterParams *filter_params_;
+  ConvolveParams conv_params_;
+  ConvolveParams compound_params_;
+  WienerConvolveParams wiener_params_;
+  DIST_WTD_COMP_PARAMS jcp_param_;
+  TxfmParam txfm_param_;
+};
+
+struct Timing {
+  double ns_per_call;
+  double cycles_per_call;
+};
+
+// Calls the function until min_time_us have passed, doubling the number of
+// calls each round.
+Timing Time(const RtcdBenchEntry &entry, const RtcdBenchArgs &args,
+            int64_t min_time_us) {
+  entry.call(entry.fn, &args);
+  for (int64_t num_calls = 1;; num_calls *= 2) {
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    const uint64_t start_cycles = ReadCycles();
+    for (int64_t i = 0; i < num_calls; ++i) entry.call(entry.fn, &args);
+    const uint64_t cycles = ReadCycles() - start_cycles;
+    aom_usec_timer_mark(&timer);
+    const int64_t elapsed_us = aom_usec_timer_elapsed(&timer);
+    if (elapsed_us >= min_time_us) {
+      Timing timing;
+      timing.ns_per_call = 1000.0 * elapsed_us / num_calls;
+      timing.cycles_per_call = static_cast<double>(cycles) / num_calls;
+      return timing;
+    }
+  }
+}
+
+void PrintUsage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [--filter=<substring>] [--min_time_us=<n>] "
+          "[--ghz=<f>] [--output=<file>]\n",
+          program);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const char *filter = "";
+  const char *output = nullptr;
+  int64_t min_time_us = 2000;
+  double ghz = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (!strncmp(argv[i], "--filter=", 9)) {
+      filter = argv[i] + 9;
+    } else if (!strncmp(argv[i], "--min_time_us=", 14)) {
+      min_time_us = atoi(argv[i] + 14);
+    } else if (!strncmp(argv[i], "--ghz=", 6)) {
+      ghz = atof(argv[i] + 6);
+    } else if (!strncmp(argv[i], "--output=", 9)) {
+      output = argv[i] + 9;
+    } else {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (min_time_us <= 0) min_time_us = 1;
+
+  FILE *const out = output ? fopen(output, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "Failed to open %s\n", output);
+    return EXIT_FAILURE;
+  }
+  Buffers buffers;
+  if (!buffers.Allocated()) {
+    fprintf(stderr, "Failed to allocate the buffers\n");
+    return EXIT_FAILURE;
+  }
+
+  aom_dsp_rtcd();
+  aom_scale_rtcd();
+  av1_rtcd();
+
+  const int caps = GetCpuCaps();
+#if AOM_ARCH_X86 || AOM_ARCH_X86_64
+  const bool has_cycles = true;
+#else
+  const bool has_cycles = ghz > 0;
+#endif
+  fprintf(out, "{\n\"cpu_caps\": %d,\n\"min_time_us\": %" PRId64 ",\n", caps,
+          min_time_us);
+  fprintf(out, "\"results\": [");
+  int num_results = 0;
+  // Times of the C function, by size and bit depth.
+  double c_ns[kNumSizes][kNumBitDepths] = {};
+  for (int t = 0; t < kNumTables; ++t) {
+    for (const RtcdBenchEntry *entry = kTables[t]; entry->name; ++entry) {
+      if (!strstr(entry->name, filter)) continue;
+      if ((entry->caps & caps) != entry->caps) continue;
+      const bool is_c = !strcmp(entry->isa, "c");
+      const int num_sizes =
+          (entry->flags & RTCD_BENCH_SIZE_ARGS) ? kNumSizes : 1;
+      const int num_bit_depths =
+          (entry->flags & RTCD_BENCH_BIT_DEPTH_ARG) ? kNumBitDepths : 1;
+      for (int b = 0; b < num_bit_depths; ++b) {
+        RtcdBenchArgs args;
+        const int bd = (entry->flags & RTCD_BENCH_BIT_DEPTH_ARG)
+                           ? kBitDepths[b]
+                           : entry->bit_depth;
+        buffers.Reset(bd, &args);
+        for (int s = 0; s < num_sizes; ++s) {
+          if (entry->flags & RTCD_BENCH_SIZE_ARGS) {
+            if ((entry->flags & RTCD_BENCH_MIN_SIZE_16) && kSizes[s] < 16) {
+              continue;
+            }
+            if ((entry->flags & RTCD_BENCH_MAX_SIZE_32) && kSizes[s] > 32) {
+              continue;
+            }
+            args.w = args.h = kSizes[s];
+          } else {
+            args.w = entry->width;
+            args.h = entry->height;
+          }
+          buffers.SetBlockSize(&args);
+          const Timing timing = Time(*entry, args, min_time_us);
+          if (is_c) c_ns[s][b] = timing.ns_per_call;
+          const double cycles = ghz > 0 ? timing.ns_per_call * ghz
+                                        : timing.cycles_per_call;
+
+          fprintf(out,
+                  "%s\n  {\"function\": \"%s\", \"isa\": \"%s\", "
+                  "\"width\": %d, \"height\": %d, \"bit_depth\": %d, "
+                  "\"ns_per_call\": %.2f",
+                  num_results++ ? "," : "", entry->name, entry->isa, args.w,
+                  args.h, bd, timing.ns_per_call);
+          if (has_cycles) {
+            fprintf(out, ", \"cycles_per_call\": %.1f", cycles);
+            if (args.w > 0) {
+              fprintf(out, ", \"cycles_per_pixel\": %.3f",
+                      cycles / (args.w * args.h));
+            }
+          }
+          // The C function comes first in the table.
+          fprintf(out, ", \"speedup\": %.2f}",
+                  c_ns[s][b] / timing.ns_per_call);
+        }
+      }
+    }
+  }
+  fprintf(out, "\n],\n\"unsupported\": [");
+  int num_unsupported = 0;
+  for (int t = 0; t < kNumTables; ++t) {
+    for (const char *const *name = kUnsupported[t]; *name; ++name) {
+      if (!strstr(*name, filter)) continue;
+      fprintf(out, "%s\n  \"%s\"", num_unsupported++ ? "," : "", *name);
+    }
+  }
+  fprintf(out, "\n]\n}\n");
+  if (output) fclose(out);
+  return EXIT_SUCCESS;
+}
@@ -78,8 +78,47 @@ svc_encoder_s1_t2() {
   [ -e "${output_file}" ] || return 1
 }
 
+# Runs svc_encoder_rtc in the simulcast mode with 3 spatial layers and 3
+# temporal layers, encoding the spatial layers in parallel as separate
+# streams, and checks each layer stream against its decoder.
+svc_encoder_s3_t3_parallel_streams() {
+  local encoder="${LIBAOM_BIN_PATH}/svc_encoder_rtc${AOM_TEST_EXE_SUFFIX}"
+  local output_file="${AOM_TEST_OUTPUT_DIR}/svc_encoder_rtc"
+
+  if [ ! -x "${encoder}" ]; then
+    elog "${encoder} does not exist or is not executable."
+    return 1
+  fi
+
+  # The layers are scaled with libyuv, and checked with the decoder.
+  if [ "$(aom_config_option_enabled CONFIG_LIBYUV)" != "yes" ] || \
+     [ "$(av1_decode_available)" != "yes" ]; then
+    return 0
+  fi
+
+  eval "${AOM_TEST_PREFIX}" "${encoder}" "${common_flags}" \
+      "--width=${YUV_RAW_INPUT_WIDTH}" \
+      "--height=${YUV_RAW_INPUT_HEIGHT}" \
+      "-lm 11" \
+      "--speed=8" \
+      "--threads=4" \
+      "--target-bitrate=780" \
+      "--bitrates=50,70,100,120,170,230,250,350,450" \
+      "--spatial-layers=3" \
+      "--temporal-layers=3" \
+      "--timebase=1/30" \
+      "--parallel-streams" \
+      "--test-decode=1" \
+      "${YUV_RAW_INPUT}" \
+      "-o ${output_file}" \
+      ${devnull} || return 1
+
+  [ -e "${output_file}" ] || return 1
+}
+
 if [ "$(av1_encode_available)" = "yes" ]; then
   svc_encoder_rtc_tests="svc_encoder_s1_t3
-                         svc_encoder_s1_t2"
+                         svc_encoder_s1_t2
+                         svc_encoder_s3_t3_parallel_streams"
   run_tests svc_encoder_verify_environment "${svc_encoder_rtc_tests}"
 fi
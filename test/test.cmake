@@ -104,6 +104,7 @@ list(APPEND AOM_UNIT_TEST_WEBM_SOURCES "${AOM_ROOT}/test/webm_video_source.h")
 add_to_libaom_test_srcs(AOM_UNIT_TEST_WEBM_SOURCES)
 list(APPEND AOM_TEST_INTRA_PRED_SPEED_SOURCES "${AOM_GEN_SRC_DIR}/usage_exit.c"
             "${AOM_ROOT}/test/test_intra_pred_speed.cc")
+list(APPEND AOM_TEST_RTCD_SPEED_SOURCES "${AOM_ROOT}/test/rtcd_speed.cc")
 
 if(CONFIG_AV1_DECODER)
   list(APPEND AOM_UNIT_TEST_COMMON_SOURCES
@@ -218,6 +219,7 @@ if(NOT BUILD_SHARED_LIBS)
               "${AOM_ROOT}/test/firstpass_test.cc"
               "${AOM_ROOT}/test/fwht4x4_test.cc"
               "${AOM_ROOT}/test/hadamard_test.cc"
+              "${AOM_ROOT}/test/hash_motion_test.cc"
               "${AOM_ROOT}/test/horver_correlation_test.cc"
               "${AOM_ROOT}/test/masked_sad_test.cc"
               "${AOM_ROOT}/test/masked_variance_test.cc"
@@ -258,6 +260,9 @@ if(NOT BUILD_SHARED_LIBS)
                 "${AOM_ROOT}/test/binary_codes_test.cc"
                 "${AOM_ROOT}/test/boolcoder_test.cc"
                 "${AOM_ROOT}/test/cnn_test.cc"
+                "${AOM_ROOT}/test/decode_header_only_test.cc"
+                "${AOM_ROOT}/test/decode_incremental_test.cc"
+                "${AOM_ROOT}/test/decode_mv_hints_test.cc"
                 "${AOM_ROOT}/test/decode_multithreaded_test.cc"
                 "${AOM_ROOT}/test/divu_small_test.cc"
                 "${AOM_ROOT}/test/dr_prediction_test.cc"
@@ -265,6 +270,7 @@ if(NOT BUILD_SHARED_LIBS)
                 "${AOM_ROOT}/test/error_resilience_test.cc"
                 "${AOM_ROOT}/test/ethread_test.cc"
                 "${AOM_ROOT}/test/film_grain_table_test.cc"
+                "${AOM_ROOT}/test/fullpel_search_cache_test.cc"
                 "${AOM_ROOT}/test/kf_test.cc"
                 "${AOM_ROOT}/test/lossless_test.cc"
                 "${AOM_ROOT}/test/quant_test.cc"
@@ -289,8 +295,11 @@ if(NOT BUILD_SHARED_LIBS)
                        "${AOM_ROOT}/test/av1_encoder_parms_get_to_decoder.cc"
                        "${AOM_ROOT}/test/av1_ext_tile_test.cc"
                        "${AOM_ROOT}/test/cnn_test.cc"
+                       "${AOM_ROOT}/test/decode_header_only_test.cc"
+                       "${AOM_ROOT}/test/decode_mv_hints_test.cc"
                        "${AOM_ROOT}/test/decode_multithreaded_test.cc"
                        "${AOM_ROOT}/test/error_resilience_test.cc"
+                       "${AOM_ROOT}/test/fullpel_search_cache_test.cc"
                        "${AOM_ROOT}/test/kf_test.cc"
                        "${AOM_ROOT}/test/lossless_test.cc"
                        "${AOM_ROOT}/test/sb_multipass_test.cc"
@@ -506,6 +515,13 @@ function(setup_aom_test_targets)
     endif()
   endif()
 
+  if(NOT BUILD_SHARED_LIBS)
+    add_executable(test_rtcd_speed ${AOM_TEST_RTCD_SPEED_SOURCES})
+    set_property(TARGET test_rtcd_speed PROPERTY FOLDER ${AOM_IDE_TEST_FOLDER})
+    target_link_libraries(test_rtcd_speed ${AOM_LIB_LINK_TYPE} aom aom_gtest)
+    list(APPEND AOM_APP_TARGETS test_rtcd_speed)
+  endif()
+
   target_link_libraries(test_libaom ${AOM_LIB_LINK_TYPE} aom aom_gtest)
 
   if(CONFIG_WEBM_IO)
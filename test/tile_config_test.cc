@@ -9,6 +9,8 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <vector>
+
 #include "aom/aom_codec.h"
 #include "aom_dsp/aom_dsp_common.h"
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
@@ -360,4 +362,76 @@ TEST_P(TileGroupTestLarge, TileGroupCountTest) {
 AV1_INSTANTIATE_TEST_SUITE(TileGroupTestLarge,
                            ::testing::ValuesIn(kTestModeParams),
                            ::testing::ValuesIn(tileGroupTestParams));
+
+// This class is used to test the chunks handed to the tile group callback in
+// the realtime mode. The test driver checks that the decoded frames match the
+// reconstruction of the encoder.
+class TileGroupCallbackTest
+    : public ::libaom_test::CodecTestWith3Params<int, int, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  TileGroupCallbackTest()
+      : EncoderTest(GET_PARAM(0)), speed_(GET_PARAM(1)), num_tg_(GET_PARAM(2)),
+        threads_(GET_PARAM(3)) {}
+  ~TileGroupCallbackTest() override = default;
+
+  void SetUp() override {
+    InitializeConfig(::libaom_test::kRealTime);
+    cfg_.rc_end_usage = AOM_CBR;
+    cfg_.g_threads = threads_;
+  }
+
+  bool DoDecode() const override { return true; }
+
+  static void AppendChunk(void *user_priv, const uint8_t *data, size_t size) {
+    auto *chunks = static_cast<std::vector<std::vector<uint8_t>> *>(user_priv);
+    chunks->emplace_back(data, data + size);
+  }
+
+  void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                          ::libaom_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, speed_);
+      // 2x2 tiles.
+      encoder->Control(AV1E_SET_TILE_COLUMNS, 1);
+      encoder->Control(AV1E_SET_TILE_ROWS, 1);
+      encoder->Control(AV1E_SET_NUM_TG, num_tg_);
+      aom_tile_group_cb_t cb = { AppendChunk, &chunks_ };
+      encoder->Control(AV1E_SET_TILE_GROUP_CALLBACK, &cb);
+    }
+    chunks_.clear();
+  }
+
+  void FramePktHook(const aom_codec_cx_pkt_t *pkt) override {
+    // At speed 7, the loop filter and CDEF levels of this clip are picked from
+    // the quantizer, so the headers, then each tile group, are handed out as
+    // soon as they are packed. Otherwise the frame is handed out in one chunk.
+    const size_t num_chunks = speed_ >= 7 && num_tg_ > 1 ? 1 + num_tg_ : 1;
+    EXPECT_EQ(chunks_.size(), num_chunks);
+    std::vector<uint8_t> streamed;
+    for (const auto &chunk : chunks_) {
+      streamed.insert(streamed.end(), chunk.begin(), chunk.end());
+    }
+    // The chunks are the packet without its temporal delimiter OBU: a header
+    // and a zero size.
+    const uint8_t *buf = static_cast<const uint8_t *>(pkt->data.frame.buf);
+    ASSERT_GE(pkt->data.frame.sz, 2u);
+    EXPECT_EQ(std::vector<uint8_t>(buf + 2, buf + pkt->data.frame.sz),
+              streamed);
+  }
+
+  const int speed_;
+  const int num_tg_;
+  const int threads_;
+  std::vector<std::vector<uint8_t>> chunks_;
+};
+
+TEST_P(TileGroupCallbackTest, ChunksMakeUpFrame) {
+  libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                     30, 1, 0, 10);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+}
+
+AV1_INSTANTIATE_TEST_SUITE(TileGroupCallbackTest, ::testing::Values(5, 7),
+                           ::testing::Values(1, 4), ::testing::Values(1, 4));
 }  // namespace
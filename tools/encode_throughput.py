@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+##
+## Copyright (c) 2024, Alliance for Open Media. All rights reserved
+##
+## This source code is subject to the terms of the BSD 2 Clause License and
+## the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+## was not distributed with this source code in the LICENSE file, you can
+## obtain it at www.aomedia.org/license/software. If the Alliance for Open
+## Media Patent License 1.0 was not distributed with this source code in the
+## PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+##
+"""Measures the throughput and the thread scaling of aomenc.
+
+Encodes every input with every combination of the usage modes, speeds, tile
+layouts, row-mt and fp-mt settings, thread counts and cq levels given, and
+reports for each combination:
+  - the encoding fps, as measured by aomenc,
+  - the speedup versus the same combination with 1 thread, and the parallel
+    efficiency (speedup / threads),
+  - the peak resident set size of aomenc,
+  - the BD-rate (PSNR) versus the first combination of the same input and
+    usage, when at least 4 cq levels are given.
+
+The inputs are y4m files, or synthetic clips of the given resolutions. The
+results are printed as a table, and written as JSON with --json.
+
+Example:
+  python3 tools/encode_throughput.py --aomenc=./aomenc --synthetic=1280x720 \\
+      --usages=rt --speeds=8,9,10 --threads=1,2,4,8 --tiles=0x0,1x1 \\
+      --cq-levels=20,30,40,50 --json=throughput.json
+"""
+
+import argparse
+import itertools
+import json
+import math
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+USAGES = {"good": "--good", "rt": "--rt", "allintra": "--allintra"}
+
+
+def int_list(value):
+  return [int(v) for v in value.split(",")]
+
+
+def str_list(value):
+  return value.split(",")
+
+
+def write_synthetic_y4m(path, width, height, frames, fps=30):
+  """Writes a 4:2:0 clip of a textured background panning diagonally."""
+  rnd = random.Random(0)
+  tex_w = width + frames
+  rows = []
+  for y in range(height + frames):
+    noise = rnd.randbytes(tex_w)
+    rows.append(
+        bytes(((x + y) // 4 + (x * y) % 61 + noise[x] % 16) & 255
+              for x in range(tex_w)))
+  chroma = bytes([128]) * (((width + 1) // 2) * ((height + 1) // 2))
+  with open(path, "wb") as f:
+    f.write(b"YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n" %
+            (width, height, fps))
+    for i in range(frames):
+      f.write(b"FRAME\n")
+      for y in range(height):
+        f.write(rows[y + i][i:i + width])
+      f.write(chroma)
+      f.write(chroma)
+
+
+def run_aomenc(aomenc, input_path, frames, config, cq_level, workdir):
+  """Encodes input_path and returns its fps, bitrate, PSNR and peak RSS."""
+  usage, speed, tiles, row_mt, fp_mt, threads = config
+  tile_cols, tile_rows = tiles.split("x")
+  cmd = [
+      aomenc, USAGES[usage], "--cpu-used=%d" % speed,
+      "--threads=%d" % threads, "--tile-columns=" + tile_cols,
+      "--tile-rows=" + tile_rows, "--row-mt=%d" % row_mt,
+      "--fp-mt=%d" % fp_mt, "--end-usage=q", "--cq-level=%d" % cq_level,
+      "--limit=%d" % frames, "--psnr", "-o",
+      os.path.join(workdir, "out.ivf"), input_path
+  ]
+  log_path = os.path.join(workdir, "aomenc.log")
+  with open(log_path, "wb") as log:
+    proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=log)
+    peak_rss_mb = None
+    if hasattr(os, "wait4"):
+      _, status, rusage = os.wait4(proc.pid, 0)
+      returncode = os.waitstatus_to_exitcode(status)
+      proc.returncode = returncode
+      # Kilobytes on Linux, bytes on macOS.
+      scale = 1024 * 1024 if sys.platform == "darwin" else 1024
+      peak_rss_mb = rusage.ru_maxrss / scale
+    else:
+      returncode = proc.wait()
+  with open(log_path, "rb") as log:
+    text = log.read().decode(errors="replace").replace("\r", "\n")
+  if returncode != 0:
+    sys.exit("Failed: %s\n%s" % (" ".join(cmd), text))
+  psnr = re.search(r"PSNR \(Overall/Avg/Y/U/V\)\s+([\d.]+)\s.*?(\d+) bps",
+                   text)
+  fps = re.findall(r"\(\s*([\d.]+) fps\)", text)
+  if not psnr or not fps:
+    sys.exit("Could not parse the output of: %s\n%s" % (" ".join(cmd), text))
+  return {
+      "fps": float(fps[-1]),
+      "bitrate_kbps": int(psnr.group(2)) / 1000.0,
+      "psnr": float(psnr.group(1)),
+      "peak_rss_mb": peak_rss_mb,
+  }
+
+
+def polyfit3(xs, ys):
+  """Returns the least squares cubic fit of ys, lowest order first."""
+  n = 4
+  a = [[sum(x**(i + j) for x in xs) for j in range(n)] for i in range(n)]
+  b = [sum(y * x**i for x, y in zip(xs, ys)) for i in range(n)]
+  # Gaussian elimination with partial pivoting.
+  for col in range(n):
+    pivot = max(range(col, n), key=lambda r: abs(a[r][col]))
+    a[col], a[pivot] = a[pivot], a[col]
+    b[col], b[pivot] = b[pivot], b[col]
+    for r in range(col + 1, n):
+      f = a[r][col] / a[col][col]
+      for c in range(col, n):
+        a[r][c] -= f * a[col][c]
+      b[r] -= f * b[col]
+  coeffs = [0.0] * n
+  for r in reversed(range(n)):
+    coeffs[r] = (b[r] - sum(a[r][c] * coeffs[c]
+                            for c in range(r + 1, n))) / a[r][r]
+  return coeffs
+
+
+def integrate3(coeffs, lo, hi):
+  def primitive(x):
+    return sum(c * x**(i + 1) / (i + 1) for i, c in enumerate(coeffs))
+
+  return primitive(hi) - primitive(lo)
+
+
+def bd_rate(ref_points, test_points):
+  """Returns the Bjontegaard rate difference in percent of test versus ref,
+  from lists of (bitrate, psnr) points."""
+  if len(ref_points) < 4 or len(test_points) < 4:
+    return None
+  # The curves are only comparable where the PSNR grows with the rate.
+  for points in (ref_points, test_points):
+    points = sorted(points)
+    if any(p[1] <= q[1] for q, p in zip(points, points[1:])):
+      return None
+  ref_psnr = [p for _, p in ref_points]
+  test_psnr = [p for _, p in test_points]
+  lo = max(min(ref_psnr), min(test_psnr))
+  hi = min(max(ref_psnr), max(test_psnr))
+  if lo >= hi:
+    return None
+  ref_fit = polyfit3(ref_psnr, [math.log(r) for r, _ in ref_points])
+  test_fit = polyfit3(test_psnr, [math.log(r) for r, _ in test_points])
+  avg_diff = (integrate3(test_fit, lo, hi) - integrate3(ref_fit, lo, hi)) / (
+      hi - lo)
+  return (math.exp(avg_diff) - 1) * 100
+
+
+def main():
+  parser = argparse.ArgumentParser(
+      description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+  parser.add_argument("--aomenc", default="./aomenc", help="aomenc binary")
+  parser.add_argument("--inputs", type=str_list, default=[],
+                      help="y4m files, comma separated")
+  parser.add_argument("--synthetic", type=str_list, default=[],
+                      help="resolutions of synthetic inputs, e.g. 640x360")
+  parser.add_argument("--frames", type=int, default=30,
+                      help="frames to encode")
+  parser.add_argument("--usages", type=str_list, default=["good"],
+                      help="good, rt or allintra")
+  parser.add_argument("--speeds", type=int_list, default=[6])
+  parser.add_argument("--tiles", type=str_list, default=["0x0"],
+                      help="log2 tile columns x log2 tile rows")
+  parser.add_argument("--row-mt", type=int_list, default=[1])
+  parser.add_argument("--fp-mt", type=int_list, default=[0])
+  parser.add_argument("--threads", type=int_list, default=[1, 2, 4, 8])
+  parser.add_argument("--cq-levels", type=int_list, default=[32],
+                      help="4 or more for BD-rates")
+  parser.add_argument("--json", help="file to write the results to")
+  args = parser.parse_args()
+
+  for usage in args.usages:
+    if usage not in USAGES:
+      sys.exit("Unknown usage: " + usage)
+  if not args.inputs and not args.synthetic:
+    sys.exit("No input: use --inputs or --synthetic")
+
+  with tempfile.TemporaryDirectory() as workdir:
+    inputs = list(args.inputs)
+    for resolution in args.synthetic:
+      width, height = (int(v) for v in resolution.split("x"))
+      path = os.path.join(workdir, "synthetic_%s.y4m" % resolution)
+      write_synthetic_y4m(path, width, height, args.frames)
+      inputs.append(path)
+
+    configs = list(
+        itertools.product(args.usages, args.speeds, args.tiles, args.row_mt,
+                          args.fp_mt, args.threads))
+    results = []
+    for input_path in inputs:
+      for config in configs:
+        points = []
+        for cq_level in args.cq_levels:
+          points.append(
+              run_aomenc(args.aomenc, input_path, args.frames, config,
+                         cq_level, workdir))
+        usage, speed, tiles, row_mt, fp_mt, threads = config
+        results.append({
+            "input": os.path.basename(input_path),
+            "usage": usage,
+            "speed": speed,
+            "tiles": tiles,
+            "row_mt": row_mt,
+            "fp_mt": fp_mt,
+            "threads": threads,
+            "fps": sum(p["fps"] for p in points) / len(points),
+            "peak_rss_mb": max(p["peak_rss_mb"] or 0 for p in points) or None,
+            "points": [(p["bitrate_kbps"], p["psnr"]) for p in points],
+        })
+
+  for r in results:
+    key = (r["input"], r["usage"], r["speed"], r["tiles"], r["row_mt"],
+           r["fp_mt"])
+    single = [
+        s for s in results if s["threads"] == 1 and
+        (s["input"], s["usage"], s["speed"], s["tiles"], s["row_mt"],
+         s["fp_mt"]) == key
+    ]
+    r["speedup"] = r["fps"] / single[0]["fps"] if single else None
+    r["efficiency"] = r["speedup"] / r["threads"] if single else None
+    ref = next(s for s in results
+               if (s["input"], s["usage"]) == (r["input"], r["usage"]))
+    r["bd_rate"] = bd_rate(ref["points"], r["points"])
+
+  print("%-24s %-8s %5s %5s %6s %5s %7s %8s %7s %7s %8s %8s" %
+        ("input", "usage", "speed", "tiles", "row_mt", "fp_mt", "threads",
+         "fps", "speedup", "effic.", "rss(MB)", "bd_rate"))
+  for r in results:
+
+    def fmt(value, spec):
+      return spec % value if value is not None else "-"
+
+    print("%-24s %-8s %5d %5s %6d %5d %7d %8.2f %7s %7s %8s %8s" %
+          (r["input"][:24], r["usage"], r["speed"], r["tiles"], r["row_mt"],
+           r["fp_mt"], r["threads"], r["fps"], fmt(r["speedup"], "%.2f"),
+           fmt(r["efficiency"], "%.2f"), fmt(r["peak_rss_mb"], "%.1f"),
+           fmt(r["bd_rate"], "%.2f%%")))
+
+  if args.json:
+    with open(args.json, "w") as f:
+      json.dump(results, f, indent=2)
+
+
+if __name__ == "__main__":
+  main()